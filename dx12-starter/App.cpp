@@ -1,11 +1,24 @@
 #include "App.h"
+#include "NullDevice.h"
+#include "Profiler.h"
+#include <chrono>
+#ifdef _WIN32
+#define GLFW_EXPOSE_NATIVE_WIN32
+#include <GLFW/glfw3native.h>
+#endif
 
-App::App()
+// imgui can take a frame or two after an input event to settle (hover, navigation), so only start sleeping once
+// this many frames in a row came out identical
+static uint32_t const               IDLE_FRAMES_BEFORE_WAIT = 3;
+
+App::App(const AppConfig& config)
+    : m_config(config)
 {
     // Create any new classes
     m_window_container = new Window();
     m_ui = new DX12Playground::UI();
     m_renderer = new Renderer();
+    m_jobs = new JobSystem();
 }
 
 /// <summary>
@@ -18,21 +31,220 @@ void App::Run()
         return;
     }
 
-    // The app loop
-    while (m_window_container->ShouldLoop())
+    auto startTime = std::chrono::steady_clock::now();
+    m_jobs->ResetStats();
+
+    // The app loop. Each frame is two jobs: the update (window events + building the UI) has to stay on the
+    // main thread, the render (recording + submission) can go anywhere. With pipelining, the update of the
+    // next frame runs while the current frame is still being submitted.
+    JobCounter updateDone;
+    const DX12Playground::UIFrame* frame = nullptr;
+    double inputTime = 0.0;
+    while (ShouldLoop())
     {
+        PROFILE_FRAME();
+
+        // Just in time: wait for the swap chain and the frame pacer before looking at input, so the frame shows the
+        // newest input possible. The previous frame has to be presented by then, so there is nothing to overlap.
+        if (m_config.pacing.justInTime)
+        {
+            m_jobs->Wait(&m_renderDone);
+            m_renderer->BeginFrame();
+        }
+
         // Run any updates before rendering
-        Update();
+        m_jobs->Run([this, &frame, &inputTime]()
+            {
+                inputTime = m_renderer->m_framePacer.SampleInput();
+                Update();
+                if (m_player)
+                {
+                    // The UI isn't built, the backend still needs its per frame setup (e.g. the font texture)
+                    m_renderer->m_device->NewUIFrame();
+                    frame = m_player->NextFrame();
+                }
+                else
+                {
+                    frame = &m_ui->Render();
+                }
+                if (frame && m_recorder && !m_recorder->WriteFrame(*frame))
+                {
+                    std::cout << "[Capture]: Unable to write " << m_config.capturePath << std::endl;
+                    delete m_recorder;
+                    m_recorder = nullptr;
+                }
+            }, &updateDone, JobAffinity::MainThread);
+        m_jobs->Wait(&updateDone);
+        if (!frame)
+        {
+            std::cout << "[Capture]: " << m_config.replayPath << " is broken, stopping" << std::endl;
+            break;
+        }
+
+        // Submissions go out in order, and the UI only keeps two frames around
+        m_jobs->Wait(&m_renderDone);
+
+        // Nothing on screen would change, keep showing the last presented frame
+        m_unchangedFrames = frame->Changed ? 0 : m_unchangedFrames + 1;
+        if (m_config.powerSaving && !frame->Changed && !m_forceRender)
+        {
+            m_skippedFrames++;
+            m_frameCount++;
+            continue;
+        }
+        m_forceRender = false;
 
         // Render the 3D!
-        Render();
+        m_jobs->Run([this, frame, inputTime]() { Render(*frame, inputTime); }, &m_renderDone);
+        if (!m_config.pipelined)
+            m_jobs->Wait(&m_renderDone);
+
+        m_frameCount++;
+    }
+    m_jobs->Wait(&m_renderDone);
+
+    if (m_config.headless)
+    {
+        std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - startTime;
+        double msPerFrame = elapsed.count() / (m_frameCount > 0 ? m_frameCount : 1);
+        std::cout << "[Headless]: " << m_frameCount << " frames in " << elapsed.count() << " ms ("
+            << msPerFrame << " ms/frame, " << 1000.0 / msPerFrame << " FPS)" << std::endl;
+
+        const UploadRingBufferStats& upload = m_renderer->m_uploadHeap.GetStats();
+        std::cout << "[Upload]: " << upload.Allocations << " allocations (" << upload.FailedAllocations << " failed), "
+            << upload.LastFrameBytes / 1024.0 << " KB last frame, peak " << upload.PeakUsedBytes / 1024.0 << " KB in flight, "
+            << upload.Wraps << " wraps" << std::endl;
+
+        const FontAtlasCacheStats& fonts = m_ui->GetFontCacheStats();
+        std::cout << "[Fonts]: " << fonts.Glyphs << " glyphs " << (fonts.Hit ? "loaded from " : "built, ")
+            << (fonts.Hit ? m_config.fonts.cachePath : fonts.Written ? "cache written" : "not cached") << " in "
+            << fonts.Seconds * 1000.0 << " ms (" << fonts.FileBytes / 1024.0 << " KB)" << std::endl;
+
+        const GlyphCacheStats& glyphs = m_ui->GetGlyphCacheStats();
+        if (glyphs.Pages > 0)
+            std::cout << "[GlyphCache]: " << glyphs.Resident << " glyphs in " << glyphs.PagesInUse << " of " << glyphs.Pages << " pages, "
+                << glyphs.Loaded << " loaded, " << glyphs.Evicted << " evicted (" << glyphs.PageEvictions << " pages), "
+                << glyphs.Missing << " missing, " << glyphs.Overflows << " overflows, " << glyphs.Uploads << " uploads ("
+                << glyphs.UploadedBytes / 1024.0 << " KB)" << std::endl;
+
+        const ImTextLayoutCacheStats& text = m_ui->GetTextLayoutCacheStats();
+        if (m_config.fonts.textLayoutCache)
+            std::cout << "[TextCache]: " << text.Layouts << " layouts (" << text.MemoryBytes / 1024.0 << " KB), last frame: " << text.MeasureHits << " of " << text.MeasureHits + text.MeasureMisses << " measures and "
+                << text.RenderHits << " of " << text.RenderHits + text.RenderMisses + text.RenderClipped << " draws from the cache ("
+                << text.RenderClipped << " clipped)" << std::endl;
+
+        UIAllocatorStats memory = m_ui->GetAllocatorStats();
+        std::cout << "[UIMemory]: " << memory.LiveBytes / 1024.0 << " KB in " << memory.LiveAllocations << " blocks (peak "
+            << memory.PeakLiveBytes / 1024.0 << " KB), " << memory.HeapBytes / 1024.0 << " KB from the heap in " << memory.HeapAllocations
+            << " allocations, last frame: " << memory.FrameAllocations << " allocations, " << memory.FrameHeapAllocations << " from the heap, "
+            << memory.CrossThreadFrees << " blocks freed across threads" << std::endl;
+
+        ImVector<ImDrawListMemoryInfo> drawLists;
+        m_ui->GetDrawListMemoryStats(drawLists);
+        size_t drawListCapacity = 0, drawListUsed = 0;
+        int drawListReallocs = 0;
+        for (const ImDrawListMemoryInfo& info : drawLists)
+        {
+            drawListCapacity += info.CapacityBytes;
+            drawListUsed += info.UsedBytes;
+            drawListReallocs += info.ReallocCount;
+        }
+        std::cout << "[DrawListMemory]: " << drawLists.Size << " lists, " << drawListCapacity / 1024.0 << " KB reserved, "
+            << drawListUsed / 1024.0 << " KB used, " << drawListReallocs << " reallocations" << std::endl;
+
+        JobSystemStats jobs = m_jobs->GetStats();
+        std::cout << "[Jobs]: " << m_jobs->GetThreadCount() << " threads, " << (m_config.pipelined ? "pipelined, " : "serial, ")
+            << jobs.Executed << " jobs, " << jobs.Stolen << " stolen, " << jobs.Sleeps << " sleeps" << std::endl;
+
+        const CommandListPoolStats& record = m_renderer->m_commandListPool.GetStats();
+        std::cout << "[Record]: " << m_renderer->m_commandListPool.GetThreadCount() << " threads, "
+            << (double)record.ListsSubmitted / (record.Frames > 0 ? record.Frames : 1) << " command lists/frame" << std::endl;
+
+        const RenderGraphStats& graph = m_renderer->m_renderGraph.GetStats();
+        std::cout << "[RenderGraph]: " << graph.Passes << " passes (" << graph.CulledPasses << " culled), "
+            << graph.Barriers << " barriers in " << graph.BarrierBatches << " batches per frame" << std::endl;
+
+        const GpuProfiler& gpu = m_renderer->m_gpuProfiler;
+        const GpuProfilerStats& gpuStats = gpu.GetStats();
+        std::cout << "[GpuTiming]: " << gpuStats.FramesResolved << " of " << gpuStats.FramesBegun << " frames read back, latency "
+            << gpuStats.LastLatency << " frames (max " << gpuStats.MaxLatency << "), last frame:";
+        for (const GpuZone& zone : gpu.GetLastFrame())
+            std::cout << " " << zone.Name << " " << (zone.End - zone.Start) / 1e6 << " ms";
+        std::cout << std::endl;
+
+        NullDevice* device = static_cast<NullDevice*>(m_renderer->m_device);
+        const NullDeviceStats& submitted = device->GetStats();
+        double drawDataCount = (double)(submitted.DrawDataSubmitted > 0 ? submitted.DrawDataSubmitted : 1);
+        std::cout << "[DrawCalls]: " << submitted.DrawCmds / drawDataCount << " commands merged into " << submitted.DrawCalls / drawDataCount
+            << " draw calls per frame, " << submitted.ScissorChanges / drawDataCount << " scissor and " << submitted.TextureChanges / drawDataCount
+            << " texture changes" << std::endl;
+
+        if (SoftwareRasterizer* rasterizer = device->GetRasterizer())
+        {
+            const SoftwareRasterizerStats& stats = rasterizer->GetStats();
+            std::cout << "[Software]: " << rasterizer->GetThreadCount() << " threads, "
+                << stats.PixelsShaded / stats.RasterSeconds / 1e6 << " Mpixels/s, "
+                << stats.Triangles / stats.RasterSeconds << " triangles/s" << std::endl;
+
+            if (m_config.screenshotPath != nullptr)
+            {
+                NullSwapChain* swapChain = static_cast<NullSwapChain*>(m_renderer->m_swapChain);
+                if (!SoftwareRasterizer::WriteTGA(m_config.screenshotPath, swapChain->GetLastPresentedBuffer()->GetFramebuffer()))
+                    std::cout << "[Software]: Unable to write " << m_config.screenshotPath << std::endl;
+            }
+        }
+    }
+
+    const FramePacerStats& pacing = m_renderer->m_framePacer.GetStats();
+    std::cout << "[Pacing]: latency " << m_config.pacing.maxLatency << (m_config.pacing.vsync ? ", vsync" : ", no vsync")
+        << (m_renderer->m_framePacer.AllowTearing() ? ", tearing" : "") << (m_config.pacing.justInTime ? ", just in time" : "")
+        << ": input to present " << pacing.TotalInputToPresent * 1000.0 / (pacing.Frames > 0 ? pacing.Frames : 1) << " ms avg, "
+        << pacing.MaxInputToPresent * 1000.0 << " ms max, " << pacing.MissedDeadlines << " missed, refresh "
+        << pacing.RefreshPeriod * 1000.0 << " ms, slept " << pacing.TotalSleep * 1000.0 << " ms" << std::endl;
+
+#ifdef PROFILER_ENABLE
+    if (m_config.tracePath != nullptr && !Profiler::ExportChromeTrace(m_config.tracePath))
+        std::cout << "[Profiler]: Unable to write " << m_config.tracePath << std::endl;
+#endif
+
+    if (m_recorder)
+    {
+        const DrawDataCaptureStats& capture = m_recorder->GetStats();
+        std::cout << "[Capture]: " << capture.Frames << " frames recorded, " << capture.RawBytes / 1024.0 << " KB -> "
+            << capture.CompressedBytes / 1024.0 << " KB (" << (double)capture.RawBytes / (capture.CompressedBytes > 0 ? capture.CompressedBytes : 1)
+            << "x)" << std::endl;
+    }
+    if (m_player)
+    {
+        const DrawDataCaptureStats& replay = m_player->GetStats();
+        std::cout << "[Replay]: " << replay.Frames << " frames replayed, " << replay.CompressedBytes / 1024.0 << " KB read, "
+            << replay.RemappedTextures << " commands with unknown textures" << std::endl;
     }
 
+    if (m_config.powerSaving)
+        std::cout << "[PowerSaving]: " << m_skippedFrames << " of " << m_frameCount << " frames skipped, "
+            << m_idleWaits << " idle waits" << std::endl;
+
     Exit();
 }
 
 bool App::Init()
 {
+    PROFILE_THREAD_NAME("Main");
+    m_jobs->Init(m_config.threads);
+    m_ui->show_dashboard = m_config.showDashboard;
+
+    if (m_config.headless)
+    {
+        // No window, no GPU. The null device records everything into memory.
+        if (!m_renderer->Init(CreateNullDevice(m_config.softwareRasterizer), nullptr, m_config.width, m_config.height, m_jobs, m_config.recordThreads, m_config.pacing)) {
+            m_renderer->CleanupDevice();
+            return false;
+        }
+        return m_ui->Init(nullptr, m_renderer->m_device, m_config.width, m_config.height, m_jobs, m_config.fonts) && InitCapture();
+    }
+
+#ifdef _WIN32
     // Initalize the window here and hydrate 
     m_window_container->Init();
     // Set a pointer to this Window class in GLFW
@@ -41,50 +253,109 @@ bool App::Init()
     glfwSetWindowUserPointer(m_window_container->m_window, this);
     glfwSetFramebufferSizeCallback(m_window_container->m_window, HandleResizeCallback);
 
+    int width, height;
+    glfwGetFramebufferSize(m_window_container->m_window, &width, &height);
+
     // Get HWND context from window - required for DX12 and imgui
     // Get application window
     // @see: https://www.glfw.org/docs/3.3/group__native.html#gafe5079aa79038b0079fc09d5f0a8e667
     HWND hwnd = glfwGetWin32Window(m_window_container->m_window);
 
     // Initialize the DX12 renderer
-    if (!m_renderer->Init(hwnd)) {
+    if (!m_renderer->Init(CreateDX12Device(), hwnd, width, height, m_jobs, m_config.recordThreads, m_config.pacing)) {
         m_renderer->CleanupDevice();
         return true;
     }
 
     // Initialize the UI (aka imgui). Requires the window context + DX12 device.
-    m_ui->Init(hwnd, m_renderer->m_pd3dDevice, m_renderer->m_pd3dSrvDescHeap);
+    m_ui->Init(hwnd, m_renderer->m_device, width, height, m_jobs, m_config.fonts);
+    if (!InitCapture())
+        return false;
+#else
+    std::cout << "[App]: Windowed mode requires DirectX 12, run with --headless" << std::endl;
+    return false;
+#endif
 
 	return true;
 }
 
-void App::Render()
+bool App::InitCapture()
 {
-    m_ui->Render();
-    m_renderer->RenderUI(m_ui);
+    if (m_config.replayPath != nullptr)
+    {
+        m_player = new DrawDataPlayer();
+        if (!m_player->Open(m_config.replayPath))
+        {
+            std::cout << "[Capture]: Unable to read " << m_config.replayPath << std::endl;
+            return false;
+        }
+    }
+    if (m_config.capturePath != nullptr)
+    {
+        m_recorder = new DrawDataRecorder();
+        if (!m_recorder->Open(m_config.capturePath))
+        {
+            std::cout << "[Capture]: Unable to write " << m_config.capturePath << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void App::Render(const DX12Playground::UIFrame& frame, double inputTime)
+{
+    m_renderer->RenderUI(frame, inputTime);
 }
 
 void App::Update()
 {
-    m_window_container->Update();
+    PROFILE_ZONE("App::Update");
+    if (m_config.headless)
+        return;
+    // While idle, sleep until input arrives. The timeout keeps things like the frame rate counter ticking.
+    bool idle = m_config.powerSaving && m_unchangedFrames >= IDLE_FRAMES_BEFORE_WAIT;
+    if (idle)
+        m_idleWaits++;
+    m_window_container->Update(idle ? m_config.idleWakeSeconds : 0.0);
+}
+
+bool App::ShouldLoop()
+{
+    if (m_config.headless)
+        return m_frameCount < m_config.headlessFrames;
+    return m_window_container->ShouldLoop();
 }
 
 void App::Exit()
 {
     m_renderer->WaitForLastSubmittedFrame();
+    // The player's draw lists belong to the imgui context
+    delete m_player;
+    m_player = nullptr;
+    delete m_recorder;
+    m_recorder = nullptr;
     m_ui->Terminate();
-    m_window_container->Terminate();
+    m_renderer->CleanupDevice();
+    if (!m_config.headless)
+        m_window_container->Terminate();
+    m_jobs->Shutdown();
 }
 
 void App::HandleResize(int width, int height)
 {
     std::cout << "Resizing window" << std::endl;
+    // Called from the update, the previous frame may still be submitting to the swap chain
+    m_jobs->Wait(&m_renderDone);
     m_window_container->HandleResize(width, height);
     m_renderer->HandleResize(width, height);
+    // The resized back buffers hold nothing yet, even if the UI comes out the same
+    m_forceRender = true;
 }
 
+#ifdef _WIN32
 void App::HandleResizeCallback(GLFWwindow* window, int width, int height)
 {
     App* app = static_cast<App*>(glfwGetWindowUserPointer(window));
     app->HandleResize(width, height);
-}
\ No newline at end of file
+}
+#endif
\ No newline at end of file
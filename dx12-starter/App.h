@@ -2,6 +2,42 @@
 #include "Window.h"
 #include "UI.h"
 #include "Renderer.h"
+#include "JobSystem.h"
+#include "DrawDataCapture.h"
+
+struct AppConfig
+{
+	// Run on the null graphics device without opening a window. Useful for profiling the CPU side of a frame.
+	bool headless = false;
+	uint32_t headlessFrames = 10000;
+	// Headless only: draw frames with the software rasterizer, optionally saving the last one as a TGA
+	bool softwareRasterizer = false;
+	const char* screenshotPath = nullptr;
+	// Write the profiler's zones as a Chrome trace on exit
+	const char* tracePath = nullptr;
+	// Record the draw data of every UI frame to a file, or draw the frames of such a file instead of the UI
+	const char* capturePath = nullptr;
+	const char* replayPath = nullptr;
+	// Open the dashboard window (20 plots built on the job system) from the start
+	bool showDashboard = false;
+	// UI font, and the file its atlas is cached in
+	DX12Playground::UIFontConfig fonts;
+	// Job system threads (including the main thread), 0 for one per core
+	uint32_t threads = 0;
+	// Max command lists recorded in parallel, 0 for one per job system thread
+	uint32_t recordThreads = 0;
+	// Build the UI of frame N+1 while frame N is submitted on a worker. Off runs the two back to back.
+	// Has no effect with just in time pacing, which needs the previous frame presented before sampling input.
+	bool pipelined = true;
+	// Frame latency, vsync/tearing and just in time input sampling
+	FramePacerConfig pacing;
+	// Don't render or present frames whose UI is identical to the last one, and once idle, sleep until the next
+	// window event instead of polling. `idleWakeSeconds` bounds the sleep, so time based content still updates.
+	bool powerSaving = true;
+	double idleWakeSeconds = 0.25;
+	uint32_t width = 1280;
+	uint32_t height = 720;
+};
 
 /// <summary>
 /// The root application code. Opens a native window and runs DX12 renderer.
@@ -9,19 +45,34 @@
 class App
 {
 	public:
-	App();
+	App(const AppConfig& config = AppConfig());
 	void Run();
 	static void HandleResizeCallback(GLFWwindow* window, int width, int height);
 
 protected:
 	bool Init();
-	void Render();
+	bool InitCapture();
+	void Render(const DX12Playground::UIFrame& frame, double inputTime);
 	void Update();
 	void Exit();
 	void HandleResize(int width, int height);
+	bool ShouldLoop();
+	AppConfig m_config;
+	uint32_t m_frameCount = 0;
+	// Power saving: frames not rendered because nothing changed, and how many unchanged frames in a row
+	uint32_t m_skippedFrames = 0;
+	uint32_t m_idleWaits = 0;
+	uint32_t m_unchangedFrames = 0;
+	// Set when something outside the UI invalidated the back buffers (e.g. a resize)
+	bool m_forceRender = true;
 	Window* m_window_container = nullptr;
 	DX12Playground::UI* m_ui = nullptr;
 	Renderer* m_renderer = nullptr;
+	JobSystem* m_jobs = nullptr;
+	DrawDataRecorder* m_recorder = nullptr;
+	DrawDataPlayer* m_player = nullptr;
+	// Tracks the frame currently being submitted
+	JobCounter m_renderDone;
 
 
 };
@@ -0,0 +1,2569 @@
+#include "Benchmarks.h"
+#include "CommandListPool.h"
+#include "DescriptorAllocator.h"
+#include "DrawDataCapture.h"
+#include "FontAtlasCache.h"
+#include "FramePacer.h"
+#include "GlyphCache.h"
+#include "GpuProfiler.h"
+#include "JobSystem.h"
+#include "NullDevice.h"
+#include "Profiler.h"
+#include "RenderGraph.h"
+#include "SoftwareRasterizer.h"
+#include "UIAllocator.h"
+#include "UploadRingBuffer.h"
+#include "imgui_internal.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cfloat>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+static uint32_t const               BENCH_JOB_COUNT = 1 << 20;
+static int const                    BENCH_FORK_DEPTH = 20;
+static int const                    BENCH_DESCRIPTOR_FRAMES = 10000;
+static int const                    BENCH_DESCRIPTOR_FRAME_LATENCY = 3;
+static uint64_t const               BENCH_UPLOAD_RING_FRAMES = 100000;
+static uint32_t const               BENCH_UPLOAD_RING_CAPACITY = 64 * 1024;
+static uint32_t const               BENCH_UPLOAD_RING_MAX_LATENCY = 3;
+static int const                    BENCH_GRAPH_ITERATIONS = 50;
+static int const                    BENCH_PACING_FRAMES = 3000;
+static double const                 BENCH_PACING_REFRESH = 1.0 / 60.0;
+static double const                 BENCH_PACING_CPU_WORK = 0.004;
+static double const                 BENCH_PACING_GPU_WORK = 0.001;
+static int const                    BENCH_PROFILER_ZONES = 1 << 20;
+static int const                    BENCH_GPU_TIMING_FRAMES = 2000;
+static uint32_t const               BENCH_GPU_TIMING_FRAMES_IN_FLIGHT = 3;
+static uint32_t const               BENCH_RECORD_FRAMES = 100;
+static uint32_t const               BENCH_RECORD_FRAMES_IN_FLIGHT = 3;
+static uint32_t const               BENCH_RECORD_MIN_ITEMS_PER_LIST = 256;
+// Scene items per frame: less than one list's worth, a few lists' worth, and plenty for every thread
+static uint32_t const               BENCH_RECORD_ITEMS[] = { 100, 700, 20000 };
+// Rounds of busy work per item, standing in for culling an object and setting up its draw
+static uint32_t const               BENCH_RECORD_ITEM_WORK = 400;
+static int const                    BENCH_TESSELLATION_POINTS = 100000;
+static int const                    BENCH_TESSELLATION_ITERATIONS = 20;
+static float const                  BENCH_FONT_SIZES[] = { 13.0f, 16.0f, 20.0f, 24.0f, 32.0f, 40.0f, 48.0f, 64.0f };
+static char const* const            BENCH_FONT_CACHE_PATH = "bench_fonts.cache";
+static int const                    BENCH_GLYPH_CACHE_FRAMES = 600;
+static int const                    BENCH_GLYPH_CACHE_PAGES = 16;
+static int const                    BENCH_GLYPH_CACHE_PAGE_SIZE = 128;
+// Glyphs drawn per frame, and how far the window moves each frame. Every 100th frame draws a burst of glyphs instead.
+static int const                    BENCH_GLYPH_CACHE_WINDOW = 200;
+static int const                    BENCH_GLYPH_CACHE_STEP = 20;
+static int const                    BENCH_GLYPH_CACHE_BURST = 2000;
+static float const                  BENCH_SDF_FONT_SIZE = 32.0f;
+// Plain pixels at least this far from half coverage must be on the same side of the outline in the distance field
+static int const                    BENCH_SDF_COVERAGE_MARGIN = 64;
+// Share of those pixels a glyph may still disagree on, for thin features the two rasterizers resolve differently
+static double const                 BENCH_SDF_MAX_DISAGREEMENT = 0.01;
+// A log view: lines in 4 columns, of which 1 in BENCH_TEXT_CACHE_CHANGE_EVERY changes every frame
+static int const                    BENCH_TEXT_CACHE_LINES = 10000;
+static int const                    BENCH_TEXT_CACHE_FRAMES = 60;
+static int const                    BENCH_TEXT_CACHE_CHANGE_EVERY = 100;
+// Log panes: about 4 MB of lines, measured and drawn a line at a time, into a draw list reset every BENCH_TEXT_DECODE_DRAW_LINES.
+// The best of BENCH_TEXT_DECODE_RUNS runs is reported.
+static int const                    BENCH_TEXT_DECODE_BYTES = 4 << 20;
+static int const                    BENCH_TEXT_DECODE_RUNS = 15;
+static int const                    BENCH_TEXT_DECODE_DRAW_LINES = 256;
+// One line in this many gets a malformed UTF-8 sequence
+static int const                    BENCH_TEXT_DECODE_MALFORMED_EVERY = 97;
+// Windows of widgets hashed like a frame of a large UI, and a buffer hashed in one go
+static int const                    BENCH_HASH_WINDOWS = 64;
+static int const                    BENCH_HASH_WIDGETS_PER_WINDOW = 256;
+static int const                    BENCH_HASH_FRAMES = 200;
+static size_t const                 BENCH_HASH_BUFFER_BYTES = 1 << 20;
+// Key counts for the storage benchmark. Sorted insertion shifts half the storage per new key, so it is only timed up to
+// BENCH_STORAGE_MAX_SORTED_INSERTS keys; larger sorted storages are built in one go with BuildSortByKey().
+static int const                    BENCH_STORAGE_KEY_COUNTS[] = { 1000, 10000, 100000, 1000000 };
+static int const                    BENCH_STORAGE_MAX_SORTED_INSERTS = 20000;
+static int const                    BENCH_STORAGE_RUNS = 5;
+// imgui allocation churn: each round replaces random blocks among BENCH_UI_ALLOC_LIVE live ones, then frees them all.
+// Frames are the same round every frame, which has to fit in the arena since it never reuses freed blocks.
+static int const                    BENCH_UI_ALLOC_LIVE = 256;
+static int const                    BENCH_UI_ALLOC_OPS = 1024;
+static int const                    BENCH_UI_ALLOC_ROUNDS = 2000;
+static int const                    BENCH_UI_ALLOC_FRAMES = 500;
+static size_t const                 BENCH_UI_ALLOC_ARENA = 8 << 20;
+// Batches of blocks allocated on a worker and freed on the main thread, like draw lists built by jobs
+static int const                    BENCH_UI_ALLOC_HANDOFFS = 500;
+// Draw list retention: a kiosk UI running 15 minutes at 60 Hz, compressed into short timers. Window i shows up for 2
+// seconds every 10 + 2 * i seconds, and the first one has a frame with a lot more on every line every 20 seconds until
+// half time.
+static int const                    BENCH_DL_RETAIN_WINDOWS = 8;
+static int const                    BENCH_DL_RETAIN_FRAMES = 60 * 60 * 15;
+static int const                    BENCH_DL_RETAIN_WARM_UP = 60 * 60;
+static int const                    BENCH_DL_RETAIN_LINES = 30;
+static int const                    BENCH_DL_RETAIN_SPIKE_RECTS = 64;
+static float const                  BENCH_DL_RETAIN_COMPACT_TIMER = 5.0f;
+static float const                  BENCH_DL_RETAIN_SHRINK_DELAY = 30.0f;
+// Large meshes: two scatter plots of 2x2 pixel points (4 vertices each) side by side, a million vertices in all, and a
+// regular window's worth of small rects with a clip rect change every 50 of them.
+static int const                    BENCH_LARGE_MESH_POINTS = 250000;
+static int const                    BENCH_LARGE_MESH_UI_RECTS = 4000;
+static int const                    BENCH_LARGE_MESH_RUNS = 10;
+// Draw call merging: frames of overlapping windows with tables, child windows and plots, scrolled a bit every frame (or
+// the frames of a capture), all rendered by the software rasterizer.
+static int const                    BENCH_DRAW_MERGE_FRAMES = 120;
+static int const                    BENCH_DRAW_MERGE_RUNS = 10;
+static int const                    BENCH_DRAW_MERGE_WIDTH = 1280;
+static int const                    BENCH_DRAW_MERGE_HEIGHT = 720;
+static int const                    BENCH_DRAW_MERGE_TABLE_ROWS = 200;
+
+static double SecondsSince(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+enum class BenchTexFormat
+{
+	Alpha8,
+	RGBA32
+};
+
+// Headless imgui context for the benchmarks that run imgui frames: the font atlas built in 'format' with texture ID 1,
+// 60 fps, no ini file. With 'fontSize', the atlas holds that font (from 'fontPath', or imgui's default font) instead of
+// the default one.
+static ImGuiIO& CreateBenchContext(const ImVec2& displaySize, BenchTexFormat format, const char* fontPath = nullptr, float fontSize = 0.0f)
+{
+	ImGui::CreateContext();
+	ImGuiIO& io = ImGui::GetIO();
+	if (fontSize > 0.0f)
+	{
+		ImFontConfig config;
+		config.SizePixels = fontSize;
+		if (fontPath != nullptr)
+			io.Fonts->AddFontFromFileTTF(fontPath, fontSize, &config);
+		else
+			io.Fonts->AddFontDefault(&config);
+	}
+	unsigned char* pixels = nullptr;
+	int width = 0, height = 0;
+	if (format == BenchTexFormat::RGBA32)
+		io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	else
+		io.Fonts->GetTexDataAsAlpha8(&pixels, &width, &height);
+	io.Fonts->SetTexID((ImTextureID)(intptr_t)1);
+	io.DisplaySize = displaySize;
+	io.DeltaTime = 1.0f / 60.0f;
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+	io.IniFilename = nullptr;
+	return io;
+}
+
+static void Report(const char* name, JobSystem& jobs, uint64_t count, double seconds)
+{
+	JobSystemStats stats = jobs.GetStats();
+	std::cout << "[JobBench] " << name << ": " << count / seconds / 1e6 << " M jobs/s ("
+		<< seconds * 1e9 / count << " ns/job, " << stats.Stolen << " stolen, " << stats.Sleeps << " sleeps)" << std::endl;
+	jobs.ResetStats();
+}
+
+// Every job spawns two children until `depth` reaches zero, so spawning happens on all threads at once
+static void Fork(JobSystem* jobs, JobCounter* counter, int depth)
+{
+	if (depth == 0)
+		return;
+	jobs->Run([jobs, counter, depth]() { Fork(jobs, counter, depth - 1); }, counter);
+	jobs->Run([jobs, counter, depth]() { Fork(jobs, counter, depth - 1); }, counter);
+}
+
+void RunJobSystemBenchmark(uint32_t numThreads)
+{
+	JobSystem jobs;
+	jobs.Init(numThreads);
+	std::cout << "[JobBench]: " << jobs.GetThreadCount() << " threads" << std::endl;
+
+	std::atomic<uint64_t> sink{ 0 };
+
+	// Everything spawned by the main thread, the other threads only get work by stealing it
+	{
+		JobCounter counter;
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t i = 0; i < BENCH_JOB_COUNT; i++)
+			jobs.Run([&sink]() { sink.fetch_add(1, std::memory_order_relaxed); }, &counter);
+		jobs.Wait(&counter);
+		Report("spawn from main + steal", jobs, BENCH_JOB_COUNT, SecondsSince(start));
+	}
+
+	// Recursive fork, 2^depth leaves
+	{
+		JobCounter counter;
+		auto start = std::chrono::steady_clock::now();
+		Fork(&jobs, &counter, BENCH_FORK_DEPTH);
+		jobs.Wait(&counter);
+		uint64_t count = (2ull << BENCH_FORK_DEPTH) - 2;
+		Report("recursive fork", jobs, count, SecondsSince(start));
+	}
+
+	// Fine grained parallel for, one job per 64 items
+	{
+		auto start = std::chrono::steady_clock::now();
+		jobs.ParallelFor(BENCH_JOB_COUNT * 64, 64, [&sink](uint32_t begin, uint32_t end)
+			{
+				uint64_t sum = 0;
+				for (uint32_t i = begin; i < end; i++)
+					sum += i;
+				sink.fetch_add(sum, std::memory_order_relaxed);
+			});
+		Report("parallel for (64 items/job)", jobs, BENCH_JOB_COUNT, SecondsSince(start));
+	}
+
+	// Dependency chain: every job only becomes runnable once the previous one finished
+	{
+		static uint32_t const CHAIN_LENGTH = 1 << 16;
+		JobCounter* links = new JobCounter[CHAIN_LENGTH];
+		auto start = std::chrono::steady_clock::now();
+		jobs.Run([]() {}, &links[0]);
+		for (uint32_t i = 1; i < CHAIN_LENGTH; i++)
+			jobs.RunAfter(&links[i - 1], []() {}, &links[i]);
+		jobs.Wait(&links[CHAIN_LENGTH - 1]);
+		Report("dependency chain", jobs, CHAIN_LENGTH, SecondsSince(start));
+		delete[] links;
+	}
+
+	jobs.Shutdown();
+}
+
+void RunDescriptorAllocatorBenchmark()
+{
+	DescriptorAllocator allocator;
+	allocator.Init(DescriptorAllocator::PAGE_SIZE, 16384, 4096);
+
+	// Fixed seed so runs are comparable
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> sizeDist(1, 16);
+	std::uniform_int_distribution<uint32_t> opsDist(0, 64);
+	std::vector<DescriptorRange> live;
+	uint64_t operations = 0;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < BENCH_DESCRIPTOR_FRAMES; frame++)
+	{
+		// The GPU is BENCH_DESCRIPTOR_FRAME_LATENCY frames behind
+		uint64_t fenceValue = (uint64_t)frame + 1;
+		if (fenceValue > BENCH_DESCRIPTOR_FRAME_LATENCY)
+			allocator.Retire(fenceValue - BENCH_DESCRIPTOR_FRAME_LATENCY);
+
+		// Random walk around ~1000 live ranges, biased towards allocating while below it
+		uint32_t ops = opsDist(rng);
+		for (uint32_t i = 0; i < ops; i++, operations++)
+		{
+			bool allocate = live.empty() || (rng() % 2000) >= live.size();
+			if (allocate)
+			{
+				DescriptorRange range;
+				if (allocator.AllocatePersistent(sizeDist(rng), range))
+					live.push_back(range);
+			}
+			else
+			{
+				size_t index = rng() % live.size();
+				allocator.FreePersistent(live[index]);
+				live[index] = live.back();
+				live.pop_back();
+			}
+		}
+		for (uint32_t i = 0; i < 32; i++, operations++)
+		{
+			DescriptorRange range;
+			allocator.AllocateTransient(sizeDist(rng), range);
+		}
+		allocator.FinishFrame(fenceValue);
+	}
+	double seconds = SecondsSince(start);
+
+	DescriptorAllocatorStats stats = allocator.GetStats();
+	std::cout << "[DescriptorBench] " << BENCH_DESCRIPTOR_FRAMES << " frames, " << operations / seconds / 1e6 << " M ops/s ("
+		<< seconds * 1e9 / operations << " ns/op)" << std::endl;
+	std::cout << "[DescriptorBench] persistent: " << stats.PersistentAllocations << " allocs, " << stats.PersistentFrees
+		<< " frees, " << stats.Grows << " grows, " << stats.FailedAllocations << " failed, capacity " << stats.PersistentCapacity
+		<< ", used " << stats.PersistentUsed << ", peak " << stats.PersistentPeak << std::endl;
+	std::cout << "[DescriptorBench] fragmentation: " << stats.FreeRanges << " free ranges, largest " << stats.LargestFreeRange
+		<< ", transient " << stats.TransientAllocations << " allocs" << std::endl;
+}
+
+// An allocation must not overlap anything allocated in a frame the GPU may still be reading
+static bool OverlapsLive(const std::deque<std::pair<uint64_t, std::pair<uint64_t, uint64_t>>>& live, uint64_t offset, uint64_t size)
+{
+	for (const auto& range : live)
+		if (offset < range.second.first + range.second.second && range.second.first < offset + size)
+			return true;
+	return false;
+}
+
+void RunUploadRingBenchmark()
+{
+	uint32_t errors = 0;
+
+	// A frame without allocations still pending when the ring is empty otherwise must not let it rewind: when it
+	// retires, the tail moves to where the head was back then
+	{
+		UploadRingBuffer ring;
+		ring.Init(1024);
+		uint64_t offset, frame3;
+		ring.Allocate(100, 1, &offset);
+		ring.FinishFrame(1);
+		ring.FinishFrame(2);
+		ring.Retire(1);
+		ring.Allocate(600, 1, &frame3);
+		ring.FinishFrame(3);
+		ring.Retire(2);
+		ring.Allocate(80, 1, &offset);
+		ring.Allocate(300, 1, &offset);
+		if (ring.Allocate(90, 1, &offset) && offset < frame3 + 600 && frame3 < offset + 90)
+			errors++;
+	}
+
+	// Random frames, a third of them empty, retired by a GPU 0 to BENCH_UPLOAD_RING_MAX_LATENCY frames behind. Every
+	// allocation is checked against the ranges of all frames not retired yet.
+	UploadRingBuffer ring;
+	ring.Init(BENCH_UPLOAD_RING_CAPACITY);
+	std::mt19937 rng(1234);
+	std::uniform_int_distribution<uint32_t> sizeDist(1, BENCH_UPLOAD_RING_CAPACITY / 16);
+	std::uniform_int_distribution<uint32_t> opsDist(0, 12);
+	std::uniform_int_distribution<uint32_t> latencyDist(0, BENCH_UPLOAD_RING_MAX_LATENCY);
+	// (fence value, (offset, size))
+	std::deque<std::pair<uint64_t, std::pair<uint64_t, uint64_t>>> live;
+	uint64_t completed = 0, allocations = 0, failed = 0;
+	double seconds = 0.0;
+	for (uint64_t fenceValue = 1; fenceValue <= BENCH_UPLOAD_RING_FRAMES; fenceValue++)
+	{
+		const uint64_t lag = latencyDist(rng);
+		if (fenceValue > lag + 1 && fenceValue - lag - 1 > completed)
+		{
+			completed = fenceValue - lag - 1;
+			ring.Retire(completed);
+			while (!live.empty() && live.front().first <= completed)
+				live.pop_front();
+		}
+
+		const uint32_t ops = rng() % 3 == 0 ? 0 : opsDist(rng);
+		for (uint32_t i = 0; i < ops; i++)
+		{
+			const uint64_t size = sizeDist(rng), alignment = 1ull << (rng() % 9);
+			uint64_t offset;
+			auto start = std::chrono::steady_clock::now();
+			const bool allocated = ring.Allocate(size, alignment, &offset);
+			seconds += SecondsSince(start);
+			allocations++;
+			if (!allocated)
+			{
+				failed++;
+				continue;
+			}
+			if (offset % alignment != 0 || offset + size > BENCH_UPLOAD_RING_CAPACITY || OverlapsLive(live, offset, size))
+				errors++;
+			live.push_back(std::make_pair(fenceValue, std::make_pair(offset, size)));
+		}
+		ring.FinishFrame(fenceValue);
+	}
+	ring.Retire(BENCH_UPLOAD_RING_FRAMES);
+	errors += ring.GetStats().UsedBytes == 0 ? 0 : 1;
+
+	const UploadRingBufferStats& stats = ring.GetStats();
+	std::cout << "[UploadRingBench] " << BENCH_UPLOAD_RING_FRAMES << " frames, " << allocations << " allocations (" << failed
+		<< " failed), " << stats.Wraps << " wraps, " << seconds * 1e9 / allocations << " ns/allocation, peak "
+		<< stats.PeakUsedBytes / 1024.0 << " KB of " << BENCH_UPLOAD_RING_CAPACITY / 1024.0 << " KB" << std::endl;
+	std::cout << "[UploadRingBench] validation: " << errors << " errors" << std::endl;
+}
+
+// Render graph
+
+struct BenchGraphAccess
+{
+	RenderGraphResource Resource;
+	ResourceState State;
+	bool Writes;
+};
+
+struct BenchGraph
+{
+	// Accesses of every pass as declared, to check against while executing
+	std::vector<std::vector<BenchGraphAccess>> Passes;
+	// Indexed by resource, 0 for imported ones
+	std::vector<uint64_t> Sizes;
+};
+
+class BenchResource : public Resource
+{
+};
+
+// Keeps track of every resource's state from the barriers it sees, and complains about anything a GPU would not like
+class ValidatingCommandList : public CommandList
+{
+public:
+	void Reset(CommandAllocator* allocator) override { (void)allocator; }
+	void ResourceBarrier(Resource* resource, ResourceState before, ResourceState after) override
+	{
+		ResourceBarrierDesc desc;
+		desc.Target = resource;
+		desc.StateBefore = before;
+		desc.StateAfter = after;
+		ResourceBarriers(1, &desc);
+	}
+	void ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers) override
+	{
+		Batches++;
+		for (uint32_t i = 0; i < count; i++)
+		{
+			const ResourceBarrierDesc& desc = barriers[i];
+			if (desc.Type == BarrierType::Aliasing)
+			{
+				Aliasing++;
+				continue;
+			}
+			Tracked& tracked = States[desc.Target];
+			if (desc.Split == BarrierSplit::End)
+			{
+				Check(tracked.Pending && tracked.PendingState == desc.StateAfter, "split barrier ended without matching begin");
+				tracked.Pending = false;
+				tracked.State = desc.StateAfter;
+				continue;
+			}
+			Check(!tracked.Pending, "transition while a split barrier is pending");
+			Check(tracked.State == desc.StateBefore, "transition from the wrong state");
+			if (desc.Split == BarrierSplit::Begin)
+			{
+				tracked.Pending = true;
+				tracked.PendingState = desc.StateAfter;
+			}
+			else
+			{
+				tracked.State = desc.StateAfter;
+			}
+		}
+	}
+	void ClearRenderTarget(Resource* renderTarget, const float color[4]) override { (void)renderTarget; (void)color; }
+	void SetRenderTarget(Resource* renderTarget) override { (void)renderTarget; }
+	void RenderDrawData(ImDrawData* drawData) override { (void)drawData; }
+	void UpdateUITexture(const TextureUpdate& update) override { (void)update; }
+	void WriteTimestamp(TimestampQueryHeap* heap, uint32_t index) override { (void)heap; (void)index; }
+	void ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count) override { (void)heap; (void)first; (void)count; }
+	void Close() override {}
+
+	void Use(Resource* resource, ResourceState state, bool writes)
+	{
+		Tracked& tracked = States[resource];
+		Check(!tracked.Pending, "resource used while its split barrier is pending");
+		if (writes)
+			Check(tracked.State == state, "resource written in the wrong state");
+		else
+			Check(tracked.State == state || (IsReadOnlyState(tracked.State) && HasAllStates(tracked.State, state)), "resource read in the wrong state");
+	}
+	void Check(bool condition, const char* message)
+	{
+		if (!condition && Errors++ == 0)
+			std::cout << "[GraphBench] validation failed: " << message << std::endl;
+	}
+
+	struct Tracked
+	{
+		ResourceState State = ResourceState::Present;
+		ResourceState PendingState = ResourceState::Present;
+		bool Pending = false;
+	};
+	std::map<Resource*, Tracked> States;
+	uint32_t Errors = 0;
+	uint32_t Batches = 0;
+	uint32_t Aliasing = 0;
+};
+
+// Chains of passes rendering into fresh transients and sampling recent ones, the way post processing and shadow
+// passes do. Some passes produce things nobody reads, those should be culled.
+static void BuildBenchGraph(RenderGraph& graph, BenchGraph& bench, uint32_t passCount, Resource* backBuffer, ValidatingCommandList* validator)
+{
+	std::mt19937 rng(passCount);
+	graph.Reset();
+	bench.Passes.clear();
+	bench.Passes.resize(passCount);
+	bench.Sizes.clear();
+	RenderGraphResource backBufferHandle = graph.ImportResource("BackBuffer", backBuffer, ResourceState::Present, ResourceState::Present);
+	bench.Sizes.push_back(0);
+	std::vector<RenderGraphResource> recent;
+
+	static ResourceState const writeStates[] = { ResourceState::RenderTarget, ResourceState::CopyDest };
+	static ResourceState const readStates[] = { ResourceState::ShaderResource, ResourceState::CopySource };
+	for (uint32_t p = 0; p < passCount; p++)
+	{
+		std::vector<BenchGraphAccess>* accesses = &bench.Passes[p];
+		RenderGraphPass pass = graph.AddPass("Pass", [accesses, validator](RenderGraphContext& context)
+			{
+				if (validator == nullptr)
+					return;
+				for (const BenchGraphAccess& access : *accesses)
+					validator->Use(context.GetResource(access.Resource), access.State, access.Writes);
+			});
+
+		uint32_t reads = recent.empty() ? 0 : 1 + rng() % 3;
+		for (uint32_t i = 0; i < reads; i++)
+		{
+			RenderGraphResource resource = recent[recent.size() - 1 - rng() % std::min<size_t>(recent.size(), 16)];
+			ResourceState state = readStates[rng() % 2];
+			graph.Read(pass, resource, state);
+			accesses->push_back({ resource, state, false });
+		}
+
+		uint32_t writes = 1 + rng() % 2;
+		for (uint32_t i = 0; i < writes; i++)
+		{
+			TransientResourceDesc desc;
+			desc.Size = (uint64_t)(1 + rng() % 64) * 256 * 1024;
+			RenderGraphResource resource = graph.CreateTransient("Transient", desc);
+			bench.Sizes.push_back(desc.Size);
+			ResourceState state = writeStates[rng() % 2];
+			graph.Write(pass, resource, state);
+			accesses->push_back({ resource, state, true });
+			// One in eight outputs is never read
+			if (rng() % 8 != 0)
+				recent.push_back(resource);
+		}
+
+		if (rng() % 16 == 0 || p + 1 == passCount)
+		{
+			graph.Modify(pass, backBufferHandle, ResourceState::RenderTarget);
+			accesses->push_back({ backBufferHandle, ResourceState::RenderTarget, true });
+		}
+	}
+}
+
+// Transients whose lifetimes overlap must not overlap in memory
+static uint32_t ValidatePlacement(const RenderGraph& graph, const BenchGraph& bench)
+{
+	uint32_t resourceCount = (uint32_t)bench.Sizes.size();
+	std::vector<uint32_t> firstUse(resourceCount, RENDER_GRAPH_INVALID), lastUse(resourceCount, 0);
+	uint32_t executed = 0;
+	for (uint32_t p = 0; p < (uint32_t)bench.Passes.size(); p++)
+	{
+		if (graph.IsCulled(p))
+			continue;
+		for (const BenchGraphAccess& access : bench.Passes[p])
+		{
+			if (firstUse[access.Resource] == RENDER_GRAPH_INVALID)
+				firstUse[access.Resource] = executed;
+			lastUse[access.Resource] = executed;
+		}
+		executed++;
+	}
+
+	uint32_t errors = 0;
+	for (uint32_t a = 0; a < resourceCount; a++)
+	{
+		if (bench.Sizes[a] == 0 || firstUse[a] == RENDER_GRAPH_INVALID)
+			continue;
+		uint64_t aBegin = graph.GetTransientOffset(a);
+		if (aBegin + bench.Sizes[a] > graph.GetTransientHeapSize())
+			errors++;
+		for (uint32_t b = a + 1; b < resourceCount; b++)
+		{
+			if (bench.Sizes[b] == 0 || firstUse[b] == RENDER_GRAPH_INVALID || firstUse[a] > lastUse[b] || firstUse[b] > lastUse[a])
+				continue;
+			uint64_t bBegin = graph.GetTransientOffset(b);
+			if (aBegin < bBegin + bench.Sizes[b] && bBegin < aBegin + bench.Sizes[a])
+				errors++;
+		}
+	}
+	return errors;
+}
+
+void RunRenderGraphBenchmark()
+{
+	static uint32_t const passCounts[] = { 1024, 4096 };
+	RenderGraph graph;
+	BenchGraph bench;
+	BenchResource backBuffer;
+
+	for (uint32_t passCount : passCounts)
+	{
+		// Timing, without validation hooks in the passes
+		double buildSeconds = 0.0;
+		double compileSeconds = 0.0;
+		for (int i = 0; i < BENCH_GRAPH_ITERATIONS; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			BuildBenchGraph(graph, bench, passCount, &backBuffer, nullptr);
+			buildSeconds += SecondsSince(start);
+			start = std::chrono::steady_clock::now();
+			bool compiled = graph.Compile();
+			compileSeconds += SecondsSince(start);
+			if (!compiled)
+			{
+				std::cout << "[GraphBench] compile failed" << std::endl;
+				return;
+			}
+		}
+
+		// Once more with the validating command list, every transient bound to a dummy resource
+		ValidatingCommandList validator;
+		BuildBenchGraph(graph, bench, passCount, &backBuffer, &validator);
+		graph.Compile();
+		std::vector<BenchResource> transients(bench.Sizes.size());
+		for (uint32_t r = 0; r < (uint32_t)bench.Sizes.size(); r++)
+			if (bench.Sizes[r] > 0)
+				graph.BindTransient(r, &transients[r]);
+		// Transients start out in the state of their first use, so the validator does not know them up front
+		for (uint32_t p = 0; p < passCount; p++)
+			for (const BenchGraphAccess& access : bench.Passes[p])
+				if (bench.Sizes[access.Resource] > 0 && !graph.IsCulled(p) && validator.States.find(&transients[access.Resource]) == validator.States.end())
+					validator.States[&transients[access.Resource]].State = access.State;
+		RenderGraphContext context;
+		context.List = &validator;
+		graph.Execute(context);
+		validator.Check(validator.States[&backBuffer].State == ResourceState::Present, "back buffer not returned to present");
+		uint32_t placementErrors = ValidatePlacement(graph, bench);
+
+		const RenderGraphStats& stats = graph.GetStats();
+		std::cout << "[GraphBench] " << passCount << " passes: build " << buildSeconds * 1e6 / BENCH_GRAPH_ITERATIONS << " us, compile "
+			<< compileSeconds * 1e6 / BENCH_GRAPH_ITERATIONS << " us (" << compileSeconds * 1e9 / BENCH_GRAPH_ITERATIONS / passCount << " ns/pass)" << std::endl;
+		std::cout << "[GraphBench] " << stats.CulledPasses << " culled, " << stats.Barriers << " barriers (" << stats.SplitBarriers << " split, "
+			<< stats.AliasingBarriers << " aliasing, " << stats.MergedReads << " merged reads) in " << stats.BarrierBatches << " batches" << std::endl;
+		std::cout << "[GraphBench] transient heap " << stats.TransientHeapSize / (1024.0 * 1024.0) << " MB for "
+			<< stats.TransientBytes / (1024.0 * 1024.0) << " MB of resources, validation: "
+			<< validator.Errors + placementErrors << " errors" << std::endl;
+	}
+}
+
+// Simulated time, sleeping just moves it forward
+class SimulatedFrameClock : public FrameClock
+{
+public:
+	double Now() override { return m_time; }
+	void SleepUntil(double time) override { m_time = std::max(m_time, time); }
+
+	double m_time = 0.0;
+};
+
+// A flip model swap chain on a fixed refresh display. Presented frames queue up, every vblank shows the oldest one
+// whose GPU work is done. The swap chain lets the CPU start another frame while fewer than `maxLatency` are queued.
+struct SimulatedDisplay
+{
+	struct QueuedFrame
+	{
+		double InputTime;
+		double GpuDone;
+	};
+
+	std::deque<QueuedFrame> Queue;
+	double NextVblank = BENCH_PACING_REFRESH;
+	double LastGpuDone = 0.0;
+	bool Showing = false;
+	std::vector<double> Latencies;
+	uint32_t RepeatedRefreshes = 0;
+
+	void AdvanceTo(double time)
+	{
+		for (; NextVblank <= time; NextVblank += BENCH_PACING_REFRESH)
+		{
+			if (!Queue.empty() && Queue.front().GpuDone <= NextVblank)
+			{
+				Latencies.push_back(NextVblank - Queue.front().InputTime);
+				Queue.pop_front();
+				Showing = true;
+			}
+			else if (Showing)
+			{
+				RepeatedRefreshes++;
+			}
+		}
+	}
+
+	void Present(double time, double inputTime)
+	{
+		LastGpuDone = std::max(time, LastGpuDone) + BENCH_PACING_GPU_WORK;
+		Queue.push_back({ inputTime, LastGpuDone });
+	}
+};
+
+void RunFramePacingBenchmark()
+{
+	for (uint32_t latency = 1; latency <= 3; latency++)
+	{
+		for (int justInTime = 0; justInTime < 2; justInTime++)
+		{
+			SimulatedFrameClock clock;
+			SimulatedDisplay display;
+			FramePacerConfig config;
+			config.maxLatency = latency;
+			config.justInTime = justInTime != 0;
+			FramePacer pacer;
+			pacer.Init(config, &clock);
+
+			// Fixed seed so runs are comparable: +-20% jitter and a 10 ms hitch every ~50 frames
+			std::mt19937 rng(1234);
+			std::uniform_real_distribution<double> jitter(0.8, 1.2);
+			for (int frame = 0; frame < BENCH_PACING_FRAMES; frame++)
+			{
+				// Waitable object
+				display.AdvanceTo(clock.m_time);
+				while (display.Queue.size() >= latency)
+				{
+					clock.m_time = display.NextVblank;
+					display.AdvanceTo(clock.m_time);
+				}
+				pacer.FrameReady();
+				pacer.WaitForInputSample();
+				double inputTime = pacer.SampleInput();
+
+				clock.m_time += BENCH_PACING_CPU_WORK * jitter(rng) + (rng() % 50 == 0 ? 0.01 : 0.0);
+				display.AdvanceTo(clock.m_time);
+				display.Present(clock.m_time, inputTime);
+				pacer.Presented(inputTime);
+			}
+
+			std::vector<double>& latencies = display.Latencies;
+			double total = 0.0;
+			for (double l : latencies)
+				total += l;
+			std::sort(latencies.begin(), latencies.end());
+			const FramePacerStats& stats = pacer.GetStats();
+			double refreshError = std::abs(stats.RefreshPeriod - BENCH_PACING_REFRESH) / BENCH_PACING_REFRESH;
+			std::cout << "[PacingBench] latency " << latency << (justInTime ? ", just in time" : "") << ": input to display "
+				<< total * 1000.0 / latencies.size() << " ms avg, " << latencies[latencies.size() * 99 / 100] * 1000.0 << " ms p99, "
+				<< latencies.size() << " frames shown, " << display.RepeatedRefreshes << " repeated refreshes" << std::endl;
+			std::cout << "[PacingBench]   " << stats.MissedDeadlines << " missed deadlines, slept " << stats.TotalSleep * 1000.0 / BENCH_PACING_FRAMES
+				<< " ms/frame, margin " << stats.Margin * 1000.0 << " ms, refresh estimate " << stats.RefreshPeriod * 1000.0
+				<< " ms (" << (refreshError < 0.01 ? "ok" : "WRONG") << ")" << std::endl;
+		}
+	}
+}
+
+void RunProfilerBenchmark()
+{
+	// Nested pairs, like real code
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < BENCH_PROFILER_ZONES / 2; i++)
+	{
+		ProfileZone outer("Outer");
+		ProfileZone inner("Inner");
+	}
+	double seconds = SecondsSince(start);
+	std::cout << "[ProfilerBench] " << seconds * 1e9 / BENCH_PROFILER_ZONES << " ns/zone" << std::endl;
+
+	// The writer fills in events whose fields all derive from one counter, so a torn one can't look consistent
+	static char const* const names[] = { "A", "B", "C", "D" };
+	ProfilerThreadBuffer* buffer = new ProfilerThreadBuffer();
+	std::atomic<bool> done{ false };
+	std::thread writer([buffer, &done]()
+		{
+			for (uint64_t i = 1; i <= (uint64_t)ProfilerThreadBuffer::CAPACITY * 64; i++)
+				buffer->Push({ names[i % 4], i * 3, i * 3 + 1, (uint32_t)(i % 7) });
+			done.store(true);
+		});
+	std::vector<ProfilerEvent> events;
+	uint64_t reads = 0;
+	uint64_t checked = 0;
+	uint64_t errors = 0;
+	while (!done.load())
+	{
+		events.clear();
+		buffer->Read(0, events);
+		reads++;
+		for (size_t e = 0; e < events.size(); e++)
+		{
+			const ProfilerEvent& event = events[e];
+			uint64_t i = event.Start / 3;
+			bool valid = event.Start == i * 3 && event.End == i * 3 + 1 && event.Name == names[i % 4] && event.Depth == i % 7;
+			// Oldest first and without gaps
+			if (e > 0)
+				valid = valid && event.Start == events[e - 1].Start + 3;
+			errors += valid ? 0 : 1;
+		}
+		checked += events.size();
+	}
+	writer.join();
+	delete buffer;
+	std::cout << "[ProfilerBench] concurrent reads: " << reads << " snapshots, " << checked << " events checked, "
+		<< errors << " errors" << std::endl;
+}
+
+void RunGpuTimingBenchmark()
+{
+	GraphicsDevice* device = CreateNullDevice();
+	CommandQueue* queue = device->CreateCommandQueue();
+	CommandAllocator* allocator = device->CreateCommandAllocator();
+	CommandList* list = device->CreateCommandList(allocator);
+	Fence* fence = device->CreateFence(0);
+	GpuProfiler profiler;
+	if (!profiler.Init(device, queue, BENCH_GPU_TIMING_FRAMES_IN_FLIGHT))
+	{
+		std::cout << "[GpuTimingBench] no timestamp queries" << std::endl;
+		return;
+	}
+
+	// The null fence completes on Signal(), the GPU is made late by holding back what Update() is told instead
+	std::mt19937 rng(1234);
+	BenchResource target;
+	float color[4] = {};
+	uint64_t completed = 0;
+	uint32_t errors = 0;
+	for (uint64_t frame = 1; frame <= BENCH_GPU_TIMING_FRAMES; frame++)
+	{
+		// Never behind by more than the frames in flight, like the renderer waiting on its frame contexts
+		uint64_t submitted = frame - 1;
+		uint64_t lag = rng() % BENCH_GPU_TIMING_FRAMES_IN_FLIGHT;
+		completed = std::max(completed, submitted > lag ? submitted - lag : 0);
+		uint64_t serialBefore = profiler.GetLastFrameSerial();
+		profiler.Update(completed);
+		uint64_t serial = profiler.GetLastFrameSerial();
+		if (serial != serialBefore)
+		{
+			// Everything up to `completed` and nothing after it
+			errors += serial == completed ? 0 : 1;
+			// Zones: Frame { Clear { 1 command }, Barriers { n commands } }, where n = serial % 5
+			const std::vector<GpuZone>& zones = profiler.GetLastFrame();
+			uint32_t expectedBarriers = (uint32_t)(serial % 5);
+			bool valid = zones.size() == 3 &&
+				zones[1].End - zones[1].Start == NULL_GPU_COMMAND_TICKS &&
+				zones[2].End - zones[2].Start == expectedBarriers * NULL_GPU_COMMAND_TICKS &&
+				zones[0].End - zones[0].Start == (1 + expectedBarriers) * NULL_GPU_COMMAND_TICKS &&
+				zones[0].Depth == 0 && zones[1].Depth == 1 && zones[2].Depth == 1 &&
+				zones[1].Start == zones[0].Start && zones[2].Start == zones[1].End;
+			errors += valid ? 0 : 1;
+		}
+
+		profiler.BeginFrame();
+		list->Reset(allocator);
+		uint32_t frameZone = profiler.BeginZone(list, "Frame");
+		uint32_t clearZone = profiler.BeginZone(list, "Clear");
+		list->ClearRenderTarget(&target, color);
+		profiler.EndZone(list, clearZone);
+		uint32_t barrierZone = profiler.BeginZone(list, "Barriers");
+		for (uint32_t b = 0; b < frame % 5; b++)
+			list->ResourceBarrier(&target, ResourceState::Present, ResourceState::Present);
+		profiler.EndZone(list, barrierZone);
+		profiler.EndZone(list, frameZone);
+		profiler.EndFrame(list, frame);
+		list->Close();
+		queue->ExecuteCommandLists(1, &list);
+		queue->Signal(fence, frame);
+	}
+	profiler.Update(BENCH_GPU_TIMING_FRAMES);
+	errors += profiler.GetLastFrameSerial() == (uint64_t)BENCH_GPU_TIMING_FRAMES ? 0 : 1;
+
+	const GpuProfilerStats& stats = profiler.GetStats();
+	std::cout << "[GpuTimingBench] " << stats.FramesResolved << " of " << stats.FramesBegun << " frames read back, "
+		<< stats.FramesDropped << " dropped, max latency " << stats.MaxLatency << " frames, validation: " << errors << " errors" << std::endl;
+
+	profiler.Shutdown();
+	delete fence;
+	delete list;
+	delete allocator;
+	delete queue;
+	delete device;
+}
+
+static uint32_t SceneItemWork(uint32_t item)
+{
+	uint32_t hash = item * 2654435761u;
+	for (uint32_t i = 0; i < BENCH_RECORD_ITEM_WORK; i++)
+		hash = (hash ^ (hash >> 15)) * 2246822519u + i;
+	return hash;
+}
+
+// Records BENCH_RECORD_FRAMES frames of `itemCount` scene items through `pool` the way the renderer's scene pass does,
+// every item followed by a timestamp, and a last list that resolves them. Returns seconds per frame.
+static double RecordSceneFrames(CommandListPool& pool, CommandQueue* queue, TimestampQueryHeap* heap, Resource* target,
+	uint32_t itemCount, std::vector<uint32_t>& results, const std::vector<uint32_t>& reference, uint32_t* errors)
+{
+	// The GPU clock only moves forward, so every item must come after the one before it and after last frame's
+	uint64_t lastTimestamp = 0;
+	double seconds = 0.0;
+	for (uint32_t frame = 0; frame < BENCH_RECORD_FRAMES; frame++)
+	{
+		std::fill(results.begin(), results.end(), 0);
+		uint64_t listsBefore = pool.GetStats().ListsSubmitted;
+
+		auto start = std::chrono::steady_clock::now();
+		pool.BeginFrame(frame);
+		pool.RecordParallel(itemCount, BENCH_RECORD_MIN_ITEMS_PER_LIST,
+			[&results, target, heap](CommandList* list, uint32_t begin, uint32_t end)
+			{
+				for (uint32_t item = begin; item < end; item++)
+				{
+					results[item] = SceneItemWork(item);
+					list->SetRenderTarget(target);
+					list->WriteTimestamp(heap, item);
+				}
+			});
+		pool.OpenCommandList()->ResolveTimestamps(heap, 0, itemCount);
+		pool.Submit(queue);
+		seconds += SecondsSince(start);
+
+		// Same split as RecordParallel(), plus the resolve list
+		uint32_t expectedLists = std::min(pool.GetThreadCount(), (itemCount + BENCH_RECORD_MIN_ITEMS_PER_LIST - 1) / BENCH_RECORD_MIN_ITEMS_PER_LIST);
+		expectedLists = std::max(std::min(expectedLists, (uint32_t)CommandListPool::MAX_LISTS_PER_FRAME - 1), 1u) + 1;
+		*errors += pool.GetStats().ListsSubmitted - listsBefore == expectedLists ? 0 : 1;
+		*errors += results == reference ? 0 : 1;
+		const uint64_t* timestamps = heap->GetResolvedData();
+		for (uint32_t item = 0; item < itemCount; item++)
+		{
+			*errors += timestamps[item] > lastTimestamp ? 0 : 1;
+			lastTimestamp = timestamps[item];
+		}
+	}
+	return seconds / BENCH_RECORD_FRAMES;
+}
+
+void RunRecordBenchmark(uint32_t numThreads, uint32_t recordThreads)
+{
+	JobSystem jobs;
+	jobs.Init(numThreads);
+	GraphicsDevice* device = CreateNullDevice();
+	CommandQueue* queue = device->CreateCommandQueue();
+	// The null queue takes render targets for its own resources
+	NullResource target;
+
+	uint32_t errors = 0;
+	for (uint32_t itemCount : BENCH_RECORD_ITEMS)
+	{
+		TimestampQueryHeap* heap = device->CreateTimestampQueryHeap(itemCount);
+		std::vector<uint32_t> reference(itemCount), results(itemCount);
+		for (uint32_t item = 0; item < itemCount; item++)
+			reference[item] = SceneItemWork(item);
+
+		// One list recorded on the calling thread, then split across the recording threads
+		CommandListPool serial, parallel;
+		serial.Init(device, BENCH_RECORD_FRAMES_IN_FLIGHT, &jobs, 1);
+		parallel.Init(device, BENCH_RECORD_FRAMES_IN_FLIGHT, &jobs, recordThreads);
+		double serialSeconds = RecordSceneFrames(serial, queue, heap, &target, itemCount, results, reference, &errors);
+		double parallelSeconds = RecordSceneFrames(parallel, queue, heap, &target, itemCount, results, reference, &errors);
+
+		const CommandListPoolStats& stats = parallel.GetStats();
+		std::cout << "[RecordBench] " << itemCount << " items: 1 thread " << serialSeconds * 1e3 << " ms/frame, "
+			<< parallel.GetThreadCount() << " threads " << parallelSeconds * 1e3 << " ms/frame (" << serialSeconds / parallelSeconds
+			<< "x), " << (double)stats.ListsSubmitted / stats.Frames << " lists/frame" << std::endl;
+
+		parallel.Shutdown();
+		serial.Shutdown();
+		delete heap;
+	}
+	std::cout << "[RecordBench] validation: " << errors << " errors" << std::endl;
+
+	delete queue;
+	delete device;
+	jobs.Shutdown();
+}
+
+struct TessellationCase
+{
+	const char* Name;
+	ImDrawListFlags Flags;
+	ImDrawFlags DrawFlags;
+	float Thickness;
+};
+
+static void Tessellate(ImDrawList& list, const TessellationCase& test, const std::vector<std::vector<ImVec2>>& lines)
+{
+	list._ResetForNewFrame();
+	list.Flags = test.Flags;
+	for (const std::vector<ImVec2>& line : lines)
+		list.AddPolyline(line.data(), (int)line.size(), IM_COL32(255, 128, 0, 255), test.DrawFlags, test.Thickness);
+}
+
+void RunTessellationBenchmark()
+{
+	// Plot lines: random walks of a few thousand points, with repeated points whose zero length segments take the other
+	// side of every branch.
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<std::vector<ImVec2>> lines;
+	for (int total = 0; total < BENCH_TESSELLATION_POINTS; total += (int)lines.back().size())
+	{
+		lines.emplace_back(2 + rng() % 4000);
+		float y = 300.0f;
+		for (size_t i = 0; i < lines.back().size(); i++)
+		{
+			y += (unit(rng) - 0.5f) * 20.0f;
+			lines.back()[i] = rng() % 50 == 0 && i > 0 ? lines.back()[i - 1] : ImVec2(i * 0.37f, y);
+		}
+	}
+
+	// A white pixel and baked line UVs, as the font atlas would provide
+	ImVec4 lineUvs[IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1];
+	for (int i = 0; i <= IM_DRAWLIST_TEX_LINES_WIDTH_MAX; i++)
+		lineUvs[i] = ImVec4(i * 0.01f, 0.5f, i * 0.01f + 0.005f, 0.75f);
+	ImDrawListSharedData shared;
+	shared.TexUvWhitePixel = ImVec2(0.25f, 0.25f);
+	shared.TexUvLines = lineUvs;
+	ImDrawList scalarList(&shared);
+	ImDrawList simdList(&shared);
+
+	ImDrawListFlags const aaLines = ImDrawListFlags_AntiAliasedLines | ImDrawListFlags_AllowVtxOffset;
+	TessellationCase const cases[] = {
+		{ "line textured", aaLines | ImDrawListFlags_AntiAliasedLinesUseTex, ImDrawFlags_None, 1.0f },
+		{ "line thin", aaLines, ImDrawFlags_None, 1.0f },
+		{ "line thin closed", aaLines, ImDrawFlags_Closed, 1.0f },
+		{ "line thick", aaLines, ImDrawFlags_None, 3.5f },
+		{ "line thick closed", aaLines, ImDrawFlags_Closed, 3.5f },
+	};
+	uint32_t errors = 0;
+	for (const TessellationCase& test : cases)
+	{
+		double seconds[2] = {};
+		for (int simd = 0; simd < 2; simd++)
+		{
+			shared.TessellationSimd = simd != 0;
+			ImDrawList& list = simd ? simdList : scalarList;
+			Tessellate(list, test, lines);
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < BENCH_TESSELLATION_ITERATIONS; i++)
+				Tessellate(list, test, lines);
+			seconds[simd] = SecondsSince(start);
+		}
+
+		bool same = scalarList.VtxBuffer.Size == simdList.VtxBuffer.Size && scalarList.IdxBuffer.Size == simdList.IdxBuffer.Size &&
+			memcmp(scalarList.VtxBuffer.Data, simdList.VtxBuffer.Data, scalarList.VtxBuffer.size_in_bytes()) == 0 &&
+			memcmp(scalarList.IdxBuffer.Data, simdList.IdxBuffer.Data, scalarList.IdxBuffer.size_in_bytes()) == 0;
+		errors += same ? 0 : 1;
+		double vertices = (double)scalarList.VtxBuffer.Size * BENCH_TESSELLATION_ITERATIONS;
+		std::cout << "[TessellationBench] " << test.Name << ": scalar " << vertices / seconds[0] / 1e6 << " M vertices/s, simd "
+			<< vertices / seconds[1] / 1e6 << " M vertices/s (" << seconds[0] / seconds[1] << "x), output "
+			<< (same ? "identical" : "DIFFERENT") << std::endl;
+	}
+	shared.TessellationSimd = true;
+	std::cout << "[TessellationBench] validation: " << errors << " errors" << std::endl;
+}
+
+// Every size of BENCH_FONT_SIZES, 3x horizontal oversampling like imgui's default for TTF fonts
+static void AddBenchFonts(ImFontAtlas& atlas, const char* fontPath)
+{
+	for (float size : BENCH_FONT_SIZES)
+	{
+		ImFontConfig config;
+		config.OversampleH = 3;
+		config.SizePixels = size;
+		if (fontPath != nullptr)
+			atlas.AddFontFromFileTTF(fontPath, size, &config, atlas.GetGlyphRangesChineseFull());
+		else
+			atlas.AddFontDefault(&config);
+	}
+}
+
+static bool SameAtlas(const ImFontAtlas& a, const ImFontAtlas& b)
+{
+	if (a.TexWidth != b.TexWidth || a.TexHeight != b.TexHeight || a.Fonts.Size != b.Fonts.Size || a.CustomRects.Size != b.CustomRects.Size ||
+		memcmp(a.TexPixelsAlpha8, b.TexPixelsAlpha8, (size_t)a.TexWidth * a.TexHeight) != 0)
+		return false;
+	for (int i = 0; i < a.CustomRects.Size; i++)
+		if (a.CustomRects[i].X != b.CustomRects[i].X || a.CustomRects[i].Y != b.CustomRects[i].Y)
+			return false;
+	for (int i = 0; i < a.Fonts.Size; i++)
+	{
+		const ImFont* fa = a.Fonts[i];
+		const ImFont* fb = b.Fonts[i];
+		if (fa->FontSize != fb->FontSize || fa->Ascent != fb->Ascent || fa->Descent != fb->Descent || fa->Glyphs.Size != fb->Glyphs.Size ||
+			fa->IndexLookup.Size != fb->IndexLookup.Size || fa->FallbackChar != fb->FallbackChar || fa->EllipsisChar != fb->EllipsisChar ||
+			memcmp(fa->Glyphs.Data, fb->Glyphs.Data, fa->Glyphs.size_in_bytes()) != 0 ||
+			memcmp(fa->IndexLookup.Data, fb->IndexLookup.Data, fa->IndexLookup.size_in_bytes()) != 0)
+			return false;
+	}
+	return true;
+}
+
+void RunFontAtlasBenchmark(uint32_t numThreads, const char* fontPath)
+{
+	JobSystem jobs;
+	jobs.Init(numThreads);
+
+	ImFontAtlas serial, parallel, cached;
+	AddBenchFonts(serial, fontPath);
+	AddBenchFonts(parallel, fontPath);
+	AddBenchFonts(cached, fontPath);
+
+	auto start = std::chrono::steady_clock::now();
+	serial.Build();
+	double serialSeconds = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	FontAtlasCache::BuildInParallel(&parallel, &jobs);
+	double parallelSeconds = SecondsSince(start);
+
+	uint64_t fileBytes = 0;
+	start = std::chrono::steady_clock::now();
+	bool saved = FontAtlasCache::Save(&parallel, BENCH_FONT_CACHE_PATH, &fileBytes);
+	double saveSeconds = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	bool loaded = saved && FontAtlasCache::Load(&cached, BENCH_FONT_CACHE_PATH);
+	double loadSeconds = SecondsSince(start);
+
+	// Any change to the fonts has to miss
+	ImFontAtlas other;
+	AddBenchFonts(other, fontPath);
+	other.ConfigData[0].RasterizerMultiply = 1.5f;
+	bool stale = FontAtlasCache::Load(&other, BENCH_FONT_CACHE_PATH);
+	remove(BENCH_FONT_CACHE_PATH);
+
+	uint32_t errors = 0;
+	errors += SameAtlas(serial, parallel) ? 0 : 1;
+	errors += loaded && SameAtlas(serial, cached) ? 0 : 1;
+	errors += stale ? 1 : 0;
+	int glyphs = 0;
+	for (const ImFont* font : serial.Fonts)
+		glyphs += font->Glyphs.Size;
+	std::cout << "[FontAtlasBench] " << (fontPath != nullptr ? fontPath : "default font") << ", " << serial.Fonts.Size << " sizes, "
+		<< glyphs << " glyphs, " << serial.TexWidth << "x" << serial.TexHeight << std::endl;
+	std::cout << "[FontAtlasBench] build " << serialSeconds * 1000.0 << " ms, parallel build on " << jobs.GetThreadCount() << " threads "
+		<< parallelSeconds * 1000.0 << " ms (" << serialSeconds / parallelSeconds << "x), cache save " << saveSeconds * 1000.0
+		<< " ms, load " << loadSeconds * 1000.0 << " ms (" << serialSeconds / loadSeconds << "x), " << fileBytes / 1024.0 << " KB" << std::endl;
+	std::cout << "[FontAtlasBench] validation: " << errors << " errors" << std::endl;
+	jobs.Shutdown();
+}
+
+static ImFont* AddGlyphCacheBenchFont(ImFontAtlas& atlas, const char* fontPath, float size, const ImWchar* ranges)
+{
+	ImFontConfig config;
+	config.SizePixels = size;
+	config.GlyphRanges = ranges;
+	return fontPath != nullptr ? atlas.AddFontFromFileTTF(fontPath, size, &config) : atlas.AddFontDefault(&config);
+}
+
+static bool SameGlyph(const ImFontAtlas& a, const ImFontGlyph& ga, const ImFontAtlas& b, const ImFontGlyph& gb)
+{
+	if (ga.Codepoint != gb.Codepoint || ga.Visible != gb.Visible || ga.AdvanceX != gb.AdvanceX ||
+		ga.X0 != gb.X0 || ga.Y0 != gb.Y0 || ga.X1 != gb.X1 || ga.Y1 != gb.Y1)
+		return false;
+	int ax = (int)roundf(ga.U0 * a.TexWidth), ay = (int)roundf(ga.V0 * a.TexHeight);
+	int bx = (int)roundf(gb.U0 * b.TexWidth), by = (int)roundf(gb.V0 * b.TexHeight);
+	int w = (int)roundf((ga.U1 - ga.U0) * a.TexWidth), h = (int)roundf((ga.V1 - ga.V0) * a.TexHeight);
+	if (w != (int)roundf((gb.U1 - gb.U0) * b.TexWidth) || h != (int)roundf((gb.V1 - gb.V0) * b.TexHeight))
+		return false;
+	for (int y = 0; y < h; y++)
+		if (memcmp(a.TexPixelsAlpha8 + (ay + y) * a.TexWidth + ax, b.TexPixelsAlpha8 + (by + y) * b.TexWidth + bx, w) != 0)
+			return false;
+	return true;
+}
+
+void RunGlyphCacheBenchmark(const char* fontPath, float size)
+{
+	static const ImWchar asciiRanges[] = { 0x0020, 0x007E, 0 };
+	static const ImWchar allRanges[] = { 0x0020, 0xFFFF, 0 };
+	ImFontAtlas full, cached;
+	ImFont* fullFont = AddGlyphCacheBenchFont(full, fontPath, size, allRanges);
+	ImFont* font = AddGlyphCacheBenchFont(cached, fontPath, size, asciiRanges);
+	GlyphCache cache;
+	cache.Reserve(&cached, BENCH_GLYPH_CACHE_PAGE_SIZE, BENCH_GLYPH_CACHE_PAGES);
+	full.Build();
+	cached.Build();
+	uint32_t errors = cache.Attach(font) ? 0 : 1;
+
+	// Everything the font has beyond what is baked
+	std::vector<ImWchar> codepoints;
+	for (const ImFontGlyph& glyph : fullFont->Glyphs)
+		if (glyph.Codepoint > 0x7E)
+			codepoints.push_back((ImWchar)glyph.Codepoint);
+
+	// The "GPU" texture only ever sees the uploads
+	std::vector<unsigned int> texture(cached.TexPixelsRGBA32, cached.TexPixelsRGBA32 + cached.TexWidth * cached.TexHeight);
+	ImVector<TextureUpdate> updates;
+	ImVector<uint8_t> pixels;
+	struct Drawn
+	{
+		ImWchar Codepoint;
+		float AdvanceX;
+		const ImFontGlyph* Glyph;
+	};
+	std::vector<Drawn> drawn;
+	uint64_t lookups = 0, fallbacks = 0;
+	double seconds = 0.0;
+	for (int frame = 0; frame < BENCH_GLYPH_CACHE_FRAMES && !codepoints.empty(); frame++)
+	{
+		// Text is measured (the advances) before it is drawn (the glyphs)
+		auto start = std::chrono::steady_clock::now();
+		cache.NewFrame();
+		drawn.clear();
+		int count = frame % 100 == 99 ? BENCH_GLYPH_CACHE_BURST : BENCH_GLYPH_CACHE_WINDOW;
+		for (int i = 0; i < count; i++)
+		{
+			ImWchar c = codepoints[((size_t)frame * BENCH_GLYPH_CACHE_STEP + i) % codepoints.size()];
+			float advanceX = font->GetCharAdvance(c);
+			drawn.push_back(Drawn{ c, advanceX, font->FindGlyph(c) });
+		}
+		cache.TakeUploads(updates, pixels);
+		seconds += SecondsSince(start);
+		lookups += count;
+
+		for (const TextureUpdate& update : updates)
+			for (uint32_t y = 0; y < update.Height; y++)
+				memcpy(&texture[(update.Y + y) * cached.TexWidth + update.X], update.Pixels + y * update.Width * 4, update.Width * 4);
+		errors += memcmp(texture.data(), cached.TexPixelsRGBA32, texture.size() * sizeof(unsigned int)) == 0 ? 0 : 1;
+
+		// Every glyph handed out this frame is still there, and the same as the fully baked one
+		for (const Drawn& d : drawn)
+		{
+			if (d.Glyph == font->FallbackGlyph)
+			{
+				fallbacks++;
+				errors += d.AdvanceX == font->FallbackAdvanceX ? 0 : 1;
+				continue;
+			}
+			const ImFontGlyph* reference = fullFont->FindGlyphNoFallback(d.Codepoint);
+			errors += reference != nullptr && d.AdvanceX == reference->AdvanceX && SameGlyph(cached, *d.Glyph, full, *reference) ? 0 : 1;
+		}
+	}
+
+	const GlyphCacheStats& stats = cache.GetStats();
+	std::cout << "[GlyphCacheBench] " << (fontPath != nullptr ? fontPath : "default font") << " at " << size << " px, "
+		<< codepoints.size() << " glyphs beyond ASCII" << std::endl;
+	std::cout << "[GlyphCacheBench] all glyphs baked: " << full.TexWidth << "x" << full.TexHeight << " atlas, "
+		<< full.TexWidth * full.TexHeight * 5 / (1024.0 * 1024.0) << " MB (alpha + RGBA); ASCII + " << stats.Pages << " pages of "
+		<< BENCH_GLYPH_CACHE_PAGE_SIZE << " px: " << cached.TexWidth << "x" << cached.TexHeight << ", "
+		<< cached.TexWidth * cached.TexHeight * 5 / (1024.0 * 1024.0) << " MB" << std::endl;
+	std::cout << "[GlyphCacheBench] " << BENCH_GLYPH_CACHE_FRAMES << " frames, " << lookups << " glyphs drawn: " << stats.Loaded
+		<< " loaded, " << stats.Evicted << " evicted (" << stats.PageEvictions << " pages), " << stats.Overflows << " overflows ("
+		<< fallbacks << " fallback glyphs drawn), " << stats.Uploads << " uploads (" << stats.UploadedBytes / 1024.0 << " KB)" << std::endl;
+	std::cout << "[GlyphCacheBench] " << seconds * 1e6 / BENCH_GLYPH_CACHE_FRAMES << " us/frame, "
+		<< seconds * 1e6 / (stats.Loaded > 0 ? stats.Loaded : 1) << " us per loaded glyph" << std::endl;
+	std::cout << "[GlyphCacheBench] validation: " << errors << " errors" << std::endl;
+	cache.Shutdown();
+}
+
+static ImFont* AddDistanceFieldBenchFont(ImFontAtlas& atlas, const char* fontPath, float size)
+{
+	ImFontConfig config;
+	config.SizePixels = size;
+	config.OversampleH = 1;
+	config.GlyphRanges = atlas.GetGlyphRangesCyrillic();
+	return fontPath != nullptr ? atlas.AddFontFromFileTTF(fontPath, size, &config) : atlas.AddFontDefault(&config);
+}
+
+static int AtlasKB(const ImFontAtlas& atlas)
+{
+	return atlas.TexWidth * atlas.TexHeight / 1024;
+}
+
+void RunDistanceFieldFontBenchmark(uint32_t numThreads, const char* fontPath)
+{
+	JobSystem jobs;
+	jobs.Init(numThreads);
+
+	ImFontAtlas serial, parallel, plain, sizes;
+	serial.Flags |= ImFontAtlasFlags_DistanceField;
+	parallel.Flags |= ImFontAtlasFlags_DistanceField;
+	ImFont* font = AddDistanceFieldBenchFont(serial, fontPath, BENCH_SDF_FONT_SIZE);
+	AddDistanceFieldBenchFont(parallel, fontPath, BENCH_SDF_FONT_SIZE);
+	ImFont* plainFont = AddDistanceFieldBenchFont(plain, fontPath, BENCH_SDF_FONT_SIZE);
+	for (float size : BENCH_FONT_SIZES)
+		AddDistanceFieldBenchFont(sizes, fontPath, size);
+
+	auto start = std::chrono::steady_clock::now();
+	serial.Build();
+	double serialSeconds = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	FontAtlasCache::BuildInParallel(&parallel, &jobs);
+	double parallelSeconds = SecondsSince(start);
+	start = std::chrono::steady_clock::now();
+	plain.Build();
+	double plainSeconds = SecondsSince(start);
+	sizes.Build();
+
+	// The field box is the plain glyph's box grown by the spread on every side
+	uint32_t errors = SameAtlas(serial, parallel) ? 0 : 1;
+	const int spread = serial.TexDistanceFieldSpread;
+	uint64_t compared = 0, disagreed = 0;
+	for (const ImFontGlyph& glyph : font->Glyphs)
+	{
+		const ImFontGlyph* reference = plainFont->FindGlyphNoFallback((ImWchar)glyph.Codepoint);
+		if (reference == nullptr || glyph.AdvanceX != reference->AdvanceX || glyph.Visible != reference->Visible)
+		{
+			errors++;
+			continue;
+		}
+		if (!glyph.Visible)
+			continue;
+		int w = (int)roundf((reference->U1 - reference->U0) * plain.TexWidth), h = (int)roundf((reference->V1 - reference->V0) * plain.TexHeight);
+		if (glyph.X0 != reference->X0 - spread || glyph.Y0 != reference->Y0 - spread ||
+			(int)roundf((glyph.U1 - glyph.U0) * serial.TexWidth) != w + spread * 2 || (int)roundf((glyph.V1 - glyph.V0) * serial.TexHeight) != h + spread * 2)
+		{
+			errors++;
+			continue;
+		}
+		int px = (int)roundf(reference->U0 * plain.TexWidth), py = (int)roundf(reference->V0 * plain.TexHeight);
+		int fx = (int)roundf(glyph.U0 * serial.TexWidth) + spread, fy = (int)roundf(glyph.V0 * serial.TexHeight) + spread;
+		uint64_t glyphCompared = 0, glyphDisagreed = 0;
+		for (int y = 0; y < h; y++)
+			for (int x = 0; x < w; x++)
+			{
+				int coverage = plain.TexPixelsAlpha8[(py + y) * plain.TexWidth + px + x];
+				if (abs(coverage - 128) < BENCH_SDF_COVERAGE_MARGIN)
+					continue;
+				bool inside = serial.TexPixelsAlpha8[(fy + y) * serial.TexWidth + fx + x] >= IM_FONT_DISTANCE_FIELD_ON_EDGE;
+				glyphCompared++;
+				glyphDisagreed += inside != (coverage > 128) ? 1 : 0;
+			}
+		compared += glyphCompared;
+		disagreed += glyphDisagreed;
+		errors += glyphDisagreed > glyphCompared * BENCH_SDF_MAX_DISAGREEMENT ? 1 : 0;
+	}
+
+	std::cout << "[SdfFontBench] " << (fontPath != nullptr ? fontPath : "default font") << " at " << BENCH_SDF_FONT_SIZE << " px, "
+		<< font->Glyphs.Size << " glyphs: distance field atlas " << serial.TexWidth << "x" << serial.TexHeight << " (" << AtlasKB(serial)
+		<< " KB) for any size, plain atlas at " << BENCH_FONT_SIZES[0] << " to " << BENCH_FONT_SIZES[IM_ARRAYSIZE(BENCH_FONT_SIZES) - 1] << " px "
+		<< sizes.TexWidth << "x" << sizes.TexHeight << " (" << AtlasKB(sizes) << " KB)" << std::endl;
+	std::cout << "[SdfFontBench] build " << serialSeconds * 1000.0 << " ms (" << serialSeconds * 1e6 / font->Glyphs.Size << " us/glyph), parallel build on "
+		<< jobs.GetThreadCount() << " threads " << parallelSeconds * 1000.0 << " ms (" << serialSeconds / parallelSeconds << "x), plain build at "
+		<< BENCH_SDF_FONT_SIZE << " px " << plainSeconds * 1000.0 << " ms" << std::endl;
+	std::cout << "[SdfFontBench] outlines: " << disagreed << " of " << compared << " pixels on the other side of the plain glyph's" << std::endl;
+	std::cout << "[SdfFontBench] validation: " << errors << " errors" << std::endl;
+	jobs.Shutdown();
+}
+
+struct TextCacheBenchFrame
+{
+	std::vector<ImVec2> Sizes;
+	ImVector<ImDrawVert> Vtx;
+	ImVector<ImDrawIdx> Idx;
+	std::vector<std::pair<unsigned int, unsigned int>> Cmds;
+};
+
+static void FormatTextCacheBenchLine(char* buf, size_t size, int line, int frame)
+{
+	if (line % BENCH_TEXT_CACHE_CHANGE_EVERY == frame % BENCH_TEXT_CACHE_CHANGE_EVERY)
+		snprintf(buf, size, "[%05d] worker %d: frame %d, %d jobs pending", line, line % 16, frame, (line * 7 + frame) % 1000);
+	else
+		snprintf(buf, size, "[%05d] worker %d: processed batch %d in %.2f ms", line, line % 16, line * 3, (line % 97) * 0.37f);
+}
+
+void RunTextLayoutCacheBenchmark(const char* fontPath, float size)
+{
+	const float lineHeight = size;
+	const float columnWidth = lineHeight * 25.0f;
+	ImGuiIO& io = CreateBenchContext(ImVec2(columnWidth * 4.0f, lineHeight * (BENCH_TEXT_CACHE_LINES / 4 + 1)), BenchTexFormat::Alpha8, fontPath, size);
+	ImFont* font = io.Fonts->Fonts[0];
+
+	std::vector<std::string> lines(BENCH_TEXT_CACHE_LINES);
+	char buf[128];
+	uint32_t errors = 0;
+	TextCacheBenchFrame results[2];
+	double seconds[2] = {}, firstSeconds[2] = {};
+	ImTextLayoutCacheStats stats;
+	for (int cached = 0; cached < 2; cached++)
+	{
+		io.ConfigTextLayoutCache = cached != 0;
+		ImDrawList list(ImGui::GetDrawListSharedData());
+		TextCacheBenchFrame& result = results[cached];
+		for (int frame = 0; frame < BENCH_TEXT_CACHE_FRAMES; frame++)
+		{
+			for (int i = 0; i < BENCH_TEXT_CACHE_LINES; i++)
+				if (frame == 0 || i % BENCH_TEXT_CACHE_CHANGE_EVERY == frame % BENCH_TEXT_CACHE_CHANGE_EVERY ||
+					i % BENCH_TEXT_CACHE_CHANGE_EVERY == (frame - 1) % BENCH_TEXT_CACHE_CHANGE_EVERY)
+				{
+					FormatTextCacheBenchLine(buf, sizeof(buf), i, frame);
+					lines[i] = buf;
+				}
+
+			ImGui::NewFrame();
+			list._ResetForNewFrame();
+			list.PushTextureID(io.Fonts->TexID);
+			list.PushClipRectFullScreen();
+			result.Sizes.clear();
+
+			// Measured like a widget, then drawn. Every 50th line is wrapped, every 7th cut in half by a clip rect (with
+			// CPU clipping), like text in a column too narrow for it.
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < BENCH_TEXT_CACHE_LINES; i++)
+			{
+				const char* text = lines[i].c_str();
+				const char* textEnd = text + lines[i].size();
+				const float wrapWidth = i % 50 == 0 ? columnWidth * 0.5f : 0.0f;
+				ImVec2 pos((i % 4) * columnWidth + 0.5f, (i / 4) * lineHeight);
+				result.Sizes.push_back(ImGui::CalcTextSize(text, textEnd, false, wrapWidth));
+				if (i % 7 == 0)
+				{
+					ImVec4 clip(pos.x, pos.y, pos.x + result.Sizes.back().x * 0.5f, pos.y + lineHeight);
+					list.AddText(font, size, pos, IM_COL32_WHITE, text, textEnd, wrapWidth, &clip);
+				}
+				else
+				{
+					list.AddText(font, size, pos, IM_COL32_WHITE, text, textEnd, wrapWidth);
+				}
+			}
+			double frameSeconds = SecondsSince(start);
+			if (frame < 2)
+				firstSeconds[cached] += frameSeconds;
+			else
+				seconds[cached] += frameSeconds;
+			ImGui::EndFrame();
+		}
+		stats = ImGui::GetCurrentContext()->TextLayoutCache.Stats;
+
+		result.Vtx = list.VtxBuffer;
+		result.Idx = list.IdxBuffer;
+		for (const ImDrawCmd& cmd : list.CmdBuffer)
+			result.Cmds.emplace_back(cmd.ElemCount, cmd.VtxOffset);
+	}
+
+	// The last frame, drawn with and without the cache
+	const TextCacheBenchFrame& a = results[0];
+	const TextCacheBenchFrame& b = results[1];
+	int vtxDifferences = 0;
+	if (a.Sizes.size() != b.Sizes.size() || memcmp(a.Sizes.data(), b.Sizes.data(), a.Sizes.size() * sizeof(ImVec2)) != 0)
+		errors++;
+	if (a.Cmds != b.Cmds || a.Idx.Size != b.Idx.Size || a.Vtx.Size != b.Vtx.Size || memcmp(a.Idx.Data, b.Idx.Data, a.Idx.size_in_bytes()) != 0)
+		errors++;
+	else
+		for (int i = 0; i < a.Vtx.Size; i++)
+			vtxDifferences += memcmp(&a.Vtx[i], &b.Vtx[i], sizeof(ImDrawVert)) == 0 ? 0 : 1;
+	errors += vtxDifferences;
+
+	int steadyFrames = BENCH_TEXT_CACHE_FRAMES - 2;
+	std::cout << "[TextCacheBench] " << (fontPath != nullptr ? fontPath : "default font") << " at " << size << " px, "
+		<< BENCH_TEXT_CACHE_LINES << " lines, 1 in " << BENCH_TEXT_CACHE_CHANGE_EVERY << " changing every frame, "
+		<< a.Vtx.Size << " vertices" << std::endl;
+	std::cout << "[TextCacheBench] measure + draw: " << seconds[0] * 1e3 / steadyFrames << " ms/frame uncached, "
+		<< seconds[1] * 1e3 / steadyFrames << " ms/frame cached (" << seconds[0] / seconds[1] << "x); first 2 frames "
+		<< firstSeconds[0] * 1e3 << " / " << firstSeconds[1] * 1e3 << " ms" << std::endl;
+	std::cout << "[TextCacheBench] last frame: " << stats.Layouts << " layouts, " << stats.MemoryBytes / 1024 << " KB, "
+		<< stats.MeasureHits << " of " << stats.MeasureHits + stats.MeasureMisses << " measures and " << stats.RenderHits << " of "
+		<< stats.RenderHits + stats.RenderMisses + stats.RenderClipped << " draws from the cache (" << stats.RenderClipped
+		<< " clipped), " << vtxDifferences << " vertices differ" << std::endl;
+	std::cout << "[TextCacheBench] validation: " << errors << " errors" << std::endl;
+	ImGui::DestroyContext();
+}
+
+// Timestamped log lines. The mixed corpus has CJK words (3 byte sequences) between the ASCII ones, and the odd line with a
+// truncated sequence, an overlong encoding or a surrogate.
+static std::string MakeTextDecodeCorpus(bool cjk, std::vector<size_t>& lineStarts)
+{
+	static char const* const words[] = { "frame", "submitted", "draw", "calls", "in", "ms", "upload", "texture", "worker", "idle" };
+	static char const* const malformed[] = { "\xE4\xB8", "\xC0\xAF", "\xED\xA0\x80", "\xFF" };
+	std::mt19937 rng(1234);
+	std::string corpus;
+	char buf[64];
+	for (int line = 0; corpus.size() < (size_t)BENCH_TEXT_DECODE_BYTES; line++)
+	{
+		lineStarts.push_back(corpus.size());
+		snprintf(buf, sizeof(buf), "[%02d:%02d:%02d.%03d] ", line / 3600000 % 24, line / 60000 % 60, line / 1000 % 60, line % 1000);
+		corpus += buf;
+		for (int word = 0, count = 6 + (int)(rng() % 10); word < count; word++)
+		{
+			if (cjk && rng() % 2 == 0)
+			{
+				for (int c = 0, length = 1 + (int)(rng() % 4); c < length; c++)
+				{
+					ImTextCharToUtf8(buf, 0x4E00 + (unsigned int)(rng() % 0x51A6));
+					corpus += buf;
+				}
+			}
+			else if (rng() % 3 == 0)
+			{
+				corpus += std::to_string(rng() % 100000);
+			}
+			else
+			{
+				corpus += words[rng() % IM_ARRAYSIZE(words)];
+			}
+			corpus += ' ';
+		}
+		if (cjk && line % BENCH_TEXT_DECODE_MALFORMED_EVERY == 0)
+			corpus += malformed[line / BENCH_TEXT_DECODE_MALFORMED_EVERY % IM_ARRAYSIZE(malformed)];
+		corpus += '\n';
+	}
+	lineStarts.push_back(corpus.size());
+	return corpus;
+}
+
+// The one character at a time loops the fast paths replace, as references for their output
+static int DecodeUtf8Reference(ImWchar* out, const char* text, const char* textEnd)
+{
+	ImWchar* outBegin = out;
+	while (text < textEnd && *text)
+	{
+		unsigned int c;
+		text += ImTextCharFromUtf8(&c, text, textEnd);
+		if (c == 0)
+			break;
+		*out++ = (ImWchar)c;
+	}
+	return (int)(out - outBegin);
+}
+
+static ImVec2 MeasureReference(const ImFont* font, float size, float maxWidth, const char* text, const char* textEnd, const char** remaining)
+{
+	const float scale = size / font->FontSize;
+	ImVec2 textSize(0.0f, 0.0f);
+	float lineWidth = 0.0f;
+	const char* s = text;
+	while (s < textEnd)
+	{
+		const char* prev = s;
+		unsigned int c = (unsigned char)*s;
+		if (c < 0x80)
+		{
+			s += 1;
+		}
+		else
+		{
+			s += ImTextCharFromUtf8(&c, s, textEnd);
+			if (c == 0)
+				break;
+		}
+		if (c == '\n')
+		{
+			textSize.x = std::max(textSize.x, lineWidth);
+			textSize.y += size;
+			lineWidth = 0.0f;
+			continue;
+		}
+		if (c == '\r')
+			continue;
+		const float charWidth = font->GetCharAdvance((ImWchar)c) * scale;
+		if (lineWidth + charWidth >= maxWidth)
+		{
+			s = prev;
+			break;
+		}
+		lineWidth += charWidth;
+	}
+	textSize.x = std::max(textSize.x, lineWidth);
+	if (lineWidth > 0.0f || textSize.y == 0.0f)
+		textSize.y += size;
+	*remaining = s;
+	return textSize;
+}
+
+// Compares the quads RenderText() wrote for one unclipped line at `pos` with the glyphs found one character at a time
+static bool SameGlyphQuads(const ImFont* font, float size, ImVec2 pos, const char* text, const char* textEnd, const ImDrawVert* vtx, int vtxCount)
+{
+	const float scale = size / font->FontSize;
+	float x = IM_FLOOR(pos.x);
+	const float y = IM_FLOOR(pos.y);
+	int quad = 0;
+	for (const char* s = text; s < textEnd; )
+	{
+		unsigned int c;
+		s += ImTextCharFromUtf8(&c, s, textEnd);
+		if (c == 0)
+			break;
+		const ImFontGlyph* glyph = font->FindGlyph((ImWchar)c);
+		if (c == '\r' || c == '\n' || glyph == nullptr)
+			continue;
+		if (glyph->Visible)
+		{
+			if ((quad + 1) * 4 > vtxCount)
+				return false;
+			const ImDrawVert* v = &vtx[quad++ * 4];
+			if (v[0].pos.x != x + glyph->X0 * scale || v[0].pos.y != y + glyph->Y0 * scale || v[2].pos.x != x + glyph->X1 * scale ||
+				v[2].pos.y != y + glyph->Y1 * scale || v[0].uv.x != glyph->U0 || v[0].uv.y != glyph->V0 || v[2].uv.x != glyph->U1 || v[2].uv.y != glyph->V1)
+				return false;
+		}
+		x += glyph->AdvanceX * scale;
+	}
+	return quad * 4 == vtxCount;
+}
+
+void RunTextDecodeBenchmark(const char* fontPath, float size)
+{
+	ImFontAtlas atlas;
+	ImFontConfig config;
+	config.SizePixels = size;
+	const ImWchar* ranges = atlas.GetGlyphRangesChineseSimplifiedCommon();
+	ImFont* font = fontPath != nullptr ? atlas.AddFontFromFileTTF(fontPath, size, &config, ranges) : atlas.AddFontDefault(&config);
+	atlas.Build();
+	atlas.SetTexID((ImTextureID)(intptr_t)1);
+	ImDrawListSharedData shared;
+	shared.Font = font;
+	shared.FontSize = size;
+	shared.TexUvWhitePixel = atlas.TexUvWhitePixel;
+	shared.ClipRectFullscreen = ImVec4(0.0f, 0.0f, 1e6f, 1e6f);
+	shared.InitialFlags = ImDrawListFlags_AllowVtxOffset;
+
+	uint32_t errors = 0;
+	for (int cjk = 0; cjk < 2; cjk++)
+	{
+		std::vector<size_t> lineStarts;
+		const std::string corpus = MakeTextDecodeCorpus(cjk != 0, lineStarts);
+		const char* text = corpus.c_str();
+		const int lineCount = (int)lineStarts.size() - 1;
+		const double megabytes = corpus.size() / (double)(1 << 20);
+
+		// Decoding to ImWchar, as InputText() does with its whole buffer
+		std::vector<ImWchar> reference(corpus.size() + 1), decoded(corpus.size() + 1);
+		int referenceCount = 0, decodedCount = 0;
+		double referenceDecodeSeconds = DBL_MAX, decodeSeconds = DBL_MAX;
+		for (int run = 0; run < BENCH_TEXT_DECODE_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			referenceCount = DecodeUtf8Reference(reference.data(), text, text + corpus.size());
+			referenceDecodeSeconds = std::min(referenceDecodeSeconds, SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			decodedCount = ImTextStrFromUtf8(decoded.data(), (int)decoded.size(), text, text + corpus.size());
+			decodeSeconds = std::min(decodeSeconds, SecondsSince(start));
+		}
+		errors += referenceCount == decodedCount && memcmp(reference.data(), decoded.data(), decodedCount * sizeof(ImWchar)) == 0 ? 0 : 1;
+
+		// Measuring every line, as widgets do before drawing. The line ends are included, like a multi-line text pane.
+		const char* remaining = nullptr;
+		float checksum[2] = {};
+		double referenceMeasureSeconds = DBL_MAX, measureSeconds = DBL_MAX;
+		for (int run = 0; run < BENCH_TEXT_DECODE_RUNS; run++)
+		{
+			checksum[0] = checksum[1] = 0.0f;
+			auto start = std::chrono::steady_clock::now();
+			for (int line = 0; line < lineCount; line++)
+				checksum[0] += MeasureReference(font, size, FLT_MAX, text + lineStarts[line], text + lineStarts[line + 1], &remaining).x;
+			referenceMeasureSeconds = std::min(referenceMeasureSeconds, SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			for (int line = 0; line < lineCount; line++)
+				checksum[1] += font->CalcTextSizeA(size, FLT_MAX, 0.0f, text + lineStarts[line], text + lineStarts[line + 1]).x;
+			measureSeconds = std::min(measureSeconds, SecondsSince(start));
+		}
+		errors += checksum[0] == checksum[1] ? 0 : 1;
+		for (int line = 0; line < lineCount; line++)
+		{
+			// Again with a width limit cutting every line in half, which has to stop on the same character
+			const char* begin = text + lineStarts[line];
+			const char* end = text + lineStarts[line + 1];
+			const char* referenceRemaining = nullptr;
+			ImVec2 referenceSize = MeasureReference(font, size, FLT_MAX, begin, end, &referenceRemaining);
+			ImVec2 size2 = font->CalcTextSizeA(size, FLT_MAX, 0.0f, begin, end, &remaining);
+			errors += referenceSize.x == size2.x && referenceSize.y == size2.y && referenceRemaining == remaining ? 0 : 1;
+			const float maxWidth = referenceSize.x * 0.5f;
+			referenceSize = MeasureReference(font, size, maxWidth, begin, end, &referenceRemaining);
+			size2 = font->CalcTextSizeA(size, maxWidth, 0.0f, begin, end, &remaining);
+			errors += referenceSize.x == size2.x && referenceSize.y == size2.y && referenceRemaining == remaining ? 0 : 1;
+		}
+
+		// Drawing every line, unclipped
+		ImDrawList list(&shared);
+		int glyphs = 0;
+		double drawSeconds = DBL_MAX;
+		for (int run = 0; run < BENCH_TEXT_DECODE_RUNS; run++)
+		{
+			glyphs = 0;
+			auto start = std::chrono::steady_clock::now();
+			for (int line = 0; line < lineCount; line++)
+			{
+				if (line % BENCH_TEXT_DECODE_DRAW_LINES == 0)
+				{
+					glyphs += list.VtxBuffer.Size / 4;
+					list._ResetForNewFrame();
+					list.PushTextureID(atlas.TexID);
+					list.PushClipRectFullScreen();
+				}
+				list.AddText(font, size, ImVec2(0.5f, (line % BENCH_TEXT_DECODE_DRAW_LINES) * size), IM_COL32_WHITE, text + lineStarts[line], text + lineStarts[line + 1]);
+			}
+			drawSeconds = std::min(drawSeconds, SecondsSince(start));
+			glyphs += list.VtxBuffer.Size / 4;
+		}
+		for (int line = 0; line < lineCount; line++)
+		{
+			list._ResetForNewFrame();
+			list.PushTextureID(atlas.TexID);
+			list.PushClipRectFullScreen();
+			const ImVec2 pos(0.5f, (line % BENCH_TEXT_DECODE_DRAW_LINES) * size);
+			list.AddText(font, size, pos, IM_COL32_WHITE, text + lineStarts[line], text + lineStarts[line + 1]);
+			errors += SameGlyphQuads(font, size, pos, text + lineStarts[line], text + lineStarts[line + 1], list.VtxBuffer.Data, list.VtxBuffer.Size) ? 0 : 1;
+		}
+
+		std::cout << "[TextDecodeBench] " << (cjk ? "mixed CJK" : "ASCII") << " log, " << corpus.size() / 1024 << " KB in " << lineCount
+			<< " lines, " << (fontPath != nullptr ? fontPath : "default font") << " at " << size << " px" << std::endl;
+		std::cout << "[TextDecodeBench] decode: " << megabytes / referenceDecodeSeconds << " MB/s one character at a time, "
+			<< megabytes / decodeSeconds << " MB/s ImTextStrFromUtf8() (" << referenceDecodeSeconds / decodeSeconds << "x)" << std::endl;
+		std::cout << "[TextDecodeBench] measure: " << megabytes / referenceMeasureSeconds << " MB/s one character at a time, "
+			<< megabytes / measureSeconds << " MB/s CalcTextSizeA() (" << referenceMeasureSeconds / measureSeconds << "x)" << std::endl;
+		std::cout << "[TextDecodeBench] draw: " << megabytes / drawSeconds << " MB/s, " << glyphs / drawSeconds / 1e6 << " M glyphs/s RenderText()" << std::endl;
+	}
+	std::cout << "[TextDecodeBench] validation: " << errors << " errors" << std::endl;
+}
+
+// imgui's original byte at a time CRC32, as the reference for the IDs
+struct ReferenceCrc32
+{
+	ImU32 Table[256];
+
+	ReferenceCrc32()
+	{
+		for (ImU32 i = 0; i < 256; i++)
+		{
+			ImU32 crc = i;
+			for (int bit = 0; bit < 8; bit++)
+				crc = (crc >> 1) ^ (0xEDB88320 & (0u - (crc & 1)));
+			Table[i] = crc;
+		}
+	}
+
+	ImGuiID HashData(const void* data, size_t size, ImU32 seed) const
+	{
+		ImU32 crc = ~seed;
+		for (const unsigned char* p = (const unsigned char*)data; size-- != 0; p++)
+			crc = (crc >> 8) ^ Table[(crc & 0xFF) ^ *p];
+		return ~crc;
+	}
+
+	ImGuiID HashStr(const char* str, ImU32 seed) const
+	{
+		seed = ~seed;
+		ImU32 crc = seed;
+		for (const unsigned char* p = (const unsigned char*)str; unsigned char c = *p++; )
+		{
+			if (c == '#' && p[0] == '#' && p[1] == '#')
+				crc = seed;
+			crc = (crc >> 8) ^ Table[(crc & 0xFF) ^ c];
+		}
+		return ~crc;
+	}
+};
+
+// The IDs of one frame: every window hashes its name, then opens a tree node every 16 widgets (whose ID seeds the
+// widgets under it), and each widget pushes its index or a pointer (like a list item) and hashes its label, the way
+// GetID() does under the ID stack. Returns a sum of all IDs.
+template<typename HashStr, typename HashData>
+static ImGuiID HashBenchFrame(const std::vector<std::string>& windows, const std::vector<std::string>& labels, HashStr hashStr, HashData hashData)
+{
+	ImGuiID sum = 0;
+	for (size_t w = 0; w < windows.size(); w++)
+	{
+		const ImGuiID windowId = hashStr(windows[w].c_str(), 0);
+		ImGuiID treeId = windowId;
+		for (int i = 0; i < BENCH_HASH_WIDGETS_PER_WINDOW; i++)
+		{
+			if (i % 16 == 0)
+				treeId = hashStr(labels[(w + i) % labels.size()].c_str(), windowId);
+			const void* item = &labels[i % labels.size()];
+			const ImGuiID seed = i % 4 == 0 ? hashData(&item, sizeof(item), treeId) : hashData(&i, sizeof(i), treeId);
+			sum += hashStr(labels[(w * 31 + i) % labels.size()].c_str(), seed);
+		}
+	}
+	return sum;
+}
+
+void RunHashBenchmark()
+{
+	// Labels as found in a tool UI: short words, "##" hidden labels, "###" IDs (some with more than one), numbered items
+	static char const* const kinds[] = { "Enabled", "##value", "Speed (m/s)", "Delete###del", "Texture Viewer/Mip", "##hidden###id",
+		"Color", "Item ####x", "Open...", "Shadow cascade split lambda", "#", "##", "a###b###c" };
+	std::vector<std::string> windows, labels;
+	for (int w = 0; w < BENCH_HASH_WINDOWS; w++)
+		windows.push_back(w % 3 == 0 ? "Inspector##" + std::to_string(w) : "Scene Hierarchy " + std::to_string(w));
+	for (int i = 0; i < 1024; i++)
+		labels.push_back(i % 2 == 0 ? std::string(kinds[i % IM_ARRAYSIZE(kinds)]) : std::string(kinds[i % IM_ARRAYSIZE(kinds)]) + " " + std::to_string(i));
+
+	ReferenceCrc32 reference;
+	uint32_t errors = 0;
+	for (const std::string& label : labels)
+		for (ImU32 seed : { 0u, 0x12345678u })
+		{
+			errors += ImHashStr(label.c_str(), 0, seed) == reference.HashStr(label.c_str(), seed) ? 0 : 1;
+			errors += ImHashStr(label.c_str(), label.size(), seed) == reference.HashStr(label.c_str(), seed) ? 0 : 1;
+			errors += ImHashData(label.c_str(), label.size(), seed) == reference.HashData(label.c_str(), label.size(), seed) ? 0 : 1;
+		}
+
+	double seconds[2] = { DBL_MAX, DBL_MAX };
+	ImGuiID sums[2] = {};
+	for (int frame = 0; frame < BENCH_HASH_FRAMES; frame++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		sums[0] = HashBenchFrame(windows, labels, [&](const char* str, ImU32 seed) { return reference.HashStr(str, seed); },
+			[&](const void* data, size_t size, ImU32 seed) { return reference.HashData(data, size, seed); });
+		seconds[0] = std::min(seconds[0], SecondsSince(start));
+		start = std::chrono::steady_clock::now();
+		sums[1] = HashBenchFrame(windows, labels, [](const char* str, ImU32 seed) { return ImHashStr(str, 0, seed); },
+			[](const void* data, size_t size, ImU32 seed) { return ImHashData(data, size, seed); });
+		seconds[1] = std::min(seconds[1], SecondsSince(start));
+	}
+	errors += sums[0] == sums[1] ? 0 : 1;
+
+	std::vector<unsigned char> buffer(BENCH_HASH_BUFFER_BYTES);
+	std::mt19937 rng(1234);
+	for (unsigned char& byte : buffer)
+		byte = (unsigned char)rng();
+	double bufferSeconds[2] = { DBL_MAX, DBL_MAX };
+	ImGuiID bufferIds[2] = {};
+	for (int run = 0; run < 10; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		bufferIds[0] = reference.HashData(buffer.data(), buffer.size(), 0);
+		bufferSeconds[0] = std::min(bufferSeconds[0], SecondsSince(start));
+		start = std::chrono::steady_clock::now();
+		bufferIds[1] = ImHashData(buffer.data(), buffer.size(), 0);
+		bufferSeconds[1] = std::min(bufferSeconds[1], SecondsSince(start));
+	}
+	errors += bufferIds[0] == bufferIds[1] ? 0 : 1;
+
+	const int ids = BENCH_HASH_WINDOWS * (BENCH_HASH_WIDGETS_PER_WINDOW * 2 + BENCH_HASH_WIDGETS_PER_WINDOW / 16 + 1);
+	const double megabytes = BENCH_HASH_BUFFER_BYTES / (double)(1 << 20);
+	std::cout << "[HashBench] ID stack: " << BENCH_HASH_WINDOWS << " windows of " << BENCH_HASH_WIDGETS_PER_WINDOW << " widgets, "
+		<< ids / seconds[0] / 1e6 << " M hashes/s byte at a time, " << ids / seconds[1] / 1e6 << " M hashes/s ImHashStr()/ImHashData() ("
+		<< seconds[0] / seconds[1] << "x)" << std::endl;
+	std::cout << "[HashBench] buffer: " << megabytes / bufferSeconds[0] << " MB/s byte at a time, " << megabytes / bufferSeconds[1]
+		<< " MB/s ImHashData() (" << bufferSeconds[0] / bufferSeconds[1] << "x)" << std::endl;
+	std::cout << "[HashBench] validation: " << errors << " errors" << std::endl;
+}
+
+void RunStorageBenchmark()
+{
+	uint32_t errors = 0;
+	for (int count : BENCH_STORAGE_KEY_COUNTS)
+	{
+		// CRC32 of a 4 byte index is a bijection, so these are distinct IDs spread like real ones. Misses are the next indices.
+		std::vector<ImGuiID> keys(count), misses(count);
+		for (int i = 0; i < count; i++)
+		{
+			const int miss = count + i;
+			keys[i] = ImHashData(&i, sizeof(i), 0);
+			misses[i] = ImHashData(&miss, sizeof(miss), 0);
+		}
+		std::vector<int> order(count);
+		for (int i = 0; i < count; i++)
+			order[i] = i;
+		std::shuffle(order.begin(), order.end(), std::mt19937(1234));
+
+		double insertSeconds[2] = { DBL_MAX, DBL_MAX }, buildSeconds = DBL_MAX;
+		ImGuiStorage sorted;
+		ImGuiHashStorage hashed;
+		for (int run = 0; run < BENCH_STORAGE_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			if (count <= BENCH_STORAGE_MAX_SORTED_INSERTS)
+			{
+				sorted.Clear();
+				for (int i : order)
+					sorted.SetInt(keys[i], i);
+				insertSeconds[0] = std::min(insertSeconds[0], SecondsSince(start));
+			}
+			start = std::chrono::steady_clock::now();
+			sorted.Clear();
+			for (int i : order)
+				sorted.Data.push_back(ImGuiStorage::ImGuiStoragePair(keys[i], i));
+			sorted.BuildSortByKey();
+			buildSeconds = std::min(buildSeconds, SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			hashed.Clear();
+			for (int i : order)
+				hashed.SetInt(keys[i], i);
+			insertSeconds[1] = std::min(insertSeconds[1], SecondsSince(start));
+		}
+
+		double hitSeconds[2] = { DBL_MAX, DBL_MAX }, missSeconds[2] = { DBL_MAX, DBL_MAX };
+		int64_t sums[2] = {}, missSums[2] = {};
+		for (int run = 0; run < BENCH_STORAGE_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			sums[0] = 0;
+			for (int i : order)
+				sums[0] += sorted.GetInt(keys[i], -1);
+			hitSeconds[0] = std::min(hitSeconds[0], SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			sums[1] = 0;
+			for (int i : order)
+				sums[1] += hashed.GetInt(keys[i], -1);
+			hitSeconds[1] = std::min(hitSeconds[1], SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			missSums[0] = 0;
+			for (ImGuiID key : misses)
+				missSums[0] += sorted.GetInt(key, -1);
+			missSeconds[0] = std::min(missSeconds[0], SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			missSums[1] = 0;
+			for (ImGuiID key : misses)
+				missSums[1] += hashed.GetInt(key, -1);
+			missSeconds[1] = std::min(missSeconds[1], SecondsSince(start));
+		}
+
+		// Ordered iteration: the hashed storage sorted into an ImGuiStorage must be the same as the sorted one
+		double iterateSeconds = DBL_MAX;
+		ImGuiStorage rebuilt;
+		for (int run = 0; run < BENCH_STORAGE_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			hashed.BuildSortedStorage(&rebuilt);
+			iterateSeconds = std::min(iterateSeconds, SecondsSince(start));
+		}
+		errors += hashed.GetCount() == count && rebuilt.Data.Size == sorted.Data.Size ? 0 : 1;
+		for (int n = 0; n < rebuilt.Data.Size && n < sorted.Data.Size; n++)
+			errors += rebuilt.Data[n].key == sorted.Data[n].key && rebuilt.Data[n].val_i == sorted.Data[n].val_i ? 0 : 1;
+		for (int i = 0; i < count; i++)
+			errors += hashed.GetInt(keys[i], -1) == i && sorted.GetInt(keys[i], -1) == i && hashed.GetInt(misses[i], -1) == -1 ? 0 : 1;
+		errors += sums[0] == sums[1] && missSums[0] == missSums[1] && missSums[1] == -(int64_t)count ? 0 : 1;
+
+		// The rest of the API: references, floats, pointers, SetAllInt()
+		*hashed.GetIntRef(keys[0]) += 1;
+		*hashed.GetFloatRef(misses[0], 0.5f) *= 2.0f;
+		*hashed.GetVoidPtrRef(misses[1]) = &keys;
+		errors += hashed.GetInt(keys[0]) == 1 && hashed.GetFloat(misses[0]) == 1.0f && hashed.GetVoidPtr(misses[1]) == &keys ? 0 : 1;
+		hashed.SetAllInt(7);
+		errors += hashed.GetInt(keys[count - 1]) == 7 && hashed.GetCount() == count + 2 ? 0 : 1;
+
+		const double ns = 1e9 / count;
+		std::cout << "[StorageBench] " << count << " keys: insert ";
+		if (count <= BENCH_STORAGE_MAX_SORTED_INSERTS)
+			std::cout << insertSeconds[0] * ns << " ns/key sorted, ";
+		std::cout << buildSeconds * ns << " ns/key sorted in one go, " << insertSeconds[1] * ns << " ns/key hashed" << std::endl;
+		std::cout << "[StorageBench] " << count << " keys: lookup " << hitSeconds[0] * ns << " ns sorted, " << hitSeconds[1] * ns
+			<< " ns hashed (" << hitSeconds[0] / hitSeconds[1] << "x), miss " << missSeconds[0] * ns << " ns sorted, " << missSeconds[1] * ns
+			<< " ns hashed (" << missSeconds[0] / missSeconds[1] << "x), sorted iteration rebuild " << iterateSeconds * 1e3 << " ms" << std::endl;
+	}
+	std::cout << "[StorageBench] validation: " << errors << " errors" << std::endl;
+}
+
+// One round of churn through imgui's allocator. Sizes are spread like imgui's: mostly small (IDs, strings, small
+// vectors), some up to 16 KB (draw buffers). Every block is stamped and checked when freed, so a block handed out twice
+// shows up as an error. Returns the number of allocations.
+static uint32_t UIAllocRound(uint32_t seed, uint32_t* errors)
+{
+	std::mt19937 rng(seed);
+	void* blocks[BENCH_UI_ALLOC_LIVE] = {};
+	uint64_t stamps[BENCH_UI_ALLOC_LIVE] = {};
+	auto release = [&](int slot)
+	{
+		*errors += memcmp(blocks[slot], &stamps[slot], sizeof(uint64_t)) == 0 ? 0 : 1;
+		IM_FREE(blocks[slot]);
+		blocks[slot] = nullptr;
+	};
+	for (int op = 0; op < BENCH_UI_ALLOC_OPS; op++)
+	{
+		int slot = (int)(rng() % BENCH_UI_ALLOC_LIVE);
+		if (blocks[slot] != nullptr)
+			release(slot);
+		size_t size = (size_t)8 << (rng() % 11);
+		size += rng() % size;
+		blocks[slot] = IM_ALLOC(size);
+		stamps[slot] = ((uint64_t)seed << 32) ^ ((uint64_t)op << 16) ^ size;
+		memcpy(blocks[slot], &stamps[slot], sizeof(uint64_t));
+	}
+	for (int slot = 0; slot < BENCH_UI_ALLOC_LIVE; slot++)
+		if (blocks[slot] != nullptr)
+			release(slot);
+	return BENCH_UI_ALLOC_OPS;
+}
+
+void RunUIAllocatorBenchmark(uint32_t numThreads)
+{
+	if (numThreads == 0)
+		numThreads = std::max(1u, std::thread::hardware_concurrency());
+	uint32_t errors = 0;
+
+	// Same rounds on every thread, with malloc() and then with the pools
+	auto churn = [numThreads]()
+	{
+		std::vector<std::thread> threads;
+		std::vector<uint32_t> threadErrors(numThreads, 0);
+		auto start = std::chrono::steady_clock::now();
+		for (uint32_t t = 0; t < numThreads; t++)
+			threads.emplace_back([t, &threadErrors]()
+				{
+					for (int round = 0; round < BENCH_UI_ALLOC_ROUNDS; round++)
+						UIAllocRound(t * BENCH_UI_ALLOC_ROUNDS + round, &threadErrors[t]);
+				});
+		for (std::thread& thread : threads)
+			thread.join();
+		double seconds = SecondsSince(start);
+		for (uint32_t threadError : threadErrors)
+			seconds = threadError == 0 ? seconds : -1.0;
+		return seconds;
+	};
+	ImGui::SetAllocatorFunctions([](size_t size, void*) { return malloc(size); }, [](void* ptr, void*) { free(ptr); });
+	double mallocSeconds = churn();
+	UIAllocator::Install(BENCH_UI_ALLOC_ARENA);
+	double poolSeconds = churn();
+	errors += mallocSeconds > 0.0 && poolSeconds > 0.0 ? 0 : 1;
+	UIAllocatorStats stats = UIAllocator::GetStats();
+	errors += stats.LiveAllocations == 0 && stats.LiveBytes == 0 ? 0 : 1;
+	const uint64_t churnAllocations = stats.Allocations;
+	const uint64_t churnHeapAllocations = stats.HeapAllocations;
+
+	// Frames on the main thread, in the pools and then in the arena. Once the first frame has filled the pools, no
+	// frame goes to the heap, and the arena rewinds every frame.
+	double frameSeconds[2] = { DBL_MAX, DBL_MAX };
+	uint64_t heapAllocationsAfterWarmUp = 0, arenaAllocations = 0;
+	for (int arena = 0; arena < 2; arena++)
+	{
+		for (int frame = 0; frame < BENCH_UI_ALLOC_FRAMES; frame++)
+		{
+			UIAllocator::NewFrame();
+			stats = UIAllocator::GetStats();
+			if (frame > 1)
+				heapAllocationsAfterWarmUp += stats.FrameHeapAllocations;
+			arenaAllocations += stats.FrameArenaAllocations;
+			auto start = std::chrono::steady_clock::now();
+			if (arena)
+			{
+				UIFrameArenaScope scope;
+				UIAllocRound(0, &errors);
+			}
+			else
+			{
+				UIAllocRound(0, &errors);
+			}
+			frameSeconds[arena] = std::min(frameSeconds[arena], SecondsSince(start));
+		}
+	}
+	UIAllocator::NewFrame();
+	stats = UIAllocator::GetStats();
+	errors += heapAllocationsAfterWarmUp == 0 && arenaAllocations > 0 ? 0 : 1;
+
+	// A worker allocates a batch, the main thread frees it. The frees can't go to the main thread's lists, the worker
+	// has to get them back or it goes to the heap for every batch.
+	std::vector<void*> batch(BENCH_UI_ALLOC_LIVE);
+	std::atomic<int> allocated{ 0 }, freed{ 0 };
+	uint64_t handoffHeapAllocations = 0;
+	std::thread worker([&batch, &allocated, &freed]()
+		{
+			for (int handoff = 1; handoff <= BENCH_UI_ALLOC_HANDOFFS; handoff++)
+			{
+				while (freed.load(std::memory_order_acquire) != handoff - 1)
+					std::this_thread::yield();
+				// The same sizes every time, like a draw list rebuilt every frame
+				std::mt19937 rng(1234);
+				for (void*& block : batch)
+				{
+					size_t size = (size_t)8 << (rng() % 11);
+					block = IM_ALLOC(size + rng() % size);
+				}
+				allocated.store(handoff, std::memory_order_release);
+			}
+		});
+	for (int handoff = 1; handoff <= BENCH_UI_ALLOC_HANDOFFS; handoff++)
+	{
+		while (allocated.load(std::memory_order_acquire) != handoff)
+			std::this_thread::yield();
+		for (void* block : batch)
+			IM_FREE(block);
+		// The first batches fill the shared lists
+		if (handoff == 2)
+			handoffHeapAllocations = UIAllocator::GetStats().HeapAllocations;
+		freed.store(handoff, std::memory_order_release);
+	}
+	worker.join();
+	stats = UIAllocator::GetStats();
+	handoffHeapAllocations = stats.HeapAllocations - handoffHeapAllocations;
+	errors += handoffHeapAllocations == 0 && stats.CrossThreadFrees >= (uint64_t)BENCH_UI_ALLOC_LIVE * BENCH_UI_ALLOC_HANDOFFS ? 0 : 1;
+	errors += stats.DeferredArenaResets == 0 && stats.ArenaOverflows == 0 && stats.LiveAllocations == 0 ? 0 : 1;
+	const uint64_t peakBytes = stats.PeakLiveBytes;
+	UIAllocator::Uninstall();
+
+	const double allocations = (double)churnAllocations;
+	std::cout << "[UIAllocBench] churn: " << numThreads << " threads, " << allocations / mallocSeconds / 1e6 << " M allocations/s malloc(), "
+		<< allocations / poolSeconds / 1e6 << " M allocations/s pools (" << mallocSeconds / poolSeconds << "x), "
+		<< churnHeapAllocations << " heap allocations for " << churnAllocations << std::endl;
+	std::cout << "[UIAllocBench] frames: " << BENCH_UI_ALLOC_OPS / frameSeconds[0] / 1e6 << " M allocations/s pools, "
+		<< BENCH_UI_ALLOC_OPS / frameSeconds[1] / 1e6 << " M allocations/s arena, heap allocations after warm up: "
+		<< heapAllocationsAfterWarmUp << ", peak " << peakBytes / 1024.0 << " KB live" << std::endl;
+	std::cout << "[UIAllocBench] handoffs: " << BENCH_UI_ALLOC_HANDOFFS << " batches of " << BENCH_UI_ALLOC_LIVE
+		<< " blocks freed on another thread, heap allocations after warm up: " << handoffHeapAllocations << std::endl;
+	std::cout << "[UIAllocBench] validation: " << errors << " errors" << std::endl;
+}
+
+static uint64_t s_retentionAllocations = 0;
+
+struct DrawListRetentionRun
+{
+	uint64_t AllocationsAfterWarmUp = 0;
+	uint64_t MostAllocationsInAFrame = 0;
+	int Reallocs = 0;
+	size_t PeakCapacityBytes = 0;
+	size_t CapacityBytes = 0;
+	// Of the spiking window's vertex buffer, when the spikes stop and at the end
+	int SpikeVtxCapacity = 0;
+	int EndVtxCapacity = 0;
+	std::vector<ImGuiID> FrameHashes;
+};
+
+static void RunDrawListRetention(bool retain, DrawListRetentionRun& run)
+{
+	ImGui::SetAllocatorFunctions([](size_t size, void*) { s_retentionAllocations++; return malloc(size); }, [](void* ptr, void*) { free(ptr); });
+	ImGuiIO& io = CreateBenchContext(ImVec2(1280.0f, 720.0f), BenchTexFormat::Alpha8);
+	io.ConfigMemoryCompactTimer = BENCH_DL_RETAIN_COMPACT_TIMER;
+	io.ConfigDrawListRetainBuffers = retain;
+	io.ConfigDrawListShrinkDelay = BENCH_DL_RETAIN_SHRINK_DELAY;
+
+	ImVector<ImDrawListMemoryInfo> stats;
+	char name[32];
+	run.FrameHashes.resize(BENCH_DL_RETAIN_FRAMES);
+	for (int frame = 0; frame < BENCH_DL_RETAIN_FRAMES; frame++)
+	{
+		const uint64_t allocationsBefore = s_retentionAllocations;
+		const int second = frame / 60;
+		ImGui::NewFrame();
+		for (int i = 0; i < BENCH_DL_RETAIN_WINDOWS; i++)
+		{
+			if (second % (10 + 2 * i) >= 2)
+				continue;
+			snprintf(name, sizeof(name), "Window %d", i);
+			ImGui::SetNextWindowPos(ImVec2(20.0f + 150.0f * i, 20.0f));
+			ImGui::SetNextWindowSize(ImVec2(300.0f, 640.0f));
+			ImGui::Begin(name);
+			const bool spike = i == 0 && frame % (60 * 20) == 30 && frame < BENCH_DL_RETAIN_FRAMES / 2;
+			for (int line = 0; line < BENCH_DL_RETAIN_LINES; line++)
+			{
+				ImGui::Text("%d: item %d = %.3f", i, line, (frame + line) * 0.25f);
+				const ImVec2 min = ImGui::GetItemRectMin();
+				for (int rect = 0; rect < (spike ? BENCH_DL_RETAIN_SPIKE_RECTS : 1); rect++)
+					ImGui::GetWindowDrawList()->AddRectFilled(ImVec2(min.x + rect, min.y), ImVec2(min.x + rect + 4.0f, min.y + 4.0f), IM_COL32(255, 128, 0, 255));
+			}
+			ImGui::End();
+		}
+		ImGui::Render();
+
+		// What gets drawn must not depend on the policy
+		ImDrawData* drawData = ImGui::GetDrawData();
+		ImGuiID hash = 0;
+		for (int n = 0; n < drawData->CmdListsCount; n++)
+		{
+			const ImDrawList* list = drawData->CmdLists[n];
+			hash = ImHashData(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes(), hash);
+			hash = ImHashData(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes(), hash);
+			for (const ImDrawCmd& cmd : list->CmdBuffer)
+				hash = ImHashData(&cmd.ElemCount, sizeof(cmd.ElemCount), hash);
+		}
+		run.FrameHashes[frame] = hash;
+
+		const uint64_t allocations = s_retentionAllocations - allocationsBefore;
+		if (frame >= BENCH_DL_RETAIN_WARM_UP)
+		{
+			run.AllocationsAfterWarmUp += allocations;
+			run.MostAllocationsInAFrame = std::max(run.MostAllocationsInAFrame, allocations);
+		}
+		ImGui::GetDrawListMemoryStats(&stats);
+		size_t capacity = 0;
+		for (const ImDrawListMemoryInfo& info : stats)
+			capacity += info.CapacityBytes;
+		run.PeakCapacityBytes = std::max(run.PeakCapacityBytes, capacity);
+		if (frame == BENCH_DL_RETAIN_FRAMES / 2)
+			run.SpikeVtxCapacity = ImGui::FindWindowByName("Window 0")->DrawList->VtxBuffer.Capacity;
+	}
+
+	ImGui::GetDrawListMemoryStats(&stats);
+	for (const ImDrawListMemoryInfo& info : stats)
+	{
+		run.Reallocs += info.ReallocCount;
+		run.CapacityBytes += info.CapacityBytes;
+	}
+	run.EndVtxCapacity = ImGui::FindWindowByName("Window 0")->DrawList->VtxBuffer.Capacity;
+	ImGui::DestroyContext();
+	ImGui::SetAllocatorFunctions([](size_t size, void*) { return malloc(size); }, [](void* ptr, void*) { free(ptr); });
+}
+
+void RunDrawListRetentionBenchmark()
+{
+	DrawListRetentionRun runs[2];
+	for (int retain = 0; retain < 2; retain++)
+		RunDrawListRetention(retain != 0, runs[retain]);
+
+	uint32_t errors = 0;
+	for (int frame = 0; frame < BENCH_DL_RETAIN_FRAMES; frame++)
+		errors += runs[0].FrameHashes[frame] == runs[1].FrameHashes[frame] ? 0 : 1;
+	// Retained buffers don't regrow when windows reappear, and the spiking window gives its spike memory back once the
+	// spikes are more than a period behind it
+	errors += runs[1].AllocationsAfterWarmUp < runs[0].AllocationsAfterWarmUp && runs[1].Reallocs < runs[0].Reallocs ? 0 : 1;
+	errors += runs[1].EndVtxCapacity < runs[1].SpikeVtxCapacity ? 0 : 1;
+
+	std::cout << "[DrawListRetentionBench] " << BENCH_DL_RETAIN_WINDOWS << " windows reappearing over " << BENCH_DL_RETAIN_FRAMES / 60
+		<< " s, compacted after " << BENCH_DL_RETAIN_COMPACT_TIMER << " s, retention periods of " << BENCH_DL_RETAIN_SHRINK_DELAY << " s" << std::endl;
+	for (int retain = 0; retain < 2; retain++)
+	{
+		const DrawListRetentionRun& run = runs[retain];
+		std::cout << "[DrawListRetentionBench] " << (retain ? "retained: " : "compacted: ") << run.AllocationsAfterWarmUp
+			<< " allocations after warm up (at most " << run.MostAllocationsInAFrame << " in a frame), " << run.Reallocs
+			<< " draw list reallocations, " << run.PeakCapacityBytes / 1024.0 << " KB reserved at peak, " << run.CapacityBytes / 1024.0
+			<< " KB at the end, spiking window " << run.SpikeVtxCapacity << " -> " << run.EndVtxCapacity << " vertices" << std::endl;
+	}
+	std::cout << "[DrawListRetentionBench] validation: " << errors << " errors" << std::endl;
+}
+
+// Commands of a 32-bit list that can be drawn as one: same texture and clip rect, contiguous indices (VtxOffset doesn't matter anymore)
+static bool CanMergeIdx32Cmds(const ImDrawCmd& a, const ImDrawCmd& b)
+{
+	return a.UserCallback == nullptr && b.UserCallback == nullptr && a.TextureId == b.TextureId &&
+		memcmp(&a.ClipRect, &b.ClipRect, sizeof(ImVec4)) == 0 && a.IdxOffset + a.ElemCount == b.IdxOffset;
+}
+
+// Draw calls the DX12 backend makes for the draw data: one per command, or per run of mergeable commands in 32-bit lists
+static int CountIndexedDraws(const ImDrawData* drawData, const ImDrawIdxPacking* packing)
+{
+	int draws = 0;
+	for (int n = 0; n < drawData->CmdListsCount; n++)
+	{
+		const ImDrawList* list = drawData->CmdLists[n];
+		for (int i = 0; i < list->CmdBuffer.Size; i++)
+		{
+			if (list->CmdBuffer[i].UserCallback != nullptr)
+				continue;
+			if (packing != nullptr && packing->ListIdx32[n])
+				while (i + 1 < list->CmdBuffer.Size && CanMergeIdx32Cmds(list->CmdBuffer[i], list->CmdBuffer[i + 1]))
+					i++;
+			draws++;
+		}
+	}
+	return draws;
+}
+
+void RunLargeMeshBenchmark()
+{
+	ImGuiIO& io = CreateBenchContext(ImVec2(1920.0f, 1080.0f), BenchTexFormat::Alpha8);
+	ImGui::NewFrame();
+
+	// Scatter plots, each in its own clip rect, and a UI list that stays under 64K vertices
+	ImDrawList plots(ImGui::GetDrawListSharedData());
+	ImDrawList ui(ImGui::GetDrawListSharedData());
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	plots._ResetForNewFrame();
+	plots.PushTextureID(io.Fonts->TexID);
+	for (int plot = 0; plot < 2; plot++)
+	{
+		const float x0 = plot * 960.0f;
+		plots.PushClipRect(ImVec2(x0, 0.0f), ImVec2(x0 + 960.0f, 1080.0f));
+		for (int i = 0; i < BENCH_LARGE_MESH_POINTS / 2; i++)
+		{
+			const ImVec2 p(x0 + unit(rng) * 958.0f, unit(rng) * 1078.0f);
+			plots.AddRectFilled(p, ImVec2(p.x + 2.0f, p.y + 2.0f), IM_COL32(80, 160, 255, 255));
+		}
+		plots.PopClipRect();
+	}
+	ui._ResetForNewFrame();
+	ui.PushTextureID(io.Fonts->TexID);
+	for (int i = 0; i < BENCH_LARGE_MESH_UI_RECTS; i++)
+	{
+		if (i % 50 == 0)
+		{
+			if (i > 0)
+				ui.PopClipRect();
+			ui.PushClipRect(ImVec2(0.0f, (float)(i / 50)), ImVec2(1920.0f, 1080.0f));
+		}
+		const ImVec2 p((float)(i % 100) * 19.0f, (float)(i / 100) * 25.0f);
+		ui.AddRectFilled(p, ImVec2(p.x + 16.0f, p.y + 20.0f), IM_COL32(200, 200, 200, 255));
+	}
+	ui.PopClipRect();
+	ui._PopUnusedDrawCmd();
+	plots._PopUnusedDrawCmd();
+
+	ImDrawList* lists[] = { &ui, &plots };
+	ImDrawData drawData;
+	drawData.Valid = true;
+	drawData.CmdLists = lists;
+	drawData.CmdListsCount = IM_ARRAYSIZE(lists);
+	for (ImDrawList* list : lists)
+	{
+		drawData.TotalVtxCount += list->VtxBuffer.Size;
+		drawData.TotalIdxCount += list->IdxBuffer.Size;
+	}
+
+	// Index upload as it was (a copy of ImDrawIdx) against the per list 16/32-bit packing
+	const size_t nativeBytes = (size_t)drawData.TotalIdxCount * sizeof(ImDrawIdx);
+	std::vector<unsigned char> native(nativeBytes), packed(drawData.TotalIdxCount * sizeof(ImU32) + 4);
+	ImDrawIdxPacking packing;
+	double nativeSeconds = DBL_MAX, packSeconds = DBL_MAX;
+	for (int run = 0; run < BENCH_LARGE_MESH_RUNS; run++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		unsigned char* dst = native.data();
+		for (ImDrawList* list : lists)
+		{
+			memcpy(dst, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+			dst += list->IdxBuffer.size_in_bytes();
+		}
+		nativeSeconds = std::min(nativeSeconds, SecondsSince(start));
+
+		start = std::chrono::steady_clock::now();
+		drawData.PlanIndexUpload(&packing);
+		drawData.PackIndices(packing, packed.data());
+		packSeconds = std::min(packSeconds, SecondsSince(start));
+	}
+
+	// Every index must address the same vertex, with ImDrawCmd::VtxOffset added in
+	uint32_t errors = 0;
+	errors += packing.ListIdx32[0] == false && packing.ListIdx32[1] == true ? 0 : 1;
+	errors += packing.TotalBytes <= packed.size() ? 0 : 1;
+	const ImU16* packed16 = (const ImU16*)packed.data();
+	const ImU32* packed32 = (const ImU32*)(packed.data() + packing.Idx32ByteOffset);
+	for (int n = 0; n < drawData.CmdListsCount; n++)
+	{
+		const ImDrawList* list = lists[n];
+		for (const ImDrawCmd& cmd : list->CmdBuffer)
+			for (unsigned int k = cmd.IdxOffset; k < cmd.IdxOffset + cmd.ElemCount; k++)
+			{
+				const unsigned int expected = (unsigned int)list->IdxBuffer[k] + cmd.VtxOffset;
+				const unsigned int actual = packing.ListIdx32[n] ? packed32[packing.ListIdxOffset[n] + k] : packed16[packing.ListIdxOffset[n] + k];
+				errors += actual == expected ? 0 : 1;
+			}
+	}
+	// Each scatter plot is one draw, the UI list is drawn as before
+	const int nativeDraws = CountIndexedDraws(&drawData, nullptr);
+	const int packedDraws = CountIndexedDraws(&drawData, &packing);
+	errors += packedDraws == CountIndexedDraws(&drawData, nullptr) - plots.CmdBuffer.Size + 2 ? 0 : 1;
+
+	std::cout << "[LargeMeshBench] " << plots.VtxBuffer.Size << " + " << ui.VtxBuffer.Size << " vertices, " << drawData.TotalIdxCount
+		<< " indices, ImDrawIdx is " << sizeof(ImDrawIdx) * 8 << "-bit" << std::endl;
+	std::cout << "[LargeMeshBench] draw calls: " << nativeDraws << " as submitted (" << plots.CmdBuffer.Size << " for the plots), "
+		<< packedDraws << " with 16/32-bit indices per list" << std::endl;
+	std::cout << "[LargeMeshBench] index upload: " << nativeBytes / 1024.0 << " KB copied in " << nativeSeconds * 1e3 << " ms, "
+		<< packing.TotalBytes / 1024.0 << " KB packed in " << packSeconds * 1e3 << " ms (" << packing.Idx16Count << " 16-bit, "
+		<< packing.Idx32Count << " 32-bit)" << std::endl;
+	std::cout << "[LargeMeshBench] validation: " << errors << " errors" << std::endl;
+	ImGui::EndFrame();
+	ImGui::DestroyContext();
+}
+
+// A frame of windows whose contents are clipped in many different ways: a scrolling table, child windows, plots and
+// imgui's own demo and metrics windows, overlapping each other
+static void DrawMergeBenchmarkFrame(int frame)
+{
+	ImGui::SetNextWindowPos(ImVec2(20.0f, 20.0f), ImGuiCond_Once);
+	ImGui::SetNextWindowSize(ImVec2(560.0f, 420.0f), ImGuiCond_Once);
+	ImGui::Begin("Table");
+	if (ImGui::BeginTable("rows", 5, ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_Borders | ImGuiTableFlags_Resizable))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Name");
+		ImGui::TableSetupColumn("Size");
+		ImGui::TableSetupColumn("Type");
+		ImGui::TableSetupColumn("Modified");
+		ImGui::TableSetupColumn("Progress");
+		ImGui::TableHeadersRow();
+		ImGuiListClipper clipper;
+		clipper.Begin(BENCH_DRAW_MERGE_TABLE_ROWS);
+		while (clipper.Step())
+			for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; row++)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn();
+				ImGui::Text("asset_%04d.dds", row);
+				ImGui::TableNextColumn();
+				ImGui::Text("%d KB", (row * 37) % 4096);
+				ImGui::TableNextColumn();
+				ImGui::TextUnformatted(row % 3 == 0 ? "Texture" : row % 3 == 1 ? "Mesh" : "Material");
+				ImGui::TableNextColumn();
+				ImGui::Text("2026-10-%02d", 1 + row % 28);
+				ImGui::TableNextColumn();
+				ImGui::ProgressBar((float)((row * 13 + frame) % 100) / 100.0f, ImVec2(-1.0f, 0.0f));
+			}
+		ImGui::SetScrollY((float)(frame * 7 % 2000));
+		ImGui::EndTable();
+	}
+	ImGui::End();
+
+	ImGui::SetNextWindowPos(ImVec2(460.0f, 120.0f), ImGuiCond_Once);
+	ImGui::SetNextWindowSize(ImVec2(520.0f, 380.0f), ImGuiCond_Once);
+	ImGui::Begin("Children");
+	for (int child = 0; child < 4; child++)
+	{
+		char name[16];
+		snprintf(name, sizeof(name), "child%d", child);
+		ImGui::BeginChild(name, ImVec2(240.0f, 160.0f), true);
+		for (int line = 0; line < 12; line++)
+		{
+			ImGui::Text("Item %d.%d", child, line);
+			ImGui::SameLine();
+			ImGui::SmallButton("Edit");
+		}
+		ImGui::SetScrollY((float)((frame + child * 20) % 120));
+		ImGui::EndChild();
+		if (child % 2 == 0)
+			ImGui::SameLine();
+	}
+	ImGui::End();
+
+	ImGui::SetNextWindowPos(ImVec2(700.0f, 380.0f), ImGuiCond_Once);
+	ImGui::SetNextWindowSize(ImVec2(540.0f, 300.0f), ImGuiCond_Once);
+	ImGui::Begin("Plots");
+	float values[90];
+	for (int i = 0; i < IM_ARRAYSIZE(values); i++)
+		values[i] = sinf((i + frame) * 0.2f) * 0.5f + 0.5f;
+	ImGui::PlotLines("Lines", values, IM_ARRAYSIZE(values), 0, nullptr, 0.0f, 1.0f, ImVec2(0.0f, 80.0f));
+	ImGui::PlotHistogram("Histogram", values, IM_ARRAYSIZE(values), 0, nullptr, 0.0f, 1.0f, ImVec2(0.0f, 80.0f));
+	ImGui::End();
+
+	ImGui::SetNextWindowPos(ImVec2(40.0f, 300.0f), ImGuiCond_Once);
+	ImGui::ShowDemoWindow();
+	ImGui::SetNextWindowPos(ImVec2(900.0f, 40.0f), ImGuiCond_Once);
+	ImGui::ShowMetricsWindow();
+}
+
+void RunDrawMergeBenchmark(const char* capturePath)
+{
+	ImGuiIO& io = CreateBenchContext(ImVec2((float)BENCH_DRAW_MERGE_WIDTH, (float)BENCH_DRAW_MERGE_HEIGHT), BenchTexFormat::RGBA32);
+	unsigned char* pixels = nullptr;
+	int width = 0, height = 0;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	DrawDataPlayer player;
+	if (capturePath != nullptr && !player.Open(capturePath))
+	{
+		std::cout << "[DrawMergeBench] Unable to read " << capturePath << std::endl;
+		ImGui::DestroyContext();
+		return;
+	}
+
+	SoftwareRasterizer rasterizer;
+	rasterizer.RegisterTexture(io.Fonts->TexID, pixels, width, height, 4);
+	const float clearColor[4] = { 0.1f, 0.1f, 0.1f, 1.0f };
+	std::vector<uint32_t> pixelsAsSubmitted, pixelsMerged;
+
+	ImDrawSubmission asSubmitted, merged, mergedByBounds;
+	ImDrawList mergedList(ImGui::GetDrawListSharedData());
+	std::vector<unsigned char> packed;
+	std::vector<int> expected;
+	uint64_t cmds = 0, callbacks = 0, culled = 0, draws = 0, mergedDraws = 0, boundsDraws = 0, acrossLists = 0, pixelFrames = 0;
+	uint64_t scissors = 0, textures = 0, mergedScissors = 0, mergedTextures = 0;
+	double asSubmittedSeconds = 0.0, mergedSeconds = 0.0, boundsSeconds = 0.0;
+	uint32_t errors = 0;
+	for (int frame = 0; frame < BENCH_DRAW_MERGE_FRAMES; frame++)
+	{
+		ImDrawData* drawData = nullptr;
+		if (capturePath != nullptr)
+		{
+			const DX12Playground::UIFrame* captured = player.NextFrame();
+			if (captured == nullptr)
+			{
+				std::cout << "[DrawMergeBench] " << capturePath << " is broken" << std::endl;
+				errors++;
+				break;
+			}
+			drawData = captured->DrawData;
+		}
+		else
+		{
+			ImGui::NewFrame();
+			DrawMergeBenchmarkFrame(frame);
+			ImGui::Render();
+			drawData = ImGui::GetDrawData();
+		}
+
+		double asSubmittedBest = DBL_MAX, mergedBest = DBL_MAX, boundsBest = DBL_MAX;
+		for (int run = 0; run < BENCH_DRAW_MERGE_RUNS; run++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			asSubmitted.Build(drawData, false);
+			asSubmittedBest = std::min(asSubmittedBest, SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			merged.Build(drawData);
+			mergedBest = std::min(mergedBest, SecondsSince(start));
+			start = std::chrono::steady_clock::now();
+			mergedByBounds.Build(drawData, true, true);
+			boundsBest = std::min(boundsBest, SecondsSince(start));
+		}
+		asSubmittedSeconds += asSubmittedBest;
+		mergedSeconds += mergedBest;
+		boundsSeconds += boundsBest;
+		cmds += merged.Stats.Cmds;
+		callbacks += merged.Stats.Callbacks;
+		culled += merged.Stats.Culled;
+		draws += asSubmitted.Stats.Draws;
+		mergedDraws += merged.Stats.Draws;
+		boundsDraws += mergedByBounds.Stats.Draws;
+		acrossLists += merged.Stats.MergedAcrossLists;
+		scissors += asSubmitted.Stats.ScissorChanges;
+		textures += asSubmitted.Stats.TextureChanges;
+		mergedScissors += merged.Stats.ScissorChanges;
+		mergedTextures += merged.Stats.TextureChanges;
+
+		// The merged draws must go through the same vertices, in the same order, as the commands drawn one by one
+		std::vector<int> listVtxStart(drawData->CmdListsCount + 1, 0);
+		for (int n = 0; n < drawData->CmdListsCount; n++)
+			listVtxStart[n + 1] = listVtxStart[n] + drawData->CmdLists[n]->VtxBuffer.Size;
+		expected.clear();
+		for (const ImDrawSubmitCmd& draw : asSubmitted.Cmds)
+		{
+			if (draw.Cmd->UserCallback != nullptr)
+			{
+				expected.push_back(-1);
+				continue;
+			}
+			const int listIndex = (int)(std::find(drawData->CmdLists, drawData->CmdLists + drawData->CmdListsCount, draw.CmdList) - drawData->CmdLists);
+			for (unsigned int k = 0; k < draw.ElemCount; k++)
+				expected.push_back(listVtxStart[listIndex] + (int)draw.Cmd->VtxOffset + (int)draw.CmdList->IdxBuffer[draw.Cmd->IdxOffset + k]);
+		}
+		pixelsAsSubmitted.clear();
+		for (const ImDrawSubmission* submission : { &merged, &mergedByBounds })
+		{
+			packed.assign(submission->Packing.TotalBytes, 0);
+			drawData->PackIndices(submission->Packing, packed.data());
+			const ImU16* packed16 = (const ImU16*)packed.data();
+			const ImU32* packed32 = (const ImU32*)(packed.data() + submission->Packing.Idx32ByteOffset);
+			size_t next = 0;
+			bool hasIdx32 = false;
+			for (const ImDrawSubmitCmd& draw : submission->Cmds)
+			{
+				if (draw.Cmd->UserCallback != nullptr)
+				{
+					errors += next < expected.size() && expected[next] == -1 ? 0 : 1;
+					next++;
+					continue;
+				}
+				hasIdx32 |= draw.Idx32;
+				for (unsigned int k = 0; k < draw.ElemCount; k++, next++)
+				{
+					const int vertex = draw.VtxOffset + (int)(draw.Idx32 ? packed32[draw.IdxOffset + k] : packed16[draw.IdxOffset + k]);
+					errors += next < expected.size() && expected[next] == vertex ? 0 : 1;
+				}
+			}
+			errors += next == expected.size() ? 0 : 1;
+
+			// And put the same pixels on screen: the merged draws as a draw list of all vertices and packed indices, clipped
+			// by their scissor rects. 32-bit draws only fit in a 32-bit ImDrawIdx.
+			if (hasIdx32 && sizeof(ImDrawIdx) == sizeof(ImU16))
+				continue;
+			mergedList._ResetForNewFrame();
+			mergedList.CmdBuffer.resize(0);
+			for (int n = 0; n < drawData->CmdListsCount; n++)
+				for (const ImDrawVert& vertex : drawData->CmdLists[n]->VtxBuffer)
+					mergedList.VtxBuffer.push_back(vertex);
+			for (int i = 0; i < submission->Packing.Idx16Count; i++)
+				mergedList.IdxBuffer.push_back((ImDrawIdx)packed16[i]);
+			for (int i = 0; i < submission->Packing.Idx32Count; i++)
+				mergedList.IdxBuffer.push_back((ImDrawIdx)packed32[i]);
+			const ImVec2 scale = drawData->FramebufferScale, offset = drawData->DisplayPos;
+			for (const ImDrawSubmitCmd& draw : submission->Cmds)
+			{
+				if (draw.Cmd->UserCallback != nullptr)
+					continue;
+				ImDrawCmd cmd;
+				cmd.ClipRect = ImVec4(draw.ClipRect[0] / scale.x + offset.x, draw.ClipRect[1] / scale.y + offset.y,
+					draw.ClipRect[2] / scale.x + offset.x, draw.ClipRect[3] / scale.y + offset.y);
+				cmd.TextureId = draw.TextureId;
+				cmd.VtxOffset = (unsigned int)draw.VtxOffset;
+				cmd.IdxOffset = draw.IdxOffset + (draw.Idx32 ? (unsigned int)submission->Packing.Idx16Count : 0);
+				cmd.ElemCount = draw.ElemCount;
+				mergedList.CmdBuffer.push_back(cmd);
+			}
+			ImDrawList* mergedLists[] = { &mergedList };
+			ImDrawData mergedData = *drawData;
+			mergedData.CmdLists = mergedLists;
+			mergedData.CmdListsCount = 1;
+
+			const int fbWidth = (int)(drawData->DisplaySize.x * scale.x), fbHeight = (int)(drawData->DisplaySize.y * scale.y);
+			SoftwareFramebuffer framebuffer;
+			framebuffer.Width = framebuffer.Stride = fbWidth;
+			framebuffer.Height = fbHeight;
+			if (pixelsAsSubmitted.empty())
+			{
+				pixelsAsSubmitted.assign((size_t)fbWidth * fbHeight, 0);
+				framebuffer.Pixels = pixelsAsSubmitted.data();
+				rasterizer.Clear(framebuffer, clearColor);
+				rasterizer.RenderDrawData(drawData, framebuffer);
+			}
+			pixelsMerged.assign((size_t)fbWidth * fbHeight, 0);
+			framebuffer.Pixels = pixelsMerged.data();
+			rasterizer.Clear(framebuffer, clearColor);
+			rasterizer.RenderDrawData(&mergedData, framebuffer);
+			for (size_t i = 0; i < pixelsMerged.size(); i++)
+				errors += pixelsMerged[i] == pixelsAsSubmitted[i] ? 0 : 1;
+			pixelFrames += submission == &merged ? 1 : 0;
+		}
+	}
+
+	const double frames = BENCH_DRAW_MERGE_FRAMES;
+	std::cout << "[DrawMergeBench] " << BENCH_DRAW_MERGE_FRAMES << " frames " << (capturePath != nullptr ? "from " : "of imgui windows")
+		<< (capturePath != nullptr ? capturePath : "") << ": " << cmds / frames << " commands per frame (" << callbacks / frames
+		<< " callbacks, " << culled / frames << " culled)" << std::endl;
+	std::cout << "[DrawMergeBench] draw calls per frame: " << draws / frames << " as submitted, " << mergedDraws / frames << " merged ("
+		<< 100.0 * (1.0 - (double)mergedDraws / (draws > 0 ? draws : 1)) << "% fewer, " << acrossLists / frames << " across draw lists), "
+		<< boundsDraws / frames << " also merged by bounds" << std::endl;
+	std::cout << "[DrawMergeBench] state changes per frame: " << scissors / frames << " -> " << mergedScissors / frames << " scissor rects, "
+		<< textures / frames << " -> " << mergedTextures / frames << " textures (" << draws / frames << " each when set for every draw)" << std::endl;
+	std::cout << "[DrawMergeBench] build: " << asSubmittedSeconds / frames * 1e6 << " us per frame as submitted, " << mergedSeconds / frames * 1e6
+		<< " us merged, " << boundsSeconds / frames * 1e6 << " us also merged by bounds, " << pixelFrames << " frames compared pixel for pixel"
+		<< std::endl;
+	std::cout << "[DrawMergeBench] validation: " << errors << " errors" << std::endl;
+	ImGui::DestroyContext();
+}
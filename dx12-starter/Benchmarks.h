@@ -0,0 +1,96 @@
+#pragma once
+#include <cstdint>
+
+// Microbenchmarks run from the command line (see main.cpp). They print their results to stdout.
+
+// Spawn, steal and fork/join throughput of the JobSystem. `numThreads` of 0 uses every hardware thread.
+void RunJobSystemBenchmark(uint32_t numThreads);
+
+// Persistent/transient churn on the device independent descriptor allocator: alloc/free rate, growth and
+// fragmentation after many frames of random sizes with deferred frees.
+void RunDescriptorAllocatorBenchmark();
+
+// Random frames of upload ring allocations, a third of them empty, retired by a GPU that lags a random number of frames.
+// Checks that no allocation overlaps a frame that isn't retired yet, and that everything is given back at the end.
+void RunUploadRingBenchmark();
+
+// Builds random render graphs of 1k+ passes, times building and compiling them and checks the compiled barriers and
+// transient placement by executing the graph against a command list that tracks resource states.
+void RunRenderGraphBenchmark();
+
+// Runs the FramePacer against a simulated clock and a 60 Hz display with a swap chain queue, for every frame latency
+// with and without just in time input sampling, and reports input to display latency and missed refreshes.
+void RunFramePacingBenchmark();
+
+// Cost of a profiler zone, and a reader collecting events while another thread keeps lapping its ring, checking that
+// no torn or overwritten event gets through.
+void RunProfilerBenchmark();
+
+// GPU timestamp bookkeeping against the null queue's synthetic clock, with the GPU completing frames a random number
+// of frames late: every frame has to be read back in order, only once its fence completed, with exact durations.
+void RunGpuTimingBenchmark();
+
+// Records frames of 100 to 20000 scene items through CommandListPool::RecordParallel() on the null device, on one thread
+// and split across `recordThreads` (0 for every job system thread). Checks the number of lists per frame, that every
+// item was recorded once, and from the GPU timestamps that the items ran in order.
+void RunRecordBenchmark(uint32_t numThreads, uint32_t recordThreads);
+
+// Anti-aliased polyline tessellation in imgui on plot sized lines, scalar against SIMD paths: vertices per second for
+// each, and a byte for byte comparison of their vertex and index output.
+void RunTessellationBenchmark();
+
+// Bakes a font at eight sizes (imgui's default font, or `fontPath` with every CJK glyph it has) with ImFontAtlas::Build()
+// and with FontAtlasCache's parallel build, then saves and maps the cache: times each, and checks that all three atlases
+// are identical and that a changed font config misses the cache.
+void RunFontAtlasBenchmark(uint32_t numThreads, const char* fontPath);
+
+// Bakes the ASCII glyphs of a font (imgui's default font, or `fontPath`) and draws a window of its other glyphs sliding
+// over all of them through a GlyphCache, with the occasional frame that needs more glyphs than the pages hold. Times
+// the frames, and checks every glyph's metrics and pixels against an atlas with all of them baked, and the texture that
+// only sees the uploads against the atlas.
+void RunGlyphCacheBenchmark(const char* fontPath, float size);
+
+// Builds a distance field atlas of a font (imgui's default font, or `fontPath`) serially and on the job system, and
+// compares it with plain atlases of every size it replaces. Checks that both builds are identical, and that each glyph's
+// field agrees with a plain rasterization of the same size on which pixels are inside the outline.
+void RunDistanceFieldFontBenchmark(uint32_t numThreads, const char* fontPath);
+
+// Measures and draws a log of short lines, most of them the same from frame to frame, with and without imgui's text
+// layout cache (ImTextLayoutCache). Times both, and checks that the sizes and the draw output are identical.
+void RunTextLayoutCacheBenchmark(const char* fontPath, float size);
+
+// Decodes, measures and draws about 4 MB of log lines, all ASCII and then mixed with CJK words and malformed UTF-8, with
+// imgui's text functions and with the one character at a time loops they replace. Checks that the decoded characters,
+// the sizes, the cut off points of width limited measures and the glyph quads are the same.
+void RunTextDecodeBenchmark(const char* fontPath, float size);
+
+// ImHashStr()/ImHashData() on the IDs of a large UI frame (window names, pushed indices and pointers, widget labels
+// with "##" and "###") and on a 1 MB buffer, against imgui's original byte at a time CRC32. Checks that every hash is
+// the same, so IDs and the table IDs stored in .ini files don't change.
+void RunHashBenchmark();
+
+// Inserts and looks up 10^3 to 10^6 IDs in imgui's sorted ImGuiStorage and in the open addressing ImGuiHashStorage, then
+// rebuilds a sorted storage from the hashed one for ordered iteration. Checks that both storages return the same values,
+// that misses return the default, and that the rebuilt storage is the same as the sorted one.
+void RunStorageBenchmark();
+
+// Grows and frees vectors through imgui's allocator the way its buffers churn, on `numThreads` threads with malloc() and
+// with UIAllocator's pools, then frame by frame in the pools and in the frame arena. Checks that contents come out the
+// same, that nothing is left live, and that no frame after the first goes to the heap.
+void RunUIAllocatorBenchmark(uint32_t numThreads);
+
+// Runs 15 simulated minutes of windows that come and go, one of them with occasional spikes of content, with imgui
+// compacting hidden windows' draw lists and with io.ConfigDrawListRetainBuffers. Checks that both draw the same, that
+// retaining takes fewer allocations and draw list reallocations, and that the spike memory is given back afterwards.
+void RunDrawListRetentionBenchmark();
+
+// Uploads the indices of a million vertex scatter plot and a regular UI draw list as they are, and packed with 16-bit or
+// 32-bit indices per list (ImDrawData::PackIndices()). Checks that every packed index addresses the same vertex, and that
+// the plots draw in one call each instead of one per 64K vertices.
+void RunLargeMeshBenchmark();
+
+// Builds the draw calls of 120 frames of overlapping imgui windows (or of a capture made with --capture) as submitted,
+// with adjacent commands of the same scissor rect merged (ImDrawSubmission), and also merged by vertex bounds. Checks
+// that the merged draws go through the same vertices in the same order, and that the software rasterizer puts the same
+// pixels on screen.
+void RunDrawMergeBenchmark(const char* capturePath);
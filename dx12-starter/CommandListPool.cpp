@@ -0,0 +1,102 @@
+#include "CommandListPool.h"
+#include "imgui.h"
+#include <algorithm>
+
+bool CommandListPool::Init(GraphicsDevice* device, uint32_t numFramesInFlight, JobSystem* jobs, uint32_t numThreads)
+{
+	m_device = device;
+	m_jobs = jobs;
+	m_numFramesInFlight = numFramesInFlight;
+	m_allocators.assign((size_t)numFramesInFlight * MAX_LISTS_PER_FRAME, nullptr);
+	m_listsUsed.assign(numFramesInFlight, 0);
+
+	if (numThreads == 0)
+		numThreads = m_jobs->GetThreadCount();
+	m_threadCount = std::min(std::max(numThreads, 1u), (uint32_t)MAX_RECORD_THREADS);
+	return true;
+}
+
+void CommandListPool::Shutdown()
+{
+	for (int i = 0; i < MAX_LISTS_PER_FRAME; i++)
+		if (m_lists[i]) { delete m_lists[i]; m_lists[i] = nullptr; }
+	for (CommandAllocator*& allocator : m_allocators)
+		if (allocator) { delete allocator; allocator = nullptr; }
+	m_allocators.clear();
+	m_listsUsed.clear();
+	m_openCount = 0;
+}
+
+void CommandListPool::BeginFrame(uint32_t frameIndex)
+{
+	IM_ASSERT(m_openCount == 0 && "Previous frame was never submitted");
+	m_frameSlot = frameIndex % m_numFramesInFlight;
+
+	CommandAllocator** allocators = &m_allocators[(size_t)m_frameSlot * MAX_LISTS_PER_FRAME];
+	for (uint32_t i = 0; i < m_listsUsed[m_frameSlot]; i++)
+		allocators[i]->Reset();
+	m_listsUsed[m_frameSlot] = 0;
+}
+
+CommandList* CommandListPool::OpenCommandList()
+{
+	IM_ASSERT(m_openCount < MAX_LISTS_PER_FRAME && "Too many command lists in one frame");
+	uint32_t slot = m_openCount++;
+
+	CommandAllocator*& allocator = m_allocators[(size_t)m_frameSlot * MAX_LISTS_PER_FRAME + slot];
+	if (allocator == nullptr)
+		allocator = m_device->CreateCommandAllocator();
+	// Lists can be reset as soon as they were submitted, only allocators have to wait for the GPU
+	if (m_lists[slot] == nullptr)
+		m_lists[slot] = m_device->CreateCommandList(allocator);
+
+	CommandList* commandList = m_lists[slot];
+	commandList->Reset(allocator);
+	m_openLists[slot] = commandList;
+	m_listsUsed[m_frameSlot] = m_openCount;
+	return commandList;
+}
+
+void CommandListPool::RecordParallel(uint32_t count, uint32_t minItemsPerList, const RecordRangeFunc& record)
+{
+	if (count == 0)
+		return;
+
+	// Fixed split that only depends on the item count, so the same item always lands in the same list
+	uint32_t rangeCount = GetThreadCount();
+	if (minItemsPerList > 0)
+		rangeCount = std::min(rangeCount, (count + minItemsPerList - 1) / minItemsPerList);
+	rangeCount = std::min(rangeCount, (uint32_t)MAX_LISTS_PER_FRAME - m_openCount);
+	rangeCount = std::max(rangeCount, 1u);
+
+	// Lists are opened here on the calling thread, creating them is not thread safe
+	for (uint32_t i = 0; i < rangeCount; i++)
+	{
+		m_ranges[i].List = OpenCommandList();
+		m_ranges[i].Begin = (uint32_t)((uint64_t)count * i / rangeCount);
+		m_ranges[i].End = (uint32_t)((uint64_t)count * (i + 1) / rangeCount);
+	}
+	JobCounter counter;
+	for (uint32_t i = 0; i < rangeCount; i++)
+	{
+		const Range* range = &m_ranges[i];
+		m_jobs->Run([&record, range]() { record(range->List, range->Begin, range->End); }, &counter);
+	}
+	m_jobs->Wait(&counter);
+
+	m_stats.ParallelBatches++;
+	m_stats.ItemsRecorded += count;
+}
+
+void CommandListPool::Submit(CommandQueue* queue)
+{
+	if (m_openCount == 0)
+		return;
+	for (uint32_t i = 0; i < m_openCount; i++)
+		m_openLists[i]->Close();
+	queue->ExecuteCommandLists(m_openCount, m_openLists);
+
+	m_stats.Frames++;
+	m_stats.ListsSubmitted += m_openCount;
+	m_openCount = 0;
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include "JobSystem.h"
+#include <functional>
+#include <vector>
+
+struct CommandListPoolStats
+{
+	uint64_t Frames = 0;
+	uint64_t ListsSubmitted = 0;
+	uint64_t ParallelBatches = 0;
+	uint64_t ItemsRecorded = 0;
+};
+
+/// <summary>
+/// Command lists for multithreaded recording. Every list slot owns one allocator per frame in flight and a list is only
+/// ever recorded by one thread at a time, so threads never share an allocator and a frame's allocators are only reset
+/// once the caller has waited for that frame's fence. Lists are submitted in the order they were opened, in a single
+/// ExecuteCommandLists call, so the GPU sees the same command stream no matter how the threads got scheduled.
+/// </summary>
+class CommandListPool
+{
+public:
+	static int const MAX_RECORD_THREADS = 8;
+	// DX12CommandQueue submits at most 16 lists per call
+	static int const MAX_LISTS_PER_FRAME = 16;
+
+	// Records items [begin, end) into `commandList`.
+	typedef std::function<void(CommandList* commandList, uint32_t begin, uint32_t end)> RecordRangeFunc;
+
+	// Lists are recorded as jobs on `jobs`. `numThreads` caps how many lists one parallel batch is split into,
+	// 0 for one per job system thread, up to MAX_RECORD_THREADS.
+	bool Init(GraphicsDevice* device, uint32_t numFramesInFlight, JobSystem* jobs, uint32_t numThreads = 0);
+	void Shutdown();
+
+	// Starts recording frame `frameIndex` and resets the allocators used by the last frame in the same slot.
+	void BeginFrame(uint32_t frameIndex);
+	// Opens the next list in submission order, to be recorded on the calling thread.
+	CommandList* OpenCommandList();
+	// Splits `count` items into contiguous ranges, at most one per thread and no smaller than `minItemsPerList`,
+	// and records every range into its own list in parallel. The lists are appended in range order.
+	void RecordParallel(uint32_t count, uint32_t minItemsPerList, const RecordRangeFunc& record);
+	// Closes every list opened this frame and submits them in order in one batch.
+	void Submit(CommandQueue* queue);
+
+	uint32_t GetThreadCount() const { return m_threadCount; }
+	const CommandListPoolStats& GetStats() const { return m_stats; }
+
+private:
+	struct Range
+	{
+		CommandList* List;
+		uint32_t Begin;
+		uint32_t End;
+	};
+
+	GraphicsDevice* m_device = nullptr;
+	JobSystem* m_jobs = nullptr;
+	uint32_t m_threadCount = 1;
+	uint32_t m_numFramesInFlight = 0;
+	// Indexed [frame * MAX_LISTS_PER_FRAME + slot], created on first use
+	std::vector<CommandAllocator*> m_allocators;
+	std::vector<uint32_t> m_listsUsed;
+	CommandList* m_lists[MAX_LISTS_PER_FRAME] = {};
+	CommandList* m_openLists[MAX_LISTS_PER_FRAME] = {};
+	uint32_t m_openCount = 0;
+	uint32_t m_frameSlot = 0;
+	// Current parallel batch. Range i always records into list i, whichever thread picks it up.
+	Range m_ranges[MAX_RECORD_THREADS] = {};
+
+	CommandListPoolStats m_stats;
+};
@@ -0,0 +1,140 @@
+#include "DX12DescriptorHeap.h"
+#include "imgui.h"
+
+bool DX12DescriptorHeap::Init(ID3D12Device* device, uint32_t initialPersistent, uint32_t maxPersistent, uint32_t transientCapacity)
+{
+	m_device = device;
+	m_descriptorSize = m_device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+	m_allocator.Init(initialPersistent, maxPersistent, transientCapacity);
+
+	m_shaderVisibleHeap = CreateHeap(m_allocator.GetHeapSize(), true);
+	if (m_shaderVisibleHeap == NULL)
+		return false;
+	m_transientStaging = CreateHeap(transientCapacity, false);
+	if (m_transientStaging == NULL)
+		return false;
+	return ResizePersistentStaging(initialPersistent);
+}
+
+void DX12DescriptorHeap::Shutdown()
+{
+	if (m_shaderVisibleHeap) { m_shaderVisibleHeap->Release(); m_shaderVisibleHeap = NULL; }
+	if (m_persistentStaging) { m_persistentStaging->Release(); m_persistentStaging = NULL; }
+	if (m_transientStaging) { m_transientStaging->Release(); m_transientStaging = NULL; }
+	m_persistentStagingSize = 0;
+}
+
+ID3D12DescriptorHeap* DX12DescriptorHeap::CreateHeap(uint32_t size, bool shaderVisible)
+{
+	D3D12_DESCRIPTOR_HEAP_DESC desc = {};
+	desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+	desc.NumDescriptors = size;
+	desc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+	ID3D12DescriptorHeap* heap = NULL;
+	if (m_device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&heap)) != S_OK)
+		return NULL;
+	return heap;
+}
+
+bool DX12DescriptorHeap::ResizePersistentStaging(uint32_t capacity)
+{
+	if (capacity <= m_persistentStagingSize)
+		return true;
+	ID3D12DescriptorHeap* heap = CreateHeap(capacity, false);
+	if (heap == NULL)
+		return false;
+
+	// Staging heaps are CPU only, so they can be copied from and released right away
+	if (m_persistentStaging)
+	{
+		m_device->CopyDescriptorsSimple(m_persistentStagingSize, heap->GetCPUDescriptorHandleForHeapStart(),
+			m_persistentStaging->GetCPUDescriptorHandleForHeapStart(), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+		m_persistentStaging->Release();
+	}
+	m_persistentStaging = heap;
+	m_persistentStagingSize = capacity;
+	return true;
+}
+
+bool DX12DescriptorHeap::AllocatePersistent(uint32_t count, DescriptorRange& range)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (!m_allocator.AllocatePersistent(count, range))
+		return false;
+	if (!ResizePersistentStaging(m_allocator.GetPersistentCapacity()))
+	{
+		// Out of memory for the staging copy, hand the range back
+		m_allocator.FreePersistent(range);
+		range = DescriptorRange();
+		return false;
+	}
+	return true;
+}
+
+void DX12DescriptorHeap::FreePersistent(const DescriptorRange& range)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_allocator.FreePersistent(range);
+}
+
+bool DX12DescriptorHeap::AllocateTransient(uint32_t count, DescriptorRange& range)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_allocator.AllocateTransient(count, range);
+}
+
+void DX12DescriptorHeap::Commit(const DescriptorRange& range)
+{
+	if (!range.IsValid())
+		return;
+	m_device->CopyDescriptorsSimple(range.Count, GetShaderVisibleCpuHandle(range.Offset), GetStagingHandle(range.Offset), D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DX12DescriptorHeap::GetStagingHandle(uint32_t index)
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE handle;
+	if (index >= m_allocator.GetTransientBase())
+	{
+		handle = m_transientStaging->GetCPUDescriptorHandleForHeapStart();
+		index -= m_allocator.GetTransientBase();
+	}
+	else
+	{
+		IM_ASSERT(index < m_persistentStagingSize);
+		handle = m_persistentStaging->GetCPUDescriptorHandleForHeapStart();
+	}
+	handle.ptr += (SIZE_T)index * m_descriptorSize;
+	return handle;
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DX12DescriptorHeap::GetShaderVisibleCpuHandle(uint32_t index) const
+{
+	D3D12_CPU_DESCRIPTOR_HANDLE handle = m_shaderVisibleHeap->GetCPUDescriptorHandleForHeapStart();
+	handle.ptr += (SIZE_T)index * m_descriptorSize;
+	return handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DX12DescriptorHeap::GetGpuHandle(uint32_t index) const
+{
+	D3D12_GPU_DESCRIPTOR_HANDLE handle = m_shaderVisibleHeap->GetGPUDescriptorHandleForHeapStart();
+	handle.ptr += (UINT64)index * m_descriptorSize;
+	return handle;
+}
+
+void DX12DescriptorHeap::FinishFrame(uint64_t fenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_allocator.FinishFrame(fenceValue);
+}
+
+void DX12DescriptorHeap::Retire(uint64_t completedFenceValue)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_allocator.Retire(completedFenceValue);
+}
+
+DescriptorAllocatorStats DX12DescriptorHeap::GetStats()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_allocator.GetStats();
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "DescriptorAllocator.h"
+#include <d3d12.h>
+#include <mutex>
+
+/// <summary>
+/// Shader visible CBV/SRV/UAV heap plus the CPU-only staging heaps descriptors are written to first.
+/// Descriptors are created in staging (shader visible heaps are write-combined and slow to read back), then copied
+/// over with Commit(). The shader visible heap is created once at its full size so it never has to be rebound and
+/// GPU handles already baked into ImTextureIDs or recorded command lists stay valid. Only the persistent staging
+/// heap grows, together with the used part of the persistent region.
+/// </summary>
+class DX12DescriptorHeap
+{
+public:
+	bool Init(ID3D12Device* device, uint32_t initialPersistent, uint32_t maxPersistent, uint32_t transientCapacity);
+	void Shutdown();
+
+	// Write the descriptors at GetStagingHandle(range.Offset + i), then Commit(range). Growing moves the persistent
+	// staging heap, so don't hold on to staging handles across allocations.
+	bool AllocatePersistent(uint32_t count, DescriptorRange& range);
+	void FreePersistent(const DescriptorRange& range);
+	// Valid until the frame being recorded has retired.
+	bool AllocateTransient(uint32_t count, DescriptorRange& range);
+	// Copies the range from staging into the shader visible heap.
+	void Commit(const DescriptorRange& range);
+
+	D3D12_CPU_DESCRIPTOR_HANDLE GetStagingHandle(uint32_t index);
+	D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index) const;
+	// For code that insists on writing descriptors itself. Writing is fine, reading back is slow.
+	D3D12_CPU_DESCRIPTOR_HANDLE GetShaderVisibleCpuHandle(uint32_t index) const;
+	ID3D12DescriptorHeap* GetShaderVisibleHeap() const { return m_shaderVisibleHeap; }
+
+	void FinishFrame(uint64_t fenceValue);
+	void Retire(uint64_t completedFenceValue);
+	DescriptorAllocatorStats GetStats();
+
+private:
+	ID3D12DescriptorHeap* CreateHeap(uint32_t size, bool shaderVisible);
+	bool ResizePersistentStaging(uint32_t capacity);
+
+	ID3D12Device* m_device = nullptr;
+	ID3D12DescriptorHeap* m_shaderVisibleHeap = NULL;
+	ID3D12DescriptorHeap* m_persistentStaging = NULL;
+	ID3D12DescriptorHeap* m_transientStaging = NULL;
+	uint32_t m_persistentStagingSize = 0;
+	uint32_t m_descriptorSize = 0;
+	DescriptorAllocator m_allocator;
+	std::mutex m_mutex;
+};
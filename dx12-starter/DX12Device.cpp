@@ -0,0 +1,609 @@
+#include "DX12Device.h"
+#include "UploadRingBuffer.h"
+#include "imgui.h"
+#include "imgui_impl_dx12.h"
+#include <cstring>
+
+static D3D12_RESOURCE_STATES ToD3D12State(ResourceState state)
+{
+	// Combined read states map to the OR of their D3D12 states, which D3D12 accepts as well
+	D3D12_RESOURCE_STATES result = D3D12_RESOURCE_STATE_COMMON;
+	if (HasAllStates(state, ResourceState::RenderTarget))   result |= D3D12_RESOURCE_STATE_RENDER_TARGET;
+	if (HasAllStates(state, ResourceState::CopySource))     result |= D3D12_RESOURCE_STATE_COPY_SOURCE;
+	if (HasAllStates(state, ResourceState::CopyDest))       result |= D3D12_RESOURCE_STATE_COPY_DEST;
+	if (HasAllStates(state, ResourceState::ShaderResource)) result |= D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+	if (HasAllStates(state, ResourceState::GenericRead))    result |= D3D12_RESOURCE_STATE_GENERIC_READ;
+	return result;
+}
+
+static ID3D12Resource* ToD3D12Resource(Resource* resource)
+{
+	return resource ? static_cast<DX12Resource*>(resource)->m_resource : NULL;
+}
+
+// Buffer
+
+DX12Buffer::~DX12Buffer()
+{
+	if (m_resource) { m_resource->Unmap(0, NULL); m_resource->Release(); m_resource = NULL; }
+}
+
+// Timestamp queries
+
+DX12TimestampQueryHeap::~DX12TimestampQueryHeap()
+{
+	if (m_readback) { m_readback->Unmap(0, NULL); m_readback->Release(); m_readback = NULL; }
+	if (m_queryHeap) { m_queryHeap->Release(); m_queryHeap = NULL; }
+}
+
+// Fence
+
+DX12Fence::~DX12Fence()
+{
+	if (m_fence) { m_fence->Release(); m_fence = NULL; }
+	if (m_fenceEvent) { CloseHandle(m_fenceEvent); m_fenceEvent = NULL; }
+}
+
+uint64_t DX12Fence::GetCompletedValue()
+{
+	return m_fence->GetCompletedValue();
+}
+
+void DX12Fence::Wait(uint64_t value)
+{
+	if (m_fence->GetCompletedValue() >= value)
+		return;
+
+	m_fence->SetEventOnCompletion(value, m_fenceEvent);
+	WaitForSingleObject(m_fenceEvent, INFINITE);
+}
+
+// Command allocator
+
+DX12CommandAllocator::~DX12CommandAllocator()
+{
+	if (m_allocator) { m_allocator->Release(); m_allocator = NULL; }
+}
+
+void DX12CommandAllocator::Reset()
+{
+	m_allocator->Reset();
+}
+
+// Command list
+
+DX12CommandList::~DX12CommandList()
+{
+	if (m_commandList) { m_commandList->Release(); m_commandList = NULL; }
+}
+
+void DX12CommandList::Reset(CommandAllocator* allocator)
+{
+	m_commandList->Reset(static_cast<DX12CommandAllocator*>(allocator)->m_allocator, NULL);
+}
+
+void DX12CommandList::ResourceBarrier(Resource* resource, ResourceState before, ResourceState after)
+{
+	D3D12_RESOURCE_BARRIER barrier = {};
+	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+	barrier.Transition.pResource = static_cast<DX12Resource*>(resource)->m_resource;
+	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+	barrier.Transition.StateBefore = ToD3D12State(before);
+	barrier.Transition.StateAfter = ToD3D12State(after);
+	m_commandList->ResourceBarrier(1, &barrier);
+}
+
+void DX12CommandList::ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers)
+{
+	// Flushed in chunks so typical batches stay on the stack
+	static uint32_t const BATCH_SIZE = 32;
+	D3D12_RESOURCE_BARRIER batch[BATCH_SIZE];
+	uint32_t batchCount = 0;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		const ResourceBarrierDesc& desc = barriers[i];
+		D3D12_RESOURCE_BARRIER& barrier = batch[batchCount++];
+		barrier = {};
+		if (desc.Split == BarrierSplit::Begin)
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+		else if (desc.Split == BarrierSplit::End)
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+		if (desc.Type == BarrierType::Aliasing)
+		{
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_ALIASING;
+			barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+			barrier.Aliasing.pResourceBefore = ToD3D12Resource(desc.AliasBefore);
+			barrier.Aliasing.pResourceAfter = ToD3D12Resource(desc.Target);
+		}
+		else
+		{
+			barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+			barrier.Transition.pResource = ToD3D12Resource(desc.Target);
+			barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+			barrier.Transition.StateBefore = ToD3D12State(desc.StateBefore);
+			barrier.Transition.StateAfter = ToD3D12State(desc.StateAfter);
+		}
+		if (batchCount == BATCH_SIZE || i + 1 == count)
+		{
+			m_commandList->ResourceBarrier(batchCount, batch);
+			batchCount = 0;
+		}
+	}
+}
+
+void DX12CommandList::ClearRenderTarget(Resource* renderTarget, const float color[4])
+{
+	m_commandList->ClearRenderTargetView(static_cast<DX12Resource*>(renderTarget)->m_rtvDescriptor, color, 0, NULL);
+}
+
+void DX12CommandList::SetRenderTarget(Resource* renderTarget)
+{
+	m_commandList->OMSetRenderTargets(1, &static_cast<DX12Resource*>(renderTarget)->m_rtvDescriptor, FALSE, NULL);
+}
+
+void DX12CommandList::RenderDrawData(ImDrawData* drawData)
+{
+	// The imgui backend binds its font texture from our SRV heap
+	m_commandList->SetDescriptorHeaps(1, &m_srvDescHeap);
+	ImGui_ImplDX12_RenderDrawData(drawData, m_commandList);
+}
+
+void DX12CommandList::UpdateUITexture(const TextureUpdate& update)
+{
+	// Texture copies read rows at a 256 byte pitch from a 512 byte aligned placement
+	DynamicUploadHeap* heap = m_device->m_uploadHeap;
+	uint32_t pitch = (update.Width * 4 + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1u) & ~(D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1u);
+	UploadAllocation allocation;
+	if (heap == nullptr || !heap->Allocate((uint64_t)pitch * update.Height, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT, allocation))
+		return;
+	for (uint32_t y = 0; y < update.Height; y++)
+		memcpy((uint8_t*)allocation.CpuAddress + (size_t)y * pitch, update.Pixels + (size_t)y * update.Width * 4, update.Width * 4);
+	Buffer* buffer = heap->GetBuffer();
+	ImGui_ImplDX12_UpdateFontsTexture(m_commandList, static_cast<DX12Buffer*>(buffer)->m_resource, allocation.GpuAddress - buffer->GetGpuAddress(),
+		pitch, (int)update.X, (int)update.Y, (int)update.Width, (int)update.Height);
+}
+
+void DX12CommandList::WriteTimestamp(TimestampQueryHeap* heap, uint32_t index)
+{
+	m_commandList->EndQuery(static_cast<DX12TimestampQueryHeap*>(heap)->m_queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, index);
+}
+
+void DX12CommandList::ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count)
+{
+	DX12TimestampQueryHeap* dx12Heap = static_cast<DX12TimestampQueryHeap*>(heap);
+	m_commandList->ResolveQueryData(dx12Heap->m_queryHeap, D3D12_QUERY_TYPE_TIMESTAMP, first, count, dx12Heap->m_readback, first * sizeof(uint64_t));
+}
+
+void DX12CommandList::Close()
+{
+	m_commandList->Close();
+}
+
+// Command queue
+
+DX12CommandQueue::~DX12CommandQueue()
+{
+	if (m_commandQueue) { m_commandQueue->Release(); m_commandQueue = NULL; }
+}
+
+void DX12CommandQueue::ExecuteCommandLists(uint32_t count, CommandList* const* commandLists)
+{
+	ID3D12CommandList* nativeLists[16];
+	IM_ASSERT(count <= IM_ARRAYSIZE(nativeLists));
+	for (uint32_t i = 0; i < count; i++)
+		nativeLists[i] = static_cast<DX12CommandList*>(commandLists[i])->m_commandList;
+	m_commandQueue->ExecuteCommandLists(count, nativeLists);
+}
+
+void DX12CommandQueue::Signal(Fence* fence, uint64_t value)
+{
+	m_commandQueue->Signal(static_cast<DX12Fence*>(fence)->m_fence, value);
+}
+
+uint64_t DX12CommandQueue::GetTimestampFrequency()
+{
+	UINT64 frequency = 0;
+	if (m_commandQueue->GetTimestampFrequency(&frequency) != S_OK)
+		return 0;
+	return frequency;
+}
+
+bool DX12CommandQueue::GetClockCalibration(uint64_t* gpuTimestamp, uint64_t* cpuTime)
+{
+	UINT64 gpu = 0, qpc = 0;
+	LARGE_INTEGER frequency;
+	if (m_commandQueue->GetClockCalibration(&gpu, &qpc) != S_OK || !QueryPerformanceFrequency(&frequency))
+		return false;
+	// steady_clock is QueryPerformanceCounter on Windows, only in nanoseconds. Split to not overflow.
+	uint64_t ticksPerSecond = (uint64_t)frequency.QuadPart;
+	*gpuTimestamp = gpu;
+	*cpuTime = qpc / ticksPerSecond * 1000000000ull + qpc % ticksPerSecond * 1000000000ull / ticksPerSecond;
+	return true;
+}
+
+// Swap chain
+
+DX12SwapChain::~DX12SwapChain()
+{
+	CleanupRenderTarget();
+	if (m_pSwapChain) { m_pSwapChain->SetFullscreenState(false, NULL); m_pSwapChain->Release(); m_pSwapChain = NULL; }
+	if (m_hSwapChainWaitableObject != NULL) { CloseHandle(m_hSwapChainWaitableObject); m_hSwapChainWaitableObject = NULL; }
+	if (m_pd3dRtvDescHeap) { m_pd3dRtvDescHeap->Release(); m_pd3dRtvDescHeap = NULL; }
+}
+
+uint32_t DX12SwapChain::GetCurrentBackBufferIndex()
+{
+	return m_pSwapChain->GetCurrentBackBufferIndex();
+}
+
+Resource* DX12SwapChain::GetBackBuffer(uint32_t index)
+{
+	return &m_backBuffers[index];
+}
+
+void DX12SwapChain::WaitForNextFrame()
+{
+	// Bounded, so a window the compositor stopped presenting (e.g. minimized) doesn't hang the frame loop
+	WaitForSingleObjectEx(m_hSwapChainWaitableObject, 1000, TRUE);
+}
+
+void DX12SwapChain::Present(uint32_t syncInterval, uint32_t flags)
+{
+	UINT dxgiFlags = 0;
+	// Tearing is only allowed with a sync interval of 0
+	if ((flags & PRESENT_ALLOW_TEARING) && m_tearingSupported && syncInterval == 0)
+		dxgiFlags |= DXGI_PRESENT_ALLOW_TEARING;
+	m_pSwapChain->Present(syncInterval, dxgiFlags);
+}
+
+void DX12SwapChain::Resize(uint32_t width, uint32_t height)
+{
+	// All references to the back buffers have to be released before resizing
+	CleanupRenderTarget();
+	m_pSwapChain->ResizeBuffers(
+		0,
+		width,
+		height,
+		DXGI_FORMAT_UNKNOWN,
+		m_flags);
+	CreateRenderTarget();
+}
+
+void DX12SwapChain::CreateRenderTarget()
+{
+	for (UINT i = 0; i < m_bufferCount; i++)
+	{
+		ID3D12Resource* pBackBuffer = NULL;
+		m_pSwapChain->GetBuffer(i, IID_PPV_ARGS(&pBackBuffer));
+		m_pd3dDevice->CreateRenderTargetView(pBackBuffer, NULL, m_backBuffers[i].m_rtvDescriptor);
+		m_backBuffers[i].m_resource = pBackBuffer;
+	}
+}
+
+void DX12SwapChain::CleanupRenderTarget()
+{
+	for (UINT i = 0; i < m_bufferCount; i++)
+		if (m_backBuffers[i].m_resource) { m_backBuffers[i].m_resource->Release(); m_backBuffers[i].m_resource = NULL; }
+}
+
+// Device
+
+GraphicsDevice* CreateDX12Device()
+{
+	DX12Device* device = new DX12Device();
+	if (!device->Init())
+	{
+		delete device;
+		return nullptr;
+	}
+	return device;
+}
+
+bool DX12Device::Init()
+{
+	// [DEBUG] Enable debug interface
+#ifdef DX12_ENABLE_DEBUG_LAYER
+	ID3D12Debug* pdx12Debug = NULL;
+	if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(&pdx12Debug))))
+		pdx12Debug->EnableDebugLayer();
+#endif
+
+	// Create device
+	D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
+	if (D3D12CreateDevice(NULL, featureLevel, IID_PPV_ARGS(&m_pd3dDevice)) != S_OK)
+		return false;
+
+	// [DEBUG] Setup debug interface to break on any warnings/errors
+#ifdef DX12_ENABLE_DEBUG_LAYER
+	if (pdx12Debug != NULL)
+	{
+		ID3D12InfoQueue* pInfoQueue = NULL;
+		m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pInfoQueue));
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_ERROR, true);
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_CORRUPTION, true);
+		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_WARNING, true);
+		pInfoQueue->Release();
+		pdx12Debug->Release();
+	}
+#endif
+
+	if (!m_srvHeap.Init(m_pd3dDevice, DX12_SRV_HEAP_INITIAL_PERSISTENT, DX12_SRV_HEAP_MAX_PERSISTENT, DX12_SRV_HEAP_TRANSIENT))
+		return false;
+
+	return true;
+}
+
+DX12Device::~DX12Device()
+{
+	m_srvHeap.Shutdown();
+	if (m_pd3dDevice) { m_pd3dDevice->Release(); m_pd3dDevice = NULL; }
+
+#ifdef DX12_ENABLE_DEBUG_LAYER
+	IDXGIDebug1* pDebug = NULL;
+	if (SUCCEEDED(DXGIGetDebugInterface1(0, IID_PPV_ARGS(&pDebug))))
+	{
+		pDebug->ReportLiveObjects(DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_SUMMARY);
+		pDebug->Release();
+	}
+#endif
+}
+
+CommandQueue* DX12Device::CreateCommandQueue()
+{
+	D3D12_COMMAND_QUEUE_DESC desc = {};
+	desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
+	desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
+	desc.NodeMask = 1;
+
+	DX12CommandQueue* queue = new DX12CommandQueue();
+	if (m_pd3dDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&queue->m_commandQueue)) != S_OK)
+	{
+		delete queue;
+		return nullptr;
+	}
+	return queue;
+}
+
+CommandAllocator* DX12Device::CreateCommandAllocator()
+{
+	DX12CommandAllocator* allocator = new DX12CommandAllocator();
+	if (m_pd3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&allocator->m_allocator)) != S_OK)
+	{
+		delete allocator;
+		return nullptr;
+	}
+	return allocator;
+}
+
+CommandList* DX12Device::CreateCommandList(CommandAllocator* allocator)
+{
+	DX12CommandList* commandList = new DX12CommandList();
+	commandList->m_srvDescHeap = m_srvHeap.GetShaderVisibleHeap();
+	commandList->m_device = this;
+	if (m_pd3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, static_cast<DX12CommandAllocator*>(allocator)->m_allocator, NULL, IID_PPV_ARGS(&commandList->m_commandList)) != S_OK ||
+		commandList->m_commandList->Close() != S_OK)
+	{
+		delete commandList;
+		return nullptr;
+	}
+	return commandList;
+}
+
+Fence* DX12Device::CreateFence(uint64_t initialValue)
+{
+	DX12Fence* fence = new DX12Fence();
+	if (m_pd3dDevice->CreateFence(initialValue, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&fence->m_fence)) != S_OK)
+	{
+		delete fence;
+		return nullptr;
+	}
+
+	fence->m_fenceEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+	if (fence->m_fenceEvent == NULL)
+	{
+		delete fence;
+		return nullptr;
+	}
+	return fence;
+}
+
+SwapChain* DX12Device::CreateSwapChain(CommandQueue* queue, const SwapChainDesc& desc)
+{
+	IM_ASSERT(desc.bufferCount <= DX12_MAX_BACK_BUFFERS);
+	IM_ASSERT(desc.maxFrameLatency >= 1 && desc.maxFrameLatency <= desc.bufferCount);
+
+	// Tearing needs both the flag on the swap chain and support from the OS/driver
+	bool tearingSupported = false;
+	if (desc.allowTearing)
+	{
+		IDXGIFactory5* factory5 = NULL;
+		if (CreateDXGIFactory1(IID_PPV_ARGS(&factory5)) == S_OK)
+		{
+			BOOL allowTearing = FALSE;
+			tearingSupported = factory5->CheckFeatureSupport(DXGI_FEATURE_PRESENT_ALLOW_TEARING, &allowTearing, sizeof(allowTearing)) == S_OK && allowTearing;
+			factory5->Release();
+		}
+	}
+
+	// Setup swap chain
+	DXGI_SWAP_CHAIN_DESC1 sd;
+	{
+		ZeroMemory(&sd, sizeof(sd));
+		sd.BufferCount = desc.bufferCount;
+		sd.Width = desc.width;
+		sd.Height = desc.height;
+		sd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		sd.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
+		if (tearingSupported)
+			sd.Flags |= DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING;
+		sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
+		sd.SampleDesc.Count = 1;
+		sd.SampleDesc.Quality = 0;
+		sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
+		sd.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
+		sd.Scaling = DXGI_SCALING_STRETCH;
+		sd.Stereo = FALSE;
+	}
+
+	DX12SwapChain* swapChain = new DX12SwapChain();
+	swapChain->m_pd3dDevice = m_pd3dDevice;
+	swapChain->m_bufferCount = desc.bufferCount;
+	swapChain->m_flags = sd.Flags;
+	swapChain->m_tearingSupported = tearingSupported;
+
+	{
+		D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+		heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
+		heapDesc.NumDescriptors = desc.bufferCount;
+		heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+		heapDesc.NodeMask = 1;
+		if (m_pd3dDevice->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&swapChain->m_pd3dRtvDescHeap)) != S_OK)
+		{
+			delete swapChain;
+			return nullptr;
+		}
+
+		SIZE_T rtvDescriptorSize = m_pd3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+		D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = swapChain->m_pd3dRtvDescHeap->GetCPUDescriptorHandleForHeapStart();
+		for (UINT i = 0; i < desc.bufferCount; i++)
+		{
+			swapChain->m_backBuffers[i].m_rtvDescriptor = rtvHandle;
+			rtvHandle.ptr += rtvDescriptorSize;
+		}
+	}
+
+	{
+		IDXGIFactory4* dxgiFactory = NULL;
+		IDXGISwapChain1* swapChain1 = NULL;
+		bool created = CreateDXGIFactory1(IID_PPV_ARGS(&dxgiFactory)) == S_OK &&
+			dxgiFactory->CreateSwapChainForHwnd(static_cast<DX12CommandQueue*>(queue)->m_commandQueue, (HWND)desc.window, &sd, NULL, NULL, &swapChain1) == S_OK &&
+			swapChain1->QueryInterface(IID_PPV_ARGS(&swapChain->m_pSwapChain)) == S_OK;
+		if (swapChain1) swapChain1->Release();
+		if (dxgiFactory) dxgiFactory->Release();
+		if (!created)
+		{
+			delete swapChain;
+			return nullptr;
+		}
+		swapChain->m_pSwapChain->SetMaximumFrameLatency(desc.maxFrameLatency);
+		swapChain->m_hSwapChainWaitableObject = swapChain->m_pSwapChain->GetFrameLatencyWaitableObject();
+	}
+
+	swapChain->CreateRenderTarget();
+	return swapChain;
+}
+
+Buffer* DX12Device::CreateUploadBuffer(uint64_t size)
+{
+	D3D12_HEAP_PROPERTIES props = {};
+	props.Type = D3D12_HEAP_TYPE_UPLOAD;
+	props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Width = size;
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+	DX12Buffer* buffer = new DX12Buffer();
+	if (m_pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, NULL, IID_PPV_ARGS(&buffer->m_resource)) != S_OK)
+	{
+		delete buffer;
+		return nullptr;
+	}
+
+	// Upload heaps can stay mapped forever, the CPU never reads back from it
+	D3D12_RANGE readRange = { 0, 0 };
+	if (buffer->m_resource->Map(0, &readRange, &buffer->m_cpuAddress) != S_OK)
+	{
+		buffer->m_resource->Release();
+		buffer->m_resource = NULL;
+		delete buffer;
+		return nullptr;
+	}
+	return buffer;
+}
+
+TimestampQueryHeap* DX12Device::CreateTimestampQueryHeap(uint32_t count)
+{
+	DX12TimestampQueryHeap* heap = new DX12TimestampQueryHeap();
+	heap->m_count = count;
+
+	D3D12_QUERY_HEAP_DESC queryDesc = {};
+	queryDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+	queryDesc.Count = count;
+	if (m_pd3dDevice->CreateQueryHeap(&queryDesc, IID_PPV_ARGS(&heap->m_queryHeap)) != S_OK)
+	{
+		delete heap;
+		return nullptr;
+	}
+
+	D3D12_HEAP_PROPERTIES props = {};
+	props.Type = D3D12_HEAP_TYPE_READBACK;
+	props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+	props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+
+	D3D12_RESOURCE_DESC desc = {};
+	desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+	desc.Width = count * sizeof(uint64_t);
+	desc.Height = 1;
+	desc.DepthOrArraySize = 1;
+	desc.MipLevels = 1;
+	desc.Format = DXGI_FORMAT_UNKNOWN;
+	desc.SampleDesc.Count = 1;
+	desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+	desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+	if (m_pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_COPY_DEST, NULL, IID_PPV_ARGS(&heap->m_readback)) != S_OK)
+	{
+		delete heap;
+		return nullptr;
+	}
+
+	// Readback memory can stay mapped as well, the fence tells when the GPU is done writing a range
+	void* data = nullptr;
+	if (heap->m_readback->Map(0, NULL, &data) != S_OK)
+	{
+		heap->m_readback->Release();
+		heap->m_readback = NULL;
+		delete heap;
+		return nullptr;
+	}
+	heap->m_resolved = static_cast<const uint64_t*>(data);
+	return heap;
+}
+
+bool DX12Device::InitUIBackend(int numFramesInFlight)
+{
+	// The backend keeps the CPU handle around and may recreate the font SRV at any time, so it writes straight
+	// into the shader visible heap (which never moves) instead of going through staging
+	if (!m_srvHeap.AllocatePersistent(1, m_fontSrv))
+		return false;
+	if (!ImGui_ImplDX12_Init(m_pd3dDevice, numFramesInFlight,
+		DXGI_FORMAT_R8G8B8A8_UNORM, m_srvHeap.GetShaderVisibleHeap(),
+		m_srvHeap.GetShaderVisibleCpuHandle(m_fontSrv.Offset),
+		m_srvHeap.GetGpuHandle(m_fontSrv.Offset)))
+		return false;
+
+	if (m_uploadHeap != nullptr)
+		ImGui_ImplDX12_SetUploadAllocator(&DynamicUploadHeap::AllocateCallback, m_uploadHeap);
+	return true;
+}
+
+void DX12Device::NewUIFrame()
+{
+	ImGui_ImplDX12_NewFrame();
+}
+
+void DX12Device::ShutdownUIBackend()
+{
+	ImGui_ImplDX12_Shutdown();
+	m_srvHeap.FreePersistent(m_fontSrv);
+	m_fontSrv = DescriptorRange();
+}
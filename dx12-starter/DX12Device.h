@@ -0,0 +1,165 @@
+#pragma once
+#include "DX12DescriptorHeap.h"
+#include "GraphicsDevice.h"
+#include <d3d12.h>
+#include <dxgi1_5.h>
+#include <wtypes.h>
+
+#ifdef _DEBUG
+#define DX12_ENABLE_DEBUG_LAYER
+#endif
+
+#ifdef DX12_ENABLE_DEBUG_LAYER
+#include <dxgidebug.h>
+#pragma comment(lib, "dxguid.lib")
+#endif
+
+static int const                    DX12_MAX_BACK_BUFFERS = 3;
+// CBV/SRV/UAV heap layout: persistent descriptors grow from 256 up to the max, followed by the per-frame ring
+static uint32_t const               DX12_SRV_HEAP_INITIAL_PERSISTENT = 256;
+static uint32_t const               DX12_SRV_HEAP_MAX_PERSISTENT = 16384;
+static uint32_t const               DX12_SRV_HEAP_TRANSIENT = 4096;
+
+class DX12Device;
+
+class DX12Resource : public Resource
+{
+public:
+	ID3D12Resource* m_resource = NULL;
+	D3D12_CPU_DESCRIPTOR_HANDLE  m_rtvDescriptor = {};
+};
+
+class DX12Buffer : public Buffer
+{
+public:
+	~DX12Buffer() override;
+	void* GetCpuAddress() override { return m_cpuAddress; }
+	uint64_t GetGpuAddress() override { return m_resource->GetGPUVirtualAddress(); }
+
+	ID3D12Resource* m_resource = NULL;
+	void* m_cpuAddress = nullptr;
+};
+
+class DX12TimestampQueryHeap : public TimestampQueryHeap
+{
+public:
+	~DX12TimestampQueryHeap() override;
+	uint32_t GetCount() override { return m_count; }
+	const uint64_t* GetResolvedData() override { return m_resolved; }
+
+	ID3D12QueryHeap* m_queryHeap = NULL;
+	// Readback buffer the queries are resolved into, mapped for its whole lifetime
+	ID3D12Resource* m_readback = NULL;
+	const uint64_t* m_resolved = nullptr;
+	uint32_t                     m_count = 0;
+};
+
+class DX12Fence : public Fence
+{
+public:
+	~DX12Fence() override;
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t value) override;
+
+	ID3D12Fence* m_fence = NULL;
+	HANDLE                       m_fenceEvent = NULL;
+};
+
+class DX12CommandAllocator : public CommandAllocator
+{
+public:
+	~DX12CommandAllocator() override;
+	void Reset() override;
+
+	ID3D12CommandAllocator* m_allocator = NULL;
+};
+
+class DX12CommandList : public CommandList
+{
+public:
+	~DX12CommandList() override;
+	void Reset(CommandAllocator* allocator) override;
+	void ResourceBarrier(Resource* resource, ResourceState before, ResourceState after) override;
+	void ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers) override;
+	void ClearRenderTarget(Resource* renderTarget, const float color[4]) override;
+	void SetRenderTarget(Resource* renderTarget) override;
+	void RenderDrawData(ImDrawData* drawData) override;
+	void UpdateUITexture(const TextureUpdate& update) override;
+	void WriteTimestamp(TimestampQueryHeap* heap, uint32_t index) override;
+	void ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count) override;
+	void Close() override;
+
+	ID3D12GraphicsCommandList* m_commandList = NULL;
+	ID3D12DescriptorHeap* m_srvDescHeap = NULL;
+	// For the dynamic upload heap, which is only set after the lists are created
+	DX12Device* m_device = nullptr;
+};
+
+class DX12CommandQueue : public CommandQueue
+{
+public:
+	~DX12CommandQueue() override;
+	void ExecuteCommandLists(uint32_t count, CommandList* const* commandLists) override;
+	void Signal(Fence* fence, uint64_t value) override;
+	uint64_t GetTimestampFrequency() override;
+	bool GetClockCalibration(uint64_t* gpuTimestamp, uint64_t* cpuTime) override;
+
+	ID3D12CommandQueue* m_commandQueue = NULL;
+};
+
+class DX12SwapChain : public SwapChain
+{
+public:
+	~DX12SwapChain() override;
+	uint32_t GetCurrentBackBufferIndex() override;
+	Resource* GetBackBuffer(uint32_t index) override;
+	void WaitForNextFrame() override;
+	void Present(uint32_t syncInterval, uint32_t flags) override;
+	bool SupportsTearing() override { return m_tearingSupported; }
+	void Resize(uint32_t width, uint32_t height) override;
+	void CreateRenderTarget();
+	void CleanupRenderTarget();
+
+	ID3D12Device* m_pd3dDevice = nullptr;
+	IDXGISwapChain3* m_pSwapChain = NULL;
+	HANDLE                       m_hSwapChainWaitableObject = NULL;
+	ID3D12DescriptorHeap* m_pd3dRtvDescHeap = NULL;
+	DX12Resource                 m_backBuffers[DX12_MAX_BACK_BUFFERS] = {};
+	uint32_t                     m_bufferCount = 0;
+	// Creation flags, ResizeBuffers() has to be passed the same ones
+	UINT                         m_flags = 0;
+	bool                         m_tearingSupported = false;
+};
+
+/// <summary>
+/// DirectX 12 implementation of the graphics interface. Owns the D3D device and the shader visible
+/// CBV/SRV/UAV heap shared by the imgui DX12 backend and user textures.
+/// </summary>
+class DX12Device : public GraphicsDevice
+{
+public:
+	bool Init();
+	~DX12Device() override;
+	const char* GetName() const override { return "DirectX 12"; }
+
+	CommandQueue* CreateCommandQueue() override;
+	CommandAllocator* CreateCommandAllocator() override;
+	CommandList* CreateCommandList(CommandAllocator* allocator) override;
+	Fence* CreateFence(uint64_t initialValue) override;
+	SwapChain* CreateSwapChain(CommandQueue* queue, const SwapChainDesc& desc) override;
+	Buffer* CreateUploadBuffer(uint64_t size) override;
+	TimestampQueryHeap* CreateTimestampQueryHeap(uint32_t count) override;
+	void SetDynamicUploadHeap(DynamicUploadHeap* heap) override { m_uploadHeap = heap; }
+	void FinishFrame(uint64_t fenceValue) override { m_srvHeap.FinishFrame(fenceValue); }
+	void RetireFrames(uint64_t completedFenceValue) override { m_srvHeap.Retire(completedFenceValue); }
+	DX12DescriptorHeap* GetSrvHeap() { return &m_srvHeap; }
+
+	bool InitUIBackend(int numFramesInFlight) override;
+	void NewUIFrame() override;
+	void ShutdownUIBackend() override;
+
+	ID3D12Device* m_pd3dDevice = nullptr;
+	DX12DescriptorHeap           m_srvHeap;
+	DescriptorRange              m_fontSrv;
+	DynamicUploadHeap* m_uploadHeap = nullptr;
+};
@@ -0,0 +1,180 @@
+#include "DescriptorAllocator.h"
+#include "imgui.h"
+#include <algorithm>
+
+// Range allocator
+
+void DescriptorRangeAllocator::Init(uint32_t capacity)
+{
+	m_freeByOffset.clear();
+	m_freeBySize.clear();
+	m_capacity = capacity;
+	m_used = 0;
+	if (capacity > 0)
+		AddFreeRange(0, capacity);
+}
+
+bool DescriptorRangeAllocator::Allocate(uint32_t count, uint32_t* outOffset)
+{
+	IM_ASSERT(count > 0);
+	// Best fit keeps large ranges around for large requests
+	SizeMap::iterator bySize = m_freeBySize.lower_bound(count);
+	if (bySize == m_freeBySize.end())
+		return false;
+
+	OffsetMap::iterator byOffset = bySize->second;
+	uint32_t offset = byOffset->first;
+	uint32_t freeCount = byOffset->second.Count;
+	RemoveFreeRange(byOffset);
+	if (freeCount > count)
+		AddFreeRange(offset + count, freeCount - count);
+
+	m_used += count;
+	*outOffset = offset;
+	return true;
+}
+
+void DescriptorRangeAllocator::Free(uint32_t offset, uint32_t count)
+{
+	IM_ASSERT(count > 0 && offset + count <= m_capacity);
+	m_used -= count;
+
+	// Merge with the free range right after, then with the one right before
+	OffsetMap::iterator next = m_freeByOffset.lower_bound(offset);
+	IM_ASSERT((next == m_freeByOffset.end() || next->first >= offset + count) && "Double free or overlapping range");
+	if (next != m_freeByOffset.end() && next->first == offset + count)
+	{
+		count += next->second.Count;
+		next = std::next(next);
+		RemoveFreeRange(std::prev(next));
+	}
+	if (next != m_freeByOffset.begin())
+	{
+		OffsetMap::iterator prev = std::prev(next);
+		IM_ASSERT(prev->first + prev->second.Count <= offset && "Double free or overlapping range");
+		if (prev->first + prev->second.Count == offset)
+		{
+			offset = prev->first;
+			count += prev->second.Count;
+			RemoveFreeRange(prev);
+		}
+	}
+	AddFreeRange(offset, count);
+}
+
+void DescriptorRangeAllocator::Grow(uint32_t newCapacity)
+{
+	IM_ASSERT(newCapacity >= m_capacity);
+	if (newCapacity == m_capacity)
+		return;
+	uint32_t oldCapacity = m_capacity;
+	m_capacity = newCapacity;
+	// Free() merges the new space with a free range at the old end
+	m_used += newCapacity - oldCapacity;
+	Free(oldCapacity, newCapacity - oldCapacity);
+}
+
+void DescriptorRangeAllocator::AddFreeRange(uint32_t offset, uint32_t count)
+{
+	OffsetMap::iterator byOffset = m_freeByOffset.emplace(offset, FreeRange()).first;
+	byOffset->second.Count = count;
+	byOffset->second.BySize = m_freeBySize.emplace(count, byOffset);
+}
+
+void DescriptorRangeAllocator::RemoveFreeRange(OffsetMap::iterator it)
+{
+	m_freeBySize.erase(it->second.BySize);
+	m_freeByOffset.erase(it);
+}
+
+// Descriptor allocator
+
+void DescriptorAllocator::Init(uint32_t initialPersistent, uint32_t maxPersistent, uint32_t transientCapacity)
+{
+	IM_ASSERT(initialPersistent <= maxPersistent);
+	m_maxPersistent = maxPersistent;
+	m_persistent.Init(initialPersistent);
+	m_transient.Init(transientCapacity);
+	m_frameFrees.clear();
+	m_pendingFrees.clear();
+	m_stats = DescriptorAllocatorStats();
+}
+
+bool DescriptorAllocator::AllocatePersistent(uint32_t count, DescriptorRange& range)
+{
+	uint32_t offset;
+	while (!m_persistent.Allocate(count, &offset))
+	{
+		uint32_t capacity = m_persistent.GetCapacity();
+		if (capacity >= m_maxPersistent)
+		{
+			m_stats.FailedAllocations++;
+			return false;
+		}
+		// Double, in whole pages, at least enough for this request
+		uint32_t newCapacity = std::max(capacity * 2, capacity + count);
+		newCapacity = (newCapacity + PAGE_SIZE - 1) / PAGE_SIZE * PAGE_SIZE;
+		m_persistent.Grow(std::min(newCapacity, m_maxPersistent));
+		m_stats.Grows++;
+	}
+
+	range.Offset = offset;
+	range.Count = count;
+	m_stats.PersistentAllocations++;
+	m_stats.PersistentPeak = std::max(m_stats.PersistentPeak, m_persistent.GetUsed());
+	return true;
+}
+
+void DescriptorAllocator::FreePersistent(const DescriptorRange& range)
+{
+	if (!range.IsValid())
+		return;
+	IM_ASSERT(range.Offset + range.Count <= m_maxPersistent && "Not a persistent range");
+	m_frameFrees.push_back(range);
+	m_stats.PersistentFrees++;
+}
+
+bool DescriptorAllocator::AllocateTransient(uint32_t count, DescriptorRange& range)
+{
+	uint64_t offset;
+	if (!m_transient.Allocate(count, 1, &offset))
+	{
+		m_stats.FailedAllocations++;
+		return false;
+	}
+	range.Offset = m_maxPersistent + (uint32_t)offset;
+	range.Count = count;
+	m_stats.TransientAllocations++;
+	m_stats.TransientDescriptors += count;
+	return true;
+}
+
+void DescriptorAllocator::FinishFrame(uint64_t fenceValue)
+{
+	for (const DescriptorRange& range : m_frameFrees)
+		m_pendingFrees.push_back({ fenceValue, range });
+	m_frameFrees.clear();
+	m_transient.FinishFrame(fenceValue);
+	m_stats.TransientLastFrame = (uint32_t)m_transient.GetStats().LastFrameBytes;
+}
+
+void DescriptorAllocator::Retire(uint64_t completedFenceValue)
+{
+	while (!m_pendingFrees.empty() && m_pendingFrees.front().FenceValue <= completedFenceValue)
+	{
+		const DescriptorRange& range = m_pendingFrees.front().Range;
+		m_persistent.Free(range.Offset, range.Count);
+		m_pendingFrees.pop_front();
+	}
+	m_transient.Retire(completedFenceValue);
+}
+
+DescriptorAllocatorStats DescriptorAllocator::GetStats() const
+{
+	DescriptorAllocatorStats stats = m_stats;
+	stats.PersistentCapacity = m_persistent.GetCapacity();
+	stats.PersistentUsed = m_persistent.GetUsed();
+	stats.FreeRanges = m_persistent.GetFreeRangeCount();
+	stats.LargestFreeRange = m_persistent.GetLargestFreeRange();
+	return stats;
+}
@@ -0,0 +1,120 @@
+#pragma once
+#include "UploadRingBuffer.h"
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <vector>
+
+/// <summary>
+/// A contiguous run of descriptors, as an index into a descriptor heap.
+/// </summary>
+struct DescriptorRange
+{
+	uint32_t Offset = 0;
+	uint32_t Count = 0;
+
+	bool IsValid() const { return Count != 0; }
+};
+
+/// <summary>
+/// Variable size range allocator over [0, capacity). Free ranges are indexed both by offset (to merge neighbours
+/// on free) and by size (best fit on allocate), so both are O(log n) in the number of free ranges.
+/// </summary>
+class DescriptorRangeAllocator
+{
+public:
+	void Init(uint32_t capacity);
+	// Returns false (and leaves the allocator untouched) if no free range is large enough.
+	bool Allocate(uint32_t count, uint32_t* outOffset);
+	void Free(uint32_t offset, uint32_t count);
+	// Appends [capacity, newCapacity) as free space.
+	void Grow(uint32_t newCapacity);
+
+	uint32_t GetCapacity() const { return m_capacity; }
+	uint32_t GetUsed() const { return m_used; }
+	uint32_t GetFreeRangeCount() const { return (uint32_t)m_freeByOffset.size(); }
+	uint32_t GetLargestFreeRange() const { return m_freeBySize.empty() ? 0 : m_freeBySize.rbegin()->first; }
+
+private:
+	struct FreeRange;
+	typedef std::map<uint32_t, FreeRange> OffsetMap;
+	typedef std::multimap<uint32_t, OffsetMap::iterator> SizeMap;
+	struct FreeRange
+	{
+		uint32_t Count;
+		SizeMap::iterator BySize;
+	};
+
+	void AddFreeRange(uint32_t offset, uint32_t count);
+	void RemoveFreeRange(OffsetMap::iterator it);
+
+	OffsetMap m_freeByOffset;
+	SizeMap m_freeBySize;
+	uint32_t m_capacity = 0;
+	uint32_t m_used = 0;
+};
+
+struct DescriptorAllocatorStats
+{
+	uint64_t PersistentAllocations = 0;
+	uint64_t PersistentFrees = 0;
+	uint64_t FailedAllocations = 0;
+	uint64_t Grows = 0;
+	uint32_t PersistentCapacity = 0;
+	uint32_t PersistentUsed = 0;
+	uint32_t PersistentPeak = 0;
+	// Fragmentation of the persistent region
+	uint32_t FreeRanges = 0;
+	uint32_t LargestFreeRange = 0;
+	uint64_t TransientAllocations = 0;
+	uint64_t TransientDescriptors = 0;
+	uint32_t TransientLastFrame = 0;
+};
+
+/// <summary>
+/// Device independent bookkeeping for a shader visible descriptor heap of `maxPersistent + transientCapacity` slots.
+/// - Persistent ranges (textures, long lived views) come from [0, maxPersistent). The usable part starts small and
+///   grows by whole pages, so the CPU staging copy only has to be as large as what is actually in use.
+///   Frees are deferred until the GPU is done with the frame they were made in.
+/// - Transient ranges (per-frame tables) are carved linearly from [maxPersistent, maxPersistent + transientCapacity)
+///   and recycled by fence value, exactly like the upload ring.
+/// Not thread safe, the device side wrapper locks.
+/// </summary>
+class DescriptorAllocator
+{
+public:
+	static uint32_t const PAGE_SIZE = 256;
+
+	void Init(uint32_t initialPersistent, uint32_t maxPersistent, uint32_t transientCapacity);
+
+	// Grows the persistent region if needed. Returns false once `maxPersistent` is exhausted.
+	bool AllocatePersistent(uint32_t count, DescriptorRange& range);
+	// The range stays reserved until the frame currently being recorded has retired.
+	void FreePersistent(const DescriptorRange& range);
+	bool AllocateTransient(uint32_t count, DescriptorRange& range);
+
+	// Same contract as UploadRingBuffer: everything since the last call belongs to the frame signaling `fenceValue`.
+	void FinishFrame(uint64_t fenceValue);
+	void Retire(uint64_t completedFenceValue);
+
+	uint32_t GetPersistentCapacity() const { return m_persistent.GetCapacity(); }
+	uint32_t GetTransientBase() const { return m_maxPersistent; }
+	uint32_t GetTransientCapacity() const { return (uint32_t)m_transient.GetCapacity(); }
+	uint32_t GetHeapSize() const { return m_maxPersistent + (uint32_t)m_transient.GetCapacity(); }
+	DescriptorAllocatorStats GetStats() const;
+
+private:
+	struct PendingFree
+	{
+		uint64_t FenceValue;
+		DescriptorRange Range;
+	};
+
+	DescriptorRangeAllocator m_persistent;
+	UploadRingBuffer m_transient;
+	uint32_t m_maxPersistent = 0;
+	// Frees made during the current frame, and frees waiting for their frame's fence
+	std::vector<DescriptorRange> m_frameFrees;
+	std::deque<PendingFree> m_pendingFrees;
+	DescriptorAllocatorStats m_stats;
+};
@@ -0,0 +1,473 @@
+#include "DrawDataCapture.h"
+#include <algorithm>
+#include <cstring>
+
+static uint32_t const               CAPTURE_VERSION = 1;
+static char const                   CAPTURE_MAGIC[4] = { 'I', 'M', 'D', 'C' };
+// Sanity limit for broken files, far above what a real frame has
+static uint32_t const               CAPTURE_MAX_LISTS = 1 << 16;
+static uint32_t const               LZ_MIN_MATCH = 4;
+static uint32_t const               LZ_MAX_OFFSET = 65535;
+static uint32_t const               LZ_HASH_BITS = 14;
+static uint32_t const               LZ_NO_POSITION = 0xFFFFFFFF;
+
+struct CaptureHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint32_t VertexSize;
+	uint32_t IndexSize;
+	// ImTextureID of the font atlas when the capture was made
+	uint64_t FontTexture;
+};
+
+struct CaptureFrameHeader
+{
+	float DisplayPos[2];
+	float DisplaySize[2];
+	float FramebufferScale[2];
+	float ClearColor[4];
+	uint32_t ListCount;
+};
+
+struct CaptureListHeader
+{
+	uint32_t Flags;
+	uint32_t CmdCount;
+	uint32_t VtxCount;
+	uint32_t IdxCount;
+};
+
+enum CaptureCallback : uint32_t
+{
+	CaptureCallback_None,
+	CaptureCallback_ResetRenderState,
+	// Anything else, dropped on replay
+	CaptureCallback_User,
+};
+
+struct CaptureCmd
+{
+	float ClipRect[4];
+	uint64_t TextureId;
+	uint32_t VtxOffset;
+	uint32_t IdxOffset;
+	uint32_t ElemCount;
+	uint32_t Callback;
+};
+
+// Every frame is a series of sections: the frame header, then per draw list its header, commands, vertices and
+// indices. Section i is delta encoded against section i of the previous frame.
+static uint32_t SectionIndex(uint32_t list, uint32_t part) { return 1 + list * 4 + part; }
+
+// LZ
+//
+// LZ4 style sequences: a token with the literal count in the high nibble and the match length - LZ_MIN_MATCH in the
+// low one (15 meaning more length bytes follow, each 255 meaning one more), the literals, then a 16-bit offset. The
+// last sequence has literals only, the decoder knows it from running out of input.
+
+static uint32_t Read32(const uint8_t* p)
+{
+	uint32_t value;
+	memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+static void LzWriteLength(std::vector<uint8_t>& out, size_t length)
+{
+	for (; length >= 255; length -= 255)
+		out.push_back(255);
+	out.push_back((uint8_t)length);
+}
+
+static void LzWriteSequence(std::vector<uint8_t>& out, const uint8_t* literals, size_t literalCount, size_t offset, size_t matchLength)
+{
+	size_t matchCode = matchLength > 0 ? matchLength - LZ_MIN_MATCH : 0;
+	out.push_back((uint8_t)((std::min<size_t>(literalCount, 15) << 4) | std::min<size_t>(matchCode, 15)));
+	if (literalCount >= 15)
+		LzWriteLength(out, literalCount - 15);
+	out.insert(out.end(), literals, literals + literalCount);
+	if (matchLength == 0)
+		return;
+	out.push_back((uint8_t)(offset & 0xFF));
+	out.push_back((uint8_t)(offset >> 8));
+	if (matchCode >= 15)
+		LzWriteLength(out, matchCode - 15);
+}
+
+static void LzCompress(const uint8_t* src, size_t size, std::vector<uint8_t>& out)
+{
+	static thread_local uint32_t table[1 << LZ_HASH_BITS];
+	std::fill(table, table + (1 << LZ_HASH_BITS), LZ_NO_POSITION);
+	out.clear();
+
+	size_t anchor = 0;
+	size_t i = 0;
+	uint32_t misses = 0;
+	while (i + LZ_MIN_MATCH <= size)
+	{
+		uint32_t sequence = Read32(src + i);
+		uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+		uint32_t candidate = table[hash];
+		table[hash] = (uint32_t)i;
+		if (candidate == LZ_NO_POSITION || i - candidate > LZ_MAX_OFFSET || Read32(src + candidate) != sequence)
+		{
+			// Skip ahead faster the longer nothing matches, incompressible data (e.g. new vertices) stays cheap
+			i += 1 + (misses++ >> 5);
+			continue;
+		}
+		misses = 0;
+		size_t length = LZ_MIN_MATCH;
+		while (i + length < size && src[candidate + length] == src[i + length])
+			length++;
+		LzWriteSequence(out, src + anchor, i - anchor, i - candidate, length);
+		i += length;
+		anchor = i;
+	}
+	LzWriteSequence(out, src + anchor, size - anchor, 0, 0);
+}
+
+static bool LzReadLength(const uint8_t* src, size_t srcSize, size_t& ip, size_t& length)
+{
+	uint8_t byte;
+	do
+	{
+		if (ip >= srcSize)
+			return false;
+		byte = src[ip++];
+		length += byte;
+	} while (byte == 255);
+	return true;
+}
+
+static bool LzDecompress(const uint8_t* src, size_t srcSize, uint8_t* dst, size_t dstSize)
+{
+	size_t ip = 0;
+	size_t op = 0;
+	while (ip < srcSize)
+	{
+		uint8_t token = src[ip++];
+		size_t literalCount = token >> 4;
+		if (literalCount == 15 && !LzReadLength(src, srcSize, ip, literalCount))
+			return false;
+		if (literalCount > srcSize - ip || literalCount > dstSize - op)
+			return false;
+		memcpy(dst + op, src + ip, literalCount);
+		ip += literalCount;
+		op += literalCount;
+		if (ip == srcSize)
+			break;
+
+		if (srcSize - ip < 2)
+			return false;
+		size_t offset = src[ip] | ((size_t)src[ip + 1] << 8);
+		ip += 2;
+		size_t length = token & 15;
+		if (length == 15 && !LzReadLength(src, srcSize, ip, length))
+			return false;
+		length += LZ_MIN_MATCH;
+		if (offset == 0 || offset > op || length > dstSize - op)
+			return false;
+		// Overlapping matches repeat the last `offset` bytes, copy in chunks that double every time
+		size_t from = op - offset;
+		while (length > 0)
+		{
+			size_t chunk = std::min(length, op - from);
+			memcpy(dst + op, dst + from, chunk);
+			op += chunk;
+			length -= chunk;
+		}
+	}
+	return op == dstSize;
+}
+
+// Delta
+
+static void AppendDelta(std::vector<uint8_t>& out, const void* data, size_t size, std::vector<uint8_t>& previous)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	size_t common = std::min(size, previous.size());
+	size_t base = out.size();
+	out.resize(base + size);
+	for (size_t i = 0; i < common; i++)
+		out[base + i] = (uint8_t)(bytes[i] - previous[i]);
+	if (size > common)
+		memcpy(out.data() + base + common, bytes + common, size - common);
+	previous.assign(bytes, bytes + size);
+}
+
+struct CaptureReader
+{
+	const uint8_t* Data;
+	size_t Size;
+	size_t Position;
+
+	// Undoes AppendDelta(). `changed` is set if the section differs from the previous frame's.
+	bool ReadDelta(void* dst, size_t size, std::vector<uint8_t>& previous, bool& changed)
+	{
+		if (size > Size - Position)
+			return false;
+		const uint8_t* src = Data + Position;
+		uint8_t* out = static_cast<uint8_t*>(dst);
+		size_t common = std::min(size, previous.size());
+		uint8_t differences = 0;
+		for (size_t i = 0; i < common; i++)
+		{
+			differences |= src[i];
+			out[i] = (uint8_t)(src[i] + previous[i]);
+		}
+		if (size > common)
+			memcpy(out + common, src + common, size - common);
+		changed |= differences != 0 || size != previous.size();
+		previous.assign(out, out + size);
+		Position += size;
+		return true;
+	}
+};
+
+// Recorder
+
+bool DrawDataRecorder::Open(const char* path)
+{
+	Close();
+	m_file = fopen(path, "wb");
+	if (!m_file)
+		return false;
+	m_headerWritten = false;
+	m_history.Reset();
+	m_stats = DrawDataCaptureStats();
+	return true;
+}
+
+bool DrawDataRecorder::WriteFrame(const DX12Playground::UIFrame& frame)
+{
+	if (!m_file || frame.DrawData == nullptr)
+		return false;
+
+	// Written with the first frame, backends create the font texture in their first NewFrame()
+	if (!m_headerWritten)
+	{
+		CaptureHeader header;
+		memcpy(header.Magic, CAPTURE_MAGIC, sizeof(header.Magic));
+		header.Version = CAPTURE_VERSION;
+		header.VertexSize = sizeof(ImDrawVert);
+		header.IndexSize = sizeof(ImDrawIdx);
+		header.FontTexture = (uint64_t)(uintptr_t)ImGui::GetIO().Fonts->TexID;
+		if (fwrite(&header, sizeof(header), 1, m_file) != 1)
+			return false;
+		m_headerWritten = true;
+	}
+
+	const ImDrawData* drawData = frame.DrawData;
+	m_raw.clear();
+	CaptureFrameHeader header = {
+		{ drawData->DisplayPos.x, drawData->DisplayPos.y },
+		{ drawData->DisplaySize.x, drawData->DisplaySize.y },
+		{ drawData->FramebufferScale.x, drawData->FramebufferScale.y },
+		{ frame.ClearColor.x, frame.ClearColor.y, frame.ClearColor.z, frame.ClearColor.w },
+		(uint32_t)drawData->CmdListsCount };
+	AppendDelta(m_raw, &header, sizeof(header), m_history.Get(0));
+
+	std::vector<CaptureCmd> cmds;
+	for (uint32_t n = 0; n < header.ListCount; n++)
+	{
+		const ImDrawList* list = drawData->CmdLists[n];
+		CaptureListHeader listHeader = { (uint32_t)list->Flags, (uint32_t)list->CmdBuffer.Size, (uint32_t)list->VtxBuffer.Size, (uint32_t)list->IdxBuffer.Size };
+		AppendDelta(m_raw, &listHeader, sizeof(listHeader), m_history.Get(SectionIndex(n, 0)));
+
+		cmds.resize(list->CmdBuffer.Size);
+		for (int c = 0; c < list->CmdBuffer.Size; c++)
+		{
+			const ImDrawCmd& src = list->CmdBuffer[c];
+			CaptureCmd& dst = cmds[c];
+			memset(&dst, 0, sizeof(dst));
+			memcpy(dst.ClipRect, &src.ClipRect, sizeof(dst.ClipRect));
+			dst.TextureId = (uint64_t)(uintptr_t)src.TextureId;
+			dst.VtxOffset = src.VtxOffset;
+			dst.IdxOffset = src.IdxOffset;
+			dst.ElemCount = src.ElemCount;
+			dst.Callback = src.UserCallback == nullptr ? CaptureCallback_None :
+				src.UserCallback == ImDrawCallback_ResetRenderState ? CaptureCallback_ResetRenderState : CaptureCallback_User;
+		}
+		AppendDelta(m_raw, cmds.data(), cmds.size() * sizeof(CaptureCmd), m_history.Get(SectionIndex(n, 1)));
+		AppendDelta(m_raw, list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes(), m_history.Get(SectionIndex(n, 2)));
+		AppendDelta(m_raw, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes(), m_history.Get(SectionIndex(n, 3)));
+	}
+
+	LzCompress(m_raw.data(), m_raw.size(), m_compressed);
+	uint32_t sizes[2] = { (uint32_t)m_raw.size(), (uint32_t)m_compressed.size() };
+	if (fwrite(sizes, sizeof(sizes), 1, m_file) != 1 || fwrite(m_compressed.data(), 1, m_compressed.size(), m_file) != m_compressed.size())
+		return false;
+	m_stats.Frames++;
+	m_stats.RawBytes += m_raw.size();
+	m_stats.CompressedBytes += m_compressed.size() + sizeof(sizes);
+	return true;
+}
+
+void DrawDataRecorder::Close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = nullptr;
+}
+
+// Player
+
+bool DrawDataPlayer::Open(const char* path)
+{
+	Close();
+	m_file = fopen(path, "rb");
+	if (!m_file)
+		return false;
+	CaptureHeader header;
+	if (fread(&header, sizeof(header), 1, m_file) != 1 || memcmp(header.Magic, CAPTURE_MAGIC, sizeof(header.Magic)) != 0 ||
+		header.Version != CAPTURE_VERSION || header.VertexSize != sizeof(ImDrawVert) || header.IndexSize != sizeof(ImDrawIdx))
+	{
+		Close();
+		return false;
+	}
+	m_capturedFontTexture = header.FontTexture;
+	m_firstFrameOffset = ftell(m_file);
+	m_history.Reset();
+	m_stats = DrawDataCaptureStats();
+	return true;
+}
+
+DrawDataPlayer::ReadResult DrawDataPlayer::ReadFrame(FrameCopy& copy, bool& changed)
+{
+	uint32_t sizes[2];
+	if (fread(sizes, sizeof(sizes), 1, m_file) != 1)
+		return ReadResult::EndOfFile;
+	// A frame can't be bigger than the file, which also stops broken sizes from allocating gigabytes
+	long start = ftell(m_file);
+	if (fseek(m_file, 0, SEEK_END) != 0)
+		return ReadResult::Broken;
+	long end = ftell(m_file);
+	fseek(m_file, start, SEEK_SET);
+	if (sizes[1] > (uint64_t)(end - start))
+		return ReadResult::EndOfFile;
+	// LZ can't expand by more than 255 times
+	if (sizes[0] / 255 > sizes[1])
+		return ReadResult::Broken;
+	m_compressed.resize(sizes[1]);
+	m_raw.resize(sizes[0]);
+	if (fread(m_compressed.data(), 1, m_compressed.size(), m_file) != m_compressed.size())
+		return ReadResult::EndOfFile;
+	if (!LzDecompress(m_compressed.data(), m_compressed.size(), m_raw.data(), m_raw.size()))
+		return ReadResult::Broken;
+
+	CaptureReader in = { m_raw.data(), m_raw.size(), 0 };
+	CaptureFrameHeader header;
+	if (!in.ReadDelta(&header, sizeof(header), m_history.Get(0), changed) || header.ListCount > CAPTURE_MAX_LISTS)
+		return ReadResult::Broken;
+	while (copy.DrawLists.Size < (int)header.ListCount)
+		copy.DrawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+
+	ImTextureID fontTexture = ImGui::GetIO().Fonts->TexID;
+	std::vector<CaptureCmd> cmds;
+	int totalVtxCount = 0;
+	int totalIdxCount = 0;
+	for (uint32_t n = 0; n < header.ListCount; n++)
+	{
+		ImDrawList* list = copy.DrawLists[n];
+		CaptureListHeader listHeader;
+		if (!in.ReadDelta(&listHeader, sizeof(listHeader), m_history.Get(SectionIndex(n, 0)), changed))
+			return ReadResult::Broken;
+		// Checked against what is left before resizing anything, so broken counts can't allocate much
+		size_t remaining = in.Size - in.Position;
+		if (listHeader.CmdCount > remaining / sizeof(CaptureCmd) || listHeader.VtxCount > remaining / sizeof(ImDrawVert) ||
+			listHeader.IdxCount > remaining / sizeof(ImDrawIdx))
+			return ReadResult::Broken;
+
+		cmds.resize(listHeader.CmdCount);
+		list->CmdBuffer.resize(listHeader.CmdCount);
+		list->VtxBuffer.resize(listHeader.VtxCount);
+		list->IdxBuffer.resize(listHeader.IdxCount);
+		list->Flags = (ImDrawListFlags)listHeader.Flags;
+		if (!in.ReadDelta(cmds.data(), cmds.size() * sizeof(CaptureCmd), m_history.Get(SectionIndex(n, 1)), changed) ||
+			!in.ReadDelta(list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes(), m_history.Get(SectionIndex(n, 2)), changed) ||
+			!in.ReadDelta(list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes(), m_history.Get(SectionIndex(n, 3)), changed))
+			return ReadResult::Broken;
+
+		for (uint32_t c = 0; c < listHeader.CmdCount; c++)
+		{
+			const CaptureCmd& src = cmds[c];
+			ImDrawCmd& dst = list->CmdBuffer[c];
+			dst = ImDrawCmd();
+			memcpy(&dst.ClipRect, src.ClipRect, sizeof(src.ClipRect));
+			// Textures of another process mean nothing here, only the font atlas can be matched up
+			dst.TextureId = fontTexture;
+			if (src.TextureId != m_capturedFontTexture)
+				m_stats.RemappedTextures++;
+			dst.VtxOffset = src.VtxOffset;
+			dst.IdxOffset = src.IdxOffset;
+			dst.ElemCount = src.ElemCount;
+			if (src.Callback == CaptureCallback_ResetRenderState)
+				dst.UserCallback = ImDrawCallback_ResetRenderState;
+			else if (src.Callback == CaptureCallback_User)
+				dst.ElemCount = 0;
+			if ((uint64_t)dst.IdxOffset + dst.ElemCount > listHeader.IdxCount)
+				return ReadResult::Broken;
+			// Every index must address a vertex of the list, renderers read them unchecked
+			uint32_t maxIndex = 0;
+			for (uint32_t i = dst.IdxOffset; i < dst.IdxOffset + dst.ElemCount; i++)
+				maxIndex = std::max(maxIndex, (uint32_t)list->IdxBuffer.Data[i]);
+			if (dst.ElemCount > 0 && (uint64_t)dst.VtxOffset + maxIndex >= listHeader.VtxCount)
+				return ReadResult::Broken;
+		}
+		totalVtxCount += (int)listHeader.VtxCount;
+		totalIdxCount += (int)listHeader.IdxCount;
+	}
+
+	copy.DrawData.Clear();
+	copy.DrawData.Valid = true;
+	copy.DrawData.CmdListsCount = (int)header.ListCount;
+	copy.DrawData.CmdLists = copy.DrawLists.Data;
+	copy.DrawData.TotalVtxCount = totalVtxCount;
+	copy.DrawData.TotalIdxCount = totalIdxCount;
+	copy.DrawData.DisplayPos = ImVec2(header.DisplayPos[0], header.DisplayPos[1]);
+	copy.DrawData.DisplaySize = ImVec2(header.DisplaySize[0], header.DisplaySize[1]);
+	copy.DrawData.FramebufferScale = ImVec2(header.FramebufferScale[0], header.FramebufferScale[1]);
+	copy.Frame.DrawData = &copy.DrawData;
+	copy.Frame.ClearColor = ImVec4(header.ClearColor[0], header.ClearColor[1], header.ClearColor[2], header.ClearColor[3]);
+
+	m_stats.Frames++;
+	m_stats.RawBytes += m_raw.size();
+	m_stats.CompressedBytes += m_compressed.size() + sizeof(sizes);
+	return ReadResult::Ok;
+}
+
+const DX12Playground::UIFrame* DrawDataPlayer::NextFrame()
+{
+	if (!m_file)
+		return nullptr;
+	FrameCopy& copy = m_frames[m_nextFrame];
+	m_nextFrame = (m_nextFrame + 1) % NUM_FRAME_COPIES;
+
+	bool changed = false;
+	ReadResult result = ReadFrame(copy, changed);
+	if (result == ReadResult::EndOfFile && m_stats.Frames > 0)
+	{
+		fseek(m_file, m_firstFrameOffset, SEEK_SET);
+		m_history.Reset();
+		changed = false;
+		result = ReadFrame(copy, changed);
+	}
+	if (result != ReadResult::Ok)
+		return nullptr;
+	copy.Frame.Changed = changed;
+	return &copy.Frame;
+}
+
+void DrawDataPlayer::Close()
+{
+	if (m_file)
+		fclose(m_file);
+	m_file = nullptr;
+	for (FrameCopy& copy : m_frames)
+	{
+		for (ImDrawList* drawList : copy.DrawLists)
+			IM_DELETE(drawList);
+		copy.DrawLists.clear();
+	}
+}
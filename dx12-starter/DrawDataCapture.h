@@ -0,0 +1,105 @@
+#pragma once
+#include "UI.h"
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+struct DrawDataCaptureStats
+{
+	uint64_t Frames = 0;
+	// Serialized frames before and after compression
+	uint64_t RawBytes = 0;
+	uint64_t CompressedBytes = 0;
+	// Player only: commands whose texture is unknown in this process, drawn with the font atlas instead
+	uint64_t RemappedTextures = 0;
+};
+
+/// <summary>
+/// Per draw list byte buffers of the previous frame. Both sides of a capture keep one in lockstep: every section is
+/// stored as the byte-wise difference to the same section of the same draw list one frame earlier, which turns a UI
+/// that barely changes into long runs of zeros for the LZ pass.
+/// </summary>
+class DrawDataDeltaHistory
+{
+public:
+	void Reset() { m_sections.clear(); }
+	std::vector<uint8_t>& Get(uint32_t index)
+	{
+		if (index >= m_sections.size())
+			m_sections.resize(index + 1);
+		return m_sections[index];
+	}
+
+private:
+	std::vector<std::vector<uint8_t>> m_sections;
+};
+
+/// <summary>
+/// Writes UI frames (draw lists with their commands, clip rects, texture IDs, vertices and indices, plus the clear
+/// color) to a capture file. Each frame is delta encoded against the previous one and LZ compressed on its own, so
+/// hour long captures of a mostly static UI stay small and the player only ever holds two frames.
+/// User callbacks are not captured, except for ImDrawCallback_ResetRenderState.
+/// </summary>
+class DrawDataRecorder
+{
+public:
+	~DrawDataRecorder() { Close(); }
+	bool Open(const char* path);
+	bool WriteFrame(const DX12Playground::UIFrame& frame);
+	void Close();
+	const DrawDataCaptureStats& GetStats() const { return m_stats; }
+
+private:
+	FILE* m_file = nullptr;
+	bool                         m_headerWritten = false;
+	DrawDataDeltaHistory         m_history;
+	std::vector<uint8_t>         m_raw;
+	std::vector<uint8_t>         m_compressed;
+	DrawDataCaptureStats         m_stats;
+};
+
+/// <summary>
+/// Reads a capture back as UI frames any renderer backend can draw, starting over at the end of the file so runs of
+/// any length replay the same input. Frames are rebuilt into draw lists of the current imgui context; the font
+/// atlas texture ID of the capture is mapped to the current one.
+/// </summary>
+class DrawDataPlayer
+{
+public:
+	~DrawDataPlayer() { Close(); }
+	// Needs a current imgui context
+	bool Open(const char* path);
+	// Returns nullptr if the file is broken. The frame stays valid until NextFrame() is called twice more.
+	const DX12Playground::UIFrame* NextFrame();
+	void Close();
+	const DrawDataCaptureStats& GetStats() const { return m_stats; }
+
+private:
+	static int const NUM_FRAME_COPIES = 2;
+
+	struct FrameCopy
+	{
+		DX12Playground::UIFrame Frame;
+		ImDrawData DrawData;
+		ImVector<ImDrawList*> DrawLists;
+	};
+
+	enum class ReadResult
+	{
+		Ok,
+		// Nothing or only part of a frame left, e.g. a capture cut short by a crash
+		EndOfFile,
+		Broken,
+	};
+	ReadResult ReadFrame(FrameCopy& copy, bool& changed);
+
+	FILE* m_file = nullptr;
+	long                         m_firstFrameOffset = 0;
+	uint64_t                     m_capturedFontTexture = 0;
+	DrawDataDeltaHistory         m_history;
+	std::vector<uint8_t>         m_raw;
+	std::vector<uint8_t>         m_compressed;
+	FrameCopy                    m_frames[NUM_FRAME_COPIES];
+	int                          m_nextFrame = 0;
+	DrawDataCaptureStats         m_stats;
+};
@@ -0,0 +1,466 @@
+#include "FontAtlasCache.h"
+#include "Profiler.h"
+#include "imgui_internal.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static uint32_t const               ATLAS_CACHE_VERSION = 1;
+static char const                   ATLAS_CACHE_MAGIC[4] = { 'I', 'M', 'F', 'A' };
+// Same limit as imgui's packer
+static int const                    ATLAS_CACHE_MAX_TEX_SIZE = 1024 * 32;
+
+struct AtlasCacheHeader
+{
+	char Magic[4];
+	uint32_t Version;
+	uint64_t Key;
+	int32_t TexWidth;
+	int32_t TexHeight;
+	uint32_t FontCount;
+	uint32_t CustomRectCount;
+	// Of the whole file, to catch truncated writes
+	uint64_t FileSize;
+	// Of everything after the header, to catch a corrupted file before it corrupts the atlas
+	uint64_t PayloadHash;
+};
+
+struct AtlasCacheRect
+{
+	uint16_t X;
+	uint16_t Y;
+};
+
+// Followed by its glyphs. The glyphs imgui adds for custom rects are left out, ImFontAtlasBuildFinish() adds them.
+struct AtlasCacheFont
+{
+	int32_t Loaded;
+	int32_t ConfigIndex;
+	int32_t ConfigDataCount;
+	float FontSize;
+	float Ascent;
+	float Descent;
+	int32_t MetricsTotalSurface;
+	uint32_t GlyphCount;
+};
+
+// 64-bit multiplicative hash, a word at a time so that hashing megabytes of CJK font data stays cheap
+class KeyHasher
+{
+public:
+	void Add(const void* data, size_t size)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+		for (; size >= 8; bytes += 8, size -= 8)
+		{
+			uint64_t word;
+			memcpy(&word, bytes, 8);
+			Mix(word);
+		}
+		uint64_t tail = 0;
+		memcpy(&tail, bytes, size);
+		Mix(tail ^ ((uint64_t)size << 56));
+	}
+	template<typename T>
+	void AddValue(const T& value) { Add(&value, sizeof(value)); }
+	uint64_t Finish() const
+	{
+		uint64_t h = m_value;
+		h ^= h >> 33;
+		h *= 0xFF51AFD7ED558CCDull;
+		h ^= h >> 33;
+		h *= 0xC4CEB9FE1A85EC53ull;
+		h ^= h >> 33;
+		return h;
+	}
+
+private:
+	void Mix(uint64_t word)
+	{
+		m_value = ((m_value << 5) | (m_value >> 59)) ^ word;
+		m_value *= 0x9E3779B97F4A7C15ull;
+	}
+
+	uint64_t m_value = 0xCBF29CE484222325ull;
+};
+
+// Read-only view of a whole file
+class MappedFile
+{
+public:
+	~MappedFile() { Close(); }
+	bool Open(const char* path)
+	{
+#ifdef _WIN32
+		m_file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (m_file == INVALID_HANDLE_VALUE)
+			return false;
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0)
+			return false;
+		m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mapping == nullptr)
+			return false;
+		m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+		m_size = (size_t)size.QuadPart;
+#else
+		m_file = open(path, O_RDONLY);
+		if (m_file < 0)
+			return false;
+		struct stat info;
+		if (fstat(m_file, &info) != 0 || info.st_size == 0)
+			return false;
+		void* data = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+		m_data = data != MAP_FAILED ? static_cast<const uint8_t*>(data) : nullptr;
+		m_size = (size_t)info.st_size;
+#endif
+		return m_data != nullptr;
+	}
+	void Close()
+	{
+#ifdef _WIN32
+		if (m_data != nullptr)
+			UnmapViewOfFile(m_data);
+		if (m_mapping != nullptr)
+			CloseHandle(m_mapping);
+		if (m_file != INVALID_HANDLE_VALUE)
+			CloseHandle(m_file);
+		m_mapping = nullptr;
+		m_file = INVALID_HANDLE_VALUE;
+#else
+		if (m_data != nullptr)
+			munmap(const_cast<uint8_t*>(m_data), m_size);
+		if (m_file >= 0)
+			close(m_file);
+		m_file = -1;
+#endif
+		m_data = nullptr;
+		m_size = 0;
+	}
+	const uint8_t* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+#ifdef _WIN32
+	HANDLE m_file = INVALID_HANDLE_VALUE;
+	HANDLE m_mapping = nullptr;
+#else
+	int m_file = -1;
+#endif
+	const uint8_t* m_data = nullptr;
+	size_t m_size = 0;
+};
+
+// Bounds checked reads from the mapped file, into aligned copies
+class CacheReader
+{
+public:
+	CacheReader(const uint8_t* data, size_t size) : m_data(data), m_size(size) {}
+	const uint8_t* Skip(size_t size)
+	{
+		if (size > m_size - m_offset)
+			return nullptr;
+		const uint8_t* p = m_data + m_offset;
+		m_offset += size;
+		return p;
+	}
+	template<typename T>
+	bool Read(T& value)
+	{
+		const uint8_t* p = Skip(sizeof(T));
+		if (p != nullptr)
+			memcpy(&value, p, sizeof(T));
+		return p != nullptr;
+	}
+
+private:
+	const uint8_t* m_data;
+	size_t m_size;
+	size_t m_offset = 0;
+};
+
+static void Append(std::vector<uint8_t>& out, const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	out.insert(out.end(), bytes, bytes + size);
+}
+
+static int FindFontIndex(const ImFontAtlas* atlas, const ImFont* font)
+{
+	for (int i = 0; i < atlas->Fonts.Size; i++)
+		if (atlas->Fonts[i] == font)
+			return i;
+	return -1;
+}
+
+// Glyphs ImFontAtlasBuildFinish() appends to `font` for custom rects, after the ones from the font sources
+static int CountCustomRectGlyphs(const ImFontAtlas* atlas, const ImFont* font)
+{
+	int count = 0;
+	for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+		count += rect.Font == font && rect.GlyphID != 0 ? 1 : 0;
+	return count;
+}
+
+static void ParallelFor(int count, void (*func)(void* userData, int index), void* userData, void* jobs)
+{
+	static_cast<JobSystem*>(jobs)->ParallelFor((uint32_t)count, 1, [func, userData](uint32_t begin, uint32_t end)
+		{
+			for (uint32_t i = begin; i < end; i++)
+				func(userData, (int)i);
+		});
+}
+
+uint64_t FontAtlasCache::ComputeKey(ImFontAtlas* atlas)
+{
+	ImFontAtlasBuildInit(atlas);
+
+	KeyHasher hasher;
+	hasher.AddValue(ATLAS_CACHE_VERSION);
+	hasher.AddValue(sizeof(ImFontGlyph));
+	hasher.AddValue(sizeof(ImWchar));
+	hasher.AddValue(atlas->Flags);
+	hasher.AddValue(atlas->TexDesiredWidth);
+	hasher.AddValue(atlas->TexGlyphPadding);
+	hasher.AddValue(atlas->TexDistanceFieldSpread);
+	hasher.AddValue(atlas->Fonts.Size);
+	hasher.AddValue(atlas->ConfigData.Size);
+	for (const ImFontConfig& cfg : atlas->ConfigData)
+	{
+		hasher.AddValue(cfg.FontDataSize);
+		hasher.Add(cfg.FontData, (size_t)cfg.FontDataSize);
+		hasher.AddValue(cfg.FontNo);
+		hasher.AddValue(cfg.SizePixels);
+		hasher.AddValue(cfg.OversampleH);
+		hasher.AddValue(cfg.OversampleV);
+		hasher.AddValue(cfg.PixelSnapH);
+		hasher.AddValue(cfg.GlyphExtraSpacing);
+		hasher.AddValue(cfg.GlyphOffset);
+		hasher.AddValue(cfg.GlyphMinAdvanceX);
+		hasher.AddValue(cfg.GlyphMaxAdvanceX);
+		hasher.AddValue(cfg.MergeMode);
+		hasher.AddValue(cfg.FontBuilderFlags);
+		hasher.AddValue(cfg.RasterizerMultiply);
+		hasher.AddValue(cfg.EllipsisChar);
+		hasher.AddValue(FindFontIndex(atlas, cfg.DstFont));
+		// Up to and including the terminating zero
+		const ImWchar* ranges = cfg.GlyphRanges ? cfg.GlyphRanges : atlas->GetGlyphRangesDefault();
+		size_t rangesSize = 0;
+		while (ranges[rangesSize] != 0)
+			rangesSize++;
+		hasher.Add(ranges, (rangesSize + 1) * sizeof(ImWchar));
+	}
+	hasher.AddValue(atlas->CustomRects.Size);
+	for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+	{
+		hasher.AddValue(rect.Width);
+		hasher.AddValue(rect.Height);
+		hasher.AddValue(rect.GlyphID);
+		hasher.AddValue(rect.GlyphAdvanceX);
+		hasher.AddValue(rect.GlyphOffset);
+		hasher.AddValue(FindFontIndex(atlas, rect.Font));
+	}
+	return hasher.Finish();
+}
+
+bool FontAtlasCache::BuildInParallel(ImFontAtlas* atlas, JobSystem* jobs)
+{
+	PROFILE_ZONE("FontAtlasCache::BuildInParallel");
+	IM_ASSERT(!atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+	if (atlas->ConfigData.Size == 0)
+		atlas->AddFontDefault();
+	return ImFontAtlasBuildWithStbTruetypeEx(atlas, jobs != nullptr ? ParallelFor : nullptr, jobs);
+}
+
+bool FontAtlasCache::Load(ImFontAtlas* atlas, const char* path, uint64_t* fileBytes)
+{
+	PROFILE_ZONE("FontAtlasCache::Load");
+	IM_ASSERT(!atlas->Locked && "Cannot modify a locked ImFontAtlas between NewFrame() and EndFrame/Render()!");
+	if (atlas->ConfigData.Size == 0)
+		atlas->AddFontDefault();
+	uint64_t key = ComputeKey(atlas);
+
+	MappedFile file;
+	if (!file.Open(path))
+		return false;
+	CacheReader reader(file.GetData(), file.GetSize());
+	AtlasCacheHeader header;
+	if (!reader.Read(header) || memcmp(header.Magic, ATLAS_CACHE_MAGIC, sizeof(header.Magic)) != 0 ||
+		header.Version != ATLAS_CACHE_VERSION || header.Key != key || header.FileSize != file.GetSize() ||
+		header.FontCount != (uint32_t)atlas->Fonts.Size || header.CustomRectCount != (uint32_t)atlas->CustomRects.Size ||
+		header.TexWidth <= 0 || header.TexWidth > ATLAS_CACHE_MAX_TEX_SIZE || header.TexHeight <= 0 || header.TexHeight > ATLAS_CACHE_MAX_TEX_SIZE)
+		return false;
+
+	// Check everything before touching the atlas
+	KeyHasher payloadHasher;
+	payloadHasher.Add(file.GetData() + sizeof(header), file.GetSize() - sizeof(header));
+	if (payloadHasher.Finish() != header.PayloadHash)
+		return false;
+	const uint8_t* rects = reader.Skip(header.CustomRectCount * sizeof(AtlasCacheRect));
+	if (rects == nullptr)
+		return false;
+	for (uint32_t i = 0; i < header.CustomRectCount; i++)
+	{
+		AtlasCacheRect rect;
+		memcpy(&rect, rects + i * sizeof(AtlasCacheRect), sizeof(rect));
+		const ImFontAtlasCustomRect& custom = atlas->CustomRects[i];
+		if (rect.X + custom.Width > header.TexWidth || rect.Y + custom.Height > header.TexHeight)
+			return false;
+	}
+	std::vector<AtlasCacheFont> fonts(header.FontCount);
+	std::vector<const uint8_t*> glyphs(header.FontCount);
+	for (uint32_t i = 0; i < header.FontCount; i++)
+	{
+		AtlasCacheFont& font = fonts[i];
+		if (!reader.Read(font) || (font.Loaded != 0 && (font.ConfigIndex < 0 || font.ConfigIndex >= atlas->ConfigData.Size ||
+			atlas->ConfigData[font.ConfigIndex].DstFont != atlas->Fonts[i])))
+			return false;
+		glyphs[i] = reader.Skip(font.GlyphCount * sizeof(ImFontGlyph));
+		if (glyphs[i] == nullptr)
+			return false;
+	}
+	size_t pixelCount = (size_t)header.TexWidth * (size_t)header.TexHeight;
+	const uint8_t* pixels = reader.Skip(pixelCount);
+	if (pixels == nullptr)
+		return false;
+
+	// Same state ImFontAtlasBuildWithStbTruetype() leaves before finishing the build
+	atlas->TexID = (ImTextureID)NULL;
+	atlas->ClearTexData();
+	atlas->TexWidth = header.TexWidth;
+	atlas->TexHeight = header.TexHeight;
+	atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+	atlas->TexUvWhitePixel = ImVec2(0.0f, 0.0f);
+	atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixelCount);
+	memcpy(atlas->TexPixelsAlpha8, pixels, pixelCount);
+	for (uint32_t i = 0; i < header.CustomRectCount; i++)
+	{
+		AtlasCacheRect rect;
+		memcpy(&rect, rects + i * sizeof(AtlasCacheRect), sizeof(rect));
+		atlas->CustomRects[i].X = rect.X;
+		atlas->CustomRects[i].Y = rect.Y;
+	}
+	for (uint32_t i = 0; i < header.FontCount; i++)
+	{
+		const AtlasCacheFont& cached = fonts[i];
+		if (cached.Loaded == 0)
+			continue;
+		ImFont* font = atlas->Fonts[i];
+		font->ClearOutputData();
+		font->FontSize = cached.FontSize;
+		font->ConfigData = &atlas->ConfigData[cached.ConfigIndex];
+		font->ConfigDataCount = (short)cached.ConfigDataCount;
+		font->ContainerAtlas = atlas;
+		font->Ascent = cached.Ascent;
+		font->Descent = cached.Descent;
+		font->MetricsTotalSurface = cached.MetricsTotalSurface;
+		font->Glyphs.resize((int)cached.GlyphCount);
+		memcpy(font->Glyphs.Data, glyphs[i], cached.GlyphCount * sizeof(ImFontGlyph));
+	}
+
+	// Renders imgui's own rects again (same pixels), adds the custom rect glyphs and builds the lookup tables
+	ImFontAtlasBuildFinish(atlas);
+	if (fileBytes != nullptr)
+		*fileBytes = file.GetSize();
+	return true;
+}
+
+bool FontAtlasCache::Save(const ImFontAtlas* atlas, const char* path, uint64_t* fileBytes)
+{
+	PROFILE_ZONE("FontAtlasCache::Save");
+	IM_ASSERT(atlas->TexPixelsAlpha8 != nullptr && "Build the atlas first");
+	ImFontAtlas* mutableAtlas = const_cast<ImFontAtlas*>(atlas);
+
+	AtlasCacheHeader header = {};
+	memcpy(header.Magic, ATLAS_CACHE_MAGIC, sizeof(header.Magic));
+	header.Version = ATLAS_CACHE_VERSION;
+	// Only registers rects that a build already did
+	header.Key = ComputeKey(mutableAtlas);
+	header.TexWidth = atlas->TexWidth;
+	header.TexHeight = atlas->TexHeight;
+	header.FontCount = (uint32_t)atlas->Fonts.Size;
+	header.CustomRectCount = (uint32_t)atlas->CustomRects.Size;
+
+	// Assembled in memory first, the payload hash goes into the header
+	std::vector<uint8_t> payload;
+	for (uint32_t i = 0; i < header.CustomRectCount; i++)
+	{
+		AtlasCacheRect rect = { atlas->CustomRects[i].X, atlas->CustomRects[i].Y };
+		Append(payload, &rect, sizeof(rect));
+	}
+	for (uint32_t i = 0; i < header.FontCount; i++)
+	{
+		const ImFont* font = atlas->Fonts[i];
+		AtlasCacheFont cached;
+		memset(&cached, 0, sizeof(cached));
+		if (font->IsLoaded())
+		{
+			cached.Loaded = 1;
+			cached.ConfigIndex = (int32_t)(font->ConfigData - atlas->ConfigData.Data);
+			cached.ConfigDataCount = font->ConfigDataCount;
+			cached.FontSize = font->FontSize;
+			cached.Ascent = font->Ascent;
+			cached.Descent = font->Descent;
+			cached.MetricsTotalSurface = font->MetricsTotalSurface;
+			cached.GlyphCount = (uint32_t)(font->Glyphs.Size - CountCustomRectGlyphs(atlas, font));
+		}
+		Append(payload, &cached, sizeof(cached));
+		Append(payload, font->Glyphs.Data, cached.GlyphCount * sizeof(ImFontGlyph));
+	}
+	Append(payload, atlas->TexPixelsAlpha8, (size_t)atlas->TexWidth * atlas->TexHeight);
+	KeyHasher payloadHasher;
+	payloadHasher.Add(payload.data(), payload.size());
+	header.PayloadHash = payloadHasher.Finish();
+	header.FileSize = sizeof(header) + payload.size();
+
+	std::string tempPath = std::string(path) + ".tmp";
+	FILE* file = fopen(tempPath.c_str(), "wb");
+	if (file == nullptr)
+		return false;
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1 && fwrite(payload.data(), 1, payload.size(), file) == payload.size();
+	ok = fclose(file) == 0 && ok;
+
+	// rename() doesn't replace an existing file on Windows
+	remove(path);
+	if (!ok || rename(tempPath.c_str(), path) != 0)
+	{
+		remove(tempPath.c_str());
+		return false;
+	}
+	if (fileBytes != nullptr)
+		*fileBytes = header.FileSize;
+	return true;
+}
+
+bool FontAtlasCache::Build(ImFontAtlas* atlas, const char* path, JobSystem* jobs)
+{
+	PROFILE_ZONE("FontAtlasCache::Build");
+	auto start = std::chrono::steady_clock::now();
+	m_stats = FontAtlasCacheStats();
+
+	bool ok = path != nullptr && Load(atlas, path, &m_stats.FileBytes);
+	m_stats.Hit = ok;
+	if (!ok)
+	{
+		ok = BuildInParallel(atlas, jobs);
+		m_stats.Written = ok && path != nullptr && Save(atlas, path, &m_stats.FileBytes);
+	}
+
+	for (const ImFont* font : atlas->Fonts)
+		m_stats.Glyphs += (uint32_t)font->Glyphs.Size;
+	m_stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return ok;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "JobSystem.h"
+#include "imgui.h"
+#include <cstdint>
+
+struct FontAtlasCacheStats
+{
+	// Loaded from the cache file. Otherwise the atlas was built, and `Written` back if there is a cache path.
+	bool Hit = false;
+	bool Written = false;
+	double Seconds = 0.0;
+	uint32_t Glyphs = 0;
+	uint64_t FileBytes = 0;
+};
+
+/// <summary>
+/// Builds an imgui font atlas, or maps it from a cache file written by an earlier run. The file holds the packed alpha
+/// pixels, the custom rect positions and every font's glyph table, and is keyed on everything that goes into the atlas
+/// (font bytes, sizes, glyph ranges, oversampling, custom rects...), so any change to the fonts is a miss.
+/// Misses build with stb_truetype, measuring and rasterizing the glyphs of each font source in batches on the job
+/// system. The result is identical to ImFontAtlas::Build(), except that a custom FontBuilderIO is ignored.
+/// </summary>
+class FontAtlasCache
+{
+public:
+	// Main thread, after the fonts are added and before anything asks the atlas for its pixels. `path` can be null to
+	// always build, `jobs` null to build on the calling thread only.
+	bool Build(ImFontAtlas* atlas, const char* path, JobSystem* jobs);
+	const FontAtlasCacheStats& GetStats() const { return m_stats; }
+
+	static bool BuildInParallel(ImFontAtlas* atlas, JobSystem* jobs);
+	// Fails without touching the atlas if the file is missing, broken or made for other fonts
+	static bool Load(ImFontAtlas* atlas, const char* path, uint64_t* fileBytes = nullptr);
+	// Needs a built atlas. Writes to a temporary file first, so a crash never leaves a truncated cache behind.
+	static bool Save(const ImFontAtlas* atlas, const char* path, uint64_t* fileBytes = nullptr);
+	// Registers imgui's own custom rects first, as they are part of the key
+	static uint64_t ComputeKey(ImFontAtlas* atlas);
+
+private:
+	FontAtlasCacheStats m_stats;
+};
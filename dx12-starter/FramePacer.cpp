@@ -0,0 +1,155 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+// Intervals between ready frames outside this range don't come from the display: shorter means the swap chain isn't
+// throttling at all (no vsync, null device), longer is a hitch or the app sleeping while idle
+static double const                 MIN_REFRESH_PERIOD = 0.002;
+static double const                 MAX_REFRESH_PERIOD = 0.05;
+// A frame only counts as released by the display if the swap chain held it back at least this long after the
+// previous present. Frames that never wait are CPU bound, their intervals say nothing about the refresh rate.
+static double const                 MIN_THROTTLED_WAIT = 0.0002;
+// Samples needed before the estimates are trusted
+static int const                    MIN_READY_SAMPLES = 8;
+static int const                    MIN_WORK_SAMPLES = 4;
+// Safety margin on top of the predicted work, in seconds
+static double const                 MARGIN_INITIAL = 0.001;
+static double const                 MARGIN_MIN = 0.0005;
+static double const                 MARGIN_GROW = 0.001;
+static double const                 MARGIN_SHRINK = 0.00025;
+static uint32_t const               MARGIN_SHRINK_FRAMES = 120;
+
+// System clock
+
+double SystemFrameClock::Now()
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void SystemFrameClock::SleepUntil(double time)
+{
+	// OS sleeps overshoot by up to a scheduler tick, so only sleep while that can't matter and yield for the rest
+	for (;;)
+	{
+		double remaining = time - Now();
+		if (remaining <= 0.0)
+			return;
+		if (remaining > 0.003)
+			std::this_thread::sleep_for(std::chrono::duration<double>(remaining - 0.002));
+		else
+			std::this_thread::yield();
+	}
+}
+
+// Pacer
+
+void FramePacer::Init(const FramePacerConfig& config, FrameClock* clock)
+{
+	m_config = config;
+	m_config.maxLatency = std::min(std::max(m_config.maxLatency, 1u), 3u);
+	m_clock = clock;
+	m_readyTime = -1.0;
+	m_presentTime = -1.0;
+	m_readyThrottled = false;
+	m_presentLate = false;
+	m_deadline = 0.0;
+	m_readyCount = 0;
+	m_workCount = 0;
+	m_framesSinceMiss = 0;
+	m_stats = FramePacerStats();
+	m_stats.Margin = MARGIN_INITIAL;
+}
+
+double FramePacer::Percentile(const double* values, int count, double percentile)
+{
+	double sorted[HISTORY_SIZE];
+	std::copy(values, values + count, sorted);
+	int index = std::min(count - 1, (int)(percentile * count));
+	std::nth_element(sorted, sorted + index, sorted + count);
+	return sorted[index];
+}
+
+void FramePacer::FrameReady()
+{
+	double now = m_clock->Now();
+	bool throttled = m_presentTime >= 0.0 && now - m_presentTime >= MIN_THROTTLED_WAIT;
+	if (throttled && m_readyThrottled)
+	{
+		double interval = now - m_readyTime;
+		if (interval <= MAX_REFRESH_PERIOD)
+			m_readyIntervals[m_readyCount++ % HISTORY_SIZE] = interval;
+
+		// Presented in time, but the display still skipped a refresh before releasing this frame: the GPU work after
+		// Present() counts towards the deadline too, and this is the only place it shows up
+		if (m_deadline != 0.0 && !m_presentLate && interval > m_stats.RefreshPeriod * 1.5)
+			MissedDeadline(true);
+	}
+	m_readyTime = now;
+	m_readyThrottled = throttled;
+
+	// The swap chain releases a frame right after a refresh, so the lower end of the intervals is the refresh period.
+	// Slow frames only ever make intervals longer.
+	m_stats.RefreshPeriod = 0.0;
+	int readySamples = std::min(m_readyCount, (int)HISTORY_SIZE);
+	if (m_config.vsync && readySamples >= MIN_READY_SAMPLES)
+	{
+		double period = Percentile(m_readyIntervals, readySamples, 0.25);
+		if (period >= MIN_REFRESH_PERIOD)
+			m_stats.RefreshPeriod = period;
+	}
+	m_deadline = m_stats.RefreshPeriod > 0.0 ? now + m_stats.RefreshPeriod : 0.0;
+}
+
+void FramePacer::WaitForInputSample()
+{
+	int workSamples = std::min(m_workCount, (int)HISTORY_SIZE);
+	m_stats.PredictedWork = workSamples > 0 ? Percentile(m_workDurations, workSamples, 0.9) : 0.0;
+	if (!m_config.justInTime || m_deadline == 0.0 || workSamples < MIN_WORK_SAMPLES)
+		return;
+
+	double sampleTime = m_deadline - m_stats.PredictedWork - m_stats.Margin;
+	double now = m_clock->Now();
+	if (sampleTime <= now)
+		return;
+	m_clock->SleepUntil(sampleTime);
+	m_stats.TotalSleep += m_clock->Now() - now;
+}
+
+void FramePacer::Presented(double inputTime)
+{
+	double now = m_clock->Now();
+	double work = now - inputTime;
+	m_workDurations[m_workCount++ % HISTORY_SIZE] = work;
+	m_presentTime = now;
+
+	m_stats.Frames++;
+	m_stats.LastInputToPresent = work;
+	m_stats.TotalInputToPresent += work;
+	m_stats.MaxInputToPresent = std::max(m_stats.MaxInputToPresent, work);
+
+	m_presentLate = false;
+	if (m_deadline == 0.0)
+		return;
+	m_presentLate = now > m_deadline;
+	if (m_presentLate)
+	{
+		// Unless the frame was a hitch far beyond the prediction: no margin would have absorbed that, and growing it
+		// only costs latency on every other frame
+		MissedDeadline(work <= m_stats.PredictedWork + m_stats.Margin + MARGIN_GROW);
+	}
+	else if (++m_framesSinceMiss >= MARGIN_SHRINK_FRAMES)
+	{
+		m_stats.Margin = std::max(m_stats.Margin - MARGIN_SHRINK, MARGIN_MIN);
+		m_framesSinceMiss = 0;
+	}
+}
+
+void FramePacer::MissedDeadline(bool growMargin)
+{
+	// Sample earlier from now on
+	m_stats.MissedDeadlines++;
+	if (growMargin)
+		m_stats.Margin = std::min(m_stats.Margin + MARGIN_GROW, m_stats.RefreshPeriod * 0.5);
+	m_framesSinceMiss = 0;
+}
@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+
+/// <summary>
+/// Time source for the FramePacer, in seconds. The pacer never reads the time any other way, so a simulated clock
+/// can drive it through any sequence of frames.
+/// </summary>
+class FrameClock
+{
+public:
+	virtual ~FrameClock() = default;
+	virtual double Now() = 0;
+	virtual void SleepUntil(double time) = 0;
+};
+
+/// <summary>
+/// steady_clock, sleeping in the OS scheduler until the last millisecond and yielding after that.
+/// </summary>
+class SystemFrameClock : public FrameClock
+{
+public:
+	double Now() override;
+	void SleepUntil(double time) override;
+};
+
+struct FramePacerConfig
+{
+	// Frames queued ahead of the display, 1 to 3. Lower is less input latency, higher absorbs more hitches.
+	uint32_t maxLatency = 2;
+	bool vsync = true;
+	// Without vsync, present with tearing allowed where the swap chain supports it
+	bool tearing = false;
+	// Delay sampling input (and everything after it) until just enough time is left to make the next refresh
+	bool justInTime = true;
+};
+
+struct FramePacerStats
+{
+	uint64_t Frames = 0;
+	// Input sampled to Present() returned, in seconds
+	double LastInputToPresent = 0.0;
+	double TotalInputToPresent = 0.0;
+	double MaxInputToPresent = 0.0;
+	// Time spent sleeping so input could be sampled later
+	double TotalSleep = 0.0;
+	// Presents that came after the refresh the pacer was aiming for
+	uint64_t MissedDeadlines = 0;
+	// 0 until the pacer has seen enough throttled frames to trust its estimate
+	double RefreshPeriod = 0.0;
+	double PredictedWork = 0.0;
+	double Margin = 0.0;
+};
+
+/// <summary>
+/// Decides when a frame starts sampling input. Every frame:
+///   FrameReady()           once the swap chain accepts another frame (the waitable object fired)
+///   WaitForInputSample()   sleeps until the latest point input can be sampled and still make the next refresh
+///   SampleInput()          right before polling input / building the UI, returns the time it happened
+///   Presented(inputTime)   right after Present() returns
+/// Only FrameReady/WaitForInputSample/Presented touch state, so with pipelining the next frame can sample input on
+/// another thread while the current one presents.
+/// The refresh period is estimated from how often the swap chain lets frames through when it had to hold them back,
+/// and the time needed from sampling to presenting from the last frames, plus a safety margin that grows on misses
+/// (late presents, or refreshes skipped because the GPU was late) and shrinks slowly otherwise. Without vsync, or before the refresh rate is known, it never sleeps.
+/// </summary>
+class FramePacer
+{
+public:
+	static int const HISTORY_SIZE = 32;
+
+	void Init(const FramePacerConfig& config, FrameClock* clock);
+
+	void FrameReady();
+	void WaitForInputSample();
+	double SampleInput() { return m_clock->Now(); }
+	void Presented(double inputTime);
+
+	uint32_t GetMaxLatency() const { return m_config.maxLatency; }
+	uint32_t GetSyncInterval() const { return m_config.vsync ? 1 : 0; }
+	bool AllowTearing() const { return !m_config.vsync && m_config.tearing; }
+	const FramePacerConfig& GetConfig() const { return m_config; }
+	const FramePacerStats& GetStats() const { return m_stats; }
+
+private:
+	static double Percentile(const double* values, int count, double percentile);
+	void MissedDeadline(bool growMargin);
+
+	FramePacerConfig m_config;
+	FrameClock* m_clock = nullptr;
+	double m_readyTime = -1.0;
+	double m_presentTime = -1.0;
+	// Whether the swap chain held back the last ready frame
+	bool m_readyThrottled = false;
+	bool m_presentLate = false;
+	double m_deadline = 0.0;
+	// Ring buffers of recent intervals between FrameReady() calls and sample-to-present durations
+	double m_readyIntervals[HISTORY_SIZE] = {};
+	double m_workDurations[HISTORY_SIZE] = {};
+	int m_readyCount = 0;
+	int m_workCount = 0;
+	uint32_t m_framesSinceMiss = 0;
+	FramePacerStats m_stats;
+};
@@ -0,0 +1,314 @@
+#include "GlyphCache.h"
+#include "Profiler.h"
+#include <cstring>
+
+// A page never holds more glyphs than this, which bounds the glyph slots every attached font reserves
+static int const                    GLYPH_CACHE_MAX_PAGE_GLYPHS = 256;
+// New shelves are this many rows taller than needed at most, so glyphs of similar height share them
+static int const                    GLYPH_CACHE_SHELF_ROUNDING = 4;
+
+void GlyphCache::Reserve(ImFontAtlas* atlas, int pageSize, int pageCount)
+{
+	IM_ASSERT(m_atlas == nullptr && !atlas->IsBuilt() && pageSize > 0);
+	m_atlas = atlas;
+	m_pageSize = pageSize;
+	for (int i = 0; i < pageCount; i++)
+		m_pageRectIds.push_back(atlas->AddCustomRectRegular(pageSize, pageSize));
+}
+
+bool GlyphCache::Attach(ImFont* font)
+{
+	IM_ASSERT(m_atlas != nullptr && m_atlas->IsBuilt() && font->ContainerAtlas == m_atlas && font->GlyphLoadFunc == NULL);
+	if (m_pages.empty())
+	{
+		for (int id : m_pageRectIds)
+		{
+			const ImFontAtlasCustomRect* rect = m_atlas->GetCustomRectByIndex(id);
+			if (!rect->IsPacked())
+				return false;
+			Page page;
+			page.X = rect->X;
+			page.Y = rect->Y;
+			m_pages.push_back(page);
+		}
+		if (m_pages.empty())
+			return false;
+		m_mainThread = std::this_thread::get_id();
+		m_stats.Pages = (uint32_t)m_pages.size();
+	}
+
+	// Index entries are ImWchar, with -1 meaning "no glyph"
+	int slots = (int)m_pages.size() * GLYPH_CACHE_MAX_PAGE_GLYPHS;
+	if (sizeof(ImWchar) == 2 && font->Glyphs.Size + slots >= 0xFFFF)
+		return false;
+
+	// Both CPU copies of the atlas are kept up to date, the RGBA one is what gets uploaded
+	unsigned char* pixels;
+	int width, height;
+	m_atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+
+	// Room for every slot up front, as FindGlyph() hands out pointers into Glyphs (FallbackGlyph among them)
+	int fallback = font->FallbackGlyph ? (int)(font->FallbackGlyph - font->Glyphs.Data) : -1;
+	font->Glyphs.reserve(font->Glyphs.Size + slots);
+	if (fallback >= 0)
+		font->FallbackGlyph = &font->Glyphs.Data[fallback];
+
+	// The index covers the BMP from now on, so it doesn't move while workers read it. A negative advance sends
+	// CalcTextSize() and friends to the loader, like a missing glyph does for FindGlyph().
+	font->GrowIndex(ImMin(IM_UNICODE_CODEPOINT_MAX, 0xFFFF) + 1);
+	for (int c = 0; c < font->IndexLookup.Size; c++)
+		if (font->IndexLookup.Data[c] == (ImWchar)-1)
+			font->IndexAdvanceX.Data[c] = -1.0f;
+
+	FontEntry* entry = new FontEntry();
+	entry->Cache = this;
+	entry->Font = font;
+	entry->Index = (int)m_fonts.size();
+	entry->FirstSlot = font->Glyphs.Size;
+	entry->Missing.Create(IM_UNICODE_CODEPOINT_MAX + 1);
+	m_fonts.push_back(entry);
+	font->GlyphLoadFunc = &GlyphCache::LoadGlyphCallback;
+	font->GlyphLoadUserData = entry;
+	return true;
+}
+
+void GlyphCache::Shutdown()
+{
+	for (FontEntry* entry : m_fonts)
+	{
+		entry->Font->GlyphLoadFunc = NULL;
+		entry->Font->GlyphLoadUserData = NULL;
+		delete entry;
+	}
+	m_fonts.clear();
+	m_mapped.clear();
+	m_pages.clear();
+	m_pageRectIds.clear();
+	m_atlas = nullptr;
+}
+
+void GlyphCache::NewFrame()
+{
+	for (const GlyphKey& key : m_mapped)
+	{
+		ImFont* font = m_fonts[key.Font]->Font;
+		font->IndexLookup.Data[key.Codepoint] = (ImWchar)-1;
+		font->IndexAdvanceX.Data[key.Codepoint] = -1.0f;
+	}
+	m_mapped.clear();
+	m_frame++;
+}
+
+void GlyphCache::TakeUploads(ImVector<TextureUpdate>& updates, ImVector<uint8_t>& pixels)
+{
+	updates.resize(0);
+	pixels.resize(0);
+	m_stats.PagesInUse = 0;
+	m_stats.Resident = 0;
+	for (Page& page : m_pages)
+	{
+		m_stats.PagesInUse += page.Glyphs.empty() ? 0 : 1;
+		m_stats.Resident += (uint32_t)page.Glyphs.size();
+		if (!page.Dirty)
+			continue;
+		page.Dirty = false;
+
+		TextureUpdate update;
+		update.X = (uint32_t)(page.X + page.DirtyX0);
+		update.Y = (uint32_t)(page.Y + page.DirtyY0);
+		update.Width = (uint32_t)(page.DirtyX1 - page.DirtyX0);
+		update.Height = (uint32_t)(page.DirtyY1 - page.DirtyY0);
+		int offset = pixels.Size;
+		pixels.resize(offset + (int)(update.Width * update.Height * 4));
+		for (uint32_t y = 0; y < update.Height; y++)
+			memcpy(&pixels.Data[offset + y * update.Width * 4], &m_atlas->TexPixelsRGBA32[(update.Y + y) * m_atlas->TexWidth + update.X], update.Width * 4);
+		updates.push_back(update);
+	}
+
+	// Pointers only once the pixel buffer is done growing
+	size_t offset = 0;
+	for (TextureUpdate& update : updates)
+	{
+		update.Pixels = pixels.Data + offset;
+		offset += (size_t)update.Width * update.Height * 4;
+	}
+	m_stats.Uploads += updates.Size;
+	m_stats.UploadedBytes += pixels.Size;
+}
+
+const ImFontGlyph* GlyphCache::LoadGlyphCallback(ImFont* font, ImWchar c, void* userData)
+{
+	FontEntry* entry = static_cast<FontEntry*>(userData);
+	IM_ASSERT(entry->Font == font);
+	(void)font;
+	return entry->Cache->LoadGlyph(*entry, c);
+}
+
+const ImFontGlyph* GlyphCache::LoadGlyph(FontEntry& entry, ImWchar c)
+{
+	if (std::this_thread::get_id() != m_mainThread)
+		return nullptr;
+	ImFont* font = entry.Font;
+	auto resident = entry.Resident.find(c);
+	if (resident != entry.Resident.end())
+	{
+		Map(entry, c, resident->second);
+		return &font->Glyphs.Data[resident->second];
+	}
+	if (entry.Missing.TestBit(c))
+		return nullptr;
+	if ((int)c >= font->IndexLookup.Size)
+		font->GrowIndex((int)c + 1);
+
+	// The first source that has the glyph, like the atlas builder
+	PROFILE_ZONE("GlyphCache::LoadGlyph");
+	const ImFontConfig* cfg = nullptr;
+	int w = 0, h = 0;
+	for (int i = 0; i < font->ConfigDataCount && cfg == nullptr; i++)
+		if (font->ConfigData[i].FontData != nullptr && ImFontAtlasBuildMeasureGlyphStbTruetype(m_atlas, &font->ConfigData[i], c, &w, &h))
+			cfg = &font->ConfigData[i];
+	if (cfg == nullptr || w > m_pageSize || h > m_pageSize)
+	{
+		entry.Missing.SetBit(c);
+		font->IndexAdvanceX.Data[c] = font->FallbackAdvanceX;
+		m_stats.Missing++;
+		return nullptr;
+	}
+
+	int pageIndex, x, y;
+	if (!Allocate(w, h, &pageIndex, &x, &y))
+	{
+		m_stats.Overflows++;
+		return nullptr;
+	}
+	int slot;
+	if (!entry.FreeSlots.empty())
+	{
+		slot = entry.FreeSlots.back();
+		entry.FreeSlots.pop_back();
+	}
+	else
+	{
+		// Never reallocates: there are as many slots as the pages can hold glyphs
+		IM_ASSERT(font->Glyphs.Size < font->Glyphs.Capacity);
+		slot = font->Glyphs.Size;
+		font->Glyphs.push_back(ImFontGlyph());
+		entry.SlotPage.push_back(0);
+	}
+
+	Page& page = m_pages[pageIndex];
+	int atlasX = page.X + x, atlasY = page.Y + y;
+	ImFontAtlasBuildRenderGlyphStbTruetype(m_atlas, font, cfg, c, atlasX, atlasY, &font->Glyphs.Data[slot]);
+	for (int row = 0; row < h; row++)
+	{
+		const unsigned char* src = m_atlas->TexPixelsAlpha8 + (atlasY + row) * m_atlas->TexWidth + atlasX;
+		unsigned int* dst = m_atlas->TexPixelsRGBA32 + (atlasY + row) * m_atlas->TexWidth + atlasX;
+		for (int col = 0; col < w; col++)
+			dst[col] = IM_COL32(255, 255, 255, (unsigned int)src[col]);
+	}
+	page.DirtyX0 = page.Dirty ? ImMin(page.DirtyX0, x) : x;
+	page.DirtyY0 = page.Dirty ? ImMin(page.DirtyY0, y) : y;
+	page.DirtyX1 = page.Dirty ? ImMax(page.DirtyX1, x + w) : x + w;
+	page.DirtyY1 = page.Dirty ? ImMax(page.DirtyY1, y + h) : y + h;
+	page.Dirty = true;
+	page.Glyphs.push_back(GlyphKey{ entry.Index, c });
+
+	entry.SlotPage[slot - entry.FirstSlot] = pageIndex;
+	entry.Resident[c] = slot;
+	m_stats.Loaded++;
+	Map(entry, c, slot);
+	return &font->Glyphs.Data[slot];
+}
+
+void GlyphCache::Map(FontEntry& entry, ImWchar c, int slot)
+{
+	ImFont* font = entry.Font;
+	font->IndexLookup.Data[c] = (ImWchar)slot;
+	font->IndexAdvanceX.Data[c] = font->Glyphs.Data[slot].AdvanceX;
+	m_pages[entry.SlotPage[slot - entry.FirstSlot]].LastUsed = m_frame;
+	m_mapped.push_back(GlyphKey{ entry.Index, c });
+}
+
+bool GlyphCache::Allocate(int w, int h, int* pageIndex, int* x, int* y)
+{
+	// Shelves of the right height first, then new shelves, then any shelf the glyph fits in, so pages fill up before
+	// anything is evicted
+	for (int pass = 0; pass < 3; pass++)
+	{
+		for (int i = 0; i < (int)m_pages.size(); i++)
+		{
+			Page& page = m_pages[i];
+			bool allocated = pass == 1 ? AllocateNewShelf(page, w, h, x, y) : AllocateInShelf(page, w, h, pass == 0, x, y);
+			if (allocated)
+			{
+				*pageIndex = i;
+				return true;
+			}
+		}
+	}
+
+	// Least recently drawn page, unless all of them are drawn from in this frame
+	int oldest = -1;
+	for (int i = 0; i < (int)m_pages.size(); i++)
+		if (m_pages[i].LastUsed != m_frame && (oldest < 0 || m_pages[i].LastUsed < m_pages[oldest].LastUsed))
+			oldest = i;
+	if (oldest < 0)
+		return false;
+	Evict(oldest);
+	*pageIndex = oldest;
+	return AllocateNewShelf(m_pages[oldest], w, h, x, y);
+}
+
+bool GlyphCache::AllocateInShelf(Page& page, int w, int h, bool tight, int* x, int* y)
+{
+	if ((int)page.Glyphs.size() >= GLYPH_CACHE_MAX_PAGE_GLYPHS)
+		return false;
+	Shelf* best = nullptr;
+	for (Shelf& shelf : page.Shelves)
+	{
+		if (shelf.Height < h || shelf.X + w > m_pageSize || (tight && shelf.Height >= h + GLYPH_CACHE_SHELF_ROUNDING))
+			continue;
+		if (best == nullptr || shelf.Height < best->Height)
+			best = &shelf;
+	}
+	if (best == nullptr)
+		return false;
+	*x = best->X;
+	*y = best->Y;
+	best->X += w;
+	return true;
+}
+
+bool GlyphCache::AllocateNewShelf(Page& page, int w, int h, int* x, int* y)
+{
+	int height = ImMin((h + GLYPH_CACHE_SHELF_ROUNDING - 1) / GLYPH_CACHE_SHELF_ROUNDING * GLYPH_CACHE_SHELF_ROUNDING, m_pageSize);
+	if ((int)page.Glyphs.size() >= GLYPH_CACHE_MAX_PAGE_GLYPHS || page.Top + height > m_pageSize)
+		return false;
+	page.Shelves.push_back(Shelf{ page.Top, height, w });
+	*x = 0;
+	*y = page.Top;
+	page.Top += height;
+	return true;
+}
+
+void GlyphCache::Evict(int pageIndex)
+{
+	Page& page = m_pages[pageIndex];
+	IM_ASSERT(page.LastUsed != m_frame);
+	for (const GlyphKey& key : page.Glyphs)
+	{
+		FontEntry* entry = m_fonts[key.Font];
+		auto resident = entry->Resident.find(key.Codepoint);
+		IM_ASSERT(resident != entry->Resident.end());
+		int slot = resident->second;
+		entry->Resident.erase(resident);
+		entry->FreeSlots.push_back(slot);
+		entry->Font->Glyphs.Data[slot] = ImFontGlyph();
+		IM_ASSERT(entry->Font->IndexLookup.Data[key.Codepoint] == (ImWchar)-1);
+	}
+	m_stats.Evicted += page.Glyphs.size();
+	m_stats.PageEvictions++;
+	page.Glyphs.clear();
+	page.Shelves.clear();
+	page.Top = 0;
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct GlyphCacheStats
+{
+	uint32_t Pages = 0;
+	// Pages holding at least one glyph, and the glyphs in them
+	uint32_t PagesInUse = 0;
+	uint32_t Resident = 0;
+	// Since Attach()
+	uint64_t Loaded = 0;
+	uint64_t Evicted = 0;
+	uint64_t PageEvictions = 0;
+	// Codepoints none of the font's sources have, drawn as the fallback glyph from then on
+	uint32_t Missing = 0;
+	// Lookups that couldn't load a glyph because every page held glyphs of the same frame; drawn as the fallback glyph
+	// for that frame
+	uint64_t Overflows = 0;
+	uint64_t Uploads = 0;
+	uint64_t UploadedBytes = 0;
+};
+
+/// <summary>
+/// Rasterizes the glyphs a font's atlas doesn't have when they are first drawn, into pages reserved in the atlas, so a
+/// font can cover all of its codepoints with a fixed amount of atlas memory. Glyphs come out exactly as the atlas builder
+/// would make them, and the changed part of each page goes to the renderer as a sub-rect update with the frame.
+/// Full pages are evicted as a whole, least recently drawn first. To see which pages a frame draws from, loaded glyphs
+/// are only in the font's index for one frame: NewFrame() takes them out and the next lookup maps them back in, one hash
+/// lookup per distinct glyph and frame. Pages drawn from in the current frame are never evicted, so glyph pointers stay
+/// valid until the frame ends.
+/// Glyphs are only loaded on the main thread. Draw lists built on workers (ParallelDrawLists) get the fallback glyph for
+/// codepoints that aren't loaded yet, and must not draw codepoints the main thread may be loading in the meantime.
+/// </summary>
+class GlyphCache
+{
+public:
+	~GlyphCache() { Shutdown(); }
+	// Before the atlas is built: adds `pageCount` custom rects of `pageSize` pixels, which are the pages once the atlas
+	// is built (or loaded from a FontAtlasCache file, which keys on custom rects as well).
+	void Reserve(ImFontAtlas* atlas, int pageSize, int pageCount);
+	// Main thread, once the atlas is built. Fonts attached to the same cache share its pages. Fails if the font's glyph
+	// table can't index that many more glyphs.
+	bool Attach(ImFont* font);
+	// Detaches the fonts, before they are destroyed
+	void Shutdown();
+
+	// Main thread, before ImGui::NewFrame()
+	void NewFrame();
+	// After ImGui::Render(): the rects of the font texture that changed during the frame, pointing into `pixels`
+	void TakeUploads(ImVector<TextureUpdate>& updates, ImVector<uint8_t>& pixels);
+
+	const GlyphCacheStats& GetStats() const { return m_stats; }
+
+private:
+	struct Shelf
+	{
+		int Y;
+		int Height;
+		// Where the next glyph goes
+		int X;
+	};
+	struct GlyphKey
+	{
+		int Font;
+		ImWchar Codepoint;
+	};
+	struct Page
+	{
+		// In the atlas
+		int X = 0;
+		int Y = 0;
+		std::vector<Shelf> Shelves;
+		// Rows below are free for new shelves
+		int Top = 0;
+		std::vector<GlyphKey> Glyphs;
+		uint64_t LastUsed = 0;
+		// Page coordinates, changed since the last TakeUploads()
+		bool Dirty = false;
+		int DirtyX0 = 0, DirtyY0 = 0, DirtyX1 = 0, DirtyY1 = 0;
+	};
+	struct FontEntry
+	{
+		GlyphCache* Cache;
+		ImFont* Font;
+		int Index;
+		// Glyphs before it are the atlas' own
+		int FirstSlot;
+		std::vector<int> FreeSlots;
+		std::vector<int> SlotPage;
+		std::unordered_map<ImWchar, int> Resident;
+		ImBitVector Missing;
+	};
+
+	static const ImFontGlyph* LoadGlyphCallback(ImFont* font, ImWchar c, void* userData);
+	const ImFontGlyph* LoadGlyph(FontEntry& entry, ImWchar c);
+	void Map(FontEntry& entry, ImWchar c, int slot);
+	bool Allocate(int w, int h, int* pageIndex, int* x, int* y);
+	bool AllocateInShelf(Page& page, int w, int h, bool tight, int* x, int* y);
+	bool AllocateNewShelf(Page& page, int w, int h, int* x, int* y);
+	void Evict(int pageIndex);
+
+	ImFontAtlas*                       m_atlas = nullptr;
+	int                                m_pageSize = 0;
+	std::vector<int>                   m_pageRectIds;
+	std::vector<Page>                  m_pages;
+	std::vector<FontEntry*>            m_fonts;
+	// Loaded glyphs in the fonts' index this frame
+	std::vector<GlyphKey>              m_mapped;
+	uint64_t                           m_frame = 1;
+	std::thread::id                    m_mainThread;
+	GlyphCacheStats                    m_stats;
+};
@@ -0,0 +1,141 @@
+#include "GpuProfiler.h"
+#include "Profiler.h"
+#include "imgui.h"
+
+bool GpuProfiler::Init(GraphicsDevice* device, CommandQueue* queue, uint32_t framesInFlight)
+{
+	uint64_t frequency = queue->GetTimestampFrequency();
+	if (frequency == 0)
+		return false;
+	m_heap = device->CreateTimestampQueryHeap(framesInFlight * MAX_ZONES_PER_FRAME * 2);
+	if (m_heap == nullptr)
+		return false;
+
+	m_queue = queue;
+	m_nanosecondsPerTick = 1e9 / (double)frequency;
+	m_slots.resize(framesInFlight);
+	for (FrameSlot& slot : m_slots)
+		slot.Zones.reserve(MAX_ZONES_PER_FRAME);
+	m_lastFrame.reserve(MAX_ZONES_PER_FRAME);
+#ifdef PROFILER_ENABLE
+	m_track = Profiler::RegisterTrack("GPU");
+#endif
+	return true;
+}
+
+void GpuProfiler::Shutdown()
+{
+	delete m_heap;
+	m_heap = nullptr;
+	m_slots.clear();
+	m_current = nullptr;
+}
+
+void GpuProfiler::BeginFrame()
+{
+	if (m_heap == nullptr)
+		return;
+	m_frameSerial++;
+	m_stats.FramesBegun++;
+	FrameSlot& slot = m_slots[m_frameSerial % m_slots.size()];
+	if (slot.Pending)
+		m_stats.FramesDropped++;
+	slot.Serial = m_frameSerial;
+	slot.Pending = false;
+	slot.Zones.clear();
+	m_current = &slot;
+	m_depth = 0;
+}
+
+uint32_t GpuProfiler::BeginZone(CommandList* list, const char* name)
+{
+	if (m_current == nullptr)
+		return GPU_PROFILER_INVALID_ZONE;
+	if (m_current->Zones.size() >= MAX_ZONES_PER_FRAME)
+	{
+		m_stats.ZonesDropped++;
+		return GPU_PROFILER_INVALID_ZONE;
+	}
+	uint32_t zone = (uint32_t)m_current->Zones.size();
+	m_current->Zones.push_back({ name, m_depth++ });
+	uint32_t base = (uint32_t)(m_current - m_slots.data()) * MAX_ZONES_PER_FRAME * 2;
+	list->WriteTimestamp(m_heap, base + zone * 2);
+	return zone;
+}
+
+void GpuProfiler::EndZone(CommandList* list, uint32_t zone)
+{
+	if (m_current == nullptr || zone == GPU_PROFILER_INVALID_ZONE)
+		return;
+	m_depth--;
+	uint32_t base = (uint32_t)(m_current - m_slots.data()) * MAX_ZONES_PER_FRAME * 2;
+	list->WriteTimestamp(m_heap, base + zone * 2 + 1);
+}
+
+void GpuProfiler::EndFrame(CommandList* list, uint64_t fenceValue)
+{
+	if (m_current == nullptr)
+		return;
+	IM_ASSERT(m_depth == 0 && "GPU zone still open at the end of the frame");
+	if (!m_current->Zones.empty())
+	{
+		// Zones use consecutive queries from the start of the slot's range
+		uint32_t base = (uint32_t)(m_current - m_slots.data()) * MAX_ZONES_PER_FRAME * 2;
+		list->ResolveTimestamps(m_heap, base, (uint32_t)m_current->Zones.size() * 2);
+		m_current->FenceValue = fenceValue;
+		m_current->Pending = true;
+	}
+	m_current = nullptr;
+}
+
+void GpuProfiler::Update(uint64_t completedFenceValue)
+{
+	if (m_heap == nullptr)
+		return;
+	bool calibrated = false;
+	uint64_t calibrationGpu = 0;
+	uint64_t calibrationCpu = 0;
+	for (;;)
+	{
+		// Oldest completed frame first, so the last one read is the newest
+		FrameSlot* oldest = nullptr;
+		for (FrameSlot& slot : m_slots)
+			if (slot.Pending && slot.FenceValue <= completedFenceValue && (oldest == nullptr || slot.Serial < oldest->Serial))
+				oldest = &slot;
+		if (oldest == nullptr)
+			return;
+		if (!calibrated)
+		{
+			calibrated = true;
+			if (!m_queue->GetClockCalibration(&calibrationGpu, &calibrationCpu))
+			{
+				calibrationGpu = 0;
+				calibrationCpu = 0;
+			}
+		}
+		ReadBack(*oldest, calibrationGpu, calibrationCpu);
+	}
+}
+
+void GpuProfiler::ReadBack(FrameSlot& slot, uint64_t calibrationGpu, uint64_t calibrationCpu)
+{
+	const uint64_t* timestamps = m_heap->GetResolvedData() + (size_t)(&slot - m_slots.data()) * MAX_ZONES_PER_FRAME * 2;
+	m_lastFrame.clear();
+	for (size_t z = 0; z < slot.Zones.size(); z++)
+	{
+		// The calibration can be from after the frame ran, so the deltas are signed
+		uint64_t start = calibrationCpu + (int64_t)((double)(int64_t)(timestamps[z * 2] - calibrationGpu) * m_nanosecondsPerTick);
+		uint64_t end = calibrationCpu + (int64_t)((double)(int64_t)(timestamps[z * 2 + 1] - calibrationGpu) * m_nanosecondsPerTick);
+		GpuZone zone = { slot.Zones[z].Name, start, end < start ? start : end, slot.Zones[z].Depth };
+		m_lastFrame.push_back(zone);
+		if (m_track != nullptr)
+			m_track->Push({ zone.Name, zone.Start, zone.End, zone.Depth });
+	}
+
+	uint32_t latency = (uint32_t)(m_frameSerial - slot.Serial);
+	m_stats.FramesResolved++;
+	m_stats.LastLatency = latency;
+	m_stats.MaxLatency = latency > m_stats.MaxLatency ? latency : m_stats.MaxLatency;
+	m_lastFrameSerial = slot.Serial;
+	slot.Pending = false;
+}
@@ -0,0 +1,95 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include <cstdint>
+#include <vector>
+
+class ProfilerThreadBuffer;
+
+static uint32_t const               GPU_PROFILER_INVALID_ZONE = 0xFFFFFFFF;
+
+/// <summary>
+/// A zone read back from the GPU. Times are on the CPU profiler's clock (Profiler::Now()), converted from GPU ticks.
+/// </summary>
+struct GpuZone
+{
+	const char* Name;
+	uint64_t Start;
+	uint64_t End;
+	uint32_t Depth;
+};
+
+struct GpuProfilerStats
+{
+	uint64_t FramesBegun = 0;
+	uint64_t FramesResolved = 0;
+	// Frames whose slot was needed again before their results came back
+	uint64_t FramesDropped = 0;
+	// Zones that did not fit into the frame's queries
+	uint64_t ZonesDropped = 0;
+	// Frames begun after a frame before its timestamps were read back
+	uint32_t LastLatency = 0;
+	uint32_t MaxLatency = 0;
+};
+
+/// <summary>
+/// GPU timestamps around passes. Every frame in flight owns a range of one query heap: BeginZone()/EndZone() write a
+/// timestamp each into it, EndFrame() resolves the range into readback memory at the end of the frame's last list,
+/// and Update() reads back every frame whose fence has completed since, oldest first, and never before. Results are
+/// converted to CPU time with the queue's clock calibration and, with the CPU profiler enabled, added to its
+/// timeline as a "GPU" track.
+/// Zones have to be recorded in submission order from one thread at a time (e.g. while executing the render graph).
+/// </summary>
+class GpuProfiler
+{
+public:
+	static uint32_t const MAX_ZONES_PER_FRAME = 64;
+
+	// Returns false if the device has no timestamp queries, the profiler then ignores every call.
+	bool Init(GraphicsDevice* device, CommandQueue* queue, uint32_t framesInFlight);
+	void Shutdown();
+
+	void BeginFrame();
+	// Returns GPU_PROFILER_INVALID_ZONE if the frame ran out of queries. EndZone() accepts that too.
+	uint32_t BeginZone(CommandList* list, const char* name);
+	void EndZone(CommandList* list, uint32_t zone);
+	// `list` has to be the last list of the frame, `fenceValue` what the queue signals after it.
+	void EndFrame(CommandList* list, uint64_t fenceValue);
+	void Update(uint64_t completedFenceValue);
+
+	bool IsEnabled() const { return m_heap != nullptr; }
+	// Zones of the newest frame read back, in the order they were begun
+	const std::vector<GpuZone>& GetLastFrame() const { return m_lastFrame; }
+	// 1 for the first frame begun, 0 until a frame was read back
+	uint64_t GetLastFrameSerial() const { return m_lastFrameSerial; }
+	const GpuProfilerStats& GetStats() const { return m_stats; }
+
+private:
+	struct ZoneInfo
+	{
+		const char* Name;
+		uint32_t Depth;
+	};
+
+	struct FrameSlot
+	{
+		uint64_t Serial = 0;
+		uint64_t FenceValue = 0;
+		bool Pending = false;
+		std::vector<ZoneInfo> Zones;
+	};
+
+	void ReadBack(FrameSlot& slot, uint64_t calibrationGpu, uint64_t calibrationCpu);
+
+	TimestampQueryHeap* m_heap = nullptr;
+	CommandQueue* m_queue = nullptr;
+	std::vector<FrameSlot> m_slots;
+	FrameSlot* m_current = nullptr;
+	uint64_t                     m_frameSerial = 0;
+	uint32_t                     m_depth = 0;
+	double                       m_nanosecondsPerTick = 0.0;
+	std::vector<GpuZone>         m_lastFrame;
+	uint64_t                     m_lastFrameSerial = 0;
+	// Timeline track in the CPU profiler
+	ProfilerThreadBuffer* m_track = nullptr;
+	GpuProfilerStats             m_stats;
+};
@@ -0,0 +1,222 @@
+#pragma once
+#include <cstdint>
+
+struct ImDrawData;
+class DynamicUploadHeap;
+
+/// <summary>
+/// Platform-neutral graphics interface used by the Renderer. Mirrors the shape of DX12
+/// (device, queue, allocator, command list, fence, swap chain) so the DX12 backend is a thin wrapper,
+/// while the null backend can record the same calls into memory and run headless on any OS.
+/// </summary>
+
+// Bit flags like D3D12_RESOURCE_STATES, so read-only states can be combined into one (e.g. ShaderResource | CopySource).
+// Present is 0, the same as D3D12's COMMON state.
+enum class ResourceState : uint8_t
+{
+	Present = 0,
+	RenderTarget = 1 << 0,
+	CopySource = 1 << 1,
+	CopyDest = 1 << 2,
+	ShaderResource = 1 << 3,
+	GenericRead = 1 << 4,
+};
+
+inline ResourceState operator|(ResourceState a, ResourceState b) { return (ResourceState)((uint8_t)a | (uint8_t)b); }
+// True for states (and combinations of states) the GPU can only read from.
+inline bool IsReadOnlyState(ResourceState state)
+{
+	uint8_t readMask = (uint8_t)ResourceState::CopySource | (uint8_t)ResourceState::ShaderResource | (uint8_t)ResourceState::GenericRead;
+	return state != ResourceState::Present && ((uint8_t)state & ~readMask) == 0;
+}
+// True if every bit of `subset` is set in `state`.
+inline bool HasAllStates(ResourceState state, ResourceState subset) { return ((uint8_t)state & (uint8_t)subset) == (uint8_t)subset; }
+
+/// <summary>
+/// Opaque GPU resource. Backends subclass this to carry their native handles.
+/// </summary>
+class Resource
+{
+public:
+	virtual ~Resource() = default;
+};
+
+/// <summary>
+/// Buffer in CPU-writable upload memory. Stays mapped for its whole lifetime.
+/// </summary>
+class Buffer : public Resource
+{
+public:
+	virtual void* GetCpuAddress() = 0;
+	virtual uint64_t GetGpuAddress() = 0;
+};
+
+/// <summary>
+/// GPU timestamp queries, plus CPU-readable memory they are resolved into. The memory stays mapped, but an entry is
+/// only valid once the list that resolved it has finished executing.
+/// </summary>
+class TimestampQueryHeap
+{
+public:
+	virtual ~TimestampQueryHeap() = default;
+	virtual uint32_t GetCount() = 0;
+	// Resolved timestamps in the queue's ticks (CommandQueue::GetTimestampFrequency()), indexed like the queries
+	virtual const uint64_t* GetResolvedData() = 0;
+};
+
+class Fence
+{
+public:
+	virtual ~Fence() = default;
+	virtual uint64_t GetCompletedValue() = 0;
+	// Blocks the calling thread until the fence reaches `value`.
+	virtual void Wait(uint64_t value) = 0;
+};
+
+class CommandAllocator
+{
+public:
+	virtual ~CommandAllocator() = default;
+	// Only valid once the GPU has finished with every list recorded from this allocator.
+	virtual void Reset() = 0;
+};
+
+enum class BarrierType : uint8_t
+{
+	Transition,
+	// Two placed resources sharing memory: `AliasBefore` stops using it, `Target` starts
+	Aliasing,
+};
+
+// Split barriers let the GPU start a transition early (Begin) and only wait for it where the resource is used (End).
+enum class BarrierSplit : uint8_t
+{
+	None,
+	Begin,
+	End,
+};
+
+struct ResourceBarrierDesc
+{
+	BarrierType Type = BarrierType::Transition;
+	BarrierSplit Split = BarrierSplit::None;
+	// Aliasing barriers accept nullptr for either side, meaning "any resource in the heap".
+	Resource* Target = nullptr;
+	Resource* AliasBefore = nullptr;
+	ResourceState StateBefore = ResourceState::Present;
+	ResourceState StateAfter = ResourceState::Present;
+};
+
+// New pixels for a rect of the UI font texture, e.g. glyphs rasterized on demand. Tightly packed RGBA8 rows.
+struct TextureUpdate
+{
+	uint32_t X = 0;
+	uint32_t Y = 0;
+	uint32_t Width = 0;
+	uint32_t Height = 0;
+	const uint8_t* Pixels = nullptr;
+};
+
+class CommandList
+{
+public:
+	virtual ~CommandList() = default;
+	virtual void Reset(CommandAllocator* allocator) = 0;
+	virtual void ResourceBarrier(Resource* resource, ResourceState before, ResourceState after) = 0;
+	// Records a batch of barriers in one go, which lets the driver merge them.
+	virtual void ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers) = 0;
+	virtual void ClearRenderTarget(Resource* renderTarget, const float color[4]) = 0;
+	virtual void SetRenderTarget(Resource* renderTarget) = 0;
+	// Records the imgui draw lists with the backend's UI renderer.
+	virtual void RenderDrawData(ImDrawData* drawData) = 0;
+	// Copies `update` into the UI font texture, draws recorded after it see the new pixels. The pixels go through the
+	// dynamic upload heap while recording, so they don't have to outlive the call. Dropped if the heap is full.
+	virtual void UpdateUITexture(const TextureUpdate& update) = 0;
+	// Stores the GPU time into query `index` once all work before it has completed.
+	virtual void WriteTimestamp(TimestampQueryHeap* heap, uint32_t index) = 0;
+	// Copies queries [first, first + count) into the heap's resolved data.
+	virtual void ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count) = 0;
+	virtual void Close() = 0;
+};
+
+class CommandQueue
+{
+public:
+	virtual ~CommandQueue() = default;
+	virtual void ExecuteCommandLists(uint32_t count, CommandList* const* commandLists) = 0;
+	virtual void Signal(Fence* fence, uint64_t value) = 0;
+	// Ticks per second of the timestamps written by lists executed on this queue.
+	virtual uint64_t GetTimestampFrequency() = 0;
+	// A GPU timestamp and the CPU time (steady clock nanoseconds, like Profiler::Now()) at the same moment, to place
+	// GPU work on the CPU timeline.
+	virtual bool GetClockCalibration(uint64_t* gpuTimestamp, uint64_t* cpuTime) = 0;
+};
+
+struct SwapChainDesc
+{
+	// Native window handle (HWND on Windows). Ignored by the null backend.
+	void* window = nullptr;
+	uint32_t bufferCount = 3;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	// Frames that can be queued for presentation before WaitForNextFrame() blocks, at most bufferCount
+	uint32_t maxFrameLatency = 3;
+	// Create the swap chain so it can present with PRESENT_ALLOW_TEARING, if the system supports it
+	bool allowTearing = false;
+};
+
+// SwapChain::Present() flags
+static uint32_t const               PRESENT_ALLOW_TEARING = 1 << 0;
+
+class SwapChain
+{
+public:
+	virtual ~SwapChain() = default;
+	virtual uint32_t GetCurrentBackBufferIndex() = 0;
+	virtual Resource* GetBackBuffer(uint32_t index) = 0;
+	// Blocks until the presentation engine can accept another frame.
+	virtual void WaitForNextFrame() = 0;
+	// `flags` are PRESENT_* flags. PRESENT_ALLOW_TEARING is ignored unless SupportsTearing().
+	virtual void Present(uint32_t syncInterval, uint32_t flags) = 0;
+	virtual bool SupportsTearing() = 0;
+	// Caller must make sure the GPU is no longer using any back buffer.
+	virtual void Resize(uint32_t width, uint32_t height) = 0;
+};
+
+class GraphicsDevice
+{
+public:
+	virtual ~GraphicsDevice() = default;
+	virtual const char* GetName() const = 0;
+
+	virtual CommandQueue* CreateCommandQueue() = 0;
+	virtual CommandAllocator* CreateCommandAllocator() = 0;
+	// The returned list is closed and must be Reset() before recording.
+	virtual CommandList* CreateCommandList(CommandAllocator* allocator) = 0;
+	virtual Fence* CreateFence(uint64_t initialValue) = 0;
+	virtual SwapChain* CreateSwapChain(CommandQueue* queue, const SwapChainDesc& desc) = 0;
+	virtual Buffer* CreateUploadBuffer(uint64_t size) = 0;
+	// Returns nullptr if the device can't write timestamps.
+	virtual TimestampQueryHeap* CreateTimestampQueryHeap(uint32_t count) = 0;
+
+	// Per-frame dynamic geometry (e.g. imgui vertices/indices) is suballocated from this heap when set.
+	// Must be called before InitUIBackend().
+	virtual void SetDynamicUploadHeap(DynamicUploadHeap* heap) = 0;
+
+	// Frame boundaries, for anything the device itself recycles by fence value (e.g. transient descriptors).
+	// Same contract as DynamicUploadHeap::FinishFrame/Retire.
+	virtual void FinishFrame(uint64_t fenceValue) = 0;
+	virtual void RetireFrames(uint64_t completedFenceValue) = 0;
+
+	// Hooks for the imgui renderer backend that matches this device.
+	virtual bool InitUIBackend(int numFramesInFlight) = 0;
+	virtual void NewUIFrame() = 0;
+	virtual void ShutdownUIBackend() = 0;
+};
+
+// Backend factories. Return nullptr if the device could not be created.
+// The null device only records commands, unless `rasterize` is set in which case it draws with the SoftwareRasterizer.
+GraphicsDevice* CreateNullDevice(bool rasterize = false);
+#ifdef _WIN32
+GraphicsDevice* CreateDX12Device();
+#endif
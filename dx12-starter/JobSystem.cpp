@@ -0,0 +1,460 @@
+#include "JobSystem.h"
+#include "imgui.h"
+#include "Profiler.h"
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Spins (yielding) this many times without finding work before going to sleep
+static int const                    JOB_SPIN_COUNT = 64;
+
+static thread_local const JobSystem* t_jobSystem = nullptr;
+static thread_local uint32_t        t_threadIndex = 0;
+
+// Counters are only written by the thread that owns them, readers may see slightly stale values
+static void Bump(std::atomic<uint64_t>& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Work queue
+
+bool JobSystem::WorkQueue::Push(Job* job)
+{
+	int64_t bottom = Bottom.load(std::memory_order_relaxed);
+	int64_t top = Top.load(std::memory_order_acquire);
+	if (bottom - top >= MAX_JOBS_PER_THREAD)
+		return false;
+	Jobs[bottom & (MAX_JOBS_PER_THREAD - 1)].store(job, std::memory_order_relaxed);
+	// Publishes the job to thieves, paired with the acquire load of Bottom in Steal()
+	Bottom.store(bottom + 1, std::memory_order_release);
+	return true;
+}
+
+Job* JobSystem::WorkQueue::Pop()
+{
+	int64_t bottom = Bottom.load(std::memory_order_relaxed) - 1;
+	Bottom.store(bottom, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t top = Top.load(std::memory_order_relaxed);
+	if (top > bottom)
+	{
+		// Empty
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return nullptr;
+	}
+
+	Job* job = Jobs[bottom & (MAX_JOBS_PER_THREAD - 1)].load(std::memory_order_relaxed);
+	if (top == bottom)
+	{
+		// Last job, race the thieves for it
+		if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+			job = nullptr;
+		Bottom.store(bottom + 1, std::memory_order_relaxed);
+	}
+	return job;
+}
+
+Job* JobSystem::WorkQueue::Steal()
+{
+	int64_t top = Top.load(std::memory_order_acquire);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	int64_t bottom = Bottom.load(std::memory_order_acquire);
+	if (top >= bottom)
+		return nullptr;
+
+	Job* job = Jobs[top & (MAX_JOBS_PER_THREAD - 1)].load(std::memory_order_relaxed);
+	if (!Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+		return nullptr; // Lost against the owner or another thief
+	return job;
+}
+
+bool JobSystem::WorkQueue::IsEmpty() const
+{
+	return Top.load() >= Bottom.load();
+}
+
+// Job system
+
+JobSystem::~JobSystem()
+{
+	Shutdown();
+}
+
+void JobSystem::Init(uint32_t numThreads)
+{
+	IM_ASSERT(m_threads == nullptr && "Already initialized");
+	if (numThreads == 0)
+		numThreads = std::thread::hardware_concurrency();
+	if (numThreads == 0)
+		numThreads = 1;
+	if (numThreads > MAX_THREADS)
+		numThreads = MAX_THREADS;
+
+	m_threadCount = numThreads;
+	// ThreadData is cache line aligned, which operator new only honours from C++17 on. Align it by hand.
+	m_threadMemory = malloc(sizeof(ThreadData) * numThreads + alignof(ThreadData) - 1);
+	IM_ASSERT(m_threadMemory != nullptr);
+	m_threads = reinterpret_cast<ThreadData*>(((uintptr_t)m_threadMemory + alignof(ThreadData) - 1) & ~(uintptr_t)(alignof(ThreadData) - 1));
+	for (uint32_t i = 0; i < numThreads; i++)
+	{
+		new (&m_threads[i]) ThreadData();
+		m_threads[i].JobPool = new Job[MAX_JOBS_PER_THREAD];
+		for (int j = MAX_JOBS_PER_THREAD; j-- > 0; )
+		{
+			Job* job = &m_threads[i].JobPool[j];
+			job->Owner = i;
+			job->Next = m_threads[i].FreeJobs;
+			m_threads[i].FreeJobs = job;
+		}
+		m_threads[i].StealSeed = i * 0x9E3779B9u + 1;
+	}
+
+	t_jobSystem = this;
+	t_threadIndex = 0;
+
+	m_quit = false;
+	for (uint32_t i = 1; i < numThreads; i++)
+		m_workers.emplace_back(&JobSystem::WorkerMain, this, i);
+}
+
+void JobSystem::Shutdown()
+{
+	if (m_threads == nullptr)
+		return;
+
+	// Jobs still queued are dropped, callers are expected to Wait() for their work first
+	m_quit = true;
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeGeneration++;
+	}
+	m_sleepCondition.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+	m_workers.clear();
+
+	for (uint32_t i = 0; i < m_threadCount; i++)
+	{
+		delete[] m_threads[i].JobPool;
+		m_threads[i].~ThreadData();
+	}
+	free(m_threadMemory);
+	m_threadMemory = nullptr;
+	m_threads = nullptr;
+	m_threadCount = 0;
+	m_mainQueue.clear();
+	m_mainQueueSize = 0;
+	if (t_jobSystem == this)
+		t_jobSystem = nullptr;
+}
+
+bool JobSystem::IsMainThread() const
+{
+	return t_jobSystem == this && t_threadIndex == 0;
+}
+
+uint32_t JobSystem::GetThreadIndex() const
+{
+	IM_ASSERT(t_jobSystem == this && "Jobs can only be spawned and waited on from threads of this job system");
+	return t_threadIndex;
+}
+
+JobSystemStats JobSystem::GetStats() const
+{
+	JobSystemStats stats;
+	for (uint32_t i = 0; i < m_threadCount; i++)
+	{
+		const ThreadStats& thread = m_threads[i].Stats;
+		stats.Spawned += thread.Spawned.load(std::memory_order_relaxed);
+		stats.Executed += thread.Executed.load(std::memory_order_relaxed);
+		stats.Stolen += thread.Stolen.load(std::memory_order_relaxed);
+		stats.MainThreadJobs += thread.MainThreadJobs.load(std::memory_order_relaxed);
+		stats.Sleeps += thread.Sleeps.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+void JobSystem::ResetStats()
+{
+	for (uint32_t i = 0; i < m_threadCount; i++)
+	{
+		ThreadStats& thread = m_threads[i].Stats;
+		thread.Spawned = 0;
+		thread.Executed = 0;
+		thread.Stolen = 0;
+		thread.MainThreadJobs = 0;
+		thread.Sleeps = 0;
+	}
+}
+
+Job* JobSystem::AllocateJob()
+{
+	uint32_t threadIndex = GetThreadIndex();
+	ThreadData& thread = m_threads[threadIndex];
+	for (;;)
+	{
+		if (thread.FreeJobs == nullptr && thread.ReturnedJobs.load(std::memory_order_relaxed) != nullptr)
+			thread.FreeJobs = thread.ReturnedJobs.exchange(nullptr, std::memory_order_acquire);
+		if (Job* job = thread.FreeJobs)
+		{
+			thread.FreeJobs = job->Next;
+			return job;
+		}
+		// Every slot is queued or running, help run jobs until one frees up
+		if (!RunOneJob(threadIndex))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::ReleaseJob(Job* job)
+{
+	ThreadData& owner = m_threads[job->Owner];
+	if (job->Owner == t_threadIndex)
+	{
+		job->Next = owner.FreeJobs;
+		owner.FreeJobs = job;
+		return;
+	}
+	// The owner only ever takes the whole list, so there is no ABA problem
+	job->Next = owner.ReturnedJobs.load(std::memory_order_relaxed);
+	while (!owner.ReturnedJobs.compare_exchange_weak(job->Next, job, std::memory_order_release, std::memory_order_relaxed))
+	{
+	}
+}
+
+void JobSystem::Increment(JobCounter* counter)
+{
+	counter->m_value.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void JobSystem::Submit(Job* job, JobCounter* dependency)
+{
+	if (job->Counter)
+		Increment(job->Counter);
+	Bump(m_threads[GetThreadIndex()].Stats.Spawned);
+
+	if (dependency)
+	{
+		// Same lock as the one the last finishing job takes, so the job is either queued here or released there
+		std::lock_guard<std::mutex> lock(dependency->m_mutex);
+		if (dependency->m_value.load(std::memory_order_acquire) != 0)
+		{
+			job->Next = dependency->m_waitingJobs;
+			dependency->m_waitingJobs = job;
+			return;
+		}
+	}
+	Schedule(job);
+}
+
+void JobSystem::Schedule(Job* job)
+{
+	if (job->Affinity == JobAffinity::MainThread)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mainQueueMutex);
+			m_mainQueue.push_back(job);
+			m_mainQueueSize.fetch_add(1);
+		}
+		// There is no way to wake only the main thread
+		Wake(true);
+		return;
+	}
+
+	// A full queue means plenty of parallel work already, just run it
+	if (!m_threads[GetThreadIndex()].Queue.Push(job))
+	{
+		Execute(job);
+		return;
+	}
+	Wake(false);
+}
+
+void JobSystem::Execute(Job* job)
+{
+	JobCounter* counter = job->Counter;
+	job->Invoke(job);
+	ReleaseJob(job);
+	Bump(m_threads[t_threadIndex].Stats.Executed);
+	if (counter)
+		Finish(counter);
+}
+
+void JobSystem::Finish(JobCounter* counter)
+{
+	int value = counter->m_value.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		IM_ASSERT(value > 0);
+		if (value > 1)
+		{
+			if (counter->m_value.compare_exchange_weak(value, value - 1, std::memory_order_acq_rel))
+				return;
+			continue;
+		}
+
+		// Last job. Reaching zero and taking the continuations happens under the counter lock, so neither a
+		// RunAfter() racing with us nor a reuse of the counter can mix up which jobs get released.
+		Job* waitingJobs;
+		{
+			std::lock_guard<std::mutex> lock(counter->m_mutex);
+			if (!counter->m_value.compare_exchange_strong(value, 0, std::memory_order_acq_rel))
+				continue;
+			waitingJobs = counter->m_waitingJobs;
+			counter->m_waitingJobs = nullptr;
+		}
+		// The counter may be gone from here on, its owner only had to wait for the lock
+		while (waitingJobs)
+		{
+			Job* next = waitingJobs->Next;
+			Schedule(waitingJobs);
+			waitingJobs = next;
+		}
+		// Wake threads blocked in Wait() on this counter
+		Wake(true);
+		return;
+	}
+}
+
+Job* JobSystem::FindJob(uint32_t threadIndex)
+{
+	ThreadData& thread = m_threads[threadIndex];
+	if (threadIndex == 0 && m_mainQueueSize.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_mainQueueMutex);
+		if (!m_mainQueue.empty())
+		{
+			Job* job = m_mainQueue.front();
+			m_mainQueue.pop_front();
+			m_mainQueueSize.fetch_sub(1);
+			Bump(thread.Stats.MainThreadJobs);
+			return job;
+		}
+	}
+
+	if (Job* job = thread.Queue.Pop())
+		return job;
+
+	// Steal, starting from a random victim so thieves spread out
+	thread.StealSeed ^= thread.StealSeed << 13;
+	thread.StealSeed ^= thread.StealSeed >> 17;
+	thread.StealSeed ^= thread.StealSeed << 5;
+	uint32_t start = thread.StealSeed % m_threadCount;
+	for (uint32_t i = 0; i < m_threadCount; i++)
+	{
+		uint32_t victim = (start + i) % m_threadCount;
+		if (victim == threadIndex)
+			continue;
+		if (Job* job = m_threads[victim].Queue.Steal())
+		{
+			Bump(thread.Stats.Stolen);
+			return job;
+		}
+	}
+	return nullptr;
+}
+
+bool JobSystem::HasWork(uint32_t threadIndex) const
+{
+	if (threadIndex == 0 && m_mainQueueSize.load() > 0)
+		return true;
+	for (uint32_t i = 0; i < m_threadCount; i++)
+		if (!m_threads[i].Queue.IsEmpty())
+			return true;
+	return false;
+}
+
+bool JobSystem::RunOneJob(uint32_t threadIndex)
+{
+	Job* job = FindJob(threadIndex);
+	if (job == nullptr)
+		return false;
+	Execute(job);
+	return true;
+}
+
+void JobSystem::Sleep(uint32_t threadIndex, JobCounter* counter)
+{
+	std::unique_lock<std::mutex> lock(m_sleepMutex);
+	uint64_t generation = m_wakeGeneration;
+	// Announce ourselves before the last look around. Pairs with the fence in Wake(): either the waker sees a
+	// sleeper, or we see its work.
+	m_sleepers.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (!m_quit && !HasWork(threadIndex) && (counter == nullptr || !counter->IsDone()))
+	{
+		Bump(m_threads[threadIndex].Stats.Sleeps);
+		m_sleepCondition.wait(lock, [&] { return m_wakeGeneration != generation || m_quit; });
+	}
+	m_sleepers.fetch_sub(1);
+}
+
+void JobSystem::Wake(bool all)
+{
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (m_sleepers.load() == 0)
+		return;
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_wakeGeneration++;
+	}
+	if (all)
+		m_sleepCondition.notify_all();
+	else
+		m_sleepCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter* counter)
+{
+	uint32_t threadIndex = GetThreadIndex();
+	int idle = 0;
+	while (!counter->IsDone())
+	{
+		if (RunOneJob(threadIndex))
+		{
+			idle = 0;
+			continue;
+		}
+		if (++idle < JOB_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		Sleep(threadIndex, counter);
+		idle = 0;
+	}
+	// The last job may still be releasing continuations under the lock, the counter has to outlive that
+	std::lock_guard<std::mutex> lock(counter->m_mutex);
+}
+
+void JobSystem::WorkerMain(uint32_t threadIndex)
+{
+	t_jobSystem = this;
+	t_threadIndex = threadIndex;
+#ifdef PROFILER_ENABLE
+	char name[32];
+	snprintf(name, sizeof(name), "Worker %u", threadIndex);
+	Profiler::SetThreadName(name);
+#endif
+
+	int idle = 0;
+	// Acquire, so everything the main thread did before Shutdown() (e.g. destroying the imgui context) is visible to the
+	// thread_local destructors that run when this thread exits
+	while (!m_quit.load(std::memory_order_acquire))
+	{
+		if (RunOneJob(threadIndex))
+		{
+			idle = 0;
+			continue;
+		}
+		if (++idle < JOB_SPIN_COUNT)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+		Sleep(threadIndex, nullptr);
+		idle = 0;
+	}
+}
@@ -0,0 +1,206 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+enum class JobAffinity : uint8_t
+{
+	// Runs on whichever thread gets to it first
+	Any,
+	// Only ever runs on the thread that called JobSystem::Init(), e.g. for window and imgui platform calls
+	MainThread,
+};
+
+/// <summary>
+/// Number of unfinished jobs attached to it. Jobs can be made to wait for a counter to reach zero with RunAfter(),
+/// or a thread can wait for it with JobSystem::Wait(). A counter can be reused once it is back to zero.
+/// </summary>
+class JobCounter
+{
+public:
+	bool IsDone() const { return m_value.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<int> m_value{ 0 };
+	// Continuations, released by whoever finishes the last job
+	std::mutex m_mutex;
+	struct Job* m_waitingJobs = nullptr;
+};
+
+struct JobSystemStats
+{
+	uint64_t Spawned = 0;
+	uint64_t Executed = 0;
+	uint64_t Stolen = 0;
+	uint64_t MainThreadJobs = 0;
+	uint64_t Sleeps = 0;
+};
+
+struct Job
+{
+	static int const STORAGE_SIZE = 64;
+
+	void (*Invoke)(Job* job);
+	JobCounter* Counter;
+	Job* Next;
+	JobAffinity Affinity;
+	// Thread whose pool the job came from, its slot goes back there once the job has run
+	uint32_t Owner;
+	alignas(16) unsigned char Storage[STORAGE_SIZE];
+};
+
+/// <summary>
+/// Work-stealing job scheduler. Every thread owns a fixed size deque: it pushes and pops its own jobs at the bottom
+/// (LIFO, cache friendly) while idle threads steal from the top of others (FIFO, oldest and usually biggest work).
+/// Thread 0 is the thread that called Init(); it takes part in running jobs whenever it calls Wait().
+/// Jobs are small callables stored inline, allocated from a per-thread pool, so spawning never touches the heap.
+/// </summary>
+class JobSystem
+{
+public:
+	static int const MAX_THREADS = 64;
+	// Per thread, both for the job pool and the deque. Spawning more runs other jobs until a slot is freed.
+	static int const MAX_JOBS_PER_THREAD = 4096;
+
+	JobSystem() = default;
+	~JobSystem();
+
+	// `numThreads` includes the calling thread, which becomes the main thread. 0 uses every hardware thread.
+	void Init(uint32_t numThreads = 0);
+	void Shutdown();
+
+	// Runs `func()` asynchronously. `counter` (optional) is incremented now and decremented once `func` returns.
+	template<typename F>
+	void Run(F&& func, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any)
+	{
+		Submit(CreateJob(std::forward<F>(func), counter, affinity), nullptr);
+	}
+
+	// Same as Run(), but `func` only becomes runnable once `dependency` reaches zero.
+	template<typename F>
+	void RunAfter(JobCounter* dependency, F&& func, JobCounter* counter = nullptr, JobAffinity affinity = JobAffinity::Any)
+	{
+		Submit(CreateJob(std::forward<F>(func), counter, affinity), dependency);
+	}
+
+	// Splits [0, count) into ranges of `batchSize` items and calls `func(begin, end)` on each in parallel.
+	// Returns once every range is done.
+	template<typename F>
+	void ParallelFor(uint32_t count, uint32_t batchSize, const F& func)
+	{
+		JobCounter counter;
+		batchSize = batchSize > 0 ? batchSize : 1;
+		for (uint32_t begin = 0; begin < count; begin += batchSize)
+		{
+			uint32_t end = count - begin > batchSize ? begin + batchSize : count;
+			Run([&func, begin, end]() { func(begin, end); }, &counter);
+		}
+		Wait(&counter);
+	}
+
+	// Runs other jobs until `counter` reaches zero. Only the main thread picks up MainThread jobs.
+	void Wait(JobCounter* counter);
+
+	uint32_t GetThreadCount() const { return m_threadCount; }
+	bool IsMainThread() const;
+	// Sums the per-thread counters. Exact once all jobs are done.
+	JobSystemStats GetStats() const;
+	void ResetStats();
+
+private:
+	// Chase-Lev deque of fixed capacity. Push/Pop from the owner only, Steal from anyone.
+	struct WorkQueue
+	{
+		bool Push(Job* job);
+		Job* Pop();
+		Job* Steal();
+		bool IsEmpty() const;
+
+		alignas(64) std::atomic<int64_t> Top{ 0 };
+		alignas(64) std::atomic<int64_t> Bottom{ 0 };
+		std::atomic<Job*> Jobs[MAX_JOBS_PER_THREAD];
+	};
+
+	// Written by the owning thread only
+	struct alignas(64) ThreadStats
+	{
+		std::atomic<uint64_t> Spawned{ 0 };
+		std::atomic<uint64_t> Executed{ 0 };
+		std::atomic<uint64_t> Stolen{ 0 };
+		std::atomic<uint64_t> MainThreadJobs{ 0 };
+		std::atomic<uint64_t> Sleeps{ 0 };
+	};
+
+	struct ThreadData
+	{
+		WorkQueue Queue;
+		Job* JobPool = nullptr;
+		// Free slots of JobPool, linked through Job::Next: the ones the owner ran itself, and the ones other threads
+		// ran (pushed by them, taken over by the owner all at once)
+		Job* FreeJobs = nullptr;
+		std::atomic<Job*> ReturnedJobs{ nullptr };
+		uint32_t StealSeed = 0;
+		ThreadStats Stats;
+	};
+
+	template<typename F>
+	Job* CreateJob(F&& func, JobCounter* counter, JobAffinity affinity)
+	{
+		typedef typename std::decay<F>::type Func;
+		static_assert(sizeof(Func) <= Job::STORAGE_SIZE, "Job captures too much state, capture a pointer instead");
+		static_assert(alignof(Func) <= 16, "Job captures over-aligned state");
+
+		Job* job = AllocateJob();
+		new (job->Storage) Func(std::forward<F>(func));
+		job->Invoke = [](Job* self)
+		{
+			Func* f = reinterpret_cast<Func*>(self->Storage);
+			(*f)();
+			f->~Func();
+		};
+		job->Counter = counter;
+		job->Affinity = affinity;
+		job->Next = nullptr;
+		return job;
+	}
+
+	static void Increment(JobCounter* counter);
+	Job* AllocateJob();
+	void ReleaseJob(Job* job);
+	void Submit(Job* job, JobCounter* dependency);
+	void Schedule(Job* job);
+	void Execute(Job* job);
+	void Finish(JobCounter* counter);
+	Job* FindJob(uint32_t threadIndex);
+	bool HasWork(uint32_t threadIndex) const;
+	bool RunOneJob(uint32_t threadIndex);
+	void Sleep(uint32_t threadIndex, JobCounter* counter);
+	void Wake(bool all);
+	void WorkerMain(uint32_t threadIndex);
+	uint32_t GetThreadIndex() const;
+
+	uint32_t m_threadCount = 0;
+	ThreadData* m_threads = nullptr;
+	void* m_threadMemory = nullptr;
+	std::vector<std::thread> m_workers;
+
+	// MainThread jobs, only drained by thread 0
+	mutable std::mutex m_mainQueueMutex;
+	std::deque<Job*> m_mainQueue;
+	std::atomic<uint32_t> m_mainQueueSize{ 0 };
+
+	// Idle threads sleep here. Every wake bumps the generation so a wake that races with a sleeper is never lost.
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+	std::atomic<uint32_t> m_sleepers{ 0 };
+	uint64_t m_wakeGeneration = 0;
+	std::atomic<bool> m_quit{ false };
+};
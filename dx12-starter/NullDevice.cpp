@@ -0,0 +1,410 @@
+#include "NullDevice.h"
+#include "Profiler.h"
+#include "UploadRingBuffer.h"
+#include "imgui.h"
+#include <algorithm>
+#include <cstring>
+
+// Resource
+
+SoftwareFramebuffer NullResource::GetFramebuffer()
+{
+	SoftwareFramebuffer framebuffer;
+	framebuffer.Pixels = m_pixels.data();
+	framebuffer.Width = m_width;
+	framebuffer.Height = m_height;
+	framebuffer.Stride = m_width;
+	return framebuffer;
+}
+
+// Fence
+
+uint64_t NullFence::GetCompletedValue()
+{
+	return m_completedValue.load(std::memory_order_acquire);
+}
+
+void NullFence::Wait(uint64_t value)
+{
+	// Work is "done" the moment it is submitted, so a wait on a signaled value never blocks
+	IM_ASSERT(GetCompletedValue() >= value && "Waiting on a fence value that was never signaled");
+	(void)value;
+}
+
+// Command list
+
+void NullCommandList::Reset(CommandAllocator* allocator)
+{
+	(void)allocator;
+	IM_ASSERT(m_closed && "Command list must be closed before it is reset");
+	m_commands.clear();
+	m_uploadedBytes = 0;
+	m_closed = false;
+}
+
+void NullCommandList::ResourceBarrier(Resource* resource, ResourceState before, ResourceState after)
+{
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::ResourceBarrier;
+	cmd.Target = resource;
+	cmd.StateBefore = before;
+	cmd.StateAfter = after;
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		NullCommand cmd = {};
+		cmd.Type = barriers[i].Type == BarrierType::Aliasing ? NullCommandType::AliasingBarrier : NullCommandType::ResourceBarrier;
+		cmd.Target = barriers[i].Target;
+		cmd.AliasBefore = barriers[i].AliasBefore;
+		cmd.StateBefore = barriers[i].StateBefore;
+		cmd.StateAfter = barriers[i].StateAfter;
+		cmd.Split = barriers[i].Split;
+		m_commands.push_back(cmd);
+	}
+}
+
+void NullCommandList::ClearRenderTarget(Resource* renderTarget, const float color[4])
+{
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::ClearRenderTarget;
+	cmd.Target = renderTarget;
+	for (int i = 0; i < 4; i++)
+		cmd.Color[i] = color[i];
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::SetRenderTarget(Resource* renderTarget)
+{
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::SetRenderTarget;
+	cmd.Target = renderTarget;
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::RenderDrawData(ImDrawData* drawData)
+{
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::RenderDrawData;
+	cmd.DrawData = drawData;
+	if (drawData != nullptr)
+	{
+		for (int n = 0; n < drawData->CmdListsCount; n++)
+			cmd.DrawCmdCount += drawData->CmdLists[n]->CmdBuffer.Size;
+		cmd.VtxCount = drawData->TotalVtxCount;
+		cmd.IdxCount = drawData->TotalIdxCount;
+		m_submission.Build(drawData);
+		cmd.DrawCallCount = m_submission.Stats.Draws;
+		cmd.ScissorChanges = m_submission.Stats.ScissorChanges;
+		cmd.TextureChanges = m_submission.Stats.TextureChanges;
+		UploadDrawData(drawData);
+	}
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::UploadDrawData(ImDrawData* drawData)
+{
+	// Same allocations and copies the DX12 backend makes, so headless runs exercise the upload heap
+	DynamicUploadHeap* heap = m_device->m_uploadHeap;
+	if (heap == nullptr)
+		return;
+	const ImDrawIdxPacking& packing = m_submission.Packing;
+	UploadAllocation vtx, idx;
+	if (!heap->Allocate((uint64_t)drawData->TotalVtxCount * sizeof(ImDrawVert), 16, vtx) ||
+		!heap->Allocate(packing.TotalBytes, 16, idx))
+		return;
+	ImDrawVert* vtxDst = (ImDrawVert*)vtx.CpuAddress;
+	for (int n = 0; n < drawData->CmdListsCount; n++)
+	{
+		const ImDrawList* cmdList = drawData->CmdLists[n];
+		memcpy(vtxDst, cmdList->VtxBuffer.Data, cmdList->VtxBuffer.Size * sizeof(ImDrawVert));
+		vtxDst += cmdList->VtxBuffer.Size;
+	}
+	drawData->PackIndices(packing, idx.CpuAddress);
+	m_uploadedBytes += (uint64_t)drawData->TotalVtxCount * sizeof(ImDrawVert) + packing.TotalBytes;
+}
+
+void NullCommandList::UpdateUITexture(const TextureUpdate& update)
+{
+	// Staged in the upload heap like the DX12 backend does (minus the pitch alignment), executed from there
+	DynamicUploadHeap* heap = m_device->m_uploadHeap;
+	uint64_t size = (uint64_t)update.Width * update.Height * 4;
+	UploadAllocation allocation;
+	if (heap == nullptr || !heap->Allocate(size, 16, allocation))
+		return;
+	memcpy(allocation.CpuAddress, update.Pixels, (size_t)size);
+	m_uploadedBytes += size;
+
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::UpdateTexture;
+	cmd.Texture = update;
+	cmd.Texture.Pixels = (const uint8_t*)allocation.CpuAddress;
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::WriteTimestamp(TimestampQueryHeap* heap, uint32_t index)
+{
+	IM_ASSERT(index < heap->GetCount());
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::WriteTimestamp;
+	cmd.QueryHeap = heap;
+	cmd.QueryIndex = index;
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count)
+{
+	IM_ASSERT(first + count <= heap->GetCount());
+	NullCommand cmd = {};
+	cmd.Type = NullCommandType::ResolveTimestamps;
+	cmd.QueryHeap = heap;
+	cmd.QueryIndex = first;
+	cmd.QueryCount = count;
+	m_commands.push_back(cmd);
+}
+
+void NullCommandList::Close()
+{
+	m_closed = true;
+}
+
+// Command queue
+
+void NullCommandQueue::ExecuteCommandLists(uint32_t count, CommandList* const* commandLists)
+{
+	for (uint32_t i = 0; i < count; i++)
+	{
+		NullCommandList* commandList = static_cast<NullCommandList*>(commandLists[i]);
+		IM_ASSERT(commandList->m_closed && "Command list must be closed before it is executed");
+		m_stats->CommandListsExecuted++;
+		m_stats->CommandsExecuted += commandList->m_commands.size();
+		m_stats->UploadedBytes += commandList->m_uploadedBytes;
+		NullResource* renderTarget = nullptr;
+		m_gpuTime = std::max(m_gpuTime, Profiler::Now());
+		for (const NullCommand& cmd : commandList->m_commands)
+		{
+			if (cmd.Type != NullCommandType::WriteTimestamp && cmd.Type != NullCommandType::ResolveTimestamps)
+				m_gpuTime += NULL_GPU_COMMAND_TICKS;
+			switch (cmd.Type)
+			{
+			case NullCommandType::ResourceBarrier:
+			case NullCommandType::AliasingBarrier:
+				m_stats->Barriers++;
+				break;
+			case NullCommandType::ClearRenderTarget:
+				if (m_rasterizer)
+					m_rasterizer->Clear(static_cast<NullResource*>(cmd.Target)->GetFramebuffer(), cmd.Color);
+				break;
+			case NullCommandType::SetRenderTarget:
+				renderTarget = static_cast<NullResource*>(cmd.Target);
+				break;
+			case NullCommandType::RenderDrawData:
+				m_stats->DrawDataSubmitted++;
+				m_stats->DrawCmds += cmd.DrawCmdCount;
+				m_stats->DrawCalls += cmd.DrawCallCount;
+				m_stats->ScissorChanges += cmd.ScissorChanges;
+				m_stats->TextureChanges += cmd.TextureChanges;
+				m_stats->Vertices += cmd.VtxCount;
+				m_stats->Indices += cmd.IdxCount;
+				// The draw data is still alive here, it is only rebuilt by the next ImGui::Render()
+				m_gpuTime += cmd.IdxCount;
+				if (m_rasterizer && renderTarget && cmd.DrawData)
+				{
+					// The rasterizer is the GPU, its real time counts
+					m_rasterizer->RenderDrawData(cmd.DrawData, renderTarget->GetFramebuffer());
+					m_gpuTime = std::max(m_gpuTime, Profiler::Now());
+				}
+				break;
+			case NullCommandType::UpdateTexture:
+				m_stats->TextureUpdates++;
+				if (m_rasterizer)
+					m_device->UpdateFontTexture(cmd.Texture);
+				break;
+			case NullCommandType::WriteTimestamp:
+				m_stats->Timestamps++;
+				static_cast<NullTimestampQueryHeap*>(cmd.QueryHeap)->m_queries[cmd.QueryIndex] = m_gpuTime;
+				break;
+			case NullCommandType::ResolveTimestamps:
+			{
+				NullTimestampQueryHeap* heap = static_cast<NullTimestampQueryHeap*>(cmd.QueryHeap);
+				std::copy(heap->m_queries.begin() + cmd.QueryIndex, heap->m_queries.begin() + cmd.QueryIndex + cmd.QueryCount,
+					heap->m_resolved.begin() + cmd.QueryIndex);
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+}
+
+void NullCommandQueue::Signal(Fence* fence, uint64_t value)
+{
+	static_cast<NullFence*>(fence)->m_completedValue.store(value, std::memory_order_release);
+}
+
+bool NullCommandQueue::GetClockCalibration(uint64_t* gpuTimestamp, uint64_t* cpuTime)
+{
+	*cpuTime = Profiler::Now();
+	*gpuTimestamp = *cpuTime;
+	return true;
+}
+
+// Swap chain
+
+uint32_t NullSwapChain::GetCurrentBackBufferIndex()
+{
+	return m_backBufferIndex;
+}
+
+Resource* NullSwapChain::GetBackBuffer(uint32_t index)
+{
+	return &m_backBuffers[index];
+}
+
+void NullSwapChain::Present(uint32_t syncInterval, uint32_t flags)
+{
+	(void)syncInterval;
+	(void)flags;
+	m_lastPresentedIndex = m_backBufferIndex;
+	m_backBufferIndex = (m_backBufferIndex + 1) % m_bufferCount;
+	m_stats->Presents++;
+}
+
+void NullSwapChain::Resize(uint32_t width, uint32_t height)
+{
+	m_width = width;
+	m_height = height;
+	if (m_rasterizer == nullptr)
+		return;
+
+	for (uint32_t i = 0; i < m_bufferCount; i++)
+	{
+		m_backBuffers[i].m_width = (int)width;
+		m_backBuffers[i].m_height = (int)height;
+		m_backBuffers[i].m_pixels.assign((size_t)width * height, 0);
+	}
+}
+
+// Device
+
+GraphicsDevice* CreateNullDevice(bool rasterize)
+{
+	return new NullDevice(rasterize);
+}
+
+NullDevice::NullDevice(bool rasterize)
+{
+	if (rasterize)
+		m_rasterizer = new SoftwareRasterizer();
+}
+
+NullDevice::~NullDevice()
+{
+	if (m_rasterizer) { delete m_rasterizer; m_rasterizer = nullptr; }
+}
+
+CommandQueue* NullDevice::CreateCommandQueue()
+{
+	NullCommandQueue* queue = new NullCommandQueue();
+	queue->m_stats = &m_stats;
+	queue->m_rasterizer = m_rasterizer;
+	queue->m_device = this;
+	return queue;
+}
+
+CommandAllocator* NullDevice::CreateCommandAllocator()
+{
+	return new NullCommandAllocator();
+}
+
+CommandList* NullDevice::CreateCommandList(CommandAllocator* allocator)
+{
+	(void)allocator;
+	NullCommandList* commandList = new NullCommandList();
+	commandList->m_device = this;
+	return commandList;
+}
+
+Fence* NullDevice::CreateFence(uint64_t initialValue)
+{
+	NullFence* fence = new NullFence();
+	fence->m_completedValue = initialValue;
+	return fence;
+}
+
+SwapChain* NullDevice::CreateSwapChain(CommandQueue* queue, const SwapChainDesc& desc)
+{
+	(void)queue;
+	IM_ASSERT(desc.bufferCount > 0 && desc.bufferCount <= NULL_MAX_BACK_BUFFERS);
+	NullSwapChain* swapChain = new NullSwapChain();
+	swapChain->m_bufferCount = desc.bufferCount;
+	swapChain->m_stats = &m_stats;
+	swapChain->m_rasterizer = m_rasterizer;
+	swapChain->Resize(desc.width, desc.height);
+	return swapChain;
+}
+
+Buffer* NullDevice::CreateUploadBuffer(uint64_t size)
+{
+	NullBuffer* buffer = new NullBuffer();
+	buffer->m_data.resize((size_t)size);
+	return buffer;
+}
+
+TimestampQueryHeap* NullDevice::CreateTimestampQueryHeap(uint32_t count)
+{
+	NullTimestampQueryHeap* heap = new NullTimestampQueryHeap();
+	heap->m_queries.resize(count);
+	heap->m_resolved.resize(count);
+	return heap;
+}
+
+bool NullDevice::InitUIBackend(int numFramesInFlight)
+{
+	(void)numFramesInFlight;
+	ImGuiIO& io = ImGui::GetIO();
+	IM_ASSERT(io.BackendRendererUserData == nullptr && "Already initialized a renderer backend!");
+	io.BackendRendererName = "imgui_impl_null";
+	io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+
+	// imgui requires a built font atlas before NewFrame(). There is no texture to upload it to,
+	// so give it a non-null placeholder ID.
+	unsigned char* pixels;
+	int width, height;
+	io.Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+	io.Fonts->SetTexID((ImTextureID)(intptr_t)1);
+	if (m_rasterizer)
+	{
+		m_fontPixels.assign(pixels, pixels + (size_t)width * height * 4);
+		m_fontWidth = width;
+		m_fontHeight = height;
+		m_rasterizer->RegisterTexture(io.Fonts->TexID, m_fontPixels.data(), width, height, 4, (io.Fonts->Flags & ImFontAtlasFlags_DistanceField) != 0);
+	}
+	return true;
+}
+
+void NullDevice::UpdateFontTexture(const TextureUpdate& update)
+{
+	IM_ASSERT(update.X + update.Width <= (uint32_t)m_fontWidth && update.Y + update.Height <= (uint32_t)m_fontHeight);
+	for (uint32_t y = 0; y < update.Height; y++)
+		memcpy(&m_fontPixels[((size_t)(update.Y + y) * m_fontWidth + update.X) * 4], update.Pixels + (size_t)y * update.Width * 4, (size_t)update.Width * 4);
+}
+
+void NullDevice::NewUIFrame()
+{
+}
+
+void NullDevice::ShutdownUIBackend()
+{
+	ImGuiIO& io = ImGui::GetIO();
+	if (m_rasterizer)
+		m_rasterizer->UnregisterTexture(io.Fonts->TexID);
+	m_fontPixels.clear();
+	io.Fonts->SetTexID(0);
+	io.BackendRendererName = nullptr;
+	io.BackendFlags &= ~ImGuiBackendFlags_RendererHasVtxOffset;
+}
@@ -0,0 +1,220 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include "SoftwareRasterizer.h"
+#include <atomic>
+#include <vector>
+
+static int const                    NULL_MAX_BACK_BUFFERS = 3;
+// Synthetic GPU clock: nanosecond ticks, every command takes NULL_GPU_COMMAND_TICKS plus one tick per index drawn
+static uint64_t const               NULL_TIMESTAMP_FREQUENCY = 1000000000;
+static uint64_t const               NULL_GPU_COMMAND_TICKS = 1000;
+
+class NullDevice;
+
+enum class NullCommandType : uint8_t
+{
+	ResourceBarrier,
+	AliasingBarrier,
+	ClearRenderTarget,
+	SetRenderTarget,
+	RenderDrawData,
+	UpdateTexture,
+	WriteTimestamp,
+	ResolveTimestamps,
+};
+
+/// <summary>
+/// A single recorded command. The null backend never touches a GPU, it only keeps enough
+/// data around to inspect or count what a frame would have submitted.
+/// </summary>
+struct NullCommand
+{
+	NullCommandType Type;
+	Resource* Target;
+	ResourceState StateBefore;
+	ResourceState StateAfter;
+	BarrierSplit Split;
+	Resource* AliasBefore;
+	float Color[4];
+	ImDrawData* DrawData;
+	int DrawCmdCount;
+	// What the DX12 backend submits for it: draws with adjacent commands merged, and the state set for them
+	int DrawCallCount;
+	int ScissorChanges;
+	int TextureChanges;
+	int VtxCount;
+	int IdxCount;
+	// Pixels point into the dynamic upload heap
+	TextureUpdate Texture;
+	TimestampQueryHeap* QueryHeap;
+	uint32_t QueryIndex;
+	uint32_t QueryCount;
+};
+
+struct NullDeviceStats
+{
+	uint64_t CommandListsExecuted = 0;
+	uint64_t CommandsExecuted = 0;
+	uint64_t Barriers = 0;
+	uint64_t DrawDataSubmitted = 0;
+	uint64_t DrawCmds = 0;
+	uint64_t DrawCalls = 0;
+	uint64_t ScissorChanges = 0;
+	uint64_t TextureChanges = 0;
+	uint64_t Vertices = 0;
+	uint64_t Indices = 0;
+	// Geometry bytes copied into the dynamic upload heap, like the DX12 backend would
+	uint64_t UploadedBytes = 0;
+	uint64_t TextureUpdates = 0;
+	uint64_t Presents = 0;
+	uint64_t Timestamps = 0;
+};
+
+class NullResource : public Resource
+{
+public:
+	SoftwareFramebuffer GetFramebuffer();
+
+	// Only allocated when the device rasterizes
+	std::vector<uint32_t> m_pixels;
+	int m_width = 0;
+	int m_height = 0;
+};
+
+class NullBuffer : public Buffer
+{
+public:
+	void* GetCpuAddress() override { return m_data.data(); }
+	// There is no separate GPU address space, hand out the CPU address so offsets line up
+	uint64_t GetGpuAddress() override { return (uint64_t)(uintptr_t)m_data.data(); }
+
+	std::vector<uint8_t> m_data;
+};
+
+class NullTimestampQueryHeap : public TimestampQueryHeap
+{
+public:
+	uint32_t GetCount() override { return (uint32_t)m_queries.size(); }
+	const uint64_t* GetResolvedData() override { return m_resolved.data(); }
+
+	std::vector<uint64_t> m_queries;
+	std::vector<uint64_t> m_resolved;
+};
+
+class NullFence : public Fence
+{
+public:
+	uint64_t GetCompletedValue() override;
+	void Wait(uint64_t value) override;
+
+	std::atomic<uint64_t> m_completedValue{ 0 };
+};
+
+class NullCommandAllocator : public CommandAllocator
+{
+public:
+	void Reset() override {}
+};
+
+class NullCommandList : public CommandList
+{
+public:
+	void Reset(CommandAllocator* allocator) override;
+	void ResourceBarrier(Resource* resource, ResourceState before, ResourceState after) override;
+	void ResourceBarriers(uint32_t count, const ResourceBarrierDesc* barriers) override;
+	void ClearRenderTarget(Resource* renderTarget, const float color[4]) override;
+	void SetRenderTarget(Resource* renderTarget) override;
+	void RenderDrawData(ImDrawData* drawData) override;
+	void UpdateUITexture(const TextureUpdate& update) override;
+	void WriteTimestamp(TimestampQueryHeap* heap, uint32_t index) override;
+	void ResolveTimestamps(TimestampQueryHeap* heap, uint32_t first, uint32_t count) override;
+	void Close() override;
+	void UploadDrawData(ImDrawData* drawData);
+
+	// Cleared on Reset() but keeps its capacity, so steady state recording does not allocate.
+	std::vector<NullCommand> m_commands;
+	bool m_closed = true;
+	// Lists record on several threads, so this is only added to the device stats on execute
+	uint64_t m_uploadedBytes = 0;
+	// Draw calls and 16/32-bit index layout of the last draw data, like the DX12 backend's
+	ImDrawSubmission m_submission;
+	NullDevice* m_device = nullptr;
+};
+
+class NullCommandQueue : public CommandQueue
+{
+public:
+	void ExecuteCommandLists(uint32_t count, CommandList* const* commandLists) override;
+	void Signal(Fence* fence, uint64_t value) override;
+	uint64_t GetTimestampFrequency() override { return NULL_TIMESTAMP_FREQUENCY; }
+	// The synthetic clock ticks in steady clock nanoseconds, so GPU and CPU time are the same thing
+	bool GetClockCalibration(uint64_t* gpuTimestamp, uint64_t* cpuTime) override;
+
+	NullDeviceStats* m_stats = nullptr;
+	SoftwareRasterizer* m_rasterizer = nullptr;
+	NullDevice* m_device = nullptr;
+	// Where the synthetic GPU is in its work. Idle GPUs catch up to the CPU clock on the next submit.
+	uint64_t                     m_gpuTime = 0;
+};
+
+class NullSwapChain : public SwapChain
+{
+public:
+	uint32_t GetCurrentBackBufferIndex() override;
+	Resource* GetBackBuffer(uint32_t index) override;
+	void WaitForNextFrame() override {}
+	void Present(uint32_t syncInterval, uint32_t flags) override;
+	bool SupportsTearing() override { return false; }
+	void Resize(uint32_t width, uint32_t height) override;
+	NullResource* GetLastPresentedBuffer() { return &m_backBuffers[m_lastPresentedIndex]; }
+
+	NullResource                 m_backBuffers[NULL_MAX_BACK_BUFFERS];
+	uint32_t                     m_bufferCount = 0;
+	uint32_t                     m_backBufferIndex = 0;
+	uint32_t                     m_lastPresentedIndex = 0;
+	uint32_t                     m_width = 0;
+	uint32_t                     m_height = 0;
+	NullDeviceStats* m_stats = nullptr;
+	SoftwareRasterizer* m_rasterizer = nullptr;
+};
+
+/// <summary>
+/// Headless graphics device. Command lists are recorded into memory and "executed" instantly on submit,
+/// so fences are always complete. Lets the whole frame loop run without a GPU (and on Linux).
+/// Optionally executes the recorded commands with the SoftwareRasterizer, so back buffers hold real pixels.
+/// </summary>
+class NullDevice : public GraphicsDevice
+{
+public:
+	NullDevice(bool rasterize);
+	~NullDevice() override;
+	const char* GetName() const override { return m_rasterizer ? "Software" : "Null"; }
+
+	CommandQueue* CreateCommandQueue() override;
+	CommandAllocator* CreateCommandAllocator() override;
+	CommandList* CreateCommandList(CommandAllocator* allocator) override;
+	Fence* CreateFence(uint64_t initialValue) override;
+	SwapChain* CreateSwapChain(CommandQueue* queue, const SwapChainDesc& desc) override;
+	Buffer* CreateUploadBuffer(uint64_t size) override;
+	TimestampQueryHeap* CreateTimestampQueryHeap(uint32_t count) override;
+	void SetDynamicUploadHeap(DynamicUploadHeap* heap) override { m_uploadHeap = heap; }
+	void FinishFrame(uint64_t fenceValue) override { (void)fenceValue; }
+	void RetireFrames(uint64_t completedFenceValue) override { (void)completedFenceValue; }
+
+	bool InitUIBackend(int numFramesInFlight) override;
+	void NewUIFrame() override;
+	void ShutdownUIBackend() override;
+
+	const NullDeviceStats& GetStats() const { return m_stats; }
+	SoftwareRasterizer* GetRasterizer() { return m_rasterizer; }
+	// Executes an UpdateTexture command on the rasterizer's copy of the font texture
+	void UpdateFontTexture(const TextureUpdate& update);
+
+	NullDeviceStats m_stats;
+	SoftwareRasterizer* m_rasterizer = nullptr;
+	DynamicUploadHeap* m_uploadHeap = nullptr;
+	// The "GPU" font texture. A copy, as the atlas pixels change while earlier frames are still being rasterized.
+	std::vector<uint8_t> m_fontPixels;
+	int m_fontWidth = 0;
+	int m_fontHeight = 0;
+};
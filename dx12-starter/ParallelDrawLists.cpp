@@ -0,0 +1,104 @@
+#include "ParallelDrawLists.h"
+#include "Profiler.h"
+
+void ParallelDrawLists::Init(JobSystem* jobs)
+{
+	m_jobs = jobs;
+}
+
+void ParallelDrawLists::Shutdown()
+{
+	if (m_jobs != nullptr)
+		m_jobs->Wait(&m_pending);
+	for (Item* item : m_items)
+	{
+		IM_DELETE(item->List);
+		delete item;
+	}
+	m_items.clear();
+	m_itemCount = 0;
+	for (ImDrawListSharedData* sharedData : m_sharedData)
+		delete sharedData;
+	m_sharedData.clear();
+	m_sharedDataCount = 0;
+	m_jobs = nullptr;
+}
+
+ParallelDrawLists::Item* ParallelDrawLists::BeginItem(const ImVec2& size)
+{
+	IM_ASSERT(m_jobs != nullptr && m_jobs->IsMainThread());
+	ImDrawList* host = ImGui::GetWindowDrawList();
+	ImVec2 min = ImGui::GetCursorScreenPos();
+	ImGui::Dummy(size);
+	if (!ImGui::IsItemVisible())
+	{
+		m_building.Dropped++;
+		return nullptr;
+	}
+
+	if (m_itemCount == m_items.size())
+		m_items.push_back(new Item{ IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()), nullptr, ImVec2(), ImVec2() });
+	Item* item = m_items[m_itemCount++];
+	item->Host = host;
+	item->Min = min;
+	item->Max = ImVec2(min.x + size.x, min.y + size.y);
+
+	// A new snapshot for the first list of the frame and whenever the font changed since the last one
+	const ImDrawListSharedData* current = ImGui::GetDrawListSharedData();
+	ImDrawListSharedData* shared = m_sharedDataCount > 0 ? m_sharedData[m_sharedDataCount - 1] : nullptr;
+	if (shared == nullptr || shared->Font != current->Font || shared->FontSize != current->FontSize)
+	{
+		if (m_sharedDataCount == m_sharedData.size())
+			m_sharedData.push_back(new ImDrawListSharedData());
+		shared = m_sharedData[m_sharedDataCount++];
+		*shared = *current;
+		// imgui's text layout cache is main thread only
+		shared->TextLayoutCache = nullptr;
+	}
+
+	// Set up like imgui does for a window's list, everything after this is up to the worker
+	ImDrawList* list = item->List;
+	list->_Data = shared;
+	list->_ResetForNewFrame();
+	list->PushTextureID(ImGui::GetIO().Fonts->TexID);
+	list->PushClipRect(host->GetClipRectMin(), host->GetClipRectMax());
+	m_building.Built++;
+	return item;
+}
+
+void ParallelDrawLists::Splice(const ImDrawData* drawData, ImVector<ImDrawList*>& out)
+{
+	{
+		PROFILE_ZONE("ParallelDrawLists::Wait");
+		m_jobs->Wait(&m_pending);
+	}
+
+	out.resize(0);
+	for (uint32_t i = 0; i < m_itemCount; i++)
+		m_items[i]->List->_PopUnusedDrawCmd();
+	for (int n = 0; n < drawData->CmdListsCount; n++)
+	{
+		ImDrawList* host = drawData->CmdLists[n];
+		out.push_back(host);
+		// In the order they were added
+		for (uint32_t i = 0; i < m_itemCount; i++)
+		{
+			Item* item = m_items[i];
+			if (item->Host != host)
+				continue;
+			item->Host = nullptr;
+			if (item->List->CmdBuffer.Size == 0)
+				continue;
+			IM_ASSERT(sizeof(ImDrawIdx) != 2 || item->List->_VtxCurrentIdx <= (1 << 16) || (item->List->Flags & ImDrawListFlags_AllowVtxOffset));
+			out.push_back(item->List);
+			m_building.Spliced++;
+		}
+	}
+	for (uint32_t i = 0; i < m_itemCount; i++)
+		m_building.Dropped += m_items[i]->Host != nullptr ? 1 : 0;
+
+	m_stats = m_building;
+	m_building = ParallelDrawListsStats();
+	m_itemCount = 0;
+	m_sharedDataCount = 0;
+}
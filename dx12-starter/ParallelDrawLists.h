@@ -0,0 +1,68 @@
+#pragma once
+#include "JobSystem.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <vector>
+
+struct ParallelDrawListsStats
+{
+	// Last frame
+	uint32_t Built = 0;
+	uint32_t Spliced = 0;
+	// Added in a window that didn't make it into the draw data (e.g. collapsed), or clipped before building
+	uint32_t Dropped = 0;
+};
+
+/// <summary>
+/// Builds heavy custom content (plots, node graphs) into draw lists of its own on job system workers, while the main
+/// thread goes on with the rest of the UI. imgui keeps updating its ImDrawListSharedData while windows are built (the
+/// current font and size), so the lists share a read-only snapshot of it instead, taken again only when the font
+/// changes. Once imgui has rendered, Splice() inserts each list right after the draw list of the window it was added
+/// in, so it draws over that window's widgets and under any window in front of it.
+/// </summary>
+class ParallelDrawLists
+{
+public:
+	~ParallelDrawLists() { Shutdown(); }
+	void Init(JobSystem* jobs);
+	void Shutdown();
+
+	// Main thread, inside a window between ImGui::NewFrame() and ImGui::Render(). Takes `size` at the cursor like
+	// ImGui::Dummy() and calls `build(ImDrawList*, ImVec2 min, ImVec2 max)` on a worker, with the window's clip rect
+	// and the font texture pushed. Whatever `build` reads has to stay unchanged until Splice().
+	template<typename F>
+	void Add(const ImVec2& size, F&& build)
+	{
+		Item* item = BeginItem(size);
+		if (item == nullptr)
+			return;
+		m_jobs->Run([item, build]() { build(item->List, item->Min, item->Max); }, &m_pending);
+	}
+
+	// After ImGui::Render(): waits for the builds, then writes the draw data's lists with the built ones inserted to
+	// `out`. The lists stay valid until the next frame's Add() calls.
+	void Splice(const ImDrawData* drawData, ImVector<ImDrawList*>& out);
+
+	const ParallelDrawListsStats& GetStats() const { return m_stats; }
+
+private:
+	struct Item
+	{
+		ImDrawList* List;
+		const ImDrawList* Host;
+		ImVec2 Min;
+		ImVec2 Max;
+	};
+
+	Item* BeginItem(const ImVec2& size);
+
+	JobSystem*                         m_jobs = nullptr;
+	JobCounter                         m_pending;
+	// Kept from frame to frame, so the lists' buffers are warm and allocation free once the UI settles
+	std::vector<Item*>                 m_items;
+	uint32_t                           m_itemCount = 0;
+	std::vector<ImDrawListSharedData*> m_sharedData;
+	uint32_t                           m_sharedDataCount = 0;
+	ParallelDrawListsStats             m_stats;
+	ParallelDrawListsStats             m_building;
+};
@@ -0,0 +1,256 @@
+#include "Profiler.h"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+static uint32_t const               PROFILER_FRAME_HISTORY = 64;
+
+// Every buffer ever created, newest first. Buffers are never freed, so events of threads that already exited can
+// still be read and the list can be walked without locks.
+static std::atomic<ProfilerThreadBuffer*> s_threads{ nullptr };
+static std::atomic<uint32_t>        s_nextThreadId{ 0 };
+static thread_local ProfilerThreadBuffer* t_buffer = nullptr;
+
+// Frame starts are only written by the thread calling NewFrame()
+static uint64_t                     s_frameStarts[PROFILER_FRAME_HISTORY];
+static std::atomic<uint64_t>        s_frameCount{ 0 };
+
+// Window state
+static bool                         s_paused = false;
+static uint64_t                     s_shownFrameStart = 0;
+static uint64_t                     s_shownFrameEnd = 0;
+static std::vector<ProfilerThreadEvents> s_shownThreads;
+static const char* s_saveResult = nullptr;
+
+static ProfilerThreadBuffer* CreateBuffer(const char* name)
+{
+	ProfilerThreadBuffer* buffer = new ProfilerThreadBuffer();
+	buffer->m_id = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+	if (name != nullptr)
+		snprintf(buffer->m_name, sizeof(buffer->m_name), "%s", name);
+	else
+		snprintf(buffer->m_name, sizeof(buffer->m_name), "Thread %u", buffer->m_id);
+	ProfilerThreadBuffer* head = s_threads.load(std::memory_order_relaxed);
+	do
+	{
+		buffer->m_next = head;
+	} while (!s_threads.compare_exchange_weak(head, buffer, std::memory_order_release, std::memory_order_relaxed));
+	return buffer;
+}
+
+static ProfilerThreadBuffer* GetThreadBuffer()
+{
+	if (t_buffer == nullptr)
+		t_buffer = CreateBuffer(nullptr);
+	return t_buffer;
+}
+
+void ProfilerThreadBuffer::Read(uint64_t since, std::vector<ProfilerEvent>& out) const
+{
+	uint64_t head = m_head.load(std::memory_order_acquire);
+	uint64_t first = head > CAPACITY ? head - CAPACITY : 0;
+	size_t base = out.size();
+	for (uint64_t i = first; i < head; i++)
+		out.push_back(m_events[i & (CAPACITY - 1)]);
+
+	// The writer may have lapped us while copying: anything it could have started to overwrite is dropped
+	uint64_t newHead = m_head.load(std::memory_order_acquire);
+	uint64_t safe = newHead >= CAPACITY ? newHead - CAPACITY + 1 : 0;
+	size_t torn = (size_t)std::min(head - first, safe > first ? safe - first : 0);
+	out.erase(out.begin() + base, out.begin() + base + torn);
+	out.erase(std::remove_if(out.begin() + base, out.end(), [since](const ProfilerEvent& event) { return event.End <= since; }), out.end());
+}
+
+uint64_t Profiler::Now()
+{
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+uint64_t Profiler::BeginZone()
+{
+	GetThreadBuffer()->m_depth++;
+	return Now();
+}
+
+void Profiler::EndZone(const char* name, uint64_t start)
+{
+	uint64_t end = Now();
+	ProfilerThreadBuffer* buffer = t_buffer;
+	buffer->m_depth--;
+	buffer->Push({ name, start, end, buffer->m_depth });
+}
+
+void Profiler::SetThreadName(const char* name)
+{
+	ProfilerThreadBuffer* buffer = GetThreadBuffer();
+	snprintf(buffer->m_name, sizeof(buffer->m_name), "%s", name);
+}
+
+ProfilerThreadBuffer* Profiler::RegisterTrack(const char* name)
+{
+	return CreateBuffer(name);
+}
+
+void Profiler::NewFrame()
+{
+	uint64_t count = s_frameCount.load(std::memory_order_relaxed);
+	s_frameStarts[count % PROFILER_FRAME_HISTORY] = Now();
+	s_frameCount.store(count + 1, std::memory_order_release);
+}
+
+uint32_t Profiler::GetFrameStarts(uint64_t* starts, uint32_t count)
+{
+	uint64_t frames = s_frameCount.load(std::memory_order_acquire);
+	count = (uint32_t)std::min<uint64_t>(std::min(count, PROFILER_FRAME_HISTORY - 1), frames);
+	for (uint32_t i = 0; i < count; i++)
+		starts[i] = s_frameStarts[(frames - count + i) % PROFILER_FRAME_HISTORY];
+	return count;
+}
+
+void Profiler::Collect(uint64_t since, std::vector<ProfilerThreadEvents>& out)
+{
+	out.clear();
+	for (ProfilerThreadBuffer* buffer = s_threads.load(std::memory_order_acquire); buffer != nullptr; buffer = buffer->m_next)
+	{
+		out.emplace_back();
+		ProfilerThreadEvents& thread = out.back();
+		thread.ThreadId = buffer->m_id;
+		thread.ThreadName = buffer->m_name;
+		buffer->Read(since, thread.Events);
+	}
+	std::sort(out.begin(), out.end(), [](const ProfilerThreadEvents& a, const ProfilerThreadEvents& b) { return a.ThreadId < b.ThreadId; });
+}
+
+static void WriteJsonString(FILE* f, const char* s)
+{
+	fputc('"', f);
+	for (; *s != '\0'; s++)
+	{
+		if (*s == '"' || *s == '\\')
+			fputc('\\', f);
+		if ((unsigned char)*s < 0x20)
+			fprintf(f, "\\u%04x", (unsigned char)*s);
+		else
+			fputc(*s, f);
+	}
+	fputc('"', f);
+}
+
+bool Profiler::ExportChromeTrace(const char* path)
+{
+	FILE* f = fopen(path, "wb");
+	if (!f)
+		return false;
+
+	std::vector<ProfilerThreadEvents> threads;
+	Collect(0, threads);
+	uint64_t origin = UINT64_MAX;
+	for (const ProfilerThreadEvents& thread : threads)
+		for (const ProfilerEvent& event : thread.Events)
+			origin = std::min(origin, event.Start);
+
+	// Complete ("X") events in microseconds, relative to the first one
+	fprintf(f, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	bool first = true;
+	for (const ProfilerThreadEvents& thread : threads)
+	{
+		fprintf(f, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", first ? "" : ",\n", thread.ThreadId);
+		WriteJsonString(f, thread.ThreadName);
+		fprintf(f, "}}");
+		first = false;
+		for (const ProfilerEvent& event : thread.Events)
+		{
+			fprintf(f, ",\n{\"name\":");
+			WriteJsonString(f, event.Name);
+			fprintf(f, ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}", thread.ThreadId,
+				(event.Start - origin) / 1000.0, (event.End - event.Start) / 1000.0);
+		}
+	}
+	fprintf(f, "\n]}\n");
+	return fclose(f) == 0;
+}
+
+static ImU32 ZoneColor(const char* name)
+{
+	// Same name, same color, frame after frame
+	uint32_t hash = 2166136261u;
+	for (const char* c = name; *c != '\0'; c++)
+		hash = (hash ^ (uint8_t)*c) * 16777619u;
+	return ImColor::HSV((hash % 360) / 360.0f, 0.45f, 0.75f);
+}
+
+void Profiler::ShowWindow(bool* open)
+{
+	ImGui::SetNextWindowSize(ImVec2(640, 320), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Profiler", open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	ImGui::Checkbox("Pause", &s_paused);
+	ImGui::SameLine();
+	if (ImGui::Button("Save trace.json"))
+		s_saveResult = ExportChromeTrace("trace.json") ? "Saved" : "Unable to write trace.json";
+	if (s_saveResult != nullptr)
+	{
+		ImGui::SameLine();
+		ImGui::TextUnformatted(s_saveResult);
+	}
+
+	// The last complete frame. Work of the frame before (e.g. a pipelined render job) that overlaps it shows up too.
+	uint64_t starts[2];
+	if (!s_paused && GetFrameStarts(starts, 2) == 2)
+	{
+		s_shownFrameStart = starts[0];
+		s_shownFrameEnd = starts[1];
+		Collect(s_shownFrameStart, s_shownThreads);
+	}
+	if (s_shownFrameEnd <= s_shownFrameStart)
+	{
+		ImGui::TextUnformatted("Waiting for frames...");
+		ImGui::End();
+		return;
+	}
+	ImGui::Text("Frame: %.3f ms", (s_shownFrameEnd - s_shownFrameStart) / 1e6);
+
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+	float width = std::max(ImGui::GetContentRegionAvail().x, 1.0f);
+	float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	double scale = width / (double)(s_shownFrameEnd - s_shownFrameStart);
+	for (const ProfilerThreadEvents& thread : s_shownThreads)
+	{
+		uint32_t rows = 0;
+		for (const ProfilerEvent& event : thread.Events)
+			if (event.Start < s_shownFrameEnd)
+				rows = std::max(rows, event.Depth + 1);
+		if (rows == 0)
+			continue;
+
+		ImGui::TextUnformatted(thread.ThreadName);
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		for (const ProfilerEvent& event : thread.Events)
+		{
+			if (event.Start >= s_shownFrameEnd)
+				continue;
+			// Clamped to the frame, zones that started earlier or end later are cut off at the edges
+			float x0 = origin.x + (float)(std::max(event.Start, s_shownFrameStart) - s_shownFrameStart) * (float)scale;
+			float x1 = origin.x + (float)(std::min(event.End, s_shownFrameEnd) - s_shownFrameStart) * (float)scale;
+			x1 = std::max(x1, x0 + 1.0f);
+			ImVec2 min(x0, origin.y + event.Depth * rowHeight);
+			ImVec2 max(x1, min.y + rowHeight - 1.0f);
+			drawList->AddRectFilled(min, max, ZoneColor(event.Name));
+			if (x1 - x0 > 8.0f)
+			{
+				drawList->PushClipRect(min, max, true);
+				drawList->AddText(ImVec2(x0 + 2.0f, min.y + 2.0f), IM_COL32(0, 0, 0, 255), event.Name);
+				drawList->PopClipRect();
+			}
+			if (ImGui::IsMouseHoveringRect(min, max))
+				ImGui::SetTooltip("%s\n%.3f ms", event.Name, (event.End - event.Start) / 1e6);
+		}
+		ImGui::Dummy(ImVec2(width, rows * rowHeight));
+	}
+	ImGui::End();
+}
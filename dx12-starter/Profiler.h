@@ -0,0 +1,114 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Zones compile to nothing when PROFILER_DISABLE is defined (e.g. in the project's preprocessor definitions)
+#ifndef PROFILER_DISABLE
+#define PROFILER_ENABLE
+#endif
+
+/// <summary>
+/// One finished zone. Times are nanoseconds on the profiler's clock, `Depth` is the number of zones it is nested in
+/// on its thread.
+/// </summary>
+struct ProfilerEvent
+{
+	const char* Name;
+	uint64_t Start;
+	uint64_t End;
+	uint32_t Depth;
+};
+
+struct ProfilerThreadEvents
+{
+	uint32_t ThreadId;
+	const char* ThreadName;
+	// Oldest first
+	std::vector<ProfilerEvent> Events;
+};
+
+/// <summary>
+/// Ring of the last CAPACITY events of one thread (or track). Only the owning thread writes, and never waits: readers
+/// copy the events out and then drop whatever the writer may have overwritten meanwhile, which they can tell from the
+/// head.
+/// </summary>
+class ProfilerThreadBuffer
+{
+public:
+	static uint32_t const CAPACITY = 1 << 15;
+
+	void Push(const ProfilerEvent& event)
+	{
+		uint64_t head = m_head.load(std::memory_order_relaxed);
+		m_events[head & (CAPACITY - 1)] = event;
+		m_head.store(head + 1, std::memory_order_release);
+	}
+	// Appends the events that end after `since`
+	void Read(uint64_t since, std::vector<ProfilerEvent>& out) const;
+
+	uint32_t                     m_id = 0;
+	char                         m_name[32] = {};
+	// Zones currently open on the thread
+	uint32_t                     m_depth = 0;
+	ProfilerThreadBuffer* m_next = nullptr;
+
+private:
+	std::atomic<uint64_t>        m_head{ 0 };
+	ProfilerEvent                m_events[CAPACITY];
+};
+
+/// <summary>
+/// Scoped CPU profiler. Every thread gets its own ring buffer the first time it opens a zone, so recording takes no
+/// locks and allocates nothing after that. The main thread marks frames with NewFrame(); the window shows the zones
+/// of the last complete frame as a flame graph per thread, and ExportChromeTrace() writes everything still in the
+/// rings as Trace Event JSON for chrome://tracing or Perfetto.
+/// Use the PROFILE_* macros rather than calling it directly, so disabled builds don't even evaluate the names.
+/// </summary>
+class Profiler
+{
+public:
+	static uint64_t Now();
+	static uint64_t BeginZone();
+	static void EndZone(const char* name, uint64_t start);
+	// Names the calling thread in the window and in traces. Threads without a name show up as "Thread <id>".
+	static void SetThreadName(const char* name);
+	// A timeline that doesn't belong to a thread, e.g. GPU work. Whoever pushes events into it has to do so from one
+	// thread at a time, same as a thread's own buffer.
+	static ProfilerThreadBuffer* RegisterTrack(const char* name);
+	static void NewFrame();
+
+	// Snapshot of every thread's events that end after `since`
+	static void Collect(uint64_t since, std::vector<ProfilerThreadEvents>& out);
+	// Start of the last `count` frames, oldest first. Returns how many there were.
+	static uint32_t GetFrameStarts(uint64_t* starts, uint32_t count);
+	static bool ExportChromeTrace(const char* path);
+	// Flame graph of the last complete frame. Needs a current imgui frame.
+	static void ShowWindow(bool* open);
+};
+
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name) : m_name(name), m_start(Profiler::BeginZone()) {}
+	~ProfileZone() { Profiler::EndZone(m_name, m_start); }
+	ProfileZone(const ProfileZone&) = delete;
+	ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+	const char* m_name;
+	uint64_t m_start;
+};
+
+#ifdef PROFILER_ENABLE
+#define PROFILER_CONCAT_(a, b) a##b
+#define PROFILER_CONCAT(a, b) PROFILER_CONCAT_(a, b)
+// Times the rest of the enclosing scope. `name` has to be a string that outlives the profiler, e.g. a literal.
+#define PROFILE_ZONE(name) ProfileZone PROFILER_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() Profiler::NewFrame()
+#define PROFILE_THREAD_NAME(name) Profiler::SetThreadName(name)
+#else
+#define PROFILE_ZONE(name) (void)0
+#define PROFILE_FRAME() (void)0
+#define PROFILE_THREAD_NAME(name) (void)0
+#endif
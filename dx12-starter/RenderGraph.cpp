@@ -0,0 +1,533 @@
+#include "RenderGraph.h"
+#include "GpuProfiler.h"
+#include "imgui.h"
+#include "Profiler.h"
+#include <algorithm>
+
+Resource* RenderGraphContext::GetResource(RenderGraphResource resource) const
+{
+	return Graph->GetResource(resource);
+}
+
+// Building
+
+void RenderGraph::Reset()
+{
+	m_resources.clear();
+	m_passes.clear();
+	m_accesses.clear();
+	m_compiled = false;
+}
+
+RenderGraphResource RenderGraph::ImportResource(const char* name, Resource* resource, ResourceState initialState, ResourceState finalState)
+{
+	ResourceNode node = {};
+	node.Name = name;
+	node.Native = resource;
+	node.Imported = true;
+	node.InitialState = initialState;
+	node.FinalState = finalState;
+	m_resources.push_back(node);
+	return (RenderGraphResource)m_resources.size() - 1;
+}
+
+RenderGraphResource RenderGraph::CreateTransient(const char* name, const TransientResourceDesc& desc)
+{
+	IM_ASSERT(desc.Size > 0 && desc.Alignment > 0 && (desc.Alignment & (desc.Alignment - 1)) == 0);
+	ResourceNode node = {};
+	node.Name = name;
+	node.Desc = desc;
+	m_resources.push_back(node);
+	return (RenderGraphResource)m_resources.size() - 1;
+}
+
+void RenderGraph::BindTransient(RenderGraphResource resource, Resource* placed)
+{
+	IM_ASSERT(!m_resources[resource].Imported);
+	m_resources[resource].Native = placed;
+}
+
+RenderGraphPass RenderGraph::AddPass(const char* name, PassFunc execute)
+{
+	m_passes.emplace_back();
+	PassNode& node = m_passes.back();
+	node.Name = name;
+	node.Execute = std::move(execute);
+	node.NeverCull = false;
+	node.Culled = false;
+	node.FirstAccess = 0;
+	node.AccessCount = 0;
+	m_compiled = false;
+	return (RenderGraphPass)m_passes.size() - 1;
+}
+
+void RenderGraph::SetNeverCull(RenderGraphPass pass)
+{
+	m_passes[pass].NeverCull = true;
+}
+
+void RenderGraph::Read(RenderGraphPass pass, RenderGraphResource resource, ResourceState state)
+{
+	AddAccess(pass, resource, state, true, false);
+}
+
+void RenderGraph::Write(RenderGraphPass pass, RenderGraphResource resource, ResourceState state)
+{
+	AddAccess(pass, resource, state, false, true);
+}
+
+void RenderGraph::Modify(RenderGraphPass pass, RenderGraphResource resource, ResourceState state)
+{
+	AddAccess(pass, resource, state, true, true);
+}
+
+void RenderGraph::AddAccess(RenderGraphPass pass, RenderGraphResource resource, ResourceState state, bool reads, bool writes)
+{
+	IM_ASSERT(pass < m_passes.size() && resource < m_resources.size());
+	IM_ASSERT((!writes || !IsReadOnlyState(state)) && "Writing a resource in a read-only state");
+	m_accesses.push_back({ pass, resource, state, reads, writes });
+	m_compiled = false;
+}
+
+// Compiling
+
+bool RenderGraph::Compile()
+{
+	m_stats = RenderGraphStats();
+	m_stats.Passes = (uint32_t)m_passes.size();
+	if (!SortAccesses() || !CullPasses())
+		return false;
+	PlaceTransients();
+	BuildBarriers();
+	m_compiled = true;
+	return true;
+}
+
+bool RenderGraph::SortAccesses()
+{
+	// Counting sort by pass, accesses may have been declared in any order
+	m_scratch.assign(m_passes.size() + 1, 0);
+	for (const Access& access : m_accesses)
+		m_scratch[access.Pass + 1]++;
+	for (size_t i = 1; i < m_scratch.size(); i++)
+		m_scratch[i] += m_scratch[i - 1];
+	m_sortedAccesses.resize(m_accesses.size());
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		m_passes[i].FirstAccess = m_scratch[i];
+		m_passes[i].AccessCount = m_scratch[i + 1] - m_scratch[i];
+	}
+	for (const Access& access : m_accesses)
+		m_sortedAccesses[m_scratch[access.Pass]++] = access;
+
+	// Fold multiple uses of the same resource by one pass into a single access. Passes only touch a handful of
+	// resources, so the quadratic search is cheaper than anything smarter.
+	uint32_t out = 0;
+	for (PassNode& pass : m_passes)
+	{
+		uint32_t begin = pass.FirstAccess;
+		uint32_t end = pass.FirstAccess + pass.AccessCount;
+		// Compacted in place, `out` never passes `i`
+		pass.FirstAccess = out;
+		for (uint32_t i = begin; i < end; i++)
+		{
+			const Access& access = m_sortedAccesses[i];
+			uint32_t j = pass.FirstAccess;
+			while (j < out && m_sortedAccesses[j].Resource != access.Resource)
+				j++;
+			if (j == out)
+			{
+				m_sortedAccesses[out++] = access;
+				continue;
+			}
+			Access& merged = m_sortedAccesses[j];
+			if (merged.State != access.State)
+			{
+				// Only reads can be combined into one state
+				if (merged.Writes || access.Writes || !IsReadOnlyState(merged.State) || !IsReadOnlyState(access.State))
+					return false;
+				merged.State = merged.State | access.State;
+			}
+			merged.Reads |= access.Reads;
+			merged.Writes |= access.Writes;
+		}
+		pass.AccessCount = out - pass.FirstAccess;
+	}
+	m_sortedAccesses.resize(out);
+	return true;
+}
+
+bool RenderGraph::CullPasses()
+{
+	// Walk backwards keeping track of which resources still have a reader further down. A pass survives if it writes
+	// one of them. Writing a whole resource ends the interest in its previous contents, so passes that only produce
+	// data somebody overwrites before reading it get culled as well.
+	m_needed.assign(m_resources.size(), false);
+	for (size_t i = 0; i < m_resources.size(); i++)
+		m_needed[i] = m_resources[i].Imported;
+
+	for (size_t p = m_passes.size(); p-- > 0;)
+	{
+		PassNode& pass = m_passes[p];
+		const Access* accesses = m_sortedAccesses.data() + pass.FirstAccess;
+		bool alive = pass.NeverCull;
+		for (uint32_t i = 0; i < pass.AccessCount && !alive; i++)
+			alive = accesses[i].Writes && m_needed[accesses[i].Resource];
+		pass.Culled = !alive;
+		if (!alive)
+		{
+			m_stats.CulledPasses++;
+			continue;
+		}
+		for (uint32_t i = 0; i < pass.AccessCount; i++)
+			if (accesses[i].Writes && !accesses[i].Reads)
+				m_needed[accesses[i].Resource] = false;
+		for (uint32_t i = 0; i < pass.AccessCount; i++)
+			if (accesses[i].Reads)
+				m_needed[accesses[i].Resource] = true;
+	}
+
+	// Anything transient still needed at the start of the graph is read before it was ever written
+	for (size_t i = 0; i < m_resources.size(); i++)
+		if (m_needed[i] && !m_resources[i].Imported)
+			return false;
+
+	m_executeOrder.clear();
+	for (size_t p = 0; p < m_passes.size(); p++)
+		if (!m_passes[p].Culled)
+			m_executeOrder.push_back((RenderGraphPass)p);
+
+	for (ResourceNode& resource : m_resources)
+	{
+		resource.FirstUse = RENDER_GRAPH_INVALID;
+		resource.LastUse = RENDER_GRAPH_INVALID;
+		resource.HeapOffset = 0;
+		resource.AliasBefore = RENDER_GRAPH_INVALID;
+		resource.Aliased = false;
+	}
+	for (uint32_t e = 0; e < (uint32_t)m_executeOrder.size(); e++)
+	{
+		const PassNode& pass = m_passes[m_executeOrder[e]];
+		for (uint32_t i = 0; i < pass.AccessCount; i++)
+		{
+			ResourceNode& resource = m_resources[m_sortedAccesses[pass.FirstAccess + i].Resource];
+			if (resource.FirstUse == RENDER_GRAPH_INVALID)
+				resource.FirstUse = e;
+			resource.LastUse = e;
+		}
+	}
+	return true;
+}
+
+void RenderGraph::PlaceTransients()
+{
+	// Linear scan in execution order: before placing the resources first used by a pass, the memory of everything
+	// that died before it goes back to the free list, then each new resource takes the best fitting free block or
+	// extends the heap
+	m_scratch.clear();
+	for (uint32_t i = 0; i < (uint32_t)m_resources.size(); i++)
+		if (!m_resources[i].Imported && m_resources[i].FirstUse != RENDER_GRAPH_INVALID)
+			m_scratch.push_back(i);
+	m_releaseOrder = m_scratch;
+	std::sort(m_scratch.begin(), m_scratch.end(), [this](uint32_t a, uint32_t b)
+		{
+			const ResourceNode& ra = m_resources[a];
+			const ResourceNode& rb = m_resources[b];
+			// Larger first within a pass, it packs better
+			if (ra.FirstUse != rb.FirstUse)
+				return ra.FirstUse < rb.FirstUse;
+			return ra.Desc.Size != rb.Desc.Size ? ra.Desc.Size > rb.Desc.Size : a < b;
+		});
+	std::sort(m_releaseOrder.begin(), m_releaseOrder.end(), [this](uint32_t a, uint32_t b)
+		{
+			return m_resources[a].LastUse != m_resources[b].LastUse ? m_resources[a].LastUse < m_resources[b].LastUse : a < b;
+		});
+
+	m_freeByOffset.clear();
+	m_freeBySize.clear();
+	m_memoryOwners.clear();
+	size_t released = 0;
+	for (uint32_t resourceIndex : m_scratch)
+	{
+		ResourceNode& resource = m_resources[resourceIndex];
+		for (; released < m_releaseOrder.size() && m_resources[m_releaseOrder[released]].LastUse < resource.FirstUse; released++)
+		{
+			const ResourceNode& dead = m_resources[m_releaseOrder[released]];
+			FreeTransientMemory(dead.HeapOffset, dead.Desc.Size);
+		}
+		resource.HeapOffset = AllocateTransientMemory(resource.Desc.Size, resource.Desc.Alignment);
+		ClaimMemory(resourceIndex);
+		m_stats.TransientBytes += resource.Desc.Size;
+	}
+}
+
+uint64_t RenderGraph::AllocateTransientMemory(uint64_t size, uint64_t alignment)
+{
+	uint64_t alignMask = alignment - 1;
+	for (std::multimap<uint64_t, uint64_t>::iterator it = m_freeBySize.lower_bound(size); it != m_freeBySize.end(); ++it)
+	{
+		uint64_t blockOffset = it->second;
+		uint64_t blockEnd = it->second + it->first;
+		uint64_t offset = (blockOffset + alignMask) & ~alignMask;
+		if (offset + size > blockEnd)
+			continue;
+		RemoveFreeMemory(m_freeByOffset.find(blockOffset));
+		if (offset > blockOffset)
+			AddFreeMemory(blockOffset, offset - blockOffset);
+		if (offset + size < blockEnd)
+			AddFreeMemory(offset + size, blockEnd - offset - size);
+		return offset;
+	}
+
+	// Nothing fits, grow the heap. A free block at the very end becomes part of the new allocation.
+	uint64_t start = m_stats.TransientHeapSize;
+	if (!m_freeByOffset.empty())
+	{
+		std::map<uint64_t, uint64_t>::iterator last = std::prev(m_freeByOffset.end());
+		if (last->first + last->second == start)
+		{
+			start = last->first;
+			RemoveFreeMemory(last);
+		}
+	}
+	uint64_t offset = (start + alignMask) & ~alignMask;
+	if (offset > start)
+		AddFreeMemory(start, offset - start);
+	m_stats.TransientHeapSize = offset + size;
+	return offset;
+}
+
+void RenderGraph::FreeTransientMemory(uint64_t offset, uint64_t size)
+{
+	std::map<uint64_t, uint64_t>::iterator next = m_freeByOffset.lower_bound(offset);
+	if (next != m_freeByOffset.end() && next->first == offset + size)
+	{
+		size += next->second;
+		std::map<uint64_t, uint64_t>::iterator merged = next++;
+		RemoveFreeMemory(merged);
+	}
+	if (next != m_freeByOffset.begin())
+	{
+		std::map<uint64_t, uint64_t>::iterator prev = std::prev(next);
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			size += prev->second;
+			RemoveFreeMemory(prev);
+		}
+	}
+	AddFreeMemory(offset, size);
+}
+
+void RenderGraph::AddFreeMemory(uint64_t offset, uint64_t size)
+{
+	m_freeByOffset[offset] = size;
+	m_freeBySize.emplace(size, offset);
+}
+
+void RenderGraph::RemoveFreeMemory(std::map<uint64_t, uint64_t>::iterator it)
+{
+	std::pair<std::multimap<uint64_t, uint64_t>::iterator, std::multimap<uint64_t, uint64_t>::iterator> range = m_freeBySize.equal_range(it->second);
+	for (std::multimap<uint64_t, uint64_t>::iterator bySize = range.first; bySize != range.second; ++bySize)
+	{
+		if (bySize->second == it->first)
+		{
+			m_freeBySize.erase(bySize);
+			break;
+		}
+	}
+	m_freeByOffset.erase(it);
+}
+
+void RenderGraph::ClaimMemory(RenderGraphResource resourceIndex)
+{
+	// Whoever used these bytes last is dead by now. If that was a single resource the aliasing barrier can name it,
+	// otherwise it has to cover the whole heap.
+	ResourceNode& resource = m_resources[resourceIndex];
+	uint64_t begin = resource.HeapOffset;
+	uint64_t end = resource.HeapOffset + resource.Desc.Size;
+	std::map<uint64_t, MemoryOwner>::iterator it = m_memoryOwners.upper_bound(begin);
+	if (it != m_memoryOwners.begin() && std::prev(it)->second.End > begin)
+		--it;
+	while (it != m_memoryOwners.end() && it->first < end)
+	{
+		uint64_t ownerBegin = it->first;
+		MemoryOwner owner = it->second;
+		if (!resource.Aliased)
+			resource.AliasBefore = owner.Resource;
+		else if (resource.AliasBefore != owner.Resource)
+			resource.AliasBefore = RENDER_GRAPH_INVALID;
+		resource.Aliased = true;
+
+		it = m_memoryOwners.erase(it);
+		// Keep the parts sticking out on either side
+		if (ownerBegin < begin)
+			m_memoryOwners[ownerBegin] = { begin, owner.Resource };
+		if (owner.End > end)
+			it = m_memoryOwners.insert({ end, { owner.End, owner.Resource } }).first;
+	}
+	m_memoryOwners[begin] = { end, resourceIndex };
+}
+
+void RenderGraph::BuildBarriers()
+{
+	m_barriers.clear();
+	for (ResourceNode& resource : m_resources)
+	{
+		resource.State = resource.InitialState;
+		resource.LastAccess = RENDER_GRAPH_INVALID;
+		resource.ReadBarrier = RENDER_GRAPH_INVALID;
+	}
+
+	uint32_t passCount = (uint32_t)m_executeOrder.size();
+	for (uint32_t e = 0; e < passCount; e++)
+	{
+		const PassNode& pass = m_passes[m_executeOrder[e]];
+		for (uint32_t i = 0; i < pass.AccessCount; i++)
+		{
+			const Access& access = m_sortedAccesses[pass.FirstAccess + i];
+			ResourceNode& resource = m_resources[access.Resource];
+			bool readOnly = !access.Writes && IsReadOnlyState(access.State);
+
+			if (!resource.Imported && resource.FirstUse == e)
+			{
+				// Transients start out in the state of their first use. If they take over memory from another
+				// resource, that handover needs an aliasing barrier instead of a transition.
+				if (resource.Aliased)
+				{
+					Barrier barrier = {};
+					barrier.Type = BarrierType::Aliasing;
+					barrier.Resource = access.Resource;
+					barrier.AliasBefore = resource.AliasBefore;
+					barrier.Batch = e;
+					barrier.PreviousUse = RENDER_GRAPH_INVALID;
+					m_barriers.push_back(barrier);
+					m_stats.AliasingBarriers++;
+				}
+				resource.State = access.State;
+				resource.ReadBarrier = RENDER_GRAPH_INVALID;
+			}
+			else if (resource.State == access.State || (readOnly && IsReadOnlyState(resource.State) && HasAllStates(resource.State, access.State)))
+			{
+				// Already there
+			}
+			else if (readOnly && resource.ReadBarrier != RENDER_GRAPH_INVALID)
+			{
+				// Nothing wrote the resource since it was last transitioned to a read state, so that transition can
+				// go straight to a state covering this read as well
+				m_barriers[resource.ReadBarrier].StateAfter = m_barriers[resource.ReadBarrier].StateAfter | access.State;
+				resource.State = m_barriers[resource.ReadBarrier].StateAfter;
+				m_stats.MergedReads++;
+			}
+			else
+			{
+				Barrier barrier = {};
+				barrier.Type = BarrierType::Transition;
+				barrier.Resource = access.Resource;
+				barrier.AliasBefore = RENDER_GRAPH_INVALID;
+				barrier.StateBefore = resource.State;
+				barrier.StateAfter = access.State;
+				barrier.Batch = e;
+				barrier.PreviousUse = resource.LastAccess;
+				resource.ReadBarrier = readOnly ? (uint32_t)m_barriers.size() : RENDER_GRAPH_INVALID;
+				resource.State = access.State;
+				m_barriers.push_back(barrier);
+			}
+			if (access.Writes)
+				resource.ReadBarrier = RENDER_GRAPH_INVALID;
+			resource.LastAccess = e;
+		}
+	}
+
+	// Imported resources leave the graph in the state the caller asked for
+	for (uint32_t r = 0; r < (uint32_t)m_resources.size(); r++)
+	{
+		const ResourceNode& resource = m_resources[r];
+		if (!resource.Imported || resource.State == resource.FinalState)
+			continue;
+		Barrier barrier = {};
+		barrier.Type = BarrierType::Transition;
+		barrier.Resource = r;
+		barrier.AliasBefore = RENDER_GRAPH_INVALID;
+		barrier.StateBefore = resource.State;
+		barrier.StateAfter = resource.FinalState;
+		barrier.Batch = passCount;
+		barrier.PreviousUse = resource.LastAccess;
+		m_barriers.push_back(barrier);
+	}
+
+	// Transitions with idle passes between the previous use and the next one start right after the previous use and
+	// only get waited on where they are needed
+	size_t transitionCount = m_barriers.size();
+	for (size_t i = 0; i < transitionCount && m_splitBarriers; i++)
+	{
+		Barrier& barrier = m_barriers[i];
+		uint32_t beginBatch = barrier.PreviousUse == RENDER_GRAPH_INVALID ? 0 : barrier.PreviousUse + 1;
+		if (barrier.Type != BarrierType::Transition || barrier.Batch <= beginBatch)
+			continue;
+		Barrier begin = barrier;
+		begin.Split = BarrierSplit::Begin;
+		begin.Batch = beginBatch;
+		barrier.Split = BarrierSplit::End;
+		m_barriers.push_back(begin);
+		m_stats.SplitBarriers++;
+	}
+	m_stats.Barriers = (uint32_t)transitionCount;
+
+	// Counting sort into batches. Within a batch barriers keep the order they were created in, so an aliasing
+	// barrier stays in front of anything else touching the same resource.
+	m_batchStart.assign(passCount + 2, 0);
+	for (const Barrier& barrier : m_barriers)
+		m_batchStart[barrier.Batch + 1]++;
+	for (size_t i = 1; i < m_batchStart.size(); i++)
+		m_batchStart[i] += m_batchStart[i - 1];
+	m_batchedBarriers.resize(m_barriers.size());
+	m_scratch.assign(m_batchStart.begin(), m_batchStart.end());
+	for (const Barrier& barrier : m_barriers)
+		m_batchedBarriers[m_scratch[barrier.Batch]++] = barrier;
+	for (uint32_t i = 0; i <= passCount; i++)
+		if (m_batchStart[i + 1] > m_batchStart[i])
+			m_stats.BarrierBatches++;
+}
+
+// Executing
+
+void RenderGraph::Execute(RenderGraphContext& context)
+{
+	IM_ASSERT(m_compiled && "Compile() the graph before executing it");
+	context.Graph = this;
+	uint32_t passCount = (uint32_t)m_executeOrder.size();
+	for (uint32_t batch = 0; batch <= passCount; batch++)
+	{
+		m_resolvedBarriers.clear();
+		for (uint32_t i = m_batchStart[batch]; i < m_batchStart[batch + 1]; i++)
+		{
+			const Barrier& barrier = m_batchedBarriers[i];
+			ResourceBarrierDesc desc;
+			desc.Type = barrier.Type;
+			desc.Split = barrier.Split;
+			desc.Target = m_resources[barrier.Resource].Native;
+			desc.AliasBefore = barrier.AliasBefore != RENDER_GRAPH_INVALID ? m_resources[barrier.AliasBefore].Native : nullptr;
+			desc.StateBefore = barrier.StateBefore;
+			desc.StateAfter = barrier.StateAfter;
+			IM_ASSERT(desc.Target != nullptr && "Transient resource used by the graph was never bound");
+			m_resolvedBarriers.push_back(desc);
+		}
+		if (!m_resolvedBarriers.empty())
+			context.List->ResourceBarriers((uint32_t)m_resolvedBarriers.size(), m_resolvedBarriers.data());
+
+		if (batch < passCount)
+		{
+			PassNode& pass = m_passes[m_executeOrder[batch]];
+			if (pass.Execute)
+			{
+				PROFILE_ZONE(pass.Name);
+				uint32_t gpuZone = context.Gpu ? context.Gpu->BeginZone(context.List, pass.Name) : GPU_PROFILER_INVALID_ZONE;
+				pass.Execute(context);
+				// The pass may have moved on to another list, the end goes where the following work is
+				if (context.Gpu)
+					context.Gpu->EndZone(context.List, gpuZone);
+			}
+		}
+	}
+}
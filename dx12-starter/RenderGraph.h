@@ -0,0 +1,200 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <vector>
+
+typedef uint32_t RenderGraphResource;
+typedef uint32_t RenderGraphPass;
+static uint32_t const               RENDER_GRAPH_INVALID = 0xFFFFFFFF;
+
+/// <summary>
+/// Memory requirements of a resource that only lives inside the graph. Transient resources with disjoint lifetimes
+/// share memory in one heap, the graph only decides the offsets. The backend creates the placed resources and binds
+/// them with BindTransient() before Execute().
+/// </summary>
+struct TransientResourceDesc
+{
+	uint64_t Size = 0;
+	uint64_t Alignment = 64 * 1024;
+};
+
+struct RenderGraphStats
+{
+	uint32_t Passes = 0;
+	uint32_t CulledPasses = 0;
+	uint32_t Barriers = 0;
+	uint32_t SplitBarriers = 0;
+	uint32_t AliasingBarriers = 0;
+	// Read accesses folded into an earlier transition instead of getting their own
+	uint32_t MergedReads = 0;
+	uint32_t BarrierBatches = 0;
+	uint64_t TransientHeapSize = 0;
+	// What the transient resources would take without aliasing
+	uint64_t TransientBytes = 0;
+};
+
+class GpuProfiler;
+class RenderGraph;
+
+/// <summary>
+/// Handed to every pass while the graph executes. A pass may replace `List` (e.g. after recording in parallel into
+/// lists of its own), the barriers of the following passes then go into the new list.
+/// </summary>
+struct RenderGraphContext
+{
+	CommandList* List = nullptr;
+	const RenderGraph* Graph = nullptr;
+	// When set, every pass is timed on the GPU under its name
+	GpuProfiler* Gpu = nullptr;
+
+	Resource* GetResource(RenderGraphResource resource) const;
+};
+
+/// <summary>
+/// Frame graph of passes and the resources they read and write. Passes run in the order they were added.
+/// Compile() is pure CPU work and does not touch the device:
+/// - culls passes whose results are never used (nothing downstream reads them and they write no imported resource)
+/// - computes every state transition, merging consecutive read-only uses into one combined read state
+/// - splits transitions whose previous use is more than one pass away into a begin/end pair
+/// - places transient resources with disjoint lifetimes at overlapping offsets of one heap, with aliasing barriers
+/// Execute() then records each pass with all barriers in front of it issued as a single batch.
+/// Rebuild it every frame: Reset() keeps the allocations around.
+/// </summary>
+class RenderGraph
+{
+public:
+	typedef std::function<void(RenderGraphContext& context)> PassFunc;
+
+	void Reset();
+
+	// A resource that lives outside the graph (e.g. the back buffer). It is in `initialState` when the graph starts and
+	// is transitioned to `finalState` at the end. Writes to imported resources always count as used.
+	RenderGraphResource ImportResource(const char* name, Resource* resource, ResourceState initialState, ResourceState finalState);
+	RenderGraphResource CreateTransient(const char* name, const TransientResourceDesc& desc);
+	// Passes that never got culled can only reference bound transient resources when executed.
+	void BindTransient(RenderGraphResource resource, Resource* placed);
+
+	RenderGraphPass AddPass(const char* name, PassFunc execute);
+	// Keeps the pass even if nothing reads its output (e.g. readbacks, queries).
+	void SetNeverCull(RenderGraphPass pass);
+	// Accesses of `pass`. A pass using the same resource more than once must use a single state, unless every use
+	// is read-only, in which case the states are combined.
+	void Read(RenderGraphPass pass, RenderGraphResource resource, ResourceState state);
+	// Overwrites the whole resource, its previous contents are not needed.
+	void Write(RenderGraphPass pass, RenderGraphResource resource, ResourceState state);
+	// Read-modify-write, e.g. drawing on top of what is already in a render target.
+	void Modify(RenderGraphPass pass, RenderGraphResource resource, ResourceState state);
+
+	// Returns false if the graph is malformed (e.g. reads a transient resource nothing wrote).
+	bool Compile();
+	void Execute(RenderGraphContext& context);
+
+	bool IsCulled(RenderGraphPass pass) const { return m_passes[pass].Culled; }
+	uint64_t GetTransientOffset(RenderGraphResource resource) const { return m_resources[resource].HeapOffset; }
+	uint64_t GetTransientHeapSize() const { return m_stats.TransientHeapSize; }
+	Resource* GetResource(RenderGraphResource resource) const { return m_resources[resource].Native; }
+	const RenderGraphStats& GetStats() const { return m_stats; }
+
+	// Split barriers are on by default. Turning them off is mostly useful to compare.
+	void SetSplitBarriers(bool enabled) { m_splitBarriers = enabled; }
+
+private:
+	struct ResourceNode
+	{
+		const char* Name;
+		Resource* Native;
+		bool Imported;
+		ResourceState InitialState;
+		ResourceState FinalState;
+		TransientResourceDesc Desc;
+		// Compiled: first and last use in execution order, and the placement for transients
+		uint32_t FirstUse;
+		uint32_t LastUse;
+		uint64_t HeapOffset;
+		// Takes over memory from an earlier resource, AliasBefore is RENDER_GRAPH_INVALID if there are several
+		bool Aliased;
+		RenderGraphResource AliasBefore;
+		// Compile time state tracking: current state, last pass to use it, and the transition into the current
+		// read-only state that later reads can be merged into
+		ResourceState State;
+		uint32_t LastAccess;
+		uint32_t ReadBarrier;
+	};
+
+	struct Access
+	{
+		RenderGraphPass Pass;
+		RenderGraphResource Resource;
+		ResourceState State;
+		bool Reads;
+		bool Writes;
+	};
+
+	struct PassNode
+	{
+		const char* Name;
+		PassFunc Execute;
+		bool NeverCull;
+		bool Culled;
+		// Into m_sortedAccesses once compiled
+		uint32_t FirstAccess;
+		uint32_t AccessCount;
+	};
+
+	// A barrier as resource indices, only resolved to Resource* when executed since transients are bound late
+	struct Barrier
+	{
+		BarrierType Type;
+		BarrierSplit Split;
+		RenderGraphResource Resource;
+		RenderGraphResource AliasBefore;
+		ResourceState StateBefore;
+		ResourceState StateAfter;
+		// Index of the batch it is issued in: batch i goes before the i-th executed pass, the last one after all of them
+		uint32_t Batch;
+		// Executed pass that used the resource before, RENDER_GRAPH_INVALID for the start of the graph
+		uint32_t PreviousUse;
+	};
+
+	void AddAccess(RenderGraphPass pass, RenderGraphResource resource, ResourceState state, bool reads, bool writes);
+	bool SortAccesses();
+	bool CullPasses();
+	void PlaceTransients();
+	uint64_t AllocateTransientMemory(uint64_t size, uint64_t alignment);
+	void FreeTransientMemory(uint64_t offset, uint64_t size);
+	void AddFreeMemory(uint64_t offset, uint64_t size);
+	void RemoveFreeMemory(std::map<uint64_t, uint64_t>::iterator it);
+	void ClaimMemory(RenderGraphResource resource);
+	void BuildBarriers();
+
+	std::vector<ResourceNode> m_resources;
+	std::vector<PassNode> m_passes;
+	std::vector<Access> m_accesses;
+
+	// Compiled state
+	std::vector<Access> m_sortedAccesses;
+	std::vector<RenderGraphPass> m_executeOrder;
+	// Transient heap while placing: free blocks by offset and by size, and which resource last used each byte range
+	struct MemoryOwner
+	{
+		uint64_t End;
+		RenderGraphResource Resource;
+	};
+	std::map<uint64_t, uint64_t> m_freeByOffset;
+	std::multimap<uint64_t, uint64_t> m_freeBySize;
+	std::map<uint64_t, MemoryOwner> m_memoryOwners;
+	std::vector<Barrier> m_barriers;
+	// m_barriers sorted by batch, batch i is [m_batchStart[i], m_batchStart[i + 1])
+	std::vector<Barrier> m_batchedBarriers;
+	std::vector<uint32_t> m_batchStart;
+	std::vector<ResourceBarrierDesc> m_resolvedBarriers;
+	// Scratch
+	std::vector<uint32_t> m_scratch;
+	std::vector<uint32_t> m_releaseOrder;
+	std::vector<bool> m_needed;
+	bool m_compiled = false;
+	bool m_splitBarriers = true;
+	RenderGraphStats m_stats;
+};
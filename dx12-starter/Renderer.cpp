@@ -1,237 +1,181 @@
 #include "Renderer.h"
+#include "Profiler.h"
 
-bool Renderer::Init(HWND hWnd)
+bool Renderer::Init(GraphicsDevice* device, void* window, uint32_t width, uint32_t height, JobSystem* jobs, uint32_t recordThreads,
+	const FramePacerConfig& pacing)
 {
-	// Setup swap chain
-	DXGI_SWAP_CHAIN_DESC1 sd;
-	{
-		ZeroMemory(&sd, sizeof(sd));
-		sd.BufferCount = NUM_BACK_BUFFERS;
-		sd.Width = 0;
-		sd.Height = 0;
-		sd.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-		sd.Flags = DXGI_SWAP_CHAIN_FLAG_FRAME_LATENCY_WAITABLE_OBJECT;
-		sd.BufferUsage = DXGI_USAGE_RENDER_TARGET_OUTPUT;
-		sd.SampleDesc.Count = 1;
-		sd.SampleDesc.Quality = 0;
-		sd.SwapEffect = DXGI_SWAP_EFFECT_FLIP_DISCARD;
-		sd.AlphaMode = DXGI_ALPHA_MODE_UNSPECIFIED;
-		sd.Scaling = DXGI_SCALING_STRETCH;
-		sd.Stereo = FALSE;
-	}
-
-	// [DEBUG] Enable debug interface
-#ifdef DX12_ENABLE_DEBUG_LAYER
-	ID3D12Debug* pdx12Debug = NULL;
-	if (SUCCEEDED(D3D12GetDebugInterface(IID_PPV_ARGS(&pdx12Debug))))
-		pdx12Debug->EnableDebugLayer();
-#endif
+	m_framePacer.Init(pacing, &m_clock);
 
-	// Create device
-	D3D_FEATURE_LEVEL featureLevel = D3D_FEATURE_LEVEL_11_0;
-	if (D3D12CreateDevice(NULL, featureLevel, IID_PPV_ARGS(&m_pd3dDevice)) != S_OK)
+	m_device = device;
+	if (m_device == nullptr)
 		return false;
 
-	// [DEBUG] Setup debug interface to break on any warnings/errors
-#ifdef DX12_ENABLE_DEBUG_LAYER
-	if (pdx12Debug != NULL)
-	{
-		ID3D12InfoQueue* pInfoQueue = NULL;
-		m_pd3dDevice->QueryInterface(IID_PPV_ARGS(&pInfoQueue));
-		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_ERROR, true);
-		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_CORRUPTION, true);
-		pInfoQueue->SetBreakOnSeverity(D3D12_MESSAGE_SEVERITY_WARNING, true);
-		pInfoQueue->Release();
-		pdx12Debug->Release();
-	}
-#endif
-
-	{
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_RTV;
-		desc.NumDescriptors = NUM_BACK_BUFFERS;
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
-		desc.NodeMask = 1;
-		if (m_pd3dDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_pd3dRtvDescHeap)) != S_OK)
-			return false;
-
-		SIZE_T rtvDescriptorSize = m_pd3dDevice->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
-		D3D12_CPU_DESCRIPTOR_HANDLE rtvHandle = m_pd3dRtvDescHeap->GetCPUDescriptorHandleForHeapStart();
-		for (UINT i = 0; i < NUM_BACK_BUFFERS; i++)
-		{
-			m_mainRenderTargetDescriptor[i] = rtvHandle;
-			rtvHandle.ptr += rtvDescriptorSize;
-		}
-	}
-
-	{
-		D3D12_DESCRIPTOR_HEAP_DESC desc = {};
-		desc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-		desc.NumDescriptors = 1;
-		desc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-		if (m_pd3dDevice->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_pd3dSrvDescHeap)) != S_OK)
-			return false;
-	}
-
-	{
-		D3D12_COMMAND_QUEUE_DESC desc = {};
-		desc.Type = D3D12_COMMAND_LIST_TYPE_DIRECT;
-		desc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
-		desc.NodeMask = 1;
-		if (m_pd3dDevice->CreateCommandQueue(&desc, IID_PPV_ARGS(&m_pd3dCommandQueue)) != S_OK)
-			return false;
-	}
-
-	for (UINT i = 0; i < NUM_FRAMES_IN_FLIGHT; i++)
-		if (m_pd3dDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&m_frameContext[i].CommandAllocator)) != S_OK)
-			return false;
+	m_commandQueue = m_device->CreateCommandQueue();
+	if (m_commandQueue == nullptr)
+		return false;
 
-	if (m_pd3dDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, m_frameContext[0].CommandAllocator, NULL, IID_PPV_ARGS(&m_pd3dCommandList)) != S_OK ||
-		m_pd3dCommandList->Close() != S_OK)
+	if (!m_commandListPool.Init(m_device, NUM_FRAMES_IN_FLIGHT, jobs, recordThreads))
 		return false;
 
-	if (m_pd3dDevice->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence)) != S_OK)
+	m_fence = m_device->CreateFence(0);
+	if (m_fence == nullptr)
 		return false;
 
-	m_fenceEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
-	if (m_fenceEvent == NULL)
+	// Per-frame geometry is suballocated from here and recycled once the frame's fence completes
+	if (!m_uploadHeap.Init(m_device, UPLOAD_HEAP_SIZE))
 		return false;
+	m_device->SetDynamicUploadHeap(&m_uploadHeap);
 
-	{
-		IDXGIFactory4* dxgiFactory = NULL;
-		IDXGISwapChain1* swapChain1 = NULL;
-		if (CreateDXGIFactory1(IID_PPV_ARGS(&dxgiFactory)) != S_OK)
-			return false;
-		if (dxgiFactory->CreateSwapChainForHwnd(m_pd3dCommandQueue, hWnd, &sd, NULL, NULL, &swapChain1) != S_OK)
-			return false;
-		if (swapChain1->QueryInterface(IID_PPV_ARGS(&m_pSwapChain)) != S_OK)
-			return false;
-		swapChain1->Release();
-		dxgiFactory->Release();
-		m_pSwapChain->SetMaximumFrameLatency(NUM_BACK_BUFFERS);
-		m_hSwapChainWaitableObject = m_pSwapChain->GetFrameLatencyWaitableObject();
-	}
+	// Optional, frames just go untimed without it
+	m_gpuProfiler.Init(m_device, m_commandQueue, NUM_FRAMES_IN_FLIGHT);
 
-	CreateRenderTarget();
-	return true;
-}
+	// Setup swap chain
+	SwapChainDesc sd;
+	sd.window = window;
+	sd.bufferCount = NUM_BACK_BUFFERS;
+	sd.width = width;
+	sd.height = height;
+	sd.maxFrameLatency = m_framePacer.GetMaxLatency();
+	sd.allowTearing = m_framePacer.AllowTearing();
+	m_swapChain = m_device->CreateSwapChain(m_commandQueue, sd);
+	if (m_swapChain == nullptr)
+		return false;
 
-void Renderer::CreateRenderTarget()
-{
-	for (UINT i = 0; i < NUM_BACK_BUFFERS; i++)
-	{
-		ID3D12Resource* pBackBuffer = NULL;
-		m_pSwapChain->GetBuffer(i, IID_PPV_ARGS(&pBackBuffer));
-		m_pd3dDevice->CreateRenderTargetView(pBackBuffer, NULL, m_mainRenderTargetDescriptor[i]);
-		m_mainRenderTargetResource[i] = pBackBuffer;
-	}
+	return true;
 }
 
 void Renderer::CleanupDevice()
 {
-	CleanupRenderTarget();
-	if (m_pSwapChain) { m_pSwapChain->SetFullscreenState(false, NULL); m_pSwapChain->Release(); m_pSwapChain = NULL; }
-	if (m_hSwapChainWaitableObject != NULL) { CloseHandle(m_hSwapChainWaitableObject); }
-	for (UINT i = 0; i < NUM_FRAMES_IN_FLIGHT; i++)
-		if (m_frameContext[i].CommandAllocator) { m_frameContext[i].CommandAllocator->Release(); m_frameContext[i].CommandAllocator = NULL; }
-	if (m_pd3dCommandQueue) { m_pd3dCommandQueue->Release(); m_pd3dCommandQueue = NULL; }
-	if (m_pd3dCommandList) { m_pd3dCommandList->Release(); m_pd3dCommandList = NULL; }
-	if (m_pd3dRtvDescHeap) { m_pd3dRtvDescHeap->Release(); m_pd3dRtvDescHeap = NULL; }
-	if (m_pd3dSrvDescHeap) { m_pd3dSrvDescHeap->Release(); m_pd3dSrvDescHeap = NULL; }
-	if (m_fence) { m_fence->Release(); m_fence = NULL; }
-	if (m_fenceEvent) { CloseHandle(m_fenceEvent); m_fenceEvent = NULL; }
-	if (m_pd3dDevice) { m_pd3dDevice->Release(); m_pd3dDevice = NULL; }
-
-#ifdef DX12_ENABLE_DEBUG_LAYER
-	IDXGIDebug1* pDebug = NULL;
-	if (SUCCEEDED(DXGIGetDebugInterface1(0, IID_PPV_ARGS(&pDebug))))
-	{
-		pDebug->ReportLiveObjects(DXGI_DEBUG_ALL, DXGI_DEBUG_RLO_SUMMARY);
-		pDebug->Release();
-	}
-#endif
-}
-
-void Renderer::CleanupRenderTarget()
-{
-	WaitForLastSubmittedFrame();
-
-	for (UINT i = 0; i < NUM_BACK_BUFFERS; i++)
-		if (m_mainRenderTargetResource[i]) { m_mainRenderTargetResource[i]->Release(); m_mainRenderTargetResource[i] = NULL; }
-
+	if (m_fence != nullptr)
+		WaitForLastSubmittedFrame();
+
+	if (m_swapChain) { delete m_swapChain; m_swapChain = nullptr; }
+	m_gpuProfiler.Shutdown();
+	m_commandListPool.Shutdown();
+	if (m_commandQueue) { delete m_commandQueue; m_commandQueue = nullptr; }
+	if (m_fence) { delete m_fence; m_fence = nullptr; }
+	if (m_device) m_device->SetDynamicUploadHeap(nullptr);
+	m_uploadHeap.Shutdown();
+	if (m_device) { delete m_device; m_device = nullptr; }
 }
 
 void Renderer::WaitForLastSubmittedFrame()
 {
 	FrameContext* frameCtx = &m_frameContext[m_frameIndex % NUM_FRAMES_IN_FLIGHT];
 
-	UINT64 fenceValue = frameCtx->FenceValue;
+	uint64_t fenceValue = frameCtx->FenceValue;
 	if (fenceValue == 0)
 		return; // No fence was signaled
 
 	frameCtx->FenceValue = 0;
-	if (m_fence->GetCompletedValue() >= fenceValue)
-		return;
+	m_fence->Wait(fenceValue);
+}
 
-	m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
-	WaitForSingleObject(m_fenceEvent, INFINITE);
+void Renderer::BeginFrame()
+{
+	// Frames that end up not being rendered (power saving) keep their slot for the next one
+	if (m_currentFrame != nullptr)
+		return;
+	m_currentFrame = WaitForNextFrameResources();
+	m_framePacer.FrameReady();
+	PROFILE_ZONE("FramePacer::WaitForInputSample");
+	m_framePacer.WaitForInputSample();
 }
 
-void Renderer::RenderUI(DX12Playground::UI* ui)
+void Renderer::RenderUI(const DX12Playground::UIFrame& frame, double inputTime)
 {
-	FrameContext* frameCtx = WaitForNextFrameResources();
-	UINT backBufferIdx = m_pSwapChain->GetCurrentBackBufferIndex();
-	frameCtx->CommandAllocator->Reset();
-
-	D3D12_RESOURCE_BARRIER barrier = {};
-	barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
-	barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
-	barrier.Transition.pResource = m_mainRenderTargetResource[backBufferIdx];
-	barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
-	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PRESENT;
-	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	m_pd3dCommandList->Reset(frameCtx->CommandAllocator, NULL);
-	m_pd3dCommandList->ResourceBarrier(1, &barrier);
-
-	// Render Dear ImGui graphics
-	const float clear_color_with_alpha[4] = { ui->clear_color.x * ui->clear_color.w, ui->clear_color.y * ui->clear_color.w, ui->clear_color.z * ui->clear_color.w, ui->clear_color.w };
-	m_pd3dCommandList->ClearRenderTargetView(m_mainRenderTargetDescriptor[backBufferIdx], clear_color_with_alpha, 0, NULL);
-	m_pd3dCommandList->OMSetRenderTargets(1, &m_mainRenderTargetDescriptor[backBufferIdx], FALSE, NULL);
-	m_pd3dCommandList->SetDescriptorHeaps(1, &m_pd3dSrvDescHeap);
+	PROFILE_ZONE("Renderer::RenderUI");
+	BeginFrame();
+	FrameContext* frameCtx = m_currentFrame;
+	m_currentFrame = nullptr;
+	uint32_t backBufferIdx = m_swapChain->GetCurrentBackBufferIndex();
+	Resource* backBuffer = m_swapChain->GetBackBuffer(backBufferIdx);
+	m_commandListPool.BeginFrame(m_frameIndex);
+	m_gpuProfiler.Update(m_fence->GetCompletedValue());
+	m_gpuProfiler.BeginFrame();
+	uint64_t fenceValue = m_fenceLastSignaledValue + 1;
+
+	// Clear, scene, UI. The graph works out the barriers, the back buffer enters and leaves it in the present state.
+	m_renderGraph.Reset();
+	RenderGraphResource backBufferHandle = m_renderGraph.ImportResource("BackBuffer", backBuffer, ResourceState::Present, ResourceState::Present);
+
+	RenderGraphPass clearPass = m_renderGraph.AddPass("Clear", [&frame, backBuffer](RenderGraphContext& context)
+		{
+			const ImVec4& clear_color = frame.ClearColor;
+			const float clear_color_with_alpha[4] = { clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w };
+			context.List->ClearRenderTarget(backBuffer, clear_color_with_alpha);
+			context.List->SetRenderTarget(backBuffer);
+		});
+	m_renderGraph.Write(clearPass, backBufferHandle, ResourceState::RenderTarget);
+
+	// Scene items are split across the recording threads, each into its own list. The UI goes into a list after them.
+	if (m_sceneItemCount > 0)
+	{
+		RenderGraphPass scenePass = m_renderGraph.AddPass("Scene", [this, backBuffer](RenderGraphContext& context)
+			{
+				m_commandListPool.RecordParallel(m_sceneItemCount, SCENE_MIN_ITEMS_PER_LIST,
+					[this, backBuffer](CommandList* sceneList, uint32_t begin, uint32_t end)
+					{
+						PROFILE_ZONE("Record scene");
+						sceneList->SetRenderTarget(backBuffer);
+						for (uint32_t item = begin; item < end; item++)
+							m_sceneRecord(sceneList, item);
+					});
+				context.List = m_commandListPool.OpenCommandList();
+				context.List->SetRenderTarget(backBuffer);
+			});
+		m_renderGraph.Modify(scenePass, backBufferHandle, ResourceState::RenderTarget);
+	}
 
 	// Have imgui backend render using command list
-	ui->RenderDrawData(m_pd3dCommandList);
-	
-	barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_RENDER_TARGET;
-	barrier.Transition.StateAfter = D3D12_RESOURCE_STATE_PRESENT;
-	m_pd3dCommandList->ResourceBarrier(1, &barrier);
-	m_pd3dCommandList->Close();
-
-	m_pd3dCommandQueue->ExecuteCommandLists(1, (ID3D12CommandList* const*)&m_pd3dCommandList);
+	RenderGraphPass uiPass = m_renderGraph.AddPass("UI", [&frame](RenderGraphContext& context)
+		{
+			// Glyphs rasterized while the frame was built go in before anything samples them
+			for (uint32_t i = 0; i < frame.TextureUpdateCount; i++)
+				context.List->UpdateUITexture(frame.TextureUpdates[i]);
+			context.List->RenderDrawData(frame.DrawData);
+		});
+	m_renderGraph.Modify(uiPass, backBufferHandle, ResourceState::RenderTarget);
+
+	bool compiled = m_renderGraph.Compile();
+	IM_ASSERT(compiled && "Frame graph is malformed");
+	(void)compiled;
+	RenderGraphContext context;
+	context.List = m_commandListPool.OpenCommandList();
+	context.Gpu = &m_gpuProfiler;
+	uint32_t frameZone = m_gpuProfiler.BeginZone(context.List, "Frame");
+	m_renderGraph.Execute(context);
+	m_gpuProfiler.EndZone(context.List, frameZone);
+	m_gpuProfiler.EndFrame(context.List, fenceValue);
+
+	// Every list of the frame goes out in one batch, in the order they were opened
+	m_commandListPool.Submit(m_commandQueue);
 
-	m_pSwapChain->Present(1, 0); // Present with vsync
-	//m_pSwapChain->Present(0, 0); // Present without vsync
+	{
+		PROFILE_ZONE("Present");
+		m_swapChain->Present(m_framePacer.GetSyncInterval(), m_framePacer.AllowTearing() ? PRESENT_ALLOW_TEARING : 0);
+	}
+	m_framePacer.Presented(inputTime);
 
-	UINT64 fenceValue = m_fenceLastSignaledValue + 1;
-	m_pd3dCommandQueue->Signal(m_fence, fenceValue);
+	m_commandQueue->Signal(m_fence, fenceValue);
 	m_fenceLastSignaledValue = fenceValue;
 	frameCtx->FenceValue = fenceValue;
+	m_uploadHeap.FinishFrame(fenceValue);
+	m_device->FinishFrame(fenceValue);
 }
 
 void Renderer::HandleResize(int width, int height)
 {
+	// Minimized windows report a 0x0 framebuffer, keep the old buffers around
+	if (width <= 0 || height <= 0)
+		return;
 
-	//_deviceContext->Flush();
-	//DestroySwapchainResources();
-
-	m_pSwapChain->ResizeBuffers(
-		0,
-		width,
-		height,
-		DXGI_FORMAT::DXGI_FORMAT_B8G8R8A8_UNORM,
-		0);
+	// The swap chain can only release its back buffers once the GPU is done with them
+	for (int i = 0; i < NUM_FRAMES_IN_FLIGHT; i++)
+		if (m_frameContext[i].FenceValue != 0)
+			m_fence->Wait(m_frameContext[i].FenceValue);
 
-	//CreateSwapchainResources();
+	m_swapChain->Resize(width, height);
 }
 
 void Renderer::HandleResizeCallback(Renderer* renderer, int width, int height)
@@ -239,25 +183,38 @@ void Renderer::HandleResizeCallback(Renderer* renderer, int width, int height)
 	return reinterpret_cast<Renderer*>(renderer)->HandleResize(width, height);
 }
 
+void Renderer::SetSceneWork(uint32_t itemCount, RecordItemFunc record)
+{
+	m_sceneItemCount = record ? itemCount : 0;
+	m_sceneRecord = record;
+}
+
 FrameContext* Renderer::WaitForNextFrameResources()
 {
-	UINT nextFrameIndex = m_frameIndex + 1;
+	PROFILE_ZONE("Renderer::WaitForNextFrameResources");
+	uint32_t nextFrameIndex = m_frameIndex + 1;
 	m_frameIndex = nextFrameIndex;
 
-	HANDLE waitableObjects[] = { m_hSwapChainWaitableObject, NULL };
-	DWORD numWaitableObjects = 1;
+	m_swapChain->WaitForNextFrame();
 
 	FrameContext* frameCtx = &m_frameContext[nextFrameIndex % NUM_FRAMES_IN_FLIGHT];
-	UINT64 fenceValue = frameCtx->FenceValue;
+	uint64_t fenceValue = frameCtx->FenceValue;
 	if (fenceValue != 0) // means no fence was signaled
 	{
 		frameCtx->FenceValue = 0;
-		m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
-		waitableObjects[1] = m_fenceEvent;
-		numWaitableObjects = 2;
+		m_fence->Wait(fenceValue);
 	}
 
-	WaitForMultipleObjects(numWaitableObjects, waitableObjects, TRUE, INFINITE);
+	// With a lower latency than frames in flight, also keep the GPU from running that far behind. Every frame
+	// signals the next fence value, so this is the frame `latency` frames back.
+	uint32_t latency = m_framePacer.GetMaxLatency();
+	if (m_fenceLastSignaledValue >= latency)
+		m_fence->Wait(m_fenceLastSignaledValue + 1 - latency);
+
+	// Frames the GPU has finished with give their upload memory and transient descriptors back
+	uint64_t completedValue = m_fence->GetCompletedValue();
+	m_uploadHeap.Retire(completedValue);
+	m_device->RetireFrames(completedValue);
 
 	return frameCtx;
 }
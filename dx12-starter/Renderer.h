@@ -1,53 +1,66 @@
 #pragma once
-#include <d3d12.h>
-#include <dxgi1_4.h>
-#include <wtypes.h>
-
-#ifdef _DEBUG
-#define DX12_ENABLE_DEBUG_LAYER
-#endif
-
-#ifdef DX12_ENABLE_DEBUG_LAYER
-#include <dxgidebug.h>
-#pragma comment(lib, "dxguid.lib")
-#endif
+#include "CommandListPool.h"
+#include "FramePacer.h"
+#include "GpuProfiler.h"
+#include "GraphicsDevice.h"
+#include "RenderGraph.h"
 #include "UI.h"
+#include "UploadRingBuffer.h"
+#include <functional>
 
 static int const                    NUM_BACK_BUFFERS = 3;
 static int const                    NUM_FRAMES_IN_FLIGHT = 3;
+// Shared by all frames in flight, sized for several frames of a heavy UI
+static uint64_t const               UPLOAD_HEAP_SIZE = 16 * 1024 * 1024;
+// Below this many scene items per thread, the cost of an extra command list outweighs the parallelism
+static uint32_t const               SCENE_MIN_ITEMS_PER_LIST = 256;
 struct FrameContext
 {
-	ID3D12CommandAllocator* CommandAllocator;
-	UINT64                  FenceValue;
+	uint64_t                FenceValue;
 };
 
 class Renderer
 {
 public:
-	bool Init(HWND hWnd);
-	void CreateRenderTarget();
+	// Records a single scene item (e.g. one draw) into the command list of the thread that owns it.
+	typedef std::function<void(CommandList* commandList, uint32_t item)> RecordItemFunc;
+
+	// Takes ownership of `device`. `window` is the native window handle (HWND on Windows), or nullptr when headless.
+	// Command lists are recorded with jobs on `jobs`, split across at most `recordThreads` lists (0 for one per thread).
+	bool Init(GraphicsDevice* device, void* window, uint32_t width, uint32_t height, JobSystem* jobs, uint32_t recordThreads = 0,
+		const FramePacerConfig& pacing = FramePacerConfig());
 	void CleanupDevice();
-	void CleanupRenderTarget();
 	void WaitForLastSubmittedFrame();
 	FrameContext* WaitForNextFrameResources();
-	void RenderUI(DX12Playground::UI* ui);
+	// Waits until the next frame can be recorded, then until the frame pacer wants input sampled. Call it right before
+	// polling input to sample it just in time; otherwise RenderUI() does it. Does nothing if the frame was already begun.
+	void BeginFrame();
+	// Records and submits one frame. `frame` has to stay untouched until this returns. `inputTime` is when the input
+	// it shows was sampled (FramePacer::SampleInput()).
+	void RenderUI(const DX12Playground::UIFrame& frame, double inputTime);
 	void HandleResize(int width, int height);
 	static void HandleResizeCallback(Renderer* renderer, int width, int height);
+	// Scene work recorded in parallel each frame, after the clear and before the UI, with the back buffer bound.
+	// Pass 0 items to disable.
+	void SetSceneWork(uint32_t itemCount, RecordItemFunc record);
 
 
 	FrameContext                 m_frameContext[NUM_FRAMES_IN_FLIGHT] = {};
-	UINT                         m_frameIndex = 0;
-	ID3D12Device* m_pd3dDevice = nullptr;
-	ID3D12DescriptorHeap* m_pd3dRtvDescHeap = NULL;
-	ID3D12DescriptorHeap* m_pd3dSrvDescHeap = NULL;
-	ID3D12CommandQueue* m_pd3dCommandQueue = NULL;
-	ID3D12GraphicsCommandList* m_pd3dCommandList = NULL;
-	ID3D12Fence* m_fence = NULL;
-	HANDLE                       m_fenceEvent = NULL;
-	UINT64                       m_fenceLastSignaledValue = 0;
-	IDXGISwapChain3* m_pSwapChain = NULL;
-	HANDLE                       m_hSwapChainWaitableObject = NULL;
-	ID3D12Resource* m_mainRenderTargetResource[NUM_BACK_BUFFERS] = {};
-	D3D12_CPU_DESCRIPTOR_HANDLE  m_mainRenderTargetDescriptor[NUM_BACK_BUFFERS] = {};
+	uint32_t                     m_frameIndex = 0;
+	GraphicsDevice* m_device = nullptr;
+	CommandQueue* m_commandQueue = nullptr;
+	CommandListPool              m_commandListPool;
+	uint32_t                     m_sceneItemCount = 0;
+	RecordItemFunc               m_sceneRecord;
+	Fence* m_fence = nullptr;
+	uint64_t                     m_fenceLastSignaledValue = 0;
+	SwapChain* m_swapChain = nullptr;
+	DynamicUploadHeap            m_uploadHeap;
+	// Rebuilt every frame, it owns all barriers of the frame
+	RenderGraph                  m_renderGraph;
+	SystemFrameClock             m_clock;
+	FramePacer                   m_framePacer;
+	// GPU time of every render graph pass, read back NUM_FRAMES_IN_FLIGHT frames later at the latest
+	GpuProfiler                  m_gpuProfiler;
+	FrameContext* m_currentFrame = nullptr;
 };
-
@@ -0,0 +1,571 @@
+#include "SoftwareRasterizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#ifdef SOFTRAST_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+// Vertices are snapped to 1/16 pixel. Clamping them to this guard band keeps every edge function
+// step within 32 bits inside a tile (see RasterTile).
+static int const                    SUBPIXEL_BITS = 4;
+static int const                    SUBPIXEL_SCALE = 1 << SUBPIXEL_BITS;
+static float const                  GUARD_BAND_PX = 16384.0f;
+
+static inline float Saturate(float v)
+{
+	return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+static inline uint32_t PackUnorm8(float v)
+{
+	return (uint32_t)(v * 255.0f + 0.5f);
+}
+
+// D3D style bilinear sampling with wrap addressing
+static inline void SampleBilinear(const uint8_t* pixels, int width, int height, int bytesPerPixel, float u, float v, float out[4])
+{
+	float fu = u * width - 0.5f;
+	float fv = v * height - 0.5f;
+	float u0f = floorf(fu);
+	float v0f = floorf(fv);
+	float fracU = fu - u0f;
+	float fracV = fv - v0f;
+	int u0 = (int)u0f % width;
+	int v0 = (int)v0f % height;
+	if (u0 < 0) u0 += width;
+	if (v0 < 0) v0 += height;
+	int u1 = u0 + 1 == width ? 0 : u0 + 1;
+	int v1 = v0 + 1 == height ? 0 : v0 + 1;
+
+	const int offsets[4] = { v0 * width + u0, v0 * width + u1, v1 * width + u0, v1 * width + u1 };
+	const float weights[4] = { (1.0f - fracU) * (1.0f - fracV), fracU * (1.0f - fracV), (1.0f - fracU) * fracV, fracU * fracV };
+	out[0] = out[1] = out[2] = out[3] = 0.0f;
+	for (int i = 0; i < 4; i++)
+	{
+		if (bytesPerPixel == 1)
+		{
+			out[3] += pixels[offsets[i]] * weights[i];
+		}
+		else
+		{
+			const uint8_t* texel = pixels + offsets[i] * 4;
+			out[0] += texel[0] * weights[i];
+			out[1] += texel[1] * weights[i];
+			out[2] += texel[2] * weights[i];
+			out[3] += texel[3] * weights[i];
+		}
+	}
+	if (bytesPerPixel == 1)
+		out[0] = out[1] = out[2] = 255.0f;
+	for (int i = 0; i < 4; i++)
+		out[i] *= 1.0f / 255.0f;
+}
+
+// Distance field alpha to coverage, `width` being how much the field changes over one pixel (fwidth() in the DX12 shader)
+static inline float DistanceFieldCoverage(float distance, float width)
+{
+	return Saturate((distance - IM_FONT_DISTANCE_FIELD_ON_EDGE / 255.0f) / std::max(width, 1e-5f) + 0.5f);
+}
+
+SoftwareRasterizer::SoftwareRasterizer(int numThreads)
+{
+	if (numThreads <= 0)
+		numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads <= 0)
+		numThreads = 1;
+
+	// The calling thread rasterizes too, so spawn one less
+	for (int i = 1; i < numThreads; i++)
+		m_workers.emplace_back(&SoftwareRasterizer::WorkerMain, this);
+}
+
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& worker : m_workers)
+		worker.join();
+}
+
+void SoftwareRasterizer::RegisterTexture(ImTextureID id, const void* pixels, int width, int height, int bytesPerPixel, bool distanceField)
+{
+	IM_ASSERT(bytesPerPixel == 1 || bytesPerPixel == 4);
+	Texture tex;
+	tex.Pixels = (const uint8_t*)pixels;
+	tex.Width = width;
+	tex.Height = height;
+	tex.BytesPerPixel = bytesPerPixel;
+	tex.DistanceField = distanceField;
+	m_textures[id] = tex;
+}
+
+void SoftwareRasterizer::UnregisterTexture(ImTextureID id)
+{
+	m_textures.erase(id);
+}
+
+void SoftwareRasterizer::Clear(const SoftwareFramebuffer& framebuffer, const float color[4])
+{
+	const uint32_t packed = PackUnorm8(Saturate(color[0])) | (PackUnorm8(Saturate(color[1])) << 8) |
+		(PackUnorm8(Saturate(color[2])) << 16) | (PackUnorm8(Saturate(color[3])) << 24);
+	for (int y = 0; y < framebuffer.Height; y++)
+		std::fill(framebuffer.Pixels + (size_t)y * framebuffer.Stride, framebuffer.Pixels + (size_t)y * framebuffer.Stride + framebuffer.Width, packed);
+}
+
+void SoftwareRasterizer::RenderDrawData(ImDrawData* drawData, const SoftwareFramebuffer& framebuffer)
+{
+	// Avoid rendering when minimized
+	if (drawData->DisplaySize.x <= 0.0f || drawData->DisplaySize.y <= 0.0f || framebuffer.Width <= 0 || framebuffer.Height <= 0)
+		return;
+	IM_ASSERT(framebuffer.Width <= (int)GUARD_BAND_PX && framebuffer.Height <= (int)GUARD_BAND_PX);
+
+	auto startTime = std::chrono::steady_clock::now();
+
+	m_target = framebuffer;
+	SetupTriangles(drawData, framebuffer);
+	BinTriangles();
+	RasterTiles();
+
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+	m_stats.Frames++;
+	m_stats.Triangles += m_triangles.size();
+	m_stats.PixelsShaded += m_pixelsShaded.exchange(0);
+	m_stats.RasterSeconds += elapsed.count();
+}
+
+void SoftwareRasterizer::SetupTriangles(ImDrawData* drawData, const SoftwareFramebuffer& framebuffer)
+{
+	m_triangles.clear();
+
+	// Same projection as the DX12 backend: DisplayPos is the top left of the render target
+	const ImVec2 clipOff = drawData->DisplayPos;
+	const ImVec2 clipScale = drawData->FramebufferScale;
+
+	for (int n = 0; n < drawData->CmdListsCount; n++)
+	{
+		const ImDrawList* cmdList = drawData->CmdLists[n];
+		for (int cmd_i = 0; cmd_i < cmdList->CmdBuffer.Size; cmd_i++)
+		{
+			const ImDrawCmd* pcmd = &cmdList->CmdBuffer[cmd_i];
+			if (pcmd->UserCallback != nullptr)
+			{
+				// There is no render state to reset, other callbacks still get to run
+				if (pcmd->UserCallback != ImDrawCallback_ResetRenderState)
+					pcmd->UserCallback(cmdList, pcmd);
+				continue;
+			}
+
+			// Scissor rectangle, truncated the same way the DX12 backend builds its D3D12_RECT
+			int clipMinX = std::max(0, (int)((pcmd->ClipRect.x - clipOff.x) * clipScale.x));
+			int clipMinY = std::max(0, (int)((pcmd->ClipRect.y - clipOff.y) * clipScale.y));
+			int clipMaxX = std::min(framebuffer.Width, (int)((pcmd->ClipRect.z - clipOff.x) * clipScale.x));
+			int clipMaxY = std::min(framebuffer.Height, (int)((pcmd->ClipRect.w - clipOff.y) * clipScale.y));
+			if (clipMaxX <= clipMinX || clipMaxY <= clipMinY)
+				continue;
+
+			auto texIt = m_textures.find(pcmd->GetTexID());
+			const Texture* tex = texIt != m_textures.end() ? &texIt->second : nullptr;
+
+			const ImDrawVert* vtxBuffer = cmdList->VtxBuffer.Data + pcmd->VtxOffset;
+			const ImDrawIdx* idxBuffer = cmdList->IdxBuffer.Data + pcmd->IdxOffset;
+			for (unsigned int i = 0; i + 2 < pcmd->ElemCount; i += 3)
+			{
+				const ImDrawVert* v[3] = { &vtxBuffer[idxBuffer[i]], &vtxBuffer[idxBuffer[i + 1]], &vtxBuffer[idxBuffer[i + 2]] };
+
+				// Snap to the subpixel grid
+				int32_t sx[3], sy[3];
+				for (int k = 0; k < 3; k++)
+				{
+					float px = std::min(std::max((v[k]->pos.x - clipOff.x) * clipScale.x, -GUARD_BAND_PX), GUARD_BAND_PX);
+					float py = std::min(std::max((v[k]->pos.y - clipOff.y) * clipScale.y, -GUARD_BAND_PX), GUARD_BAND_PX);
+					sx[k] = (int32_t)floorf(px * SUBPIXEL_SCALE + 0.5f);
+					sy[k] = (int32_t)floorf(py * SUBPIXEL_SCALE + 0.5f);
+				}
+
+				// No culling in the DX12 pipeline, so flip clockwise triangles to a common winding
+				int64_t area = (int64_t)(sy[1] - sy[2]) * (sx[0] - sx[1]) + (int64_t)(sx[2] - sx[1]) * (sy[0] - sy[1]);
+				if (area == 0)
+					continue;
+				if (area < 0)
+				{
+					std::swap(sx[1], sx[2]);
+					std::swap(sy[1], sy[2]);
+					std::swap(v[1], v[2]);
+				}
+
+				// Pixel centers sit at +8 subpixels, only keep pixels whose center can be inside
+				int minSX = std::min(sx[0], std::min(sx[1], sx[2]));
+				int minSY = std::min(sy[0], std::min(sy[1], sy[2]));
+				int maxSX = std::max(sx[0], std::max(sx[1], sx[2]));
+				int maxSY = std::max(sy[0], std::max(sy[1], sy[2]));
+				Triangle tri;
+				tri.MinX = std::max(clipMinX, (minSX - SUBPIXEL_SCALE / 2 + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS);
+				tri.MinY = std::max(clipMinY, (minSY - SUBPIXEL_SCALE / 2 + SUBPIXEL_SCALE - 1) >> SUBPIXEL_BITS);
+				tri.MaxX = std::min(clipMaxX, ((maxSX - SUBPIXEL_SCALE / 2) >> SUBPIXEL_BITS) + 1);
+				tri.MaxY = std::min(clipMaxY, ((maxSY - SUBPIXEL_SCALE / 2) >> SUBPIXEL_BITS) + 1);
+				if (tri.MaxX <= tri.MinX || tri.MaxY <= tri.MinY)
+					continue;
+
+				// Edge i is opposite to vertex i. Top-left edges include their boundary, the others don't.
+				for (int e = 0; e < 3; e++)
+				{
+					int a = (e + 1) % 3;
+					int b = (e + 2) % 3;
+					tri.A[e] = sy[a] - sy[b];
+					tri.B[e] = sx[b] - sx[a];
+					tri.C[e] = -((int64_t)tri.A[e] * sx[a] + (int64_t)tri.B[e] * sy[a]);
+					bool topLeft = tri.A[e] > 0 || (tri.A[e] == 0 && tri.B[e] > 0);
+					if (!topLeft)
+						tri.C[e] -= 1;
+				}
+
+				// Attribute planes, relative to the top left of the clipped bounds to keep float magnitudes small
+				double x0 = (double)sx[0] / SUBPIXEL_SCALE - tri.MinX, y0 = (double)sy[0] / SUBPIXEL_SCALE - tri.MinY;
+				double d1x = (double)(sx[1] - sx[0]) / SUBPIXEL_SCALE, d1y = (double)(sy[1] - sy[0]) / SUBPIXEL_SCALE;
+				double d2x = (double)(sx[2] - sx[0]) / SUBPIXEL_SCALE, d2y = (double)(sy[2] - sy[0]) / SUBPIXEL_SCALE;
+				double det = d1x * d2y - d2x * d1y;
+				float attr[3][6];
+				for (int k = 0; k < 3; k++)
+				{
+					ImU32 col = v[k]->col;
+					attr[k][0] = ((col >> IM_COL32_R_SHIFT) & 0xFF) * (1.0f / 255.0f);
+					attr[k][1] = ((col >> IM_COL32_G_SHIFT) & 0xFF) * (1.0f / 255.0f);
+					attr[k][2] = ((col >> IM_COL32_B_SHIFT) & 0xFF) * (1.0f / 255.0f);
+					attr[k][3] = ((col >> IM_COL32_A_SHIFT) & 0xFF) * (1.0f / 255.0f);
+					attr[k][4] = v[k]->uv.x;
+					attr[k][5] = v[k]->uv.y;
+				}
+				for (int k = 0; k < 6; k++)
+				{
+					double da1 = (double)attr[1][k] - attr[0][k];
+					double da2 = (double)attr[2][k] - attr[0][k];
+					double px = (da1 * d2y - da2 * d1y) / det;
+					double py = (da2 * d1x - da1 * d2x) / det;
+					tri.Px[k] = (float)px;
+					tri.Py[k] = (float)py;
+					tri.P0[k] = (float)(attr[0][k] - px * x0 - py * y0);
+				}
+				tri.Tex = tex;
+				tri.ConstantTexel = tex == nullptr || (tri.Px[4] == 0.0f && tri.Py[4] == 0.0f && tri.Px[5] == 0.0f && tri.Py[5] == 0.0f);
+				if (tex == nullptr)
+					tri.Texel[0] = tri.Texel[1] = tri.Texel[2] = tri.Texel[3] = 1.0f;
+				else if (tri.ConstantTexel)
+				{
+					SampleBilinear(tex->Pixels, tex->Width, tex->Height, tex->BytesPerPixel, tri.P0[4], tri.P0[5], tri.Texel);
+					if (tex->DistanceField)
+						tri.Texel[3] = DistanceFieldCoverage(tri.Texel[3], 0.0f);
+				}
+				m_triangles.push_back(tri);
+			}
+		}
+	}
+}
+
+void SoftwareRasterizer::BinTriangles()
+{
+	m_tilesX = (m_target.Width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (m_target.Height + TILE_SIZE - 1) / TILE_SIZE;
+	if ((int)m_tileBins.size() < m_tilesX * m_tilesY)
+		m_tileBins.resize(m_tilesX * m_tilesY);
+	for (std::vector<uint32_t>& bin : m_tileBins)
+		bin.clear();
+
+	// Bins are filled in submission order, which is what keeps blending correct per tile
+	for (uint32_t t = 0; t < (uint32_t)m_triangles.size(); t++)
+	{
+		const Triangle& tri = m_triangles[t];
+		int tileX0 = tri.MinX / TILE_SIZE, tileX1 = (tri.MaxX - 1) / TILE_SIZE;
+		int tileY0 = tri.MinY / TILE_SIZE, tileY1 = (tri.MaxY - 1) / TILE_SIZE;
+		for (int ty = tileY0; ty <= tileY1; ty++)
+			for (int tx = tileX0; tx <= tileX1; tx++)
+				m_tileBins[ty * m_tilesX + tx].push_back(t);
+	}
+}
+
+void SoftwareRasterizer::RasterTiles()
+{
+	m_nextTile.store(0);
+	if (!m_workers.empty())
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_generation++;
+			m_workersBusy = (int)m_workers.size();
+		}
+		m_wakeCondition.notify_all();
+	}
+
+	const int tileCount = m_tilesX * m_tilesY;
+	for (int tile = m_nextTile.fetch_add(1); tile < tileCount; tile = m_nextTile.fetch_add(1))
+		RasterTile(tile);
+
+	if (!m_workers.empty())
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCondition.wait(lock, [this] { return m_workersBusy == 0; });
+	}
+}
+
+void SoftwareRasterizer::WorkerMain()
+{
+	uint64_t seenGeneration = 0;
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [&] { return m_quit || m_generation != seenGeneration; });
+			if (m_quit)
+				return;
+			seenGeneration = m_generation;
+		}
+
+		const int tileCount = m_tilesX * m_tilesY;
+		for (int tile = m_nextTile.fetch_add(1); tile < tileCount; tile = m_nextTile.fetch_add(1))
+			RasterTile(tile);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (--m_workersBusy == 0)
+				m_doneCondition.notify_one();
+		}
+	}
+}
+
+// Alpha blending matching the DX12 backend pipeline: SRC_ALPHA / INV_SRC_ALPHA for color, ONE / INV_SRC_ALPHA for alpha
+// `constantTexel` is used instead of sampling when the texture lookup doesn't vary over the triangle.
+// `uvSteps` (u, v one pixel to the right, then one pixel down) is only given for distance field textures.
+static inline void ShadePixel(const float* attr, const float* constantTexel, const uint8_t* texPixels, int texWidth, int texHeight, int texBytesPerPixel, const float* uvSteps, uint32_t* dst)
+{
+	float src[4] = { Saturate(attr[0]), Saturate(attr[1]), Saturate(attr[2]), Saturate(attr[3]) };
+	float sampled[4];
+	const float* texel = constantTexel;
+	if (texel == nullptr)
+	{
+		SampleBilinear(texPixels, texWidth, texHeight, texBytesPerPixel, attr[4], attr[5], sampled);
+		if (uvSteps != nullptr)
+		{
+			// The GPU takes fwidth() from the neighbours in its 2x2 pixel quad, sampling the neighbours gives the same
+			float right[4], below[4];
+			SampleBilinear(texPixels, texWidth, texHeight, texBytesPerPixel, attr[4] + uvSteps[0], attr[5] + uvSteps[1], right);
+			SampleBilinear(texPixels, texWidth, texHeight, texBytesPerPixel, attr[4] + uvSteps[2], attr[5] + uvSteps[3], below);
+			sampled[3] = DistanceFieldCoverage(sampled[3], fabsf(right[3] - sampled[3]) + fabsf(below[3] - sampled[3]));
+		}
+		texel = sampled;
+	}
+	for (int i = 0; i < 4; i++)
+		src[i] *= texel[i];
+
+	// Fully transparent pixels leave the destination bit-exact, skip the read-modify-write
+	if (src[3] <= 0.0f)
+		return;
+
+	uint32_t d = *dst;
+	float invA = 1.0f - src[3];
+	float r = src[0] * src[3] + ((d >> 0) & 0xFF) * (1.0f / 255.0f) * invA;
+	float g = src[1] * src[3] + ((d >> 8) & 0xFF) * (1.0f / 255.0f) * invA;
+	float b = src[2] * src[3] + ((d >> 16) & 0xFF) * (1.0f / 255.0f) * invA;
+	float a = src[3] + ((d >> 24) & 0xFF) * (1.0f / 255.0f) * invA;
+	*dst = PackUnorm8(Saturate(r)) | (PackUnorm8(Saturate(g)) << 8) | (PackUnorm8(Saturate(b)) << 16) | (PackUnorm8(Saturate(a)) << 24);
+}
+
+#ifdef SOFTRAST_USE_SSE2
+// 4-wide version of ShadePixel for triangles with a constant texel. Same operations in the same order,
+// so it produces the exact same bytes. Lanes outside `mask` are written back unchanged.
+static inline void ShadeQuad(const __m128 attr[4], const float* constantTexel, int mask, uint32_t* dst)
+{
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	__m128 src[4];
+	for (int i = 0; i < 4; i++)
+		src[i] = _mm_mul_ps(_mm_min_ps(_mm_max_ps(attr[i], zero), one), _mm_set1_ps(constantTexel[i]));
+
+	const __m128i byteMask = _mm_set1_epi32(0xFF);
+	const __m128 inv255 = _mm_set1_ps(1.0f / 255.0f);
+	__m128i d = _mm_loadu_si128((const __m128i*)dst);
+	__m128 invA = _mm_sub_ps(one, src[3]);
+	__m128i packed = _mm_setzero_si128();
+	for (int i = 0; i < 4; i++)
+	{
+		__m128 dc = _mm_mul_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(d, i * 8), byteMask)), inv255), invA);
+		__m128 c = _mm_add_ps(i == 3 ? src[3] : _mm_mul_ps(src[i], src[3]), dc);
+		c = _mm_min_ps(_mm_max_ps(c, zero), one);
+		__m128i c8 = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(c, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+		packed = _mm_or_si128(packed, _mm_slli_epi32(c8, i * 8));
+	}
+
+	const __m128i laneMask = _mm_set_epi32((mask & 8) ? -1 : 0, (mask & 4) ? -1 : 0, (mask & 2) ? -1 : 0, (mask & 1) ? -1 : 0);
+	_mm_storeu_si128((__m128i*)dst, _mm_or_si128(_mm_and_si128(laneMask, packed), _mm_andnot_si128(laneMask, d)));
+}
+#endif
+
+void SoftwareRasterizer::RasterTile(int tileIndex)
+{
+	const int tileX0 = (tileIndex % m_tilesX) * TILE_SIZE;
+	const int tileY0 = (tileIndex / m_tilesX) * TILE_SIZE;
+	const int tileX1 = std::min(tileX0 + TILE_SIZE, m_target.Width);
+	const int tileY1 = std::min(tileY0 + TILE_SIZE, m_target.Height);
+	uint64_t pixelsShaded = 0;
+
+	for (uint32_t triIndex : m_tileBins[tileIndex])
+	{
+		const Triangle& tri = m_triangles[triIndex];
+		const int x0 = std::max(tri.MinX, tileX0), x1 = std::min(tri.MaxX, tileX1);
+		const int y0 = std::max(tri.MinY, tileY0), y1 = std::min(tri.MaxY, tileY1);
+		if (x1 <= x0 || y1 <= y0)
+			continue;
+
+		// Classify each edge against the clipped rectangle using 64-bit math. Edges that don't cross
+		// the rectangle are either rejected or dropped. Crossing edges have |E| bounded by the edge
+		// variation over the tile, which the guard band keeps below 2^30, so 32-bit stepping is exact.
+		int32_t e0[3], stepX[3], stepY[3];
+		bool rejected = false;
+		for (int e = 0; e < 3 && !rejected; e++)
+		{
+			int64_t base = (int64_t)tri.A[e] * (x0 * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2) + (int64_t)tri.B[e] * (y0 * SUBPIXEL_SCALE + SUBPIXEL_SCALE / 2) + tri.C[e];
+			int64_t dx = (int64_t)tri.A[e] * SUBPIXEL_SCALE * (x1 - 1 - x0);
+			int64_t dy = (int64_t)tri.B[e] * SUBPIXEL_SCALE * (y1 - 1 - y0);
+			int64_t eMin = base + std::min<int64_t>(dx, 0) + std::min<int64_t>(dy, 0);
+			int64_t eMax = base + std::max<int64_t>(dx, 0) + std::max<int64_t>(dy, 0);
+			if (eMax < 0)
+			{
+				rejected = true;
+			}
+			else if (eMin >= 0)
+			{
+				e0[e] = 0;
+				stepX[e] = 0;
+				stepY[e] = 0;
+			}
+			else
+			{
+				e0[e] = (int32_t)base;
+				stepX[e] = tri.A[e] * SUBPIXEL_SCALE;
+				stepY[e] = tri.B[e] * SUBPIXEL_SCALE;
+			}
+		}
+		if (rejected)
+			continue;
+
+		const float* constantTexel = tri.ConstantTexel ? tri.Texel : nullptr;
+		const uint8_t* texPixels = tri.Tex ? tri.Tex->Pixels : nullptr;
+		const int texWidth = tri.Tex ? tri.Tex->Width : 0;
+		const int texHeight = tri.Tex ? tri.Tex->Height : 0;
+		const int texBytesPerPixel = tri.Tex ? tri.Tex->BytesPerPixel : 0;
+		const float uvSteps[4] = { tri.Px[4], tri.Px[5], tri.Py[4], tri.Py[5] };
+		const float* distanceFieldSteps = tri.Tex && tri.Tex->DistanceField ? uvSteps : nullptr;
+		int32_t eRow[3] = { e0[0], e0[1], e0[2] };
+		for (int y = y0; y < y1; y++)
+		{
+			uint32_t* row = m_target.Pixels + (size_t)y * m_target.Stride;
+			const float fy = (float)(y - tri.MinY) + 0.5f;
+			float rowBase[6];
+			for (int k = 0; k < 6; k++)
+				rowBase[k] = tri.P0[k] + tri.Py[k] * fy;
+
+#ifdef SOFTRAST_USE_SSE2
+			const __m128i laneIndex = _mm_set_epi32(3, 2, 1, 0);
+			__m128i ev[3], evStep[3];
+			for (int e = 0; e < 3; e++)
+			{
+				// E for lanes x..x+3 = eRow + lane * stepX, advanced by 4 * stepX per iteration
+				__m128i laneStep = _mm_set_epi32(3 * stepX[e], 2 * stepX[e], stepX[e], 0);
+				ev[e] = _mm_add_epi32(_mm_set1_epi32(eRow[e]), laneStep);
+				evStep[e] = _mm_set1_epi32(4 * stepX[e]);
+			}
+			for (int x = x0; x < x1; x += 4)
+			{
+				__m128i outside = _mm_or_si128(_mm_or_si128(_mm_srai_epi32(ev[0], 31), _mm_srai_epi32(ev[1], 31)), _mm_srai_epi32(ev[2], 31));
+				__m128i inRect = _mm_cmplt_epi32(laneIndex, _mm_set1_epi32(x1 - x));
+				int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_andnot_si128(outside, inRect)));
+				for (int e = 0; e < 3; e++)
+					ev[e] = _mm_add_epi32(ev[e], evStep[e]);
+				if (mask == 0)
+					continue;
+
+				__m128 fx = _mm_add_ps(_mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32(x - tri.MinX), laneIndex)), _mm_set1_ps(0.5f));
+				if (constantTexel != nullptr && x + 4 <= x1)
+				{
+					// All 4 pixels are inside this tile, so a full 16 byte read-modify-write can't race with another tile
+					__m128 attr[4];
+					for (int k = 0; k < 4; k++)
+						attr[k] = _mm_add_ps(_mm_set1_ps(rowBase[k]), _mm_mul_ps(_mm_set1_ps(tri.Px[k]), fx));
+					ShadeQuad(attr, constantTexel, mask, row + x);
+					pixelsShaded += (mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1);
+					continue;
+				}
+				alignas(16) float lanes[6][4];
+				for (int k = 0; k < 6; k++)
+					_mm_store_ps(lanes[k], _mm_add_ps(_mm_set1_ps(rowBase[k]), _mm_mul_ps(_mm_set1_ps(tri.Px[k]), fx)));
+				for (int lane = 0; lane < 4; lane++)
+				{
+					if (!(mask & (1 << lane)))
+						continue;
+					float attr[6] = { lanes[0][lane], lanes[1][lane], lanes[2][lane], lanes[3][lane], lanes[4][lane], lanes[5][lane] };
+					ShadePixel(attr, constantTexel, texPixels, texWidth, texHeight, texBytesPerPixel, distanceFieldSteps, row + x + lane);
+					pixelsShaded++;
+				}
+			}
+#else
+			int32_t ev[3] = { eRow[0], eRow[1], eRow[2] };
+			for (int x = x0; x < x1; x++)
+			{
+				bool inside = (ev[0] | ev[1] | ev[2]) >= 0;
+				for (int e = 0; e < 3; e++)
+					ev[e] += stepX[e];
+				if (!inside)
+					continue;
+
+				const float fx = (float)(x - tri.MinX) + 0.5f;
+				float attr[6];
+				for (int k = 0; k < 6; k++)
+					attr[k] = rowBase[k] + tri.Px[k] * fx;
+				ShadePixel(attr, constantTexel, texPixels, texWidth, texHeight, texBytesPerPixel, distanceFieldSteps, row + x);
+				pixelsShaded++;
+			}
+#endif
+			for (int e = 0; e < 3; e++)
+				eRow[e] += stepY[e];
+		}
+	}
+
+	m_pixelsShaded.fetch_add(pixelsShaded, std::memory_order_relaxed);
+}
+
+bool SoftwareRasterizer::WriteTGA(const char* path, const SoftwareFramebuffer& framebuffer)
+{
+	FILE* f = fopen(path, "wb");
+	if (f == nullptr)
+		return false;
+
+	// Uncompressed true-color, 32 bpp, top-left origin
+	uint8_t header[18] = {};
+	header[2] = 2;
+	header[12] = (uint8_t)(framebuffer.Width & 0xFF);
+	header[13] = (uint8_t)(framebuffer.Width >> 8);
+	header[14] = (uint8_t)(framebuffer.Height & 0xFF);
+	header[15] = (uint8_t)(framebuffer.Height >> 8);
+	header[16] = 32;
+	header[17] = 0x28;
+	fwrite(header, 1, sizeof(header), f);
+
+	std::vector<uint8_t> row(framebuffer.Width * 4);
+	for (int y = 0; y < framebuffer.Height; y++)
+	{
+		const uint32_t* src = framebuffer.Pixels + (size_t)y * framebuffer.Stride;
+		for (int x = 0; x < framebuffer.Width; x++)
+		{
+			row[x * 4 + 0] = (uint8_t)(src[x] >> 16);
+			row[x * 4 + 1] = (uint8_t)(src[x] >> 8);
+			row[x * 4 + 2] = (uint8_t)(src[x] >> 0);
+			row[x * 4 + 3] = (uint8_t)(src[x] >> 24);
+		}
+		fwrite(row.data(), 1, row.size(), f);
+	}
+	fclose(f);
+	return true;
+}
@@ -0,0 +1,116 @@
+#pragma once
+#include "imgui.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// SSE2 is part of x64 so it is always there on MSVC x64/GCC x86-64. Everything else takes the scalar path,
+// which performs the exact same float operations so both paths produce identical pixels.
+#if defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SOFTRAST_USE_SSE2
+#endif
+
+/// <summary>
+/// Render target for the software rasterizer. R8G8B8A8 pixels (same memory layout as IM_COL32 / DXGI_FORMAT_R8G8B8A8_UNORM).
+/// </summary>
+struct SoftwareFramebuffer
+{
+	uint32_t* Pixels = nullptr;
+	int Width = 0;
+	int Height = 0;
+	int Stride = 0; // In pixels
+};
+
+struct SoftwareRasterizerStats
+{
+	uint64_t Frames = 0;
+	uint64_t Triangles = 0;
+	uint64_t PixelsShaded = 0;
+	double   RasterSeconds = 0.0;
+};
+
+/// <summary>
+/// Multithreaded, tile-binned rasterizer for ImDrawData. Triangles are set up and binned into 64x64 pixel tiles
+/// on the calling thread, then tiles are rasterized in parallel. Each tile is owned by a single thread and
+/// processes its triangles in submission order, so the output is identical for any thread count.
+/// Coverage uses fixed-point edge functions with the D3D top-left fill rule, blending matches the DX12 backend.
+/// </summary>
+class SoftwareRasterizer
+{
+public:
+	static int const TILE_SIZE = 64;
+
+	// `numThreads` includes the calling thread. 0 uses every hardware thread.
+	SoftwareRasterizer(int numThreads = 0);
+	~SoftwareRasterizer();
+
+	// Pixels are referenced, not copied. 1 byte per pixel textures are treated as alpha with white color.
+	// `distanceField` textures (ImFontAtlasFlags_DistanceField atlases) are drawn like the DX12 backend's distance field shader.
+	void RegisterTexture(ImTextureID id, const void* pixels, int width, int height, int bytesPerPixel, bool distanceField = false);
+	void UnregisterTexture(ImTextureID id);
+
+	void Clear(const SoftwareFramebuffer& framebuffer, const float color[4]);
+	void RenderDrawData(ImDrawData* drawData, const SoftwareFramebuffer& framebuffer);
+
+	const SoftwareRasterizerStats& GetStats() const { return m_stats; }
+	void ResetStats() { m_stats = SoftwareRasterizerStats(); }
+	int GetThreadCount() const { return (int)m_workers.size() + 1; }
+
+	// Writes an uncompressed 32-bit TGA, handy for golden image comparisons.
+	static bool WriteTGA(const char* path, const SoftwareFramebuffer& framebuffer);
+
+private:
+	struct Texture
+	{
+		const uint8_t* Pixels;
+		int Width;
+		int Height;
+		int BytesPerPixel;
+		bool DistanceField;
+	};
+
+	struct Triangle
+	{
+		// Pixel bounds clipped against scissor and framebuffer, max is exclusive
+		int MinX, MinY, MaxX, MaxY;
+		// Edge functions E(x, y) = A * x + B * y + C in 1/16 pixel units, top-left bias folded into C
+		int32_t A[3], B[3];
+		int64_t C[3];
+		// Attribute planes: value = P0 + Px * x + Py * y, x/y in pixels. Order is r, g, b, a, u, v.
+		float P0[6], Px[6], Py[6];
+		const Texture* Tex;
+		// Most imgui geometry samples a single texel (the atlas white pixel), fetched once at setup
+		bool ConstantTexel;
+		float Texel[4];
+	};
+
+	void SetupTriangles(ImDrawData* drawData, const SoftwareFramebuffer& framebuffer);
+	void BinTriangles();
+	void RasterTiles();
+	void RasterTile(int tileIndex);
+	void WorkerMain();
+
+	std::unordered_map<ImTextureID, Texture> m_textures;
+	std::vector<Triangle> m_triangles;
+	std::vector<std::vector<uint32_t>> m_tileBins;
+	int m_tilesX = 0;
+	int m_tilesY = 0;
+	SoftwareFramebuffer m_target;
+
+	// Worker pool. Workers wake up on a new generation and pull tiles off m_nextTile.
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_wakeCondition;
+	std::condition_variable m_doneCondition;
+	uint64_t m_generation = 0;
+	int m_workersBusy = 0;
+	bool m_quit = false;
+	std::atomic<int> m_nextTile{ 0 };
+	std::atomic<uint64_t> m_pixelsShaded{ 0 };
+
+	SoftwareRasterizerStats m_stats;
+};
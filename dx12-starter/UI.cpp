@@ -1,12 +1,73 @@
 #include "UI.h"
+#include "Profiler.h"
+#include "UIAllocator.h"
+#include "imgui_internal.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include "imgui_impl_win32.h"
+#endif
 
 
 // Data
 static int const                    NUM_FRAMES_IN_FLIGHT = 3;
+static int const                    DASHBOARD_PLOTS = 20;
+static int const                    DASHBOARD_PLOT_POINTS = 5000;
+static float const                  DASHBOARD_PLOT_HEIGHT = 90.0f;
+
+// One dashboard plot: a few thousand samples of a signal, drawn as a background, a grid and an anti-aliased line
+static void BuildDashboardPlot(ImDrawList* drawList, const ImVec2& min, const ImVec2& max, int plot, double time)
+{
+    static thread_local ImVector<ImVec2> points;
+    drawList->AddRectFilled(min, max, IM_COL32(20, 24, 30, 255));
+    for (int line = 1; line < 4; line++)
+    {
+        float y = min.y + (max.y - min.y) * line / 4.0f;
+        drawList->AddLine(ImVec2(min.x, y), ImVec2(max.x, y), IM_COL32(60, 66, 76, 255));
+    }
+
+    points.resize(DASHBOARD_PLOT_POINTS);
+    float center = (min.y + max.y) * 0.5f;
+    float amplitude = (max.y - min.y) * 0.45f;
+    for (int i = 0; i < DASHBOARD_PLOT_POINTS; i++)
+    {
+        double t = time + i * 0.004;
+        double value = sin(t * (1.0 + plot * 0.13)) * 0.6 + sin(t * 7.3 + plot) * 0.3 + sin(t * 31.7 + plot * 2.1) * 0.1;
+        points[i] = ImVec2(min.x + (max.x - min.x) * i / (DASHBOARD_PLOT_POINTS - 1), center - (float)value * amplitude);
+    }
+    drawList->AddPolyline(points.Data, points.Size, ImColor::HSV(plot / (float)DASHBOARD_PLOTS, 0.6f, 0.9f), ImDrawFlags_None, 1.5f);
+
+    char label[32];
+    snprintf(label, sizeof(label), "Signal %d", plot);
+    drawList->AddText(ImVec2(min.x + 4.0f, min.y + 2.0f), IM_COL32(220, 220, 220, 255), label);
+}
+
+static const ImWchar* FindGlyphRanges(ImFontAtlas* atlas, const char* name)
+{
+    if (name == nullptr || strcmp(name, "default") == 0) return atlas->GetGlyphRangesDefault();
+    if (strcmp(name, "greek") == 0) return atlas->GetGlyphRangesGreek();
+    if (strcmp(name, "korean") == 0) return atlas->GetGlyphRangesKorean();
+    if (strcmp(name, "japanese") == 0) return atlas->GetGlyphRangesJapanese();
+    if (strcmp(name, "chinese") == 0) return atlas->GetGlyphRangesChineseFull();
+    if (strcmp(name, "chinese-simplified") == 0) return atlas->GetGlyphRangesChineseSimplifiedCommon();
+    if (strcmp(name, "cyrillic") == 0) return atlas->GetGlyphRangesCyrillic();
+    if (strcmp(name, "thai") == 0) return atlas->GetGlyphRangesThai();
+    if (strcmp(name, "vietnamese") == 0) return atlas->GetGlyphRangesVietnamese();
+    printf("[UI]: Unknown glyph ranges %s, using the default ones\n", name);
+    return atlas->GetGlyphRangesDefault();
+}
 
 namespace DX12Playground {
-    bool UI::Init(HWND hwnd, ID3D12Device* device, ID3D12DescriptorHeap* srvHeap)
+    bool UI::Init(void* window, GraphicsDevice* device, uint32_t width, uint32_t height, JobSystem* jobs, const UIFontConfig& fonts)
     {
+        // Everything imgui allocates goes through our pools, including the draw lists of the workers. No frame arena:
+        // imgui keeps its buffers from frame to frame, there is nothing transient to scope into one.
+        UIAllocator::Install(0);
+        m_device = device;
+        m_parallelDrawLists.Init(jobs);
+        m_headless = window == nullptr;
+        m_displaySize = ImVec2((float)width, (float)height);
 
         // Setup Dear ImGui context
         IMGUI_CHECKVERSION();
@@ -14,18 +75,14 @@ namespace DX12Playground {
         ImGuiIO& io = ImGui::GetIO(); (void)io;
         io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
         //io.ConfigFlags |= ImGuiConfigFlags_NavEnableGamepad;      // Enable Gamepad Controls
+        io.ConfigTextLayoutCache = fonts.textLayoutCache;
+        // Windows that come and go keep their draw list buffers instead of regrowing them every time they reappear
+        io.ConfigDrawListRetainBuffers = true;
 
         // Setup Dear ImGui style
         ImGui::StyleColorsDark();
         //ImGui::StyleColorsLight();
 
-        // Setup Platform/Renderer backends
-        ImGui_ImplWin32_Init(hwnd);
-        ImGui_ImplDX12_Init(device, NUM_FRAMES_IN_FLIGHT,
-            DXGI_FORMAT_R8G8B8A8_UNORM, srvHeap,
-            srvHeap->GetCPUDescriptorHandleForHeapStart(),
-            srvHeap->GetGPUDescriptorHandleForHeapStart());
-
         // Load Fonts
         // - If no fonts are loaded, dear imgui will use the default font. You can also load multiple fonts and use ImGui::PushFont()/PopFont() to select them.
         // - AddFontFromFileTTF() will return the ImFont* so you can store it if you need to select the font among multiple.
@@ -41,21 +98,79 @@ namespace DX12Playground {
         //io.Fonts->AddFontFromFileTTF("../../misc/fonts/Cousine-Regular.ttf", 15.0f);
         //ImFont* font = io.Fonts->AddFontFromFileTTF("c:\\Windows\\Fonts\\ArialUni.ttf", 18.0f, NULL, io.Fonts->GetGlyphRangesJapanese());
         //IM_ASSERT(font != NULL);
+        ImFont* font = nullptr;
+        const float bakeSize = fonts.distanceField ? fonts.distanceFieldSize : fonts.size;
+        if (fonts.path != nullptr)
+        {
+            size_t size = 0;
+            void* data = ImFileLoadToMemory(fonts.path, "rb", &size);
+            if (data != nullptr)
+                font = io.Fonts->AddFontFromMemoryTTF(data, (int)size, bakeSize, nullptr, FindGlyphRanges(io.Fonts, fonts.glyphRanges));
+            else
+                printf("[UI]: Unable to load font %s, using the default font\n", fonts.path);
+        }
+        if (font != nullptr && fonts.glyphCachePages > 0)
+            m_glyphCache.Reserve(io.Fonts, fonts.glyphCachePageSize, fonts.glyphCachePages);
+        ImFont* distanceFieldFont = font;
+        float distanceFieldScale = fonts.size / fonts.distanceFieldSize;
+        if (fonts.distanceField)
+        {
+            io.Fonts->Flags |= ImFontAtlasFlags_DistanceField;
+            if (distanceFieldFont == nullptr)
+            {
+                // AddFontDefault() bakes at 13 pixels
+                ImFontConfig config;
+                config.SizePixels = fonts.distanceFieldSize;
+                distanceFieldFont = io.Fonts->AddFontDefault(&config);
+                distanceFieldScale = 13.0f / fonts.distanceFieldSize;
+            }
+        }
+
+        // The backends below ask for the atlas pixels, have them ready (from the cache if it's there)
+        if (!m_fontCache.Build(io.Fonts, fonts.cachePath, jobs))
+            return false;
+        if (font != nullptr && fonts.glyphCachePages > 0 && !m_glyphCache.Attach(font))
+            printf("[UI]: Unable to set up the glyph cache, glyphs outside the font ranges will be missing\n");
+        if (fonts.distanceField)
+            distanceFieldFont->Scale = distanceFieldScale;
+
+        // Setup Platform/Renderer backends
+#ifdef _WIN32
+        if (!m_headless)
+            ImGui_ImplWin32_Init(window);
+#endif
+        if (!m_device->InitUIBackend(NUM_FRAMES_IN_FLIGHT))
+            return false;
         return true;
     }
     void UI::Update()
     {
     }
-    void UI::Render()
+    const UIFrame& UI::Render()
     {
+        PROFILE_ZONE("UI::Render");
 
         // Our state
         bool show_demo_window = true;
         bool show_another_window = false;
 
         // Start the Dear ImGui frame
-        ImGui_ImplDX12_NewFrame();
-        ImGui_ImplWin32_NewFrame();
+        UIAllocator::NewFrame();
+        m_device->NewUIFrame();
+        m_glyphCache.NewFrame();
+        if (m_headless)
+        {
+            // No platform backend, so feed a fixed size and time step. Keeps headless runs deterministic.
+            ImGuiIO& io = ImGui::GetIO();
+            io.DisplaySize = m_displaySize;
+            io.DeltaTime = 1.0f / 60.0f;
+        }
+#ifdef _WIN32
+        else
+        {
+            ImGui_ImplWin32_NewFrame();
+        }
+#endif
         ImGui::NewFrame();
         ImGui::ShowDemoWindow(&show_demo_window);
 
@@ -68,6 +183,12 @@ namespace DX12Playground {
 
             ImGui::Text("This is some useful text.");               // Display some text (you can use a format strings too)
             ImGui::Checkbox("Demo Window", &show_demo_window);      // Edit bools storing our window open/close state
+#ifdef PROFILER_ENABLE
+            ImGui::SameLine();
+            ImGui::Checkbox("Profiler", &m_showProfiler);
+#endif
+            ImGui::SameLine();
+            ImGui::Checkbox("Dashboard", &show_dashboard);
 
             ImGui::SliderFloat("float", &f, 0.0f, 1.0f);            // Edit 1 float using a slider from 0.0f to 1.0f
             ImGui::ColorEdit3("clear color", (float*)&clear_color); // Edit 3 floats representing a color
@@ -75,23 +196,150 @@ namespace DX12Playground {
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
             ImGui::End();
         }
+#ifdef PROFILER_ENABLE
+        if (m_showProfiler)
+            Profiler::ShowWindow(&m_showProfiler);
+#endif
+        if (show_dashboard)
+            ShowDashboard();
 
 
         // Rendering
-        ImGui::Render();
+        {
+            PROFILE_ZONE("ImGui::Render");
+            ImGui::Render();
+        }
 
+        // imgui rebuilds its draw lists on the next NewFrame(), keep a copy around for the renderer
+        FrameCopy& copy = m_frames[m_nextFrame];
+        const FrameCopy& previous = m_frames[(m_nextFrame + NUM_FRAME_COPIES - 1) % NUM_FRAME_COPIES];
+        m_nextFrame = (m_nextFrame + 1) % NUM_FRAME_COPIES;
+        m_parallelDrawLists.Splice(ImGui::GetDrawData(), m_drawLists);
+        CopyDrawData(copy, ImGui::GetDrawData(), m_drawLists);
+        m_glyphCache.TakeUploads(copy.TextureUpdates, copy.TexturePixels);
+        copy.Frame.TextureUpdates = copy.TextureUpdates.Data;
+        copy.Frame.TextureUpdateCount = (uint32_t)copy.TextureUpdates.Size;
+        copy.Frame.ClearColor = clear_color;
+        // New glyphs have to reach the texture even if the draw data is the same
+        copy.Frame.Changed = !SameFrame(copy, previous) || copy.Frame.TextureUpdateCount > 0;
+        return copy.Frame;
+    }
 
+    void UI::ShowDashboard()
+    {
+        ImGui::SetNextWindowSize(ImVec2(760, 560), ImGuiCond_FirstUseEver);
+        if (!ImGui::Begin("Dashboard", &show_dashboard))
+        {
+            ImGui::End();
+            return;
+        }
+        ImGui::Checkbox("Build plots on workers", &m_dashboardOnWorkers);
+        const ParallelDrawListsStats& stats = m_parallelDrawLists.GetStats();
+        ImGui::SameLine();
+        ImGui::Text("%u lists built, %u spliced, %u dropped", stats.Built, stats.Spliced, stats.Dropped);
+
+        // Two columns of plots. Off screen ones are skipped by Add() (and by the visibility check on the main thread).
+        double time = ImGui::GetTime();
+        float width = (ImGui::GetContentRegionAvail().x - ImGui::GetStyle().ItemSpacing.x) * 0.5f;
+        ImVec2 size(width > 1.0f ? width : 1.0f, DASHBOARD_PLOT_HEIGHT);
+        for (int plot = 0; plot < DASHBOARD_PLOTS; plot++)
+        {
+            if (plot % 2 != 0)
+                ImGui::SameLine();
+            if (m_dashboardOnWorkers)
+            {
+                m_parallelDrawLists.Add(size, [plot, time](ImDrawList* drawList, const ImVec2& min, const ImVec2& max)
+                    {
+                        BuildDashboardPlot(drawList, min, max, plot, time);
+                    });
+            }
+            else
+            {
+                ImVec2 min = ImGui::GetCursorScreenPos();
+                ImGui::Dummy(size);
+                if (ImGui::IsItemVisible())
+                    BuildDashboardPlot(ImGui::GetWindowDrawList(), min, ImVec2(min.x + size.x, min.y + size.y), plot, time);
+            }
+        }
+        ImGui::End();
     }
-    
-    void UI::RenderDrawData(ID3D12GraphicsCommandList* m_pd3dCommandList)
+
+    bool UI::SameFrame(const FrameCopy& a, const FrameCopy& b)
     {
-        ImGui_ImplDX12_RenderDrawData(ImGui::GetDrawData(), m_pd3dCommandList);
+        // Compared byte for byte rather than hashed, so there are no collisions and the buffers are still in cache
+        // from the copy
+        const ImDrawData& da = a.DrawData;
+        const ImDrawData& db = b.DrawData;
+        if (b.Frame.DrawData == nullptr || da.CmdListsCount != db.CmdListsCount ||
+            da.TotalVtxCount != db.TotalVtxCount || da.TotalIdxCount != db.TotalIdxCount ||
+            da.DisplayPos.x != db.DisplayPos.x || da.DisplayPos.y != db.DisplayPos.y ||
+            da.DisplaySize.x != db.DisplaySize.x || da.DisplaySize.y != db.DisplaySize.y ||
+            da.FramebufferScale.x != db.FramebufferScale.x || da.FramebufferScale.y != db.FramebufferScale.y ||
+            memcmp(&a.Frame.ClearColor, &b.Frame.ClearColor, sizeof(ImVec4)) != 0)
+            return false;
+        for (int n = 0; n < da.CmdListsCount; n++)
+        {
+            const ImDrawList* la = da.CmdLists[n];
+            const ImDrawList* lb = db.CmdLists[n];
+            if (la->CmdBuffer.Size != lb->CmdBuffer.Size || la->IdxBuffer.Size != lb->IdxBuffer.Size || la->VtxBuffer.Size != lb->VtxBuffer.Size)
+                return false;
+            if ((la->CmdBuffer.Size > 0 && memcmp(la->CmdBuffer.Data, lb->CmdBuffer.Data, la->CmdBuffer.size_in_bytes()) != 0) ||
+                (la->IdxBuffer.Size > 0 && memcmp(la->IdxBuffer.Data, lb->IdxBuffer.Data, la->IdxBuffer.size_in_bytes()) != 0) ||
+                (la->VtxBuffer.Size > 0 && memcmp(la->VtxBuffer.Data, lb->VtxBuffer.Data, la->VtxBuffer.size_in_bytes()) != 0))
+                return false;
+        }
+        return true;
+    }
+
+    void UI::CopyDrawData(FrameCopy& copy, const ImDrawData* drawData, const ImVector<ImDrawList*>& drawLists)
+    {
+        // Draw lists are kept from frame to frame, so once warmed up this is only memcpys
+        while (copy.DrawLists.Size < drawLists.Size)
+            copy.DrawLists.push_back(IM_NEW(ImDrawList)(ImGui::GetDrawListSharedData()));
+        int totalVtxCount = 0;
+        int totalIdxCount = 0;
+        for (int n = 0; n < drawLists.Size; n++)
+        {
+            const ImDrawList* src = drawLists[n];
+            ImDrawList* dst = copy.DrawLists[n];
+            dst->CmdBuffer.resize(src->CmdBuffer.Size);
+            dst->IdxBuffer.resize(src->IdxBuffer.Size);
+            dst->VtxBuffer.resize(src->VtxBuffer.Size);
+            if (src->CmdBuffer.Size > 0)
+                memcpy(dst->CmdBuffer.Data, src->CmdBuffer.Data, src->CmdBuffer.size_in_bytes());
+            if (src->IdxBuffer.Size > 0)
+                memcpy(dst->IdxBuffer.Data, src->IdxBuffer.Data, src->IdxBuffer.size_in_bytes());
+            if (src->VtxBuffer.Size > 0)
+                memcpy(dst->VtxBuffer.Data, src->VtxBuffer.Data, src->VtxBuffer.size_in_bytes());
+            dst->Flags = src->Flags;
+            totalVtxCount += src->VtxBuffer.Size;
+            totalIdxCount += src->IdxBuffer.Size;
+        }
+
+        copy.DrawData = *drawData;
+        copy.DrawData.CmdLists = copy.DrawLists.Data;
+        copy.DrawData.CmdListsCount = drawLists.Size;
+        copy.DrawData.TotalVtxCount = totalVtxCount;
+        copy.DrawData.TotalIdxCount = totalIdxCount;
+        copy.Frame.DrawData = &copy.DrawData;
     }
     void UI::Terminate()
     {
         // Cleanup
-        ImGui_ImplDX12_Shutdown();
-        ImGui_ImplWin32_Shutdown();
+        m_parallelDrawLists.Shutdown();
+        for (FrameCopy& copy : m_frames)
+        {
+            for (ImDrawList* drawList : copy.DrawLists)
+                IM_DELETE(drawList);
+            copy.DrawLists.clear();
+        }
+        m_device->ShutdownUIBackend();
+#ifdef _WIN32
+        if (!m_headless)
+            ImGui_ImplWin32_Shutdown();
+#endif
+        m_glyphCache.Shutdown();
         ImGui::DestroyContext();
+        UIAllocator::Uninstall();
     }
 }
\ No newline at end of file
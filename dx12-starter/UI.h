@@ -1,26 +1,102 @@
 #pragma once
 #include "imgui.h"
-#include "imgui_impl_win32.h"
-#include "imgui_impl_dx12.h"
-#include <d3d12.h>
-#include <dxgi1_4.h>
-#include <tchar.h>
-#include <GLFW/glfw3.h>
-#define GLFW_EXPOSE_NATIVE_WIN32
-#include <GLFW/glfw3native.h>
+#include "FontAtlasCache.h"
+#include "GlyphCache.h"
+#include "GraphicsDevice.h"
+#include "ParallelDrawLists.h"
+#include "UIAllocator.h"
 
 namespace DX12Playground {
 
+/// <summary>
+/// Everything the renderer needs to draw one UI frame. Owns a copy of the draw lists, so it stays valid
+/// while the next frame is being built.
+/// </summary>
+struct UIFrame
+{
+	ImDrawData* DrawData = nullptr;
+	ImVec4 ClearColor;
+	// False if the draw data and clear color are identical to the previous frame's, i.e. rendering it again would
+	// put the same pixels on screen
+	bool Changed = true;
+	// Font texture rects with glyphs loaded during the frame, to upload before drawing it
+	const TextureUpdate* TextureUpdates = nullptr;
+	uint32_t TextureUpdateCount = 0;
+};
+
+/// <summary>
+/// The font UI::Init() loads, and where its atlas is cached between runs.
+/// </summary>
+struct UIFontConfig
+{
+	// TTF/OTF file, nullptr for imgui's default font
+	const char* path = nullptr;
+	float size = 16.0f;
+	// "default", "greek", "korean", "japanese", "chinese", "chinese-simplified", "cyrillic", "thai" or "vietnamese"
+	const char* glyphRanges = "default";
+	// nullptr to build the atlas on every start
+	const char* cachePath = "imgui_fonts.cache";
+	// Atlas pages for the glyphs of `path` outside `glyphRanges`, rasterized when they are first drawn. 0 to draw them as
+	// the fallback glyph instead.
+	int glyphCachePages = 16;
+	int glyphCachePageSize = 128;
+	// Bakes the font once as a signed distance field of `distanceFieldSize` pixels and draws it scaled to `size`, so any
+	// size, scale or DPI draws sharp from the same atlas
+	bool distanceField = false;
+	float distanceFieldSize = 32.0f;
+	// Reuse the measured size and glyphs of text drawn in earlier frames (io.ConfigTextLayoutCache). Off by default: it
+	// costs memory for every string drawn and measures within noise of laying text out again.
+	bool textLayoutCache = false;
+};
+
 class UI
 {
 public:
-	bool Init(HWND window, ID3D12Device* device, ID3D12DescriptorHeap* srvHeap);
+	// `window` is the native window handle (HWND on Windows). Pass nullptr to run headless,
+	// in which case the UI is driven with a fixed display size and time step.
+	// Custom content of windows (e.g. the dashboard's plots) and the font atlas are built on `jobs`.
+	bool Init(void* window, GraphicsDevice* device, uint32_t width, uint32_t height, JobSystem* jobs, const UIFontConfig& fonts);
 	void Update();
-	void Render();
-	void RenderDrawData(ID3D12GraphicsCommandList* m_pd3dCommandList);
+	// Builds the next UI frame. The returned frame stays valid until Render() is called twice more.
+	const UIFrame& Render();
 	void Terminate();
+	const FontAtlasCacheStats& GetFontCacheStats() const { return m_fontCache.GetStats(); }
+	const GlyphCacheStats& GetGlyphCacheStats() const { return m_glyphCache.GetStats(); }
+	// Of the last frame
+	const ImTextLayoutCacheStats& GetTextLayoutCacheStats() const { return ImGui::GetCurrentContext()->TextLayoutCache.StatsLastFrame; }
+	UIAllocatorStats GetAllocatorStats() const { return UIAllocator::GetStats(); }
+	void GetDrawListMemoryStats(ImVector<ImDrawListMemoryInfo>& stats) const { ImGui::GetDrawListMemoryStats(&stats); }
 
 	ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
+	bool show_dashboard = false;
+
+protected:
+	static int const NUM_FRAME_COPIES = 2;
+
+	struct FrameCopy
+	{
+		UIFrame Frame;
+		ImDrawData DrawData;
+		ImVector<ImDrawList*> DrawLists;
+		ImVector<TextureUpdate> TextureUpdates;
+		ImVector<uint8_t> TexturePixels;
+	};
+	void CopyDrawData(FrameCopy& copy, const ImDrawData* drawData, const ImVector<ImDrawList*>& drawLists);
+	void ShowDashboard();
+	static bool SameFrame(const FrameCopy& a, const FrameCopy& b);
+
+	GraphicsDevice* m_device = nullptr;
+	bool m_headless = false;
+	ImVec2 m_displaySize = ImVec2(0.0f, 0.0f);
+	FrameCopy m_frames[NUM_FRAME_COPIES];
+	int m_nextFrame = 0;
+	bool m_showProfiler = false;
+	ParallelDrawLists m_parallelDrawLists;
+	// Draw data lists with the parallel ones spliced in
+	ImVector<ImDrawList*> m_drawLists;
+	bool m_dashboardOnWorkers = true;
+	FontAtlasCache m_fontCache;
+	GlyphCache m_glyphCache;
 };
 
-}
\ No newline at end of file
+}
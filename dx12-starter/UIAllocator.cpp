@@ -0,0 +1,327 @@
+#include "UIAllocator.h"
+#include "imgui.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+// Pools: blocks of 32 bytes to POOL_MAX_BLOCK (header included), one size class per power of two
+static size_t const                 POOL_MIN_BLOCK = 32;
+static int const                    POOL_CLASSES = 11;
+// Chunks hold at least POOL_CHUNK_MIN_BLOCKS blocks, so the large classes don't go back to the heap for every few blocks
+static size_t const                 POOL_CHUNK_SIZE = 64 * 1024;
+static size_t const                 POOL_CHUNK_MIN_BLOCKS = 8;
+static uint32_t const               TIER_LARGE = POOL_CLASSES;
+static uint32_t const               TIER_ARENA = POOL_CLASSES + 1;
+static size_t const                 ARENA_ALIGNMENT = 16;
+
+// In front of every block. 16 bytes, so blocks keep the alignment of malloc().
+struct UIBlockHeader
+{
+	// Pool size class, TIER_LARGE or TIER_ARENA
+	uint32_t Tier;
+	// Thread that allocated a pool block, see GetThreadId()
+	uint32_t Owner;
+	// As requested
+	uint64_t Size;
+};
+static_assert(sizeof(UIBlockHeader) == 16, "blocks must stay 16 byte aligned");
+static_assert((POOL_MIN_BLOCK << (POOL_CLASSES - 1)) == UIAllocator::POOL_MAX_BLOCK, "size classes must end at POOL_MAX_BLOCK");
+
+struct UIFreeBlock
+{
+	UIFreeBlock* Next;
+};
+
+// Chunks start with a link to the next one, padded to a header so the blocks after it stay aligned
+struct UIChunk
+{
+	UIChunk* Next;
+	uint8_t Padding[sizeof(UIBlockHeader) - sizeof(UIChunk*)];
+};
+
+// Free lists of one thread. Only valid for the Install() they were filled under, see s_generation.
+struct UIThreadCache
+{
+	UIFreeBlock* FreeLists[POOL_CLASSES];
+	uint32_t Generation;
+};
+
+static std::mutex                   s_chunkMutex;
+static UIChunk*                     s_chunks = nullptr;
+static std::atomic<uint32_t>        s_generation{ 0 };
+static thread_local UIThreadCache   t_cache;
+static thread_local uint32_t        t_threadId = 0;
+static thread_local int             t_arenaDepth = 0;
+static std::atomic<uint32_t>        s_nextThreadId{ 1 };
+// Pool blocks freed by another thread than the one that allocated them. Frees push one block, a thread whose own list
+// ran dry takes the whole list, so there is no ABA problem.
+static std::atomic<UIFreeBlock*>    s_sharedFreeLists[POOL_CLASSES];
+
+static uint8_t*                     s_arena = nullptr;
+static size_t                       s_arenaCapacity = 0;
+static std::atomic<size_t>          s_arenaOffset{ 0 };
+static std::atomic<uint64_t>        s_arenaLive{ 0 };
+
+// Totals since Install(). Per frame counters are the difference with the totals at the last NewFrame().
+static std::atomic<uint64_t>        s_liveBytes{ 0 };
+static std::atomic<uint64_t>        s_peakLiveBytes{ 0 };
+static std::atomic<uint64_t>        s_liveAllocations{ 0 };
+static std::atomic<uint64_t>        s_heapBytes{ 0 };
+static std::atomic<uint64_t>        s_allocations{ 0 };
+static std::atomic<uint64_t>        s_heapAllocations{ 0 };
+static std::atomic<uint64_t>        s_arenaAllocations{ 0 };
+static std::atomic<uint64_t>        s_arenaOverflows{ 0 };
+static std::atomic<uint64_t>        s_crossThreadFrees{ 0 };
+static uint64_t                     s_deferredArenaResets = 0;
+static uint64_t                     s_frameStartAllocations = 0;
+static uint64_t                     s_frameStartHeapAllocations = 0;
+static uint64_t                     s_frameStartArenaAllocations = 0;
+static UIAllocatorStats             s_lastFrame;
+
+static UIThreadCache& GetThreadCache()
+{
+	UIThreadCache& cache = t_cache;
+	uint32_t generation = s_generation.load(std::memory_order_relaxed);
+	if (cache.Generation != generation)
+	{
+		memset(cache.FreeLists, 0, sizeof(cache.FreeLists));
+		cache.Generation = generation;
+	}
+	return cache;
+}
+
+static uint32_t GetThreadId()
+{
+	if (t_threadId == 0)
+		t_threadId = s_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+	return t_threadId;
+}
+
+static uint32_t GetSizeClass(size_t blockSize)
+{
+	uint32_t sizeClass = 0;
+	while ((POOL_MIN_BLOCK << sizeClass) < blockSize)
+		sizeClass++;
+	return sizeClass;
+}
+
+// Refills the calling thread's free list of `sizeClass` with the blocks other threads freed, or else a new chunk
+static bool RefillPool(UIThreadCache& cache, uint32_t sizeClass)
+{
+	if (s_sharedFreeLists[sizeClass].load(std::memory_order_relaxed) != nullptr)
+	{
+		cache.FreeLists[sizeClass] = s_sharedFreeLists[sizeClass].exchange(nullptr, std::memory_order_acquire);
+		if (cache.FreeLists[sizeClass] != nullptr)
+			return true;
+	}
+
+	size_t blockSize = POOL_MIN_BLOCK << sizeClass;
+	size_t chunkSize = sizeof(UIChunk) + (blockSize * POOL_CHUNK_MIN_BLOCKS > POOL_CHUNK_SIZE ? blockSize * POOL_CHUNK_MIN_BLOCKS : POOL_CHUNK_SIZE);
+	UIChunk* chunk = (UIChunk*)malloc(chunkSize);
+	if (chunk == nullptr)
+		return false;
+	{
+		std::lock_guard<std::mutex> lock(s_chunkMutex);
+		chunk->Next = s_chunks;
+		s_chunks = chunk;
+	}
+	s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+	s_heapBytes.fetch_add(chunkSize, std::memory_order_relaxed);
+
+	uint8_t* first = (uint8_t*)(chunk + 1);
+	size_t count = (chunkSize - sizeof(UIChunk)) / blockSize;
+	for (size_t i = count; i-- > 0; )
+	{
+		UIFreeBlock* block = (UIFreeBlock*)(first + i * blockSize);
+		block->Next = cache.FreeLists[sizeClass];
+		cache.FreeLists[sizeClass] = block;
+	}
+	return true;
+}
+
+static UIBlockHeader* AllocateFromArena(size_t size)
+{
+	size_t blockSize = (sizeof(UIBlockHeader) + size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+	size_t offset = s_arenaOffset.fetch_add(blockSize, std::memory_order_relaxed);
+	if (offset + blockSize > s_arenaCapacity)
+	{
+		s_arenaOverflows.fetch_add(1, std::memory_order_relaxed);
+		return nullptr;
+	}
+	s_arenaLive.fetch_add(1, std::memory_order_relaxed);
+	s_arenaAllocations.fetch_add(1, std::memory_order_relaxed);
+	return (UIBlockHeader*)(s_arena + offset);
+}
+
+void UIAllocator::Install(size_t arenaCapacity)
+{
+	// Blocks still live from an earlier Install() keep their chunks, only the counters of the new one start over
+	s_generation.fetch_add(1, std::memory_order_relaxed);
+	if (s_arena == nullptr && arenaCapacity > 0)
+	{
+		s_arena = (uint8_t*)malloc(arenaCapacity);
+		s_arenaCapacity = s_arena != nullptr ? arenaCapacity : 0;
+		s_heapBytes.fetch_add(s_arenaCapacity, std::memory_order_relaxed);
+	}
+	s_arenaOffset.store(0, std::memory_order_relaxed);
+	s_allocations.store(0, std::memory_order_relaxed);
+	s_heapAllocations.store(0, std::memory_order_relaxed);
+	s_arenaAllocations.store(0, std::memory_order_relaxed);
+	s_arenaOverflows.store(0, std::memory_order_relaxed);
+	s_crossThreadFrees.store(0, std::memory_order_relaxed);
+	s_deferredArenaResets = 0;
+	s_frameStartAllocations = s_frameStartHeapAllocations = s_frameStartArenaAllocations = 0;
+	s_lastFrame = UIAllocatorStats();
+	ImGui::SetAllocatorFunctions(Alloc, Free);
+}
+
+void UIAllocator::Uninstall()
+{
+	// imgui's free function stays pointed at Free(): blocks that outlive the context (e.g. thread_local ImVectors freed
+	// at thread exit) must come back here, so their memory is only released once nothing is live
+	if (s_liveAllocations.load(std::memory_order_relaxed) != 0)
+		return;
+	std::lock_guard<std::mutex> lock(s_chunkMutex);
+	while (s_chunks != nullptr)
+	{
+		UIChunk* next = s_chunks->Next;
+		free(s_chunks);
+		s_chunks = next;
+	}
+	for (std::atomic<UIFreeBlock*>& sharedFreeList : s_sharedFreeLists)
+		sharedFreeList.store(nullptr, std::memory_order_relaxed);
+	free(s_arena);
+	s_arena = nullptr;
+	s_arenaCapacity = 0;
+	s_heapBytes.store(0, std::memory_order_relaxed);
+	// Drops every thread's free lists, which point into the chunks
+	s_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+void UIAllocator::NewFrame()
+{
+	uint64_t allocations = s_allocations.load(std::memory_order_relaxed);
+	uint64_t heapAllocations = s_heapAllocations.load(std::memory_order_relaxed);
+	uint64_t arenaAllocations = s_arenaAllocations.load(std::memory_order_relaxed);
+	size_t arenaBytes = s_arenaOffset.load(std::memory_order_relaxed);
+	s_lastFrame.FrameAllocations = allocations - s_frameStartAllocations;
+	s_lastFrame.FrameHeapAllocations = heapAllocations - s_frameStartHeapAllocations;
+	s_lastFrame.FrameArenaAllocations = arenaAllocations - s_frameStartArenaAllocations;
+	s_lastFrame.FrameArenaBytes = arenaBytes < s_arenaCapacity ? arenaBytes : s_arenaCapacity;
+	s_frameStartAllocations = allocations;
+	s_frameStartHeapAllocations = heapAllocations;
+	s_frameStartArenaAllocations = arenaAllocations;
+
+	if (s_arenaLive.load(std::memory_order_relaxed) == 0)
+		s_arenaOffset.store(0, std::memory_order_relaxed);
+	else
+		s_deferredArenaResets++;
+}
+
+UIAllocatorStats UIAllocator::GetStats()
+{
+	UIAllocatorStats stats = s_lastFrame;
+	stats.LiveBytes = s_liveBytes.load(std::memory_order_relaxed);
+	stats.PeakLiveBytes = s_peakLiveBytes.load(std::memory_order_relaxed);
+	stats.LiveAllocations = s_liveAllocations.load(std::memory_order_relaxed);
+	stats.HeapBytes = s_heapBytes.load(std::memory_order_relaxed);
+	stats.Allocations = s_allocations.load(std::memory_order_relaxed);
+	stats.HeapAllocations = s_heapAllocations.load(std::memory_order_relaxed);
+	stats.DeferredArenaResets = s_deferredArenaResets;
+	stats.ArenaOverflows = s_arenaOverflows.load(std::memory_order_relaxed);
+	stats.CrossThreadFrees = s_crossThreadFrees.load(std::memory_order_relaxed);
+	return stats;
+}
+
+void* UIAllocator::Alloc(size_t size, void*)
+{
+	UIBlockHeader* block = nullptr;
+	uint32_t tier = TIER_LARGE;
+	if (t_arenaDepth > 0 && s_arena != nullptr)
+	{
+		block = AllocateFromArena(size);
+		tier = TIER_ARENA;
+	}
+	if (block == nullptr && sizeof(UIBlockHeader) + size <= POOL_MAX_BLOCK)
+	{
+		UIThreadCache& cache = GetThreadCache();
+		tier = GetSizeClass(sizeof(UIBlockHeader) + size);
+		if (cache.FreeLists[tier] == nullptr && !RefillPool(cache, tier))
+			return nullptr;
+		UIFreeBlock* freeBlock = cache.FreeLists[tier];
+		cache.FreeLists[tier] = freeBlock->Next;
+		block = (UIBlockHeader*)freeBlock;
+	}
+	else if (block == nullptr)
+	{
+		block = (UIBlockHeader*)malloc(sizeof(UIBlockHeader) + size);
+		if (block == nullptr)
+			return nullptr;
+		tier = TIER_LARGE;
+		s_heapAllocations.fetch_add(1, std::memory_order_relaxed);
+		s_heapBytes.fetch_add(sizeof(UIBlockHeader) + size, std::memory_order_relaxed);
+	}
+	block->Tier = tier;
+	block->Owner = GetThreadId();
+	block->Size = size;
+
+	s_allocations.fetch_add(1, std::memory_order_relaxed);
+	s_liveAllocations.fetch_add(1, std::memory_order_relaxed);
+	uint64_t live = s_liveBytes.fetch_add(size, std::memory_order_relaxed) + size;
+	uint64_t peak = s_peakLiveBytes.load(std::memory_order_relaxed);
+	while (live > peak && !s_peakLiveBytes.compare_exchange_weak(peak, live, std::memory_order_relaxed))
+	{
+	}
+	return block + 1;
+}
+
+void UIAllocator::Free(void* ptr, void*)
+{
+	if (ptr == nullptr)
+		return;
+	UIBlockHeader* block = (UIBlockHeader*)ptr - 1;
+	uint32_t tier = block->Tier;
+	s_liveAllocations.fetch_sub(1, std::memory_order_relaxed);
+	s_liveBytes.fetch_sub(block->Size, std::memory_order_relaxed);
+	if (tier == TIER_ARENA)
+	{
+		// The memory comes back when NewFrame() rewinds the arena
+		s_arenaLive.fetch_sub(1, std::memory_order_relaxed);
+	}
+	else if (tier == TIER_LARGE)
+	{
+		s_heapBytes.fetch_sub(sizeof(UIBlockHeader) + block->Size, std::memory_order_relaxed);
+		free(block);
+	}
+	else if (block->Owner == GetThreadId())
+	{
+		UIThreadCache& cache = GetThreadCache();
+		// The link overwrites the header
+		UIFreeBlock* freeBlock = (UIFreeBlock*)block;
+		freeBlock->Next = cache.FreeLists[tier];
+		cache.FreeLists[tier] = freeBlock;
+	}
+	else
+	{
+		// Not onto this thread's list: blocks allocated on one thread and freed on another (e.g. a worker's draw list
+		// freed by the main thread) would pile up there while their owner keeps going to the heap
+		s_crossThreadFrees.fetch_add(1, std::memory_order_relaxed);
+		UIFreeBlock* freeBlock = (UIFreeBlock*)block;
+		std::atomic<UIFreeBlock*>& sharedFreeList = s_sharedFreeLists[tier];
+		freeBlock->Next = sharedFreeList.load(std::memory_order_relaxed);
+		while (!sharedFreeList.compare_exchange_weak(freeBlock->Next, freeBlock, std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+}
+
+void UIAllocator::BeginArena()
+{
+	t_arenaDepth++;
+}
+
+void UIAllocator::EndArena()
+{
+	t_arenaDepth--;
+}
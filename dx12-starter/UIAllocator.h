@@ -0,0 +1,77 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+struct UIAllocatorStats
+{
+	// Requested bytes handed out and not freed yet, and the most there ever were
+	uint64_t LiveBytes = 0;
+	uint64_t PeakLiveBytes = 0;
+	uint64_t LiveAllocations = 0;
+	// Bytes taken from the heap: pool chunks, large blocks and the arena
+	uint64_t HeapBytes = 0;
+	// Since Install()
+	uint64_t Allocations = 0;
+	uint64_t HeapAllocations = 0;
+	// Of the last frame, between the last two NewFrame() calls. HeapAllocations are the malloc() calls: new pool chunks
+	// and blocks too large for the pools.
+	uint64_t FrameAllocations = 0;
+	uint64_t FrameHeapAllocations = 0;
+	uint64_t FrameArenaAllocations = 0;
+	// Arena bytes in use when the last frame ended, including earlier frames' if the arena couldn't rewind
+	uint64_t FrameArenaBytes = 0;
+	// NewFrame() calls that couldn't rewind the arena because some of its blocks were still live
+	uint64_t DeferredArenaResets = 0;
+	// Arena allocations that didn't fit and went to the pools instead
+	uint64_t ArenaOverflows = 0;
+	// Pool blocks freed on another thread than the one that allocated them, since Install()
+	uint64_t CrossThreadFrees = 0;
+};
+
+/// <summary>
+/// imgui's allocator (ImGui::SetAllocatorFunctions), in three tiers. Blocks up to POOL_MAX_BLOCK bytes come from size
+/// class pools: power of two blocks carved out of large chunks, with free lists per thread, so allocating and freeing
+/// takes no locks and, once the lists are warm, no heap calls. Frees may happen on any thread: a block freed by the
+/// thread that allocated it goes back to that thread's list, others to a shared list per size class that a thread takes
+/// over when its own list runs dry. Larger blocks go to malloc(). Allocations made inside a UIFrameArenaScope are bumped
+/// out of one arena instead, and freeing them does nothing: the arena rewinds in NewFrame(), so they must not outlive
+/// the frame. Every block carries a small header with its tier and owner, so imgui's free(ptr) without a size knows
+/// where it goes.
+/// Chunks are only given back by Uninstall() when no block is live, so blocks freed after it (e.g. by thread_local
+/// ImVectors at thread exit) are still fine.
+/// </summary>
+class UIAllocator
+{
+public:
+	static size_t const POOL_MAX_BLOCK = 32 * 1024;
+
+	// Before ImGui::CreateContext()
+	static void Install(size_t arenaCapacity);
+	// After ImGui::DestroyContext()
+	static void Uninstall();
+	// Main thread, between frames: starts the per-frame counters over, and rewinds the arena
+	static void NewFrame();
+	static UIAllocatorStats GetStats();
+
+	// The functions given to ImGui::SetAllocatorFunctions()
+	static void* Alloc(size_t size, void* userData);
+	static void Free(void* ptr, void* userData);
+
+private:
+	friend class UIFrameArenaScope;
+	static void BeginArena();
+	static void EndArena();
+};
+
+/// <summary>
+/// Allocations made through imgui on this thread while the scope is open come from the frame arena. Only for buffers
+/// that are freed before the next UIAllocator::NewFrame(), or the arena can't rewind. Scopes nest.
+/// </summary>
+class UIFrameArenaScope
+{
+public:
+	UIFrameArenaScope() { UIAllocator::BeginArena(); }
+	~UIFrameArenaScope() { UIAllocator::EndArena(); }
+	UIFrameArenaScope(const UIFrameArenaScope&) = delete;
+	UIFrameArenaScope& operator=(const UIFrameArenaScope&) = delete;
+};
@@ -0,0 +1,136 @@
+#include "UploadRingBuffer.h"
+#include "imgui.h"
+
+void UploadRingBuffer::Init(uint64_t capacity)
+{
+	*this = UploadRingBuffer();
+	m_capacity = capacity;
+}
+
+bool UploadRingBuffer::Allocate(uint64_t size, uint64_t alignment, uint64_t* outOffset)
+{
+	IM_ASSERT(alignment != 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of two");
+
+	// Nothing in flight, start over from the beginning to avoid needless wrapping. Not while frames are pending, even
+	// empty ones: retiring them moves the tail to where the head was when they finished.
+	if (m_used == 0 && m_frameCount == 0)
+		m_head = m_tail = 0;
+
+	uint64_t offset = (m_head + alignment - 1) & ~(alignment - 1);
+	uint64_t consumed = 0;
+	bool wrapped = false;
+	if (m_head > m_tail || m_used == 0)
+	{
+		// Free space is [head, capacity) followed by [0, tail)
+		if (offset + size <= m_capacity)
+		{
+			consumed = offset - m_head + size;
+		}
+		else if (size <= m_tail)
+		{
+			offset = 0;
+			consumed = m_capacity - m_head + size;
+			wrapped = true;
+		}
+		else
+		{
+			m_stats.FailedAllocations++;
+			return false;
+		}
+	}
+	else if (m_head < m_tail && offset + size <= m_tail)
+	{
+		// Free space is [head, tail)
+		consumed = offset - m_head + size;
+	}
+	else
+	{
+		// Full, or the gap in front of the tail is too small
+		m_stats.FailedAllocations++;
+		return false;
+	}
+
+	m_head = offset + size;
+	m_used += consumed;
+	m_frameBytes += consumed;
+
+	m_stats.Allocations++;
+	m_stats.BytesAllocated += size;
+	if (wrapped)
+	{
+		m_stats.Wraps++;
+		m_stats.WrapBytes += consumed - size;
+	}
+	else
+	{
+		m_stats.PaddingBytes += consumed - size;
+	}
+	m_stats.UsedBytes = m_used;
+	if (m_used > m_stats.PeakUsedBytes)
+		m_stats.PeakUsedBytes = m_used;
+
+	*outOffset = offset;
+	return true;
+}
+
+void UploadRingBuffer::FinishFrame(uint64_t fenceValue)
+{
+	IM_ASSERT(m_frameCount < MAX_PENDING_FRAMES && "Too many frames in flight, call Retire()");
+	FrameMarker& frame = m_frames[(m_firstFrame + m_frameCount) % MAX_PENDING_FRAMES];
+	frame.FenceValue = fenceValue;
+	frame.End = m_head;
+	frame.Bytes = m_frameBytes;
+	m_frameCount++;
+	m_stats.LastFrameBytes = m_frameBytes;
+	m_frameBytes = 0;
+}
+
+void UploadRingBuffer::Retire(uint64_t completedFenceValue)
+{
+	while (m_frameCount > 0 && m_frames[m_firstFrame].FenceValue <= completedFenceValue)
+	{
+		const FrameMarker& frame = m_frames[m_firstFrame];
+		m_tail = frame.End;
+		m_used -= frame.Bytes;
+		m_firstFrame = (m_firstFrame + 1) % MAX_PENDING_FRAMES;
+		m_frameCount--;
+	}
+	m_stats.UsedBytes = m_used;
+}
+
+bool DynamicUploadHeap::Init(GraphicsDevice* device, uint64_t capacity)
+{
+	m_buffer = device->CreateUploadBuffer(capacity);
+	if (m_buffer == nullptr)
+		return false;
+	m_ring.Init(capacity);
+	return true;
+}
+
+void DynamicUploadHeap::Shutdown()
+{
+	if (m_buffer) { delete m_buffer; m_buffer = nullptr; }
+}
+
+bool DynamicUploadHeap::Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation)
+{
+	uint64_t offset;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_buffer == nullptr || !m_ring.Allocate(size, alignment, &offset))
+			return false;
+	}
+	allocation.CpuAddress = (uint8_t*)m_buffer->GetCpuAddress() + offset;
+	allocation.GpuAddress = m_buffer->GetGpuAddress() + offset;
+	return true;
+}
+
+bool DynamicUploadHeap::AllocateCallback(void* userData, size_t size, size_t alignment, void** outCpuAddress, unsigned long long* outGpuAddress)
+{
+	UploadAllocation allocation;
+	if (!static_cast<DynamicUploadHeap*>(userData)->Allocate(size, alignment, allocation))
+		return false;
+	*outCpuAddress = allocation.CpuAddress;
+	*outGpuAddress = allocation.GpuAddress;
+	return true;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include "GraphicsDevice.h"
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+
+struct UploadRingBufferStats
+{
+	uint64_t Allocations = 0;
+	uint64_t FailedAllocations = 0;
+	uint64_t BytesAllocated = 0;
+	// Bytes lost to alignment, and to the unused tail when an allocation wraps back to offset 0
+	uint64_t PaddingBytes = 0;
+	uint64_t WrapBytes = 0;
+	uint64_t Wraps = 0;
+	uint64_t UsedBytes = 0;
+	uint64_t PeakUsedBytes = 0;
+	uint64_t LastFrameBytes = 0;
+};
+
+/// <summary>
+/// Linear ring allocator over a fixed range of offsets. Allocations are handed out in order from the head,
+/// grouped per frame with FinishFrame(fenceValue), and given back in order from the tail by Retire() once the
+/// GPU has passed that fence. Pure bookkeeping, it never touches memory, so it can be tested on the CPU alone.
+/// </summary>
+class UploadRingBuffer
+{
+public:
+	static int const MAX_PENDING_FRAMES = 16;
+
+	void Init(uint64_t capacity);
+	// Returns false (and leaves the ring untouched) if there isn't enough contiguous free space.
+	bool Allocate(uint64_t size, uint64_t alignment, uint64_t* outOffset);
+	// Everything allocated since the previous call belongs to the frame that signals `fenceValue`.
+	void FinishFrame(uint64_t fenceValue);
+	// Frees all frames whose fence value is <= `completedFenceValue`.
+	void Retire(uint64_t completedFenceValue);
+
+	uint64_t GetCapacity() const { return m_capacity; }
+	const UploadRingBufferStats& GetStats() const { return m_stats; }
+
+private:
+	struct FrameMarker
+	{
+		uint64_t FenceValue;
+		uint64_t End;
+		uint64_t Bytes;
+	};
+
+	uint64_t m_capacity = 0;
+	uint64_t m_head = 0;
+	uint64_t m_tail = 0;
+	uint64_t m_used = 0;
+	uint64_t m_frameBytes = 0;
+	FrameMarker m_frames[MAX_PENDING_FRAMES] = {};
+	int m_firstFrame = 0;
+	int m_frameCount = 0;
+	UploadRingBufferStats m_stats;
+};
+
+struct UploadAllocation
+{
+	void* CpuAddress = nullptr;
+	uint64_t GpuAddress = 0;
+};
+
+/// <summary>
+/// One persistently mapped upload buffer shared by every frame in flight, suballocated with an UploadRingBuffer.
+/// Used for per-frame dynamic data such as the imgui vertex/index buffers. Allocate() may be called from several
+/// recording threads at once, FinishFrame() and Retire() only between frames.
+/// </summary>
+class DynamicUploadHeap
+{
+public:
+	bool Init(GraphicsDevice* device, uint64_t capacity);
+	void Shutdown();
+	bool Allocate(uint64_t size, uint64_t alignment, UploadAllocation& allocation);
+	void FinishFrame(uint64_t fenceValue) { m_ring.FinishFrame(fenceValue); }
+	void Retire(uint64_t completedFenceValue) { m_ring.Retire(completedFenceValue); }
+	const UploadRingBufferStats& GetStats() const { return m_ring.GetStats(); }
+	// For copies that take the buffer plus an offset (e.g. texture uploads): offset = GpuAddress - GetGpuAddress()
+	Buffer* GetBuffer() const { return m_buffer; }
+
+	// Matches the allocation callback expected by the imgui DX12 backend
+	static bool AllocateCallback(void* userData, size_t size, size_t alignment, void** outCpuAddress, unsigned long long* outGpuAddress);
+
+private:
+	Buffer* m_buffer = nullptr;
+	UploadRingBuffer m_ring;
+	std::mutex m_mutex;
+};
@@ -4,6 +4,7 @@ Window::Window()
 {
 }
 
+#ifdef _WIN32
 /// <summary>
 /// Initializes and opens a native Window context using GLFW. A ref to window context is stored as class property (`m_window`).
 /// </summary>
@@ -52,15 +53,38 @@ void Window::Terminate()
     glfwTerminate();
 }
 
-void Window::Update()
+void Window::Update(double waitSeconds)
 {
-    glfwPollEvents();
+    if (waitSeconds > 0.0)
+        glfwWaitEventsTimeout(waitSeconds);
+    else
+        glfwPollEvents();
 }
 
 bool Window::ShouldLoop()
 {
     return !glfwWindowShouldClose(m_window);
 }
+#else
+bool Window::Init()
+{
+    std::cout << "[Window]: No native window outside Windows\n";
+    return false;
+}
+
+void Window::Terminate()
+{
+}
+
+void Window::Update(double waitSeconds)
+{
+}
+
+bool Window::ShouldLoop()
+{
+    return false;
+}
+#endif
 
 void Window::HandleResize(int width, int height)
 {
@@ -1,5 +1,10 @@
 #pragma once
+#ifdef _WIN32
 #include <GLFW/glfw3.h>
+#else
+// Windowed mode needs DirectX 12, elsewhere only --headless runs and there is no GLFW
+struct GLFWwindow;
+#endif
 #include <iostream>
 
 
@@ -9,7 +14,9 @@ public:
 	Window();
 	bool Init();
 	void Terminate();
-	void Update();
+	// Processes pending window events. With a positive `waitSeconds`, sleeps until an event arrives or the timeout
+	// expires instead of returning right away.
+	void Update(double waitSeconds = 0.0);
 	bool ShouldLoop();
 	void HandleResize(int width, int height);
 	// Callback for C library so needs to be static
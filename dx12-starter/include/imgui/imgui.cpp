@@ -1206,6 +1206,10 @@ ImGuiIO::ImGuiIO()
     ConfigWindowsResizeFromEdges = true;
     ConfigWindowsMoveFromTitleBarOnly = false;
     ConfigMemoryCompactTimer = 60.0f;
+    ConfigTextLayoutCache = false;
+    ConfigDrawListRetainBuffers = false;
+    ConfigDrawListShrinkRatio = 2.0f;
+    ConfigDrawListShrinkDelay = 60.0f;
 
     // Platform Functions
     BackendPlatformName = BackendRendererName = NULL;
@@ -1843,51 +1847,107 @@ static const ImU32 GCrc32LookupTable[256] =
     0xBDBDF21C,0xCABAC28A,0x53B39330,0x24B4A3A6,0xBAD03605,0xCDD70693,0x54DE5729,0x23D967BF,0xB3667A2E,0xC4614AB8,0x5D681B02,0x2A6F2B94,0xB40BBE37,0xC30C8EA1,0x5A05DF1B,0x2D02EF8D,
 };
 
+// Hardware CRC32 on ARMv8: its CRC32 instructions use the same polynomial as the table above, so the hashes are the same.
+// The SSE4.2 crc32 instruction on x86 computes CRC32C (a different polynomial): using it would change every ID, and with it
+// the table IDs stored in .ini files, so x86 uses the slicing-by-8 tables below.
+#if defined(__ARM_FEATURE_CRC32) || defined(_M_ARM64)
+#define IMGUI_ENABLE_ARM_CRC32
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#else
+#include <arm_acle.h>
+#endif
+#endif
+
+#ifndef IMGUI_ENABLE_ARM_CRC32
+// Slicing-by-8: GCrc32LookupTable extended to 8 tables, so 8 bytes cost 8 independent lookups instead of 8 dependent ones.
+// Built on first use (a function-local static, thread-safe and usable from static constructors). Little-endian only.
+struct ImCrc32Tables
+{
+    ImU32 Data[8][256];
+    ImCrc32Tables()
+    {
+        memcpy(Data[0], GCrc32LookupTable, sizeof(GCrc32LookupTable));
+        for (int n = 1; n < 8; n++)
+            for (int i = 0; i < 256; i++)
+                Data[n][i] = (Data[n - 1][i] >> 8) ^ Data[0][Data[n - 1][i] & 0xFF];
+    }
+};
+#endif
+
+// CRC32 of 'data' continuing from 'crc' (not inverted)
+static ImU32 ImCrc32(ImU32 crc, const unsigned char* data, size_t data_size)
+{
+#ifdef IMGUI_ENABLE_ARM_CRC32
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        ImU64 word;
+        memcpy(&word, data, 8);
+        crc = __crc32d(crc, word);
+    }
+    while (data_size-- != 0)
+        crc = __crc32b(crc, *data++);
+#else
+    static const ImCrc32Tables tables;
+    const ImU32 (*t)[256] = tables.Data;
+    for (; data_size >= 8; data += 8, data_size -= 8)
+    {
+        ImU32 lo, hi;
+        memcpy(&lo, data, 4);
+        memcpy(&hi, data + 4, 4);
+        lo ^= crc;
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+    }
+    if (data_size >= 4)
+    {
+        ImU32 lo;
+        memcpy(&lo, data, 4);
+        lo ^= crc;
+        crc = t[3][lo & 0xFF] ^ t[2][(lo >> 8) & 0xFF] ^ t[1][(lo >> 16) & 0xFF] ^ t[0][lo >> 24];
+        data += 4;
+        data_size -= 4;
+    }
+    switch (data_size)
+    {
+    case 3: crc ^= data[0] | (data[1] << 8) | (data[2] << 16); crc = (crc >> 24) ^ t[2][crc & 0xFF] ^ t[1][(crc >> 8) & 0xFF] ^ t[0][(crc >> 16) & 0xFF]; break;
+    case 2: crc ^= data[0] | (data[1] << 8); crc = (crc >> 16) ^ t[1][crc & 0xFF] ^ t[0][(crc >> 8) & 0xFF]; break;
+    case 1: crc = (crc >> 8) ^ t[0][(crc ^ data[0]) & 0xFF]; break;
+    }
+#endif
+    return crc;
+}
+
 // Known size hash
 // It is ok to call ImHashData on a string with known length but the ### operator won't be supported.
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashData(const void* data_p, size_t data_size, ImU32 seed)
 {
-    ImU32 crc = ~seed;
-    const unsigned char* data = (const unsigned char*)data_p;
-    const ImU32* crc32_lut = GCrc32LookupTable;
-    while (data_size-- != 0)
-        crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ *data++];
-    return ~crc;
+    return ~ImCrc32(~seed, (const unsigned char*)data_p, data_size);
 }
 
 // Zero-terminated string hash, with support for ### to reset back to seed value
 // We support a syntax of "label###id" where only "###id" is included in the hash, and only "label" gets displayed.
 // Because this syntax is rarely used we are optimizing for the common case.
-// - If we reach ### in the string we discard the hash so far and reset to the seed.
-// - We don't do 'current += 2; continue;' after handling ### to keep the code smaller/faster (measured ~10% diff in Debug build)
-// FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
+// - Resetting to the seed on every ### discards everything before the last one, so we find the end of the string and the
+//   last ### in one pass, then only hash from there.
 ImGuiID ImHashStr(const char* data_p, size_t data_size, ImU32 seed)
 {
-    seed = ~seed;
-    ImU32 crc = seed;
-    const unsigned char* data = (const unsigned char*)data_p;
-    const ImU32* crc32_lut = GCrc32LookupTable;
+    const char* hash_begin = data_p;
+    const char* p = data_p;
     if (data_size != 0)
     {
-        while (data_size-- != 0)
-        {
-            unsigned char c = *data++;
-            if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#')
-                crc = seed;
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-        }
+        const char* data_end = data_p + data_size;
+        for (; p < data_end; p++)
+            if (*p == '#' && data_end - p >= 3 && p[1] == '#' && p[2] == '#')
+                hash_begin = p;
     }
     else
     {
-        while (unsigned char c = *data++)
-        {
-            if (c == '#' && data[0] == '#' && data[1] == '#')
-                crc = seed;
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-        }
+        for (; *p; p++)
+            if (*p == '#' && p[1] == '#' && p[2] == '#')
+                hash_begin = p;
     }
-    return ~crc;
+    return ~ImCrc32(~seed, (const unsigned char*)hash_begin, (size_t)(p - hash_begin));
 }
 
 //-----------------------------------------------------------------------------
@@ -2022,14 +2082,86 @@ int ImTextCharFromUtf8(unsigned int* out_char, const char* in_text, const char*
     return wanted;
 }
 
+// Runs of ASCII characters (except 0), which decode as themselves, 16 bytes at a time with SSE2 or NEON.
+// - A signed compare against 1 catches both 0 and the bytes of multi-byte sequences (0x80 and up).
+// - Callers skip decoding for the whole run, which is where most of the time goes on ASCII text.
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_ENABLE_SIMD_TEXT
+static inline bool ImTextIsAscii16(const char* in_text) { return _mm_movemask_epi8(_mm_cmplt_epi8(_mm_loadu_si128((const __m128i*)in_text), _mm_set1_epi8(1))) == 0; }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define IMGUI_ENABLE_SIMD_TEXT
+#include <arm_neon.h>
+static inline bool ImTextIsAscii16(const char* in_text) { return vmaxvq_u8(vcltq_s8(vld1q_s8((const int8_t*)in_text), vdupq_n_s8(1))) == 0; }
+#endif
+
+int ImTextCountAsciiChars(const char* in_text, const char* in_text_end)
+{
+    const char* s = in_text;
+#ifdef IMGUI_ENABLE_SIMD_TEXT
+    while (in_text_end - s >= 16 && ImTextIsAscii16(s))
+        s += 16;
+#endif
+    while (s < in_text_end && (signed char)*s > 0)
+        s++;
+    return (int)(s - in_text);
+}
+
+// Copy a run of ASCII characters (except 0), widening them 16 at a time. Return the number of characters copied.
+static int ImTextStrFromAscii(ImWchar* buf, int buf_size, const char* in_text, const char* in_text_end)
+{
+    int n = 0;
+    const int n_max = ImMin(buf_size, (int)(in_text_end - in_text));
+#ifdef IMGUI_ENABLE_SIMD_TEXT
+    for (; n + 16 <= n_max && ImTextIsAscii16(in_text + n); n += 16)
+    {
+#if defined(__aarch64__) || defined(_M_ARM64)
+        const uint8x16_t bytes = vld1q_u8((const uint8_t*)in_text + n);
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(bytes)), hi = vmovl_u8(vget_high_u8(bytes));
+#ifdef IMGUI_USE_WCHAR32
+        vst1q_u32((uint32_t*)buf + n, vmovl_u16(vget_low_u16(lo)));
+        vst1q_u32((uint32_t*)buf + n + 4, vmovl_u16(vget_high_u16(lo)));
+        vst1q_u32((uint32_t*)buf + n + 8, vmovl_u16(vget_low_u16(hi)));
+        vst1q_u32((uint32_t*)buf + n + 12, vmovl_u16(vget_high_u16(hi)));
+#else
+        vst1q_u16((uint16_t*)buf + n, lo);
+        vst1q_u16((uint16_t*)buf + n + 8, hi);
+#endif
+#else
+        const __m128i bytes = _mm_loadu_si128((const __m128i*)(in_text + n));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i lo = _mm_unpacklo_epi8(bytes, zero), hi = _mm_unpackhi_epi8(bytes, zero);
+#ifdef IMGUI_USE_WCHAR32
+        _mm_storeu_si128((__m128i*)(buf + n), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(buf + n + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128((__m128i*)(buf + n + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128((__m128i*)(buf + n + 12), _mm_unpackhi_epi16(hi, zero));
+#else
+        _mm_storeu_si128((__m128i*)(buf + n), lo);
+        _mm_storeu_si128((__m128i*)(buf + n + 8), hi);
+#endif
+#endif
+    }
+#endif
+    for (; n < n_max && (signed char)in_text[n] > 0; n++)
+        buf[n] = (ImWchar)in_text[n];
+    return n;
+}
+
 int ImTextStrFromUtf8(ImWchar* buf, int buf_size, const char* in_text, const char* in_text_end, const char** in_text_remaining)
 {
     ImWchar* buf_out = buf;
     ImWchar* buf_end = buf + buf_size;
     while (buf_out < buf_end - 1 && (!in_text_end || in_text < in_text_end) && *in_text)
     {
+        if (in_text_end && (signed char)*in_text > 0)
+        {
+            const int n = ImTextStrFromAscii(buf_out, (int)(buf_end - 1 - buf_out), in_text, in_text_end);
+            buf_out += n;
+            in_text += n;
+            continue;
+        }
         unsigned int c;
-        in_text += ImTextCharFromUtf8(&c, in_text, in_text_end);
+        in_text += in_text_end ? ImTextCharFromUtf8Multibyte(&c, in_text, in_text_end) : ImTextCharFromUtf8(&c, in_text, in_text_end);
         if (c == 0)
             break;
         *buf_out++ = (ImWchar)c;
@@ -2045,8 +2177,15 @@ int ImTextCountCharsFromUtf8(const char* in_text, const char* in_text_end)
     int char_count = 0;
     while ((!in_text_end || in_text < in_text_end) && *in_text)
     {
+        if (in_text_end && (signed char)*in_text > 0)
+        {
+            const int n = ImTextCountAsciiChars(in_text, in_text_end);
+            char_count += n;
+            in_text += n;
+            continue;
+        }
         unsigned int c;
-        in_text += ImTextCharFromUtf8(&c, in_text, in_text_end);
+        in_text += in_text_end ? ImTextCharFromUtf8Multibyte(&c, in_text, in_text_end) : ImTextCharFromUtf8(&c, in_text, in_text_end);
         if (c == 0)
             break;
         char_count++;
@@ -2376,6 +2515,228 @@ void ImGuiStorage::SetAllInt(int v)
         Data[i].val_i = v;
 }
 
+//-----------------------------------------------------------------------------
+// ImGuiHashStorage
+// Helper: Key->value storage, open addressing with SIMD probing
+//-----------------------------------------------------------------------------
+
+// Return a bit per control byte of the group equal to 'v'.
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+static inline ImU32 ImHashStorageMatchGroup(const ImU8* ctrl, ImU8 v) { return (ImU32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)ctrl), _mm_set1_epi8((char)v))); }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#include <arm_neon.h>
+static inline ImU32 ImHashStorageMatchGroup(const ImU8* ctrl, ImU8 v)
+{
+    static const uint8_t bits[16] = { 1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128 };
+    const uint8x16_t match = vandq_u8(vceqq_u8(vld1q_u8(ctrl), vdupq_n_u8(v)), vld1q_u8(bits));
+    return (ImU32)vaddv_u8(vget_low_u8(match)) | ((ImU32)vaddv_u8(vget_high_u8(match)) << 8);
+}
+#else
+static inline ImU32 ImHashStorageMatchGroup(const ImU8* ctrl, ImU8 v)
+{
+    ImU32 mask = 0;
+    for (int n = 0; n < IM_HASHSTORAGE_GROUP_SIZE; n++)
+        mask |= (ImU32)(ctrl[n] == v) << n;
+    return mask;
+}
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline int ImHashStorageLowestBit(ImU32 mask) { unsigned long n; _BitScanForward(&n, mask); return (int)n; }
+#else
+static inline int ImHashStorageLowestBit(ImU32 mask) { return __builtin_ctz(mask); }
+#endif
+
+// IDs are usually already hashed, but user keys may be sequential indices: mix so that both the group index (high bits) and the 7-bit tag (low bits) are well spread.
+static inline ImU32 ImHashStorageHash(ImGuiID key)
+{
+    ImU32 h = (key ^ (key >> 16)) * 0x45D9F3Bu;
+    return h ^ (h >> 16);
+}
+
+// Probe whole groups in triangular order, which visits every group once since the group count is a power of two.
+// There are no deletions, so the first group with an empty slot ends the probe sequence of a missing key.
+ImGuiStorage::ImGuiStoragePair* ImGuiHashStorage::FindPair(ImGuiID key) const
+{
+    if (Count == 0)
+        return NULL;
+    const ImU32 hash = ImHashStorageHash(key);
+    const ImU8 tag = (ImU8)(hash & 0x7F);
+    const int group_mask = Slots.Size / IM_HASHSTORAGE_GROUP_SIZE - 1;
+    for (int group = (int)(hash >> 7) & group_mask, step = 1; ; group = (group + step++) & group_mask)
+    {
+        const int base = group * IM_HASHSTORAGE_GROUP_SIZE;
+        for (ImU32 match = ImHashStorageMatchGroup(Ctrl.Data + base, tag); match != 0; match &= match - 1)
+        {
+            ImGuiStorage::ImGuiStoragePair* pair = &Slots.Data[base + ImHashStorageLowestBit(match)];
+            if (pair->key == key)
+                return pair;
+        }
+        if (ImHashStorageMatchGroup(Ctrl.Data + base, IM_HASHSTORAGE_CTRL_EMPTY) != 0)
+            return NULL;
+    }
+}
+
+// Grow before probing, so a lookup of an existing key may grow one insertion early, which only matters at the 7/8 load threshold.
+ImGuiStorage::ImGuiStoragePair* ImGuiHashStorage::GetOrAddPair(ImGuiID key, bool* p_added)
+{
+    if ((Count + 1) * 8 > Slots.Size * 7)
+        Rehash(ImMax(Slots.Size * 2, IM_HASHSTORAGE_GROUP_SIZE));
+    const ImU32 hash = ImHashStorageHash(key);
+    const ImU8 tag = (ImU8)(hash & 0x7F);
+    const int group_mask = Slots.Size / IM_HASHSTORAGE_GROUP_SIZE - 1;
+    for (int group = (int)(hash >> 7) & group_mask, step = 1; ; group = (group + step++) & group_mask)
+    {
+        const int base = group * IM_HASHSTORAGE_GROUP_SIZE;
+        for (ImU32 match = ImHashStorageMatchGroup(Ctrl.Data + base, tag); match != 0; match &= match - 1)
+        {
+            ImGuiStorage::ImGuiStoragePair* pair = &Slots.Data[base + ImHashStorageLowestBit(match)];
+            if (pair->key == key)
+            {
+                *p_added = false;
+                return pair;
+            }
+        }
+        if (ImU32 empty = ImHashStorageMatchGroup(Ctrl.Data + base, IM_HASHSTORAGE_CTRL_EMPTY))
+        {
+            const int slot = base + ImHashStorageLowestBit(empty);
+            Ctrl.Data[slot] = tag;
+            Slots.Data[slot].key = key;
+            Count++;
+            *p_added = true;
+            return &Slots.Data[slot];
+        }
+    }
+}
+
+void ImGuiHashStorage::Rehash(int slot_count)
+{
+    IM_ASSERT(slot_count >= IM_HASHSTORAGE_GROUP_SIZE && ImIsPowerOfTwo(slot_count) && Count * 8 <= slot_count * 7);
+    ImVector<ImU8> old_ctrl;
+    ImVector<ImGuiStorage::ImGuiStoragePair> old_slots;
+    old_ctrl.swap(Ctrl);
+    old_slots.swap(Slots);
+    Ctrl.reserve(slot_count);
+    Ctrl.resize(slot_count);
+    memset(Ctrl.Data, IM_HASHSTORAGE_CTRL_EMPTY, (size_t)slot_count);
+    Slots.reserve(slot_count);
+    Slots.resize(slot_count);
+    Count = 0;
+    for (int n = 0; n < old_ctrl.Size; n++)
+        if (!(old_ctrl.Data[n] & IM_HASHSTORAGE_CTRL_EMPTY))
+        {
+            bool added;
+            *GetOrAddPair(old_slots.Data[n].key, &added) = old_slots.Data[n];
+        }
+}
+
+void ImGuiHashStorage::Reserve(int count)
+{
+    int slot_count = IM_HASHSTORAGE_GROUP_SIZE;
+    while (slot_count * 7 < count * 8)
+        slot_count *= 2;
+    if (slot_count > Slots.Size)
+        Rehash(slot_count);
+}
+
+int ImGuiHashStorage::GetInt(ImGuiID key, int default_val) const
+{
+    ImGuiStorage::ImGuiStoragePair* pair = FindPair(key);
+    return pair ? pair->val_i : default_val;
+}
+
+bool ImGuiHashStorage::GetBool(ImGuiID key, bool default_val) const
+{
+    return GetInt(key, default_val ? 1 : 0) != 0;
+}
+
+float ImGuiHashStorage::GetFloat(ImGuiID key, float default_val) const
+{
+    ImGuiStorage::ImGuiStoragePair* pair = FindPair(key);
+    return pair ? pair->val_f : default_val;
+}
+
+void* ImGuiHashStorage::GetVoidPtr(ImGuiID key) const
+{
+    ImGuiStorage::ImGuiStoragePair* pair = FindPair(key);
+    return pair ? pair->val_p : NULL;
+}
+
+// References are only valid until a new value is added to the storage. Calling a Set***() function or a Get***Ref() function invalidates the pointer.
+int* ImGuiHashStorage::GetIntRef(ImGuiID key, int default_val)
+{
+    bool added;
+    ImGuiStorage::ImGuiStoragePair* pair = GetOrAddPair(key, &added);
+    if (added)
+        pair->val_i = default_val;
+    return &pair->val_i;
+}
+
+bool* ImGuiHashStorage::GetBoolRef(ImGuiID key, bool default_val)
+{
+    return (bool*)GetIntRef(key, default_val ? 1 : 0);
+}
+
+float* ImGuiHashStorage::GetFloatRef(ImGuiID key, float default_val)
+{
+    bool added;
+    ImGuiStorage::ImGuiStoragePair* pair = GetOrAddPair(key, &added);
+    if (added)
+        pair->val_f = default_val;
+    return &pair->val_f;
+}
+
+void** ImGuiHashStorage::GetVoidPtrRef(ImGuiID key, void* default_val)
+{
+    bool added;
+    ImGuiStorage::ImGuiStoragePair* pair = GetOrAddPair(key, &added);
+    if (added)
+        pair->val_p = default_val;
+    return &pair->val_p;
+}
+
+void ImGuiHashStorage::SetInt(ImGuiID key, int val)
+{
+    bool added;
+    GetOrAddPair(key, &added)->val_i = val;
+}
+
+void ImGuiHashStorage::SetBool(ImGuiID key, bool val)
+{
+    SetInt(key, val ? 1 : 0);
+}
+
+void ImGuiHashStorage::SetFloat(ImGuiID key, float val)
+{
+    bool added;
+    GetOrAddPair(key, &added)->val_f = val;
+}
+
+void ImGuiHashStorage::SetVoidPtr(ImGuiID key, void* val)
+{
+    bool added;
+    GetOrAddPair(key, &added)->val_p = val;
+}
+
+void ImGuiHashStorage::SetAllInt(int v)
+{
+    for (int n = 0; n < Slots.Size; n++)
+        if (!(Ctrl.Data[n] & IM_HASHSTORAGE_CTRL_EMPTY))
+            Slots.Data[n].val_i = v;
+}
+
+// Ordered iteration: slots are in hash order, so gather the used pairs and sort them once.
+void ImGuiHashStorage::BuildSortedStorage(ImGuiStorage* out) const
+{
+    out->Data.resize(0);
+    out->Data.reserve(Count);
+    for (int n = 0; n < Slots.Size; n++)
+        if (!(Ctrl.Data[n] & IM_HASHSTORAGE_CTRL_EMPTY))
+            out->Data.push_back(Slots.Data[n]);
+    out->BuildSortByKey();
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImGuiTextFilter
 //-----------------------------------------------------------------------------
@@ -3513,7 +3874,6 @@ void ImGui::Shutdown()
         IM_DELETE(g.IO.Fonts);
     }
     g.IO.Fonts = NULL;
-    g.DrawListSharedData.TempBuffer.clear();
 
     // Cleanup of other data are conditional on actually having initialized Dear ImGui.
     if (!g.Initialized)
@@ -3560,6 +3920,7 @@ void ImGui::Shutdown()
     g.ClipboardHandlerData.clear();
     g.MenusIdSubmittedThisFrame.clear();
     g.InputTextState.ClearFreeMemory();
+    g.TextLayoutCache.Clear();
 
     g.SettingsWindows.clear();
     g.SettingsHandlers.clear();
@@ -3708,10 +4069,16 @@ void ImGui::GcCompactTransientMiscBuffers()
 void ImGui::GcCompactTransientWindowBuffers(ImGuiWindow* window)
 {
     window->MemoryCompacted = true;
-    window->MemoryDrawListIdxCapacity = window->DrawList->IdxBuffer.Capacity;
-    window->MemoryDrawListVtxCapacity = window->DrawList->VtxBuffer.Capacity;
     window->IDStack.clear();
-    window->DrawList->_ClearFreeMemory();
+    // With io.ConfigDrawListRetainBuffers the draw list keeps its buffers for when the window reappears, and is only
+    // shrunk by GcRetainDrawListBuffers(). Unless everything is being compacted.
+    ImGuiContext& g = *GImGui;
+    if (!g.IO.ConfigDrawListRetainBuffers || g.GcCompactAll)
+    {
+        window->MemoryDrawListIdxCapacity = window->DrawList->IdxBuffer.Capacity;
+        window->MemoryDrawListVtxCapacity = window->DrawList->VtxBuffer.Capacity;
+        window->DrawList->_ClearFreeMemory();
+    }
     window->DC.ChildWindows.clear();
     window->DC.ItemWidthStack.clear();
     window->DC.TextWrapPosStack.clear();
@@ -3727,6 +4094,76 @@ void ImGui::GcAwakeTransientWindowBuffers(ImGuiWindow* window)
     window->MemoryDrawListIdxCapacity = window->MemoryDrawListVtxCapacity = 0;
 }
 
+// Shrink a buffer to its high-water mark plus 25% headroom, if its capacity is more than 'ratio' times the mark.
+// The contents are discarded: only called right before the list is reset.
+template<typename T>
+static void GcShrinkDrawListBuffer(ImVector<T>& buffer, int high_water, float ratio)
+{
+    const int new_capacity = ImMax(high_water + high_water / 4, 64);
+    if (buffer.Capacity <= new_capacity || (float)buffer.Capacity <= (float)high_water * ratio)
+        return;
+    buffer.clear();
+    buffer.reserve(new_capacity);
+}
+
+// High-water mark retention with hysteresis: buffers only grow during a period of io.ConfigDrawListShrinkDelay seconds,
+// and at the end of it are only shrunk if they are more than io.ConfigDrawListShrinkRatio times larger than the most the
+// period needed. So a window that reappears, or content that spikes now and then, finds its buffers at the size it needs
+// instead of regrowing them, and memory still follows the load over the long run.
+// The sizes seen here are those the list ended its last frame with. For a window that was hidden they are from the last
+// frame it was visible, which is what it will likely need again.
+void ImGui::GcRetainDrawListBuffers(ImDrawList* draw_list)
+{
+    ImGuiContext& g = *GImGui;
+    draw_list->_CmdHighWater = ImMax(draw_list->_CmdHighWater, draw_list->CmdBuffer.Size);
+    draw_list->_IdxHighWater = ImMax(draw_list->_IdxHighWater, draw_list->IdxBuffer.Size);
+    draw_list->_VtxHighWater = ImMax(draw_list->_VtxHighWater, draw_list->VtxBuffer.Size);
+    if (g.IO.ConfigDrawListShrinkDelay < 0.0f || (float)g.Time - draw_list->_HighWaterTime < g.IO.ConfigDrawListShrinkDelay)
+        return;
+
+    if (g.IO.ConfigDrawListRetainBuffers)
+    {
+        const float ratio = ImMax(g.IO.ConfigDrawListShrinkRatio, 1.25f);
+        GcShrinkDrawListBuffer(draw_list->CmdBuffer, draw_list->_CmdHighWater, ratio);
+        GcShrinkDrawListBuffer(draw_list->IdxBuffer, draw_list->_IdxHighWater, ratio);
+        GcShrinkDrawListBuffer(draw_list->VtxBuffer, draw_list->_VtxHighWater, ratio);
+    }
+    draw_list->_CmdHighWater = draw_list->_IdxHighWater = draw_list->_VtxHighWater = 0;
+    draw_list->_HighWaterTime = (float)g.Time;
+}
+
+static void AddDrawListMemoryInfo(ImVector<ImDrawListMemoryInfo>* out_stats, const ImDrawList* draw_list, const char* name)
+{
+    ImDrawListMemoryInfo info;
+    info.Name = name;
+    info.CmdSize = draw_list->CmdBuffer.Size;
+    info.CmdCapacity = draw_list->CmdBuffer.Capacity;
+    info.CmdHighWater = ImMax(draw_list->_CmdHighWater, info.CmdSize);
+    info.IdxSize = draw_list->IdxBuffer.Size;
+    info.IdxCapacity = draw_list->IdxBuffer.Capacity;
+    info.IdxHighWater = ImMax(draw_list->_IdxHighWater, info.IdxSize);
+    info.VtxSize = draw_list->VtxBuffer.Size;
+    info.VtxCapacity = draw_list->VtxBuffer.Capacity;
+    info.VtxHighWater = ImMax(draw_list->_VtxHighWater, info.VtxSize);
+    info.CapacityBytes = (size_t)info.CmdCapacity * sizeof(ImDrawCmd) + (size_t)info.IdxCapacity * sizeof(ImDrawIdx) + (size_t)info.VtxCapacity * sizeof(ImDrawVert);
+    info.UsedBytes = (size_t)info.CmdSize * sizeof(ImDrawCmd) + (size_t)info.IdxSize * sizeof(ImDrawIdx) + (size_t)info.VtxSize * sizeof(ImDrawVert);
+    info.ReallocCount = draw_list->_ReallocCount;
+    out_stats->push_back(info);
+}
+
+// Includes hidden windows, whose buffers are kept with io.ConfigDrawListRetainBuffers
+void ImGui::GetDrawListMemoryStats(ImVector<ImDrawListMemoryInfo>* out_stats)
+{
+    ImGuiContext& g = *GImGui;
+    out_stats->resize(0);
+    for (int i = 0; i < g.Windows.Size; i++)
+        AddDrawListMemoryInfo(out_stats, g.Windows[i]->DrawList, g.Windows[i]->Name);
+    for (int i = 0; i < g.Viewports.Size; i++)
+        for (int n = 0; n < IM_ARRAYSIZE(g.Viewports[i]->DrawLists); n++)
+            if (ImDrawList* draw_list = g.Viewports[i]->DrawLists[n])
+                AddDrawListMemoryInfo(out_stats, draw_list, draw_list->_OwnerName);
+}
+
 void ImGui::SetActiveID(ImGuiID id, ImGuiWindow* window)
 {
     ImGuiContext& g = *GImGui;
@@ -4020,11 +4457,22 @@ float ImGui::CalcWrapWidthForPos(const ImVec2& pos, float wrap_pos_x)
     return ImMax(wrap_pos_x - pos.x, 1.0f);
 }
 
+// io.MetricsActiveAllocations is updated from every thread that allocates: draw lists built in parallel and font atlas
+// build jobs (ImFontAtlasBuildWithStbTruetypeEx) go through MemAlloc()/MemFree() too.
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+static inline void ImAtomicAddInt(int* p, int v) { _InterlockedExchangeAdd((volatile long*)p, (long)v); }
+static inline int ImAtomicLoadInt(const int* p) { return (int)_InterlockedOr((volatile long*)p, 0); }
+#else
+static inline void ImAtomicAddInt(int* p, int v) { __atomic_fetch_add(p, v, __ATOMIC_RELAXED); }
+static inline int ImAtomicLoadInt(const int* p) { return __atomic_load_n(p, __ATOMIC_RELAXED); }
+#endif
+
 // IM_ALLOC() == ImGui::MemAlloc()
 void* ImGui::MemAlloc(size_t size)
 {
     if (ImGuiContext* ctx = GImGui)
-        ctx->IO.MetricsActiveAllocations++;
+        ImAtomicAddInt(&ctx->IO.MetricsActiveAllocations, 1);
     return (*GImAllocatorAllocFunc)(size, GImAllocatorUserData);
 }
 
@@ -4033,7 +4481,7 @@ void ImGui::MemFree(void* ptr)
 {
     if (ptr)
         if (ImGuiContext* ctx = GImGui)
-            ctx->IO.MetricsActiveAllocations--;
+            ImAtomicAddInt(&ctx->IO.MetricsActiveAllocations, -1);
     return (*GImAllocatorFreeFunc)(ptr, GImAllocatorUserData);
 }
 
@@ -4095,6 +4543,7 @@ static ImDrawList* GetViewportDrawList(ImGuiViewportP* viewport, size_t drawlist
     // Our ImDrawList system requires that there is always a command
     if (viewport->DrawListsLastFrame[drawlist_no] != g.FrameCount)
     {
+        ImGui::GcRetainDrawListBuffers(draw_list);
         draw_list->_ResetForNewFrame();
         draw_list->PushTextureID(g.IO.Fonts->TexID);
         draw_list->PushClipRect(viewport->Pos, viewport->Pos + viewport->Size, false);
@@ -4373,12 +4822,17 @@ void ImGui::NewFrame()
     g.DrawListSharedData.InitialFlags = ImDrawListFlags_None;
     if (g.Style.AntiAliasedLines)
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedLines;
-    if (g.Style.AntiAliasedLinesUseTex && !(g.Font->ContainerAtlas->Flags & ImFontAtlasFlags_NoBakedLines))
+    if (g.Style.AntiAliasedLinesUseTex && !(g.Font->ContainerAtlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_DistanceField)))
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedLinesUseTex;
     if (g.Style.AntiAliasedFill)
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedFill;
     if (g.IO.BackendFlags & ImGuiBackendFlags_RendererHasVtxOffset)
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AllowVtxOffset;
+    g.DrawListSharedData.TextLayoutCache = g.IO.ConfigTextLayoutCache ? &g.TextLayoutCache : NULL;
+    if (g.IO.ConfigTextLayoutCache)
+        g.TextLayoutCache.NewFrame(g.FrameCount);
+    else if (g.TextLayoutCache.Layouts.Size > 0)
+        g.TextLayoutCache.Clear();
 
     // Mark rendering data as invalid to prevent user who may have a handle on it to use it.
     for (int n = 0; n < g.Viewports.Size; n++)
@@ -4532,8 +4986,8 @@ void ImGui::NewFrame()
         window->BeginCountPreviousFrame = window->BeginCount;
         window->BeginCount = 0;
 
-        // Garbage collect transient buffers of recently unused windows
-        if (!window->WasActive && !window->MemoryCompacted && window->LastTimeActive < memory_compact_start_time)
+        // Garbage collect transient buffers of recently unused windows (again when compacting all, for draw lists retained by io.ConfigDrawListRetainBuffers)
+        if (!window->WasActive && ((!window->MemoryCompacted && window->LastTimeActive < memory_compact_start_time) || (window->MemoryCompacted && g.GcCompactAll && g.IO.ConfigDrawListRetainBuffers)))
             GcCompactTransientWindowBuffers(window);
     }
 
@@ -4969,7 +5423,23 @@ ImVec2 ImGui::CalcTextSize(const char* text, const char* text_end, bool hide_tex
     const float font_size = g.FontSize;
     if (text == text_display_end)
         return ImVec2(0.0f, font_size);
-    ImVec2 text_size = font->CalcTextSizeA(font_size, FLT_MAX, wrap_width, text, text_display_end, NULL);
+    ImVec2 text_size;
+    ImTextLayout* layout = g.DrawListSharedData.TextLayoutCache ? g.DrawListSharedData.TextLayoutCache->GetLayout(font, font_size, wrap_width, text, text_display_end) : NULL;
+    if (layout && layout->HasTextSize)
+    {
+        text_size = layout->TextSize;
+        g.TextLayoutCache.Stats.MeasureHits++;
+    }
+    else
+    {
+        text_size = font->CalcTextSizeA(font_size, FLT_MAX, wrap_width, text, text_display_end, NULL);
+        if (layout)
+        {
+            layout->TextSize = text_size;
+            layout->HasTextSize = true;
+            g.TextLayoutCache.Stats.MeasureMisses++;
+        }
+    }
 
     // Round
     // FIXME: This has been here since Dec 2015 (7b0bf230) but down the line we want this out.
@@ -6147,6 +6617,7 @@ bool ImGui::Begin(const char* name, bool* p_open, ImGuiWindowFlags flags)
         window->HasCloseButton = (p_open != NULL);
         window->ClipRect = ImVec4(-FLT_MAX, -FLT_MAX, +FLT_MAX, +FLT_MAX);
         window->IDStack.resize(1);
+        GcRetainDrawListBuffers(window->DrawList);
         window->DrawList->_ResetForNewFrame();
         window->DC.CurrentTableIdx = -1;
 
@@ -13191,7 +13662,7 @@ void ImGui::ShowMetricsWindow(bool* p_open)
     Text("Dear ImGui %s", GetVersion());
     Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
     Text("%d vertices, %d indices (%d triangles)", io.MetricsRenderVertices, io.MetricsRenderIndices, io.MetricsRenderIndices / 3);
-    Text("%d visible windows, %d active allocations", io.MetricsRenderWindows, io.MetricsActiveAllocations);
+    Text("%d visible windows, %d active allocations", io.MetricsRenderWindows, ImAtomicLoadInt(&io.MetricsActiveAllocations));
     //SameLine(); if (SmallButton("GC")) { g.GcCompactAll = true; }
 
     Separator();
@@ -133,9 +133,11 @@ Index of this file:
 struct ImDrawChannel;               // Temporary storage to output draw commands out of order, used by ImDrawListSplitter and ImDrawList::ChannelsSplit()
 struct ImDrawCmd;                   // A single draw command within a parent ImDrawList (generally maps to 1 GPU draw call, unless it is a callback)
 struct ImDrawData;                  // All draw command lists required to render the frame + pos/size coordinates to use for the projection matrix.
+struct ImDrawIdxPacking;            // Layout of a frame's indices uploaded as 16-bit or 32-bit per draw list (see ImDrawData::PlanIndexUpload())
 struct ImDrawList;                  // A single draw command list (generally one per window, conceptually you may see this as a dynamic "mesh" builder)
 struct ImDrawListSharedData;        // Data shared among multiple draw lists (typically owned by parent ImGui context, but you may create one yourself)
 struct ImDrawListSplitter;          // Helper to split a draw list into different layers which can be drawn into out of order, then flattened back.
+struct ImDrawSubmission;            // A frame's draw calls with adjacent compatible commands merged, for backends to submit (see ImDrawSubmission::Build())
 struct ImDrawVert;                  // A single vertex (pos + uv + col = 20 bytes by default. Override layout with IMGUI_OVERRIDE_DRAWVERT_STRUCT_LAYOUT)
 struct ImFont;                      // Runtime data for a single font within a parent ImFontAtlas
 struct ImFontAtlas;                 // Runtime data for multiple fonts, bake multiple fonts into a single texture, TTF/OTF font loader
@@ -1974,6 +1976,10 @@ struct ImGuiIO
     bool        ConfigWindowsResizeFromEdges;   // = true           // Enable resizing of windows from their edges and from the lower-left corner. This requires (io.BackendFlags & ImGuiBackendFlags_HasMouseCursors) because it needs mouse cursor feedback. (This used to be a per-window ImGuiWindowFlags_ResizeFromAnySide flag)
     bool        ConfigWindowsMoveFromTitleBarOnly; // = false       // Enable allowing to move windows only when clicking on their title bar. Does not apply to windows without a title bar.
     float       ConfigMemoryCompactTimer;       // = 60.0f          // Timer (in seconds) to free transient windows/tables memory buffers when unused. Set to -1.0f to disable.
+    bool        ConfigTextLayoutCache;          // = false          // Keep the size and glyphs of text drawn again in later frames, so CalcTextSize() and text rendering skip decoding and glyph lookups (see ImTextLayoutCache in imgui_internal.h).
+    bool        ConfigDrawListRetainBuffers;    // = false          // Keep draw list buffers at their high-water mark instead of freeing them with inactive windows (io.ConfigMemoryCompactTimer), so windows that reappear don't regrow them. Only buffers far larger than recently needed are shrunk, see below. Stats: ImGui::GetDrawListMemoryStats().
+    float       ConfigDrawListShrinkRatio;      // = 2.0f           // With ConfigDrawListRetainBuffers: a buffer is shrunk when its capacity is more than this many times its high-water mark. Must be > 1.25f (the headroom kept when shrinking) for hysteresis.
+    float       ConfigDrawListShrinkDelay;      // = 60.0f          // With ConfigDrawListRetainBuffers: length (in seconds) of the period over which high-water marks are taken. Buffers are only shrunk at the end of a period. Set to -1.0f to never shrink.
 
     //------------------------------------------------------------------
     // Platform Functions
@@ -2040,7 +2046,7 @@ struct ImGuiIO
     int         MetricsRenderIndices;               // Indices output during last call to Render() = number of triangles * 3
     int         MetricsRenderWindows;               // Number of visible windows
     int         MetricsActiveWindows;               // Number of active windows
-    int         MetricsActiveAllocations;           // Number of active allocations, updated by MemAlloc/MemFree based on current context. May be off if you have multiple imgui contexts.
+    int         MetricsActiveAllocations;           // Number of active allocations, updated atomically by MemAlloc/MemFree based on current context (they may be called from other threads). May be off if you have multiple imgui contexts.
     ImVec2      MouseDelta;                         // Mouse delta. Note that this is zero if either current or previous position are invalid (-FLT_MAX,-FLT_MAX), so a disappearing/reappearing mouse won't have a huge delta.
 
     // Legacy: before 1.87, we required backend to fill io.KeyMap[] (imgui->native map) during initialization and io.KeysDown[] (native indices) every frame.
@@ -2555,9 +2561,15 @@ struct ImDrawList
     ImVector<ImVec4>        _ClipRectStack;     // [Internal]
     ImVector<ImTextureID>   _TextureIdStack;    // [Internal]
     ImVector<ImVec2>        _Path;              // [Internal] current path building
+    ImVector<ImVec2>        _TempBuffer;        // [Internal] scratch for AddPolyline()/AddConvexPolyFilled(), per list so lists sharing an ImDrawListSharedData can be built on different threads
     ImDrawCmdHeader         _CmdHeader;         // [Internal] template of active commands. Fields should match those of CmdBuffer.back().
     ImDrawListSplitter      _Splitter;          // [Internal] for channels api (note: prefer using your own persistent instance of ImDrawListSplitter!)
     float                   _FringeScale;       // [Internal] anti-alias fringe is scaled by this value, this helps to keep things sharp while zooming at vertex buffer content
+    int                     _ReallocCount;      // [Internal] number of times CmdBuffer/IdxBuffer/VtxBuffer had to grow, see ImGui::GetDrawListMemoryStats()
+    int                     _CmdHighWater;      // [Internal] largest CmdBuffer/IdxBuffer/VtxBuffer sizes a frame ended with in the current retention period (io.ConfigDrawListShrinkDelay)
+    int                     _IdxHighWater;      // [Internal]
+    int                     _VtxHighWater;      // [Internal]
+    float                   _HighWaterTime;     // [Internal] time the current retention period started
 
     // If you want to create ImDrawList instances, pass them ImGui::GetDrawListSharedData() or create and use your own ImDrawListSharedData (so you can use ImDrawList without ImGui)
     ImDrawList(ImDrawListSharedData* shared_data) { memset(this, 0, sizeof(*this)); _Data = shared_data; }
@@ -2682,6 +2694,75 @@ struct ImDrawData
     void Clear()    { memset(this, 0, sizeof(*this)); }     // The ImDrawList are owned by ImGuiContext!
     IMGUI_API void  DeIndexAllBuffers();                    // Helper to convert all buffers from indexed to non-indexed, in case you cannot render indexed. Note: this is slow and most likely a waste of resources. Always prefer indexed rendering!
     IMGUI_API void  ScaleClipRects(const ImVec2& fb_scale); // Helper to scale the ClipRect field of each ImDrawCmd. Use if your final output buffer is at a different scale than Dear ImGui expects, or if there is a difference between your window resolution and framebuffer resolution.
+    IMGUI_API void  PlanIndexUpload(ImDrawIdxPacking* out_packing, bool batch_lists = false) const; // Helper for backends that can bind both 16-bit and 32-bit index buffers: pick a format per draw list, see ImDrawIdxPacking.
+    IMGUI_API void  PackIndices(const ImDrawIdxPacking& packing, void* dst) const;  // Write all indices as planned by PlanIndexUpload(), to packing.TotalBytes at dst (4-byte aligned).
+};
+
+// Index upload with a format per draw list, whichever is the narrowest that addresses all of the list's vertices:
+// - Lists of up to 64K vertices are uploaded as 16-bit indices (halved from a 32-bit ImDrawIdx).
+// - Larger lists are uploaded as 32-bit indices, so all their commands draw from the list's first vertex. The commands
+//   a 16-bit ImDrawIdx list was split into at each 64K vertices can then be merged into one draw call (see ImDrawSubmission).
+// Each command's VtxOffset is folded into its indices, which count from ListVtxBase[], the list's first vertex in the
+// vertex buffer of all lists one after the other. With 'batch_lists', consecutive 16-bit lists that fit in 64K vertices
+// together share the first one's base vertex, so a backend can draw commands of different lists in one call (see ImDrawSubmission).
+// The 16-bit indices come first, the 32-bit ones start at Idx32ByteOffset. ListIdxOffset[] counts indices of the list's
+// format from the start of its part, so a backend binds the part's index buffer view and adds it to ImDrawCmd::IdxOffset.
+struct ImDrawIdxPacking
+{
+    ImVector<int>   ListIdxOffset;          // Per draw_data->CmdLists[]: first index of the list within its part
+    ImVector<int>   ListVtxBase;            // Per draw_data->CmdLists[]: base vertex its indices count from
+    ImVector<bool>  ListIdx32;              // Per draw_data->CmdLists[]: the list is uploaded as 32-bit indices
+    int             Idx16Count;             // Number of 16-bit indices, at offset 0
+    int             Idx32Count;             // Number of 32-bit indices, at Idx32ByteOffset
+    size_t          Idx32ByteOffset;
+    size_t          TotalBytes;
+
+    ImDrawIdxPacking()  { Idx16Count = Idx32Count = 0; Idx32ByteOffset = TotalBytes = 0; }
+};
+
+// One draw call (or callback) of an ImDrawSubmission
+struct ImDrawSubmitCmd
+{
+    int                 ClipRect[4];        // Scissor rect in framebuffer pixels (x1, y1, x2, y2): (ImDrawCmd::ClipRect - DisplayPos) * FramebufferScale, clamped to the display. Never empty.
+    ImTextureID         TextureId;
+    unsigned int        IdxOffset;          // First index, counted in the draw's format from the start of that part of the packed indices (see ImDrawIdxPacking)
+    unsigned int        ElemCount;          // Number of indices, 0 for callbacks
+    int                 VtxOffset;          // Base vertex, in the vertex buffer of all lists one after the other
+    bool                Idx32;              // Indices are 32-bit
+    int                 CmdCount;           // Number of ImDrawCmd drawn by this call
+    const ImDrawList*   CmdList;            // First of them and its list. For callbacks: call Cmd->UserCallback(CmdList, Cmd) unless it is ImDrawCallback_ResetRenderState
+    const ImDrawCmd*    Cmd;
+};
+
+// Draw calls and render state changes of the last ImDrawSubmission::Build()
+struct ImDrawSubmissionStats
+{
+    int     Cmds;                           // ImDrawCmd in the draw data, callbacks included
+    int     Draws;                          // Draw calls left
+    int     Callbacks;
+    int     Culled;                         // Commands without elements, or clipped out of the display
+    int     MergedAcrossLists;              // Draw calls with commands of more than one draw list
+    int     ScissorChanges;                 // Render state a backend has to set, skipping what the previous draw already set.
+    int     TextureChanges;                 // Callbacks are assumed to change everything.
+    int     IndexFormatChanges;
+
+    ImDrawSubmissionStats() { memset(this, 0, sizeof(*this)); }
+};
+
+// A frame's draw calls, worked out from ImDrawData alone so backends only walk Cmds and set the state that changes.
+// With 'merge_cmds', consecutive commands are drawn in one call when they use the same texture, the same scissor rect and
+// their packed indices are contiguous from the same base vertex (lists are batched, see ImDrawIdxPacking). With
+// 'merge_by_bounds', scissor rects that don't tell commands apart are merged too: a command whose vertices all lie inside
+// both its own rect and the call's is clipped by neither. This walks the indices of those commands, which mostly costs
+// more CPU time than the draw calls it saves. Commands are never reordered, as imgui's draws blend in submission order.
+struct ImDrawSubmission
+{
+    ImDrawIdxPacking            Packing;    // Indices to upload with ImDrawData::PackIndices()
+    ImVector<ImDrawSubmitCmd>   Cmds;
+    ImDrawSubmissionStats       Stats;
+    ImVector<ImVec4>            _CmdBounds; // [Internal] Per command: bounding box of its vertices in framebuffer pixels, computed when needed
+
+    IMGUI_API void  Build(const ImDrawData* draw_data, bool merge_cmds = true, bool merge_by_bounds = false);
 };
 
 //-----------------------------------------------------------------------------
@@ -2763,8 +2844,12 @@ enum ImFontAtlasFlags_
     ImFontAtlasFlags_NoPowerOfTwoHeight = 1 << 0,   // Don't round the height to next power of two
     ImFontAtlasFlags_NoMouseCursors     = 1 << 1,   // Don't build software mouse cursors into the atlas (save a little texture memory)
     ImFontAtlasFlags_NoBakedLines       = 1 << 2,   // Don't build thick line textures into the atlas (save a little texture memory, allow support for point/nearest filtering). The AntiAliasedLinesUseTex features uses them, otherwise they will be rendered using polygons (more expensive for CPU/GPU).
+    ImFontAtlasFlags_DistanceField      = 1 << 3,   // Build glyphs as signed distance fields (see TexDistanceFieldSpread), so a font can be drawn at any size/scale from one bake. The renderer must threshold the atlas alpha at IM_FONT_DISTANCE_FIELD_ON_EDGE. Implies NoBakedLines, ignores OversampleH/V and RasterizerMultiply.
 };
 
+// Value of a distance field glyph on its outline, higher inside. Renderers draw alpha = saturate((a - ON_EDGE/255) / fwidth(a) + 0.5).
+#define IM_FONT_DISTANCE_FIELD_ON_EDGE  128
+
 // Load and rasterize multiple TTF/OTF fonts into a same texture. The font atlas will build a single texture holding:
 //  - One or more fonts.
 //  - Custom graphics data needed to render the shapes needed by Dear ImGui.
@@ -2852,6 +2937,7 @@ struct ImFontAtlas
     ImTextureID                 TexID;              // User data to refer to the texture once it has been uploaded to user's graphic systems. It is passed back to you during rendering via the ImDrawCmd structure.
     int                         TexDesiredWidth;    // Texture width desired by user before Build(). Must be a power-of-two. If have many glyphs your graphics API have texture size restrictions you may want to increase texture width to decrease height.
     int                         TexGlyphPadding;    // Padding between glyphs within texture in pixels. Defaults to 1. If your rendering method doesn't rely on bilinear filtering you may set this to 0 (will also need to set AntiAliasedLinesUseTex = false).
+    int                         TexDistanceFieldSpread; // With ImFontAtlasFlags_DistanceField: pixels (at the font size) around each outline covered by its distance field. Defaults to 4. Larger spreads keep more precision when drawing much smaller than the bake size.
     bool                        Locked;             // Marked as Locked by ImGui::NewFrame() so attempt to modify the atlas will assert.
     void*                       UserData;           // Store your own atlas related user-data (if e.g. you have multiple font atlas).
 
@@ -2883,6 +2969,10 @@ struct ImFontAtlas
     //typedef ImFontGlyphRangesBuilder GlyphRangesBuilder; // OBSOLETED in 1.67+
 };
 
+// Callback for glyphs loaded on demand (e.g. by a glyph cache rasterizing into reserved atlas space), see ImFont::GlyphLoadFunc.
+// Return the glyph after making it reachable through IndexLookup/IndexAdvanceX, or NULL if there is none (the fallback glyph is used).
+typedef const ImFontGlyph* (*ImFontGlyphLoadFunc)(ImFont* font, ImWchar c, void* user_data);
+
 // Font runtime data and rendering
 // ImFontAtlas automatically loads a default embedded font for you when you call GetTexDataAsAlpha8() or GetTexDataAsRGBA32().
 struct ImFont
@@ -2909,13 +2999,15 @@ struct ImFont
     float                       Ascent, Descent;    // 4+4   // out //            // Ascent: distance from top to bottom of e.g. 'A' [0..FontSize]
     int                         MetricsTotalSurface;// 4     // out //            // Total surface in pixels to get an idea of the font rasterization/texture cost (not exact, we approximate the cost of padding between glyphs)
     ImU8                        Used4kPagesMap[(IM_UNICODE_CODEPOINT_MAX+1)/4096/8]; // 2 bytes if ImWchar=ImWchar16, 34 bytes if ImWchar==ImWchar32. Store 1-bit for each block of 4K codepoints that has one active glyph. This is mainly used to facilitate iterations across all used codepoints.
+    ImFontGlyphLoadFunc         GlyphLoadFunc;      // 4-8   // in  // = NULL     // Called by FindGlyph()/FindGlyphNoFallback()/GetCharAdvance() for codepoints without a glyph. A negative IndexAdvanceX entry means "not loaded yet".
+    void*                       GlyphLoadUserData;  // 4-8   // in  // = NULL
 
     // Methods
     IMGUI_API ImFont();
     IMGUI_API ~ImFont();
-    IMGUI_API const ImFontGlyph*FindGlyph(ImWchar c) const;
+    const ImFontGlyph*          FindGlyph(ImWchar c) const          { ImWchar i = ((int)c < IndexLookup.Size) ? IndexLookup.Data[(int)c] : (ImWchar)-1; return (i != (ImWchar)-1) ? &Glyphs.Data[i] : FindGlyphSlow(c); }
     IMGUI_API const ImFontGlyph*FindGlyphNoFallback(ImWchar c) const;
-    float                       GetCharAdvance(ImWchar c) const     { return ((int)c < IndexAdvanceX.Size) ? IndexAdvanceX[(int)c] : FallbackAdvanceX; }
+    float                       GetCharAdvance(ImWchar c) const     { float advance_x = ((int)c < IndexAdvanceX.Size) ? IndexAdvanceX.Data[(int)c] : -1.0f; return (advance_x >= 0.0f) ? advance_x : GetCharAdvanceSlow(c); }
     bool                        IsLoaded() const                    { return ContainerAtlas != NULL; }
     const char*                 GetDebugName() const                { return ConfigData ? ConfigData->Name : "<unknown>"; }
 
@@ -2930,6 +3022,8 @@ struct ImFont
     IMGUI_API void              BuildLookupTable();
     IMGUI_API void              ClearOutputData();
     IMGUI_API void              GrowIndex(int new_size);
+    IMGUI_API const ImFontGlyph*FindGlyphSlow(ImWchar c) const;
+    IMGUI_API float             GetCharAdvanceSlow(ImWchar c) const;
     IMGUI_API void              AddGlyph(const ImFontConfig* src_cfg, ImWchar c, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, float advance_x);
     IMGUI_API void              AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst = true); // Makes 'dst' character/glyph points to 'src' character/glyph. Currently needs to be called AFTER fonts have been built.
     IMGUI_API void              SetGlyphVisible(ImWchar c, bool visible);
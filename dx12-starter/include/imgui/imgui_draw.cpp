@@ -16,6 +16,7 @@ Index of this file:
 // [SECTION] ImFontAtlas glyph ranges helpers
 // [SECTION] ImFontGlyphRangesBuilder
 // [SECTION] ImFont
+// [SECTION] ImTextLayoutCache
 // [SECTION] ImGui Internal Render Helpers
 // [SECTION] Decompression code
 // [SECTION] Default font data (ProggyClean.ttf)
@@ -365,6 +366,7 @@ ImDrawListSharedData::ImDrawListSharedData()
         ArcFastVtx[i] = ImVec2(ImCos(a), ImSin(a));
     }
     ArcFastRadiusCutoff = IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_CALC_R(IM_DRAWLIST_ARCFAST_SAMPLE_MAX, CircleSegmentMaxError);
+    TessellationSimd = true;
 }
 
 void ImDrawListSharedData::SetCircleTessellationMaxError(float max_error)
@@ -380,6 +382,7 @@ void ImDrawListSharedData::SetCircleTessellationMaxError(float max_error)
         CircleSegmentCounts[i] = (ImU8)((i > 0) ? IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_CALC(radius, CircleSegmentMaxError) : IM_DRAWLIST_ARCFAST_SAMPLE_MAX);
     }
     ArcFastRadiusCutoff = IM_DRAWLIST_CIRCLE_AUTO_SEGMENT_CALC_R(IM_DRAWLIST_ARCFAST_SAMPLE_MAX, CircleSegmentMaxError);
+    TessellationSimd = true;
 }
 
 // Initialize before use in a new frame. We always have a command ready in the buffer.
@@ -402,6 +405,7 @@ void ImDrawList::_ResetForNewFrame()
     _TextureIdStack.resize(0);
     _Path.resize(0);
     _Splitter.Clear();
+    _ReallocCount += (CmdBuffer.Capacity == 0);
     CmdBuffer.push_back(ImDrawCmd());
     _FringeScale = 1.0f;
 }
@@ -418,6 +422,7 @@ void ImDrawList::_ClearFreeMemory()
     _ClipRectStack.clear();
     _TextureIdStack.clear();
     _Path.clear();
+    _TempBuffer.clear();
     _Splitter.ClearFreeMemory();
 }
 
@@ -440,6 +445,7 @@ void ImDrawList::AddDrawCmd()
     draw_cmd.IdxOffset = IdxBuffer.Size;
 
     IM_ASSERT(draw_cmd.ClipRect.x <= draw_cmd.ClipRect.z && draw_cmd.ClipRect.y <= draw_cmd.ClipRect.w);
+    _ReallocCount += (CmdBuffer.Size == CmdBuffer.Capacity);
     CmdBuffer.push_back(draw_cmd);
 }
 
@@ -630,11 +636,13 @@ void ImDrawList::PrimReserve(int idx_count, int vtx_count)
     ImDrawCmd* draw_cmd = &CmdBuffer.Data[CmdBuffer.Size - 1];
     draw_cmd->ElemCount += idx_count;
 
+    // Growths are counted for ImGui::GetDrawListMemoryStats()
     int vtx_buffer_old_size = VtxBuffer.Size;
+    int idx_buffer_old_size = IdxBuffer.Size;
+    _ReallocCount += (vtx_buffer_old_size + vtx_count > VtxBuffer.Capacity) + (idx_buffer_old_size + idx_count > IdxBuffer.Capacity);
     VtxBuffer.resize(vtx_buffer_old_size + vtx_count);
     _VtxWritePtr = VtxBuffer.Data + vtx_buffer_old_size;
 
-    int idx_buffer_old_size = IdxBuffer.Size;
     IdxBuffer.resize(idx_buffer_old_size + idx_count);
     _IdxWritePtr = IdxBuffer.Data + idx_buffer_old_size;
 }
@@ -702,6 +710,275 @@ void ImDrawList::PrimQuadUV(const ImVec2& a, const ImVec2& b, const ImVec2& c, c
 #define IM_FIXNORMAL2F_MAX_INVLEN2          100.0f // 500.0f (see #4053, #3366)
 #define IM_FIXNORMAL2F(VX,VY)               { float d2 = VX*VX + VY*VY; if (d2 > 0.000001f) { float inv_len2 = 1.0f / d2; if (inv_len2 > IM_FIXNORMAL2F_MAX_INVLEN2) inv_len2 = IM_FIXNORMAL2F_MAX_INVLEN2; VX *= inv_len2; VY *= inv_len2; } } (void)0
 
+// SIMD version of the anti-aliased path of AddPolyline(), 4 points per iteration.
+// - Every lane performs the same float operations as the scalar code above, in the same order, so the output is bit identical.
+//   (This assumes the compiler doesn't contract multiply-adds into FMA in only one of the two paths, e.g. keep -ffp-contract=off on ARM.)
+// - SSE2 uses the same rsqrt approximation as ImRsqrt(), NEON (AArch64 only) uses exact sqrt and division like the non-SSE ImRsqrt().
+// - Short lines (most of the UI) stay on the scalar paths, where the setup would cost more than it saves.
+// - Set ImDrawListSharedData::TessellationSimd to false to always use the scalar paths.
+// - AddConvexPolyFilled() has no SIMD path: its fan and fringe are cheap enough that one measured no faster.
+#define IM_DRAWLIST_SIMD_MIN_POINTS         16
+
+#if defined(IMGUI_ENABLE_SSE) && (defined(__SSE2__) || defined(__x86_64__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMGUI_ENABLE_SIMD_TESSELLATION
+typedef __m128  ImSimdF4;
+typedef __m128i ImSimdI4;
+static inline ImSimdF4  ImSimdSet1(float v)                         { return _mm_set1_ps(v); }
+static inline ImSimdF4  ImSimdAdd(ImSimdF4 a, ImSimdF4 b)           { return _mm_add_ps(a, b); }
+static inline ImSimdF4  ImSimdSub(ImSimdF4 a, ImSimdF4 b)           { return _mm_sub_ps(a, b); }
+static inline ImSimdF4  ImSimdMul(ImSimdF4 a, ImSimdF4 b)           { return _mm_mul_ps(a, b); }
+static inline ImSimdF4  ImSimdDiv(ImSimdF4 a, ImSimdF4 b)           { return _mm_div_ps(a, b); }
+static inline ImSimdF4  ImSimdMin(ImSimdF4 a, ImSimdF4 b)           { return _mm_min_ps(a, b); }
+static inline ImSimdF4  ImSimdNeg(ImSimdF4 a)                       { return _mm_xor_ps(a, _mm_set1_ps(-0.0f)); }
+static inline ImSimdF4  ImSimdRsqrt(ImSimdF4 a)                     { return _mm_rsqrt_ps(a); }
+static inline ImSimdF4  ImSimdSelectGreater(ImSimdF4 a, ImSimdF4 b, ImSimdF4 if_greater, ImSimdF4 otherwise) { ImSimdF4 m = _mm_cmpgt_ps(a, b); return _mm_or_ps(_mm_and_ps(m, if_greater), _mm_andnot_ps(m, otherwise)); }
+static inline void      ImSimdStore(float* out, ImSimdF4 a)         { _mm_storeu_ps(out, a); }
+static inline void      ImSimdLoadVec2(const ImVec2* p, ImSimdF4* out_x, ImSimdF4* out_y) { ImSimdF4 a = _mm_loadu_ps(&p[0].x), b = _mm_loadu_ps(&p[2].x); *out_x = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)); *out_y = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)); }
+static inline void      ImSimdStoreVec2(ImVec2* p, ImSimdF4 x, ImSimdF4 y) { _mm_storeu_ps(&p[0].x, _mm_unpacklo_ps(x, y)); _mm_storeu_ps(&p[2].x, _mm_unpackhi_ps(x, y)); }
+static inline ImSimdI4  ImSimdLoadIdx(const ImDrawIdx* p)           { return _mm_loadu_si128((const __m128i*)p); }
+static inline void      ImSimdStoreIdx(ImDrawIdx* p, ImSimdI4 v)    { _mm_storeu_si128((__m128i*)p, v); }
+static inline ImSimdI4  ImSimdAddIdx(ImSimdI4 a, ImSimdI4 b)        { return sizeof(ImDrawIdx) == 2 ? _mm_add_epi16(a, b) : _mm_add_epi32(a, b); }
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define IMGUI_ENABLE_SIMD_TESSELLATION
+#include <arm_neon.h>
+typedef float32x4_t ImSimdF4;
+typedef uint8x16_t  ImSimdI4;
+static inline ImSimdF4  ImSimdSet1(float v)                         { return vdupq_n_f32(v); }
+static inline ImSimdF4  ImSimdAdd(ImSimdF4 a, ImSimdF4 b)           { return vaddq_f32(a, b); }
+static inline ImSimdF4  ImSimdSub(ImSimdF4 a, ImSimdF4 b)           { return vsubq_f32(a, b); }
+static inline ImSimdF4  ImSimdMul(ImSimdF4 a, ImSimdF4 b)           { return vmulq_f32(a, b); }
+static inline ImSimdF4  ImSimdDiv(ImSimdF4 a, ImSimdF4 b)           { return vdivq_f32(a, b); }
+static inline ImSimdF4  ImSimdMin(ImSimdF4 a, ImSimdF4 b)           { return vminq_f32(a, b); }
+static inline ImSimdF4  ImSimdNeg(ImSimdF4 a)                       { return vnegq_f32(a); }
+static inline ImSimdF4  ImSimdRsqrt(ImSimdF4 a)                     { return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(a)); }
+static inline ImSimdF4  ImSimdSelectGreater(ImSimdF4 a, ImSimdF4 b, ImSimdF4 if_greater, ImSimdF4 otherwise) { return vbslq_f32(vcgtq_f32(a, b), if_greater, otherwise); }
+static inline void      ImSimdStore(float* out, ImSimdF4 a)         { vst1q_f32(out, a); }
+static inline void      ImSimdLoadVec2(const ImVec2* p, ImSimdF4* out_x, ImSimdF4* out_y) { float32x4x2_t v = vld2q_f32(&p->x); *out_x = v.val[0]; *out_y = v.val[1]; }
+static inline void      ImSimdStoreVec2(ImVec2* p, ImSimdF4 x, ImSimdF4 y) { float32x4x2_t v; v.val[0] = x; v.val[1] = y; vst2q_f32(&p->x, v); }
+static inline ImSimdI4  ImSimdLoadIdx(const ImDrawIdx* p)           { return vld1q_u8((const uint8_t*)p); }
+static inline void      ImSimdStoreIdx(ImDrawIdx* p, ImSimdI4 v)    { vst1q_u8((uint8_t*)p, v); }
+static inline ImSimdI4  ImSimdAddIdx(ImSimdI4 a, ImSimdI4 b)        { return sizeof(ImDrawIdx) == 2 ? vreinterpretq_u8_u16(vaddq_u16(vreinterpretq_u16_u8(a), vreinterpretq_u16_u8(b))) : vreinterpretq_u8_u32(vaddq_u32(vreinterpretq_u32_u8(a), vreinterpretq_u32_u8(b))); }
+#endif
+
+#ifdef IMGUI_ENABLE_SIMD_TESSELLATION
+IM_STATIC_ASSERT(sizeof(ImDrawIdx) == 2 || sizeof(ImDrawIdx) == 4);
+
+// Vertices emitted for each point of an anti-aliased outline: vertex k is at the point itself if Center[k], otherwise at point + miter normal * Scale[k].
+// (p + n * -s is bit identical to the scalar paths' p - n * s.)
+struct ImOutlineVtxSetup
+{
+    int     VtxPerPoint;
+    bool    Center[4];
+    float   Scale[4];
+    ImVec2  Uv[4];
+    ImU32   Col[4];
+
+    void    Set(int k, bool center, float scale, const ImVec2& uv, ImU32 col) { Center[k] = center; Scale[k] = scale; Uv[k] = uv; Col[k] = col; }
+};
+
+static inline void ImSimdNormalizeOverZero(ImSimdF4* vx, ImSimdF4* vy)
+{
+    ImSimdF4 d2 = ImSimdAdd(ImSimdMul(*vx, *vx), ImSimdMul(*vy, *vy));
+    ImSimdF4 inv_len = ImSimdRsqrt(d2);
+    ImSimdF4 zero = ImSimdSet1(0.0f);
+    *vx = ImSimdSelectGreater(d2, zero, ImSimdMul(*vx, inv_len), *vx);
+    *vy = ImSimdSelectGreater(d2, zero, ImSimdMul(*vy, inv_len), *vy);
+}
+
+static inline void ImSimdFixNormal(ImSimdF4* vx, ImSimdF4* vy)
+{
+    ImSimdF4 d2 = ImSimdAdd(ImSimdMul(*vx, *vx), ImSimdMul(*vy, *vy));
+    ImSimdF4 inv_len2 = ImSimdMin(ImSimdDiv(ImSimdSet1(1.0f), d2), ImSimdSet1(IM_FIXNORMAL2F_MAX_INVLEN2));
+    ImSimdF4 min_d2 = ImSimdSet1(0.000001f);
+    *vx = ImSimdSelectGreater(d2, min_d2, ImSimdMul(*vx, inv_len2), *vx);
+    *vy = ImSimdSelectGreater(d2, min_d2, ImSimdMul(*vy, inv_len2), *vy);
+}
+
+// Normal of every segment of a closed outline, or of an open one minus its last point
+static void ImOutlineNormals(const ImVec2* points, int points_count, int count, ImVec2* temp_normals)
+{
+    int i1 = 0;
+    for (; i1 + 4 < points_count; i1 += 4)
+    {
+        ImSimdF4 x1, y1, x2, y2;
+        ImSimdLoadVec2(points + i1, &x1, &y1);
+        ImSimdLoadVec2(points + i1 + 1, &x2, &y2);
+        ImSimdF4 dx = ImSimdSub(x2, x1);
+        ImSimdF4 dy = ImSimdSub(y2, y1);
+        ImSimdNormalizeOverZero(&dx, &dy);
+        ImSimdStoreVec2(temp_normals + i1, dy, ImSimdNeg(dx));
+    }
+    for (; i1 < count; i1++)
+    {
+        const int i2 = (i1 + 1) == points_count ? 0 : i1 + 1;
+        float dx = points[i2].x - points[i1].x;
+        float dy = points[i2].y - points[i1].y;
+        IM_NORMALIZE2F_OVER_ZERO(dx, dy);
+        temp_normals[i1].x = dy;
+        temp_normals[i1].y = -dx;
+    }
+}
+
+static inline void ImOutlinePointVtx(ImDrawVert* vtx, const ImVec2& p, float dm_x, float dm_y, const ImOutlineVtxSetup& setup)
+{
+    for (int k = 0; k < setup.VtxPerPoint; k++)
+    {
+        if (setup.Center[k])
+            vtx[k].pos = p;
+        else
+            vtx[k].pos = ImVec2(p.x + dm_x * setup.Scale[k], p.y + dm_y * setup.Scale[k]);
+        vtx[k].uv = setup.Uv[k];
+        vtx[k].col = setup.Col[k];
+    }
+}
+
+// Vertices of the point between the segments with normals n0 and n1
+static inline void ImOutlineMiterVtx(ImDrawVert* vtx, const ImVec2& p, const ImVec2& n0, const ImVec2& n1, const ImOutlineVtxSetup& setup)
+{
+    float dm_x = (n0.x + n1.x) * 0.5f;
+    float dm_y = (n0.y + n1.y) * 0.5f;
+    IM_FIXNORMAL2F(dm_x, dm_y);
+    ImOutlinePointVtx(vtx, p, dm_x, dm_y, setup);
+}
+
+// Vertices of points [1, points_count), point i sitting between the segments with normals temp_normals[i - 1] and temp_normals[i].
+// Templated on the vertex count so the per vertex loops unroll.
+template<int VTX_PER_POINT>
+static void ImOutlineMiterVtxRange(ImDrawVert* vtx, const ImVec2* points, const ImVec2* temp_normals, int points_count, const ImOutlineVtxSetup& setup)
+{
+    const ImSimdF4 half = ImSimdSet1(0.5f);
+    ImSimdF4 scale[VTX_PER_POINT];
+    for (int k = 0; k < VTX_PER_POINT; k++)
+        scale[k] = ImSimdSet1(setup.Scale[k]);
+    int i = 1;
+    for (; i + 4 <= points_count; i += 4)
+    {
+        ImSimdF4 px, py, n0x, n0y, n1x, n1y;
+        ImSimdLoadVec2(points + i, &px, &py);
+        ImSimdLoadVec2(temp_normals + i - 1, &n0x, &n0y);
+        ImSimdLoadVec2(temp_normals + i, &n1x, &n1y);
+        ImSimdF4 dm_x = ImSimdMul(ImSimdAdd(n0x, n1x), half);
+        ImSimdF4 dm_y = ImSimdMul(ImSimdAdd(n0y, n1y), half);
+        ImSimdFixNormal(&dm_x, &dm_y);
+
+        // Positions per vertex, then the lanes get written out as whole vertices
+        ImVec2 pos[VTX_PER_POINT][4];
+        for (int k = 0; k < VTX_PER_POINT; k++)
+        {
+            if (setup.Center[k])
+                ImSimdStoreVec2(pos[k], px, py);
+            else
+                ImSimdStoreVec2(pos[k], ImSimdAdd(px, ImSimdMul(dm_x, scale[k])), ImSimdAdd(py, ImSimdMul(dm_y, scale[k])));
+        }
+        ImDrawVert* out = vtx + i * VTX_PER_POINT;
+        for (int lane = 0; lane < 4; lane++)
+            for (int k = 0; k < VTX_PER_POINT; k++, out++)
+            {
+                out->pos = pos[k][lane];
+                out->uv = setup.Uv[k];
+                out->col = setup.Col[k];
+            }
+    }
+    for (; i < points_count; i++)
+        ImOutlineMiterVtx(vtx + i * VTX_PER_POINT, points[i], temp_normals[i - 1], temp_normals[i], setup);
+}
+
+static void ImOutlineMiterVtxRange(ImDrawVert* vtx, const ImVec2* points, const ImVec2* temp_normals, int points_count, const ImOutlineVtxSetup& setup)
+{
+    switch (setup.VtxPerPoint)
+    {
+    case 2: ImOutlineMiterVtxRange<2>(vtx, points, temp_normals, points_count, setup); break;
+    case 3: ImOutlineMiterVtxRange<3>(vtx, points, temp_normals, points_count, setup); break;
+    case 4: ImOutlineMiterVtxRange<4>(vtx, points, temp_normals, points_count, setup); break;
+    default: IM_ASSERT(0);
+    }
+}
+
+// Writes `count` repetitions of an index pattern, index k of repetition r being first[k] + r * step[k] (truncated like the scalar paths' casts).
+// A block of whole repetitions that is also a whole number of vectors is built once, then every vector only needs one add per block.
+static ImDrawIdx* ImWriteIndexPattern(ImDrawIdx* out, const unsigned int* first, const unsigned int* step, int size, int count)
+{
+    const int lanes = 16 / (int)sizeof(ImDrawIdx);
+    int gcd = size, b = lanes;
+    while (b != 0) { int t = gcd % b; gcd = b; b = t; }
+    const int block_reps = lanes / gcd;
+    const int block_vecs = block_reps * size / lanes;
+    IM_ASSERT(block_reps * size <= 72);
+
+    int r = 0;
+    if (count >= block_reps * 2)
+    {
+        ImDrawIdx values[72], increments[72];
+        for (int j = 0; j < block_reps * size; j++)
+        {
+            const int k = j % size;
+            values[j] = (ImDrawIdx)(first[k] + (unsigned int)(j / size) * step[k]);
+            increments[j] = (ImDrawIdx)((unsigned int)block_reps * step[k]);
+        }
+        ImSimdI4 value_vecs[9], increment_vecs[9];
+        for (int v = 0; v < block_vecs; v++)
+        {
+            value_vecs[v] = ImSimdLoadIdx(values + v * lanes);
+            increment_vecs[v] = ImSimdLoadIdx(increments + v * lanes);
+        }
+        for (; r + block_reps <= count; r += block_reps)
+            for (int v = 0; v < block_vecs; v++, out += lanes)
+            {
+                ImSimdStoreIdx(out, value_vecs[v]);
+                value_vecs[v] = ImSimdAddIdx(value_vecs[v], increment_vecs[v]);
+            }
+    }
+    for (; r < count; r++)
+        for (int k = 0; k < size; k++)
+            *out++ = (ImDrawIdx)(first[k] + (unsigned int)r * step[k]);
+    return out;
+}
+
+// Anti-aliased AddPolyline() paths, after PrimReserve(). Index pattern per segment, as offsets from the segment's first vertex.
+static const ImU8 IM_POLYLINE_IDX_TEX[6]    = { 2, 0, 1, 3, 1, 2 };
+static const ImU8 IM_POLYLINE_IDX_THIN[12]  = { 3, 0, 2, 2, 5, 3, 4, 1, 0, 0, 3, 4 };
+static const ImU8 IM_POLYLINE_IDX_THICK[18] = { 5, 1, 2, 2, 6, 5, 5, 1, 0, 0, 4, 5, 6, 2, 3, 3, 7, 6 };
+
+static void ImDrawList_PolylineSimd(ImDrawList* draw_list, const ImVec2* points, const int points_count, bool closed, const ImOutlineVtxSetup& setup)
+{
+    const int count = closed ? points_count : points_count - 1;
+    const int vtx_per_point = setup.VtxPerPoint;
+    const unsigned int vtx_base = draw_list->_VtxCurrentIdx;
+    draw_list->_TempBuffer.reserve_discard(points_count);
+    ImVec2* temp_normals = draw_list->_TempBuffer.Data;
+    ImOutlineNormals(points, points_count, count, temp_normals);
+    if (!closed)
+        temp_normals[points_count - 1] = temp_normals[points_count - 2];
+
+    // Indices: every segment but the closing one follows the pattern, the closing one ends at the first point's vertices
+    const ImU8* pattern = vtx_per_point == 2 ? IM_POLYLINE_IDX_TEX : vtx_per_point == 3 ? IM_POLYLINE_IDX_THIN : IM_POLYLINE_IDX_THICK;
+    const int pattern_size = vtx_per_point == 2 ? 6 : vtx_per_point == 3 ? 12 : 18;
+    unsigned int first[18], step[18];
+    for (int k = 0; k < pattern_size; k++)
+    {
+        first[k] = vtx_base + pattern[k];
+        step[k] = (unsigned int)vtx_per_point;
+    }
+    draw_list->_IdxWritePtr = ImWriteIndexPattern(draw_list->_IdxWritePtr, first, step, pattern_size, points_count - 1);
+    if (closed)
+    {
+        const unsigned int idx1 = vtx_base + (points_count - 1) * vtx_per_point;
+        for (int k = 0; k < pattern_size; k++)
+            draw_list->_IdxWritePtr[k] = (ImDrawIdx)(pattern[k] >= vtx_per_point ? vtx_base + pattern[k] - vtx_per_point : idx1 + pattern[k]);
+        draw_list->_IdxWritePtr += pattern_size;
+    }
+
+    // Vertices: open lines start at the first segment's normal, closed ones blend in the closing segment
+    ImDrawVert* vtx = draw_list->_VtxWritePtr;
+    if (closed)
+        ImOutlineMiterVtx(vtx, points[0], temp_normals[points_count - 1], temp_normals[0], setup);
+    else
+        ImOutlinePointVtx(vtx, points[0], temp_normals[0].x, temp_normals[0].y, setup);
+    ImOutlineMiterVtxRange(vtx, points, temp_normals, points_count, setup);
+    draw_list->_VtxWritePtr += points_count * vtx_per_point;
+}
+#endif // #ifdef IMGUI_ENABLE_SIMD_TESSELLATION
+
 // TODO: Thickness anti-aliased lines cap are missing their AA fringe.
 // We avoid using the ImVec2 math operators here to reduce cost to a minimum for debug/non-inlined builds.
 void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32 col, ImDrawFlags flags, float thickness)
@@ -731,16 +1008,51 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         const bool use_texture = (Flags & ImDrawListFlags_AntiAliasedLinesUseTex) && (integer_thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX) && (fractional_thickness <= 0.00001f) && (AA_SIZE == 1.0f);
 
         // We should never hit this, because NewFrame() doesn't set ImDrawListFlags_AntiAliasedLinesUseTex unless ImFontAtlasFlags_NoBakedLines is off
-        IM_ASSERT_PARANOID(!use_texture || !(_Data->Font->ContainerAtlas->Flags & ImFontAtlasFlags_NoBakedLines));
+        IM_ASSERT_PARANOID(!use_texture || !(_Data->Font->ContainerAtlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_DistanceField)));
 
         const int idx_count = use_texture ? (count * 6) : (thick_line ? count * 18 : count * 12);
         const int vtx_count = use_texture ? (points_count * 2) : (thick_line ? points_count * 4 : points_count * 3);
         PrimReserve(idx_count, vtx_count);
 
+#ifdef IMGUI_ENABLE_SIMD_TESSELLATION
+        if (_Data->TessellationSimd && points_count >= IM_DRAWLIST_SIMD_MIN_POINTS)
+        {
+            // Same geometry as the paths below
+            ImOutlineVtxSetup setup;
+            if (use_texture)
+            {
+                const float half_draw_size = (thickness * 0.5f) + 1;
+                const ImVec4 tex_uvs = _Data->TexUvLines[integer_thickness];
+                setup.VtxPerPoint = 2;
+                setup.Set(0, false, half_draw_size, ImVec2(tex_uvs.x, tex_uvs.y), col);
+                setup.Set(1, false, -half_draw_size, ImVec2(tex_uvs.z, tex_uvs.w), col);
+            }
+            else if (!thick_line)
+            {
+                setup.VtxPerPoint = 3;
+                setup.Set(0, true, 0.0f, opaque_uv, col);
+                setup.Set(1, false, AA_SIZE, opaque_uv, col_trans);
+                setup.Set(2, false, -AA_SIZE, opaque_uv, col_trans);
+            }
+            else
+            {
+                const float half_inner_thickness = (thickness - AA_SIZE) * 0.5f;
+                setup.VtxPerPoint = 4;
+                setup.Set(0, false, half_inner_thickness + AA_SIZE, opaque_uv, col_trans);
+                setup.Set(1, false, half_inner_thickness, opaque_uv, col);
+                setup.Set(2, false, -half_inner_thickness, opaque_uv, col);
+                setup.Set(3, false, -(half_inner_thickness + AA_SIZE), opaque_uv, col_trans);
+            }
+            ImDrawList_PolylineSimd(this, points, points_count, closed, setup);
+            _VtxCurrentIdx += (ImDrawIdx)vtx_count;
+            return;
+        }
+#endif
+
         // Temporary buffer
         // The first <points_count> items are normals at each line point, then after that there are either 2 or 4 temp points for each line point
-        _Data->TempBuffer.reserve_discard(points_count * ((use_texture || !thick_line) ? 3 : 5));
-        ImVec2* temp_normals = _Data->TempBuffer.Data;
+        _TempBuffer.reserve_discard(points_count * ((use_texture || !thick_line) ? 3 : 5));
+        ImVec2* temp_normals = _TempBuffer.Data;
         ImVec2* temp_points = temp_normals + points_count;
 
         // Calculate normals (tangents) for each line segment
@@ -988,8 +1300,8 @@ void ImDrawList::AddConvexPolyFilled(const ImVec2* points, const int points_coun
         }
 
         // Compute normals
-        _Data->TempBuffer.reserve_discard(points_count);
-        ImVec2* temp_normals = _Data->TempBuffer.Data;
+        _TempBuffer.reserve_discard(points_count);
+        ImVec2* temp_normals = _TempBuffer.Data;
         for (int i0 = points_count - 1, i1 = 0; i1 < points_count; i0 = i1++)
         {
             const ImVec2& p0 = points[i0];
@@ -1751,6 +2063,7 @@ void ImDrawListSplitter::Merge(ImDrawList* draw_list)
             idx_offset += ch._CmdBuffer.Data[cmd_n].ElemCount;
         }
     }
+    draw_list->_ReallocCount += (draw_list->CmdBuffer.Size + new_cmd_buffer_count > draw_list->CmdBuffer.Capacity) + (draw_list->IdxBuffer.Size + new_idx_buffer_count > draw_list->IdxBuffer.Capacity);
     draw_list->CmdBuffer.resize(draw_list->CmdBuffer.Size + new_cmd_buffer_count);
     draw_list->IdxBuffer.resize(draw_list->IdxBuffer.Size + new_idx_buffer_count);
 
@@ -1842,6 +2155,308 @@ void ImDrawData::ScaleClipRects(const ImVec2& fb_scale)
     }
 }
 
+// Kept out of the command loop so the compiler sees a plain widening loop and vectorizes it
+template<typename T>
+static void ImOffsetDrawIndices(T* dst, const ImDrawIdx* src, int count, ImU32 vtx_offset)
+{
+    for (int n = 0; n < count; n++)
+        dst[n] = (T)((ImU32)src[n] + vtx_offset);
+}
+
+// Fold each command's VtxOffset and the list's distance to its batch's base vertex into its indices. Indices no command refers to are zeroed.
+template<typename T>
+static void ImOffsetDrawListIndices(T* out, const ImDrawList* cmd_list, ImU32 rebase)
+{
+    const ImDrawIdx* src = cmd_list->IdxBuffer.Data;
+    int written = 0;
+    for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+    {
+        const ImDrawCmd* pcmd = &cmd_list->CmdBuffer.Data[cmd_i];
+        const int idx_start = (int)pcmd->IdxOffset;
+        const int idx_end = ImMin(idx_start + (int)pcmd->ElemCount, cmd_list->IdxBuffer.Size);
+        if (pcmd->UserCallback != NULL || idx_start < written || idx_end <= idx_start)
+            continue;
+        memset(out + written, 0, (size_t)(idx_start - written) * sizeof(T));
+        ImOffsetDrawIndices(out + idx_start, src + idx_start, idx_end - idx_start, pcmd->VtxOffset + rebase);
+        written = idx_end;
+    }
+    memset(out + written, 0, (size_t)(cmd_list->IdxBuffer.Size - written) * sizeof(T));
+}
+
+void ImDrawData::PlanIndexUpload(ImDrawIdxPacking* out_packing, bool batch_lists) const
+{
+    ImDrawIdxPacking& packing = *out_packing;
+    packing.ListIdxOffset.resize(CmdListsCount);
+    packing.ListVtxBase.resize(CmdListsCount);
+    packing.ListIdx32.resize(CmdListsCount);
+    packing.Idx16Count = packing.Idx32Count = 0;
+    int vtx_start = 0, batch_vtx_base = 0, batch_vtx_count = 0;
+    for (int i = 0; i < CmdListsCount; i++)
+    {
+        const ImDrawList* cmd_list = CmdLists[i];
+        const bool idx32 = cmd_list->VtxBuffer.Size > (1 << 16);
+        if (!batch_lists || i == 0 || idx32 || packing.ListIdx32[i - 1] || batch_vtx_count + cmd_list->VtxBuffer.Size > (1 << 16))
+        {
+            batch_vtx_base = vtx_start;
+            batch_vtx_count = 0;
+        }
+        packing.ListIdx32[i] = idx32;
+        packing.ListVtxBase[i] = batch_vtx_base;
+        int& count = idx32 ? packing.Idx32Count : packing.Idx16Count;
+        packing.ListIdxOffset[i] = count;
+        count += cmd_list->IdxBuffer.Size;
+        batch_vtx_count += cmd_list->VtxBuffer.Size;
+        vtx_start += cmd_list->VtxBuffer.Size;
+    }
+    packing.Idx32ByteOffset = ((size_t)packing.Idx16Count * sizeof(ImU16) + 3) & ~(size_t)3;
+    packing.TotalBytes = packing.Idx32ByteOffset + (size_t)packing.Idx32Count * sizeof(ImU32);
+}
+
+void ImDrawData::PackIndices(const ImDrawIdxPacking& packing, void* dst) const
+{
+    IM_ASSERT(packing.ListIdxOffset.Size == CmdListsCount);
+    ImU16* dst16 = (ImU16*)dst;
+    ImU32* dst32 = (ImU32*)(void*)((unsigned char*)dst + packing.Idx32ByteOffset);
+    int vtx_start = 0;
+    for (int i = 0; i < CmdListsCount; i++)
+    {
+        const ImDrawList* cmd_list = CmdLists[i];
+        const ImU32 rebase = (ImU32)(vtx_start - packing.ListVtxBase[i]);
+        vtx_start += cmd_list->VtxBuffer.Size;
+        if (packing.ListIdx32[i])
+        {
+            ImOffsetDrawListIndices(dst32 + packing.ListIdxOffset[i], cmd_list, rebase);
+            continue;
+        }
+
+        // Up to 64K vertices in the batch, so each index fits in 16 bits. Copied as is when there is nothing to add.
+        ImU16* out = dst16 + packing.ListIdxOffset[i];
+        bool offset = rebase != 0;
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size && !offset; cmd_i++)
+            offset = cmd_list->CmdBuffer.Data[cmd_i].VtxOffset != 0;
+        if (offset)
+            ImOffsetDrawListIndices(out, cmd_list, rebase);
+        else if (sizeof(ImDrawIdx) == sizeof(ImU16))
+            memcpy(out, cmd_list->IdxBuffer.Data, (size_t)cmd_list->IdxBuffer.Size * sizeof(ImU16));
+        else
+            for (int n = 0; n < cmd_list->IdxBuffer.Size; n++)
+                out[n] = (ImU16)cmd_list->IdxBuffer.Data[n];
+    }
+}
+
+// Scissor rect of a command in framebuffer pixels, as backends set it
+static void ImDrawCmdScissor(const ImDrawCmd* pcmd, const ImVec2& display_pos, const ImVec2& fb_scale, int fb_width, int fb_height, int out[4])
+{
+    out[0] = ImMax((int)((pcmd->ClipRect.x - display_pos.x) * fb_scale.x), 0);
+    out[1] = ImMax((int)((pcmd->ClipRect.y - display_pos.y) * fb_scale.y), 0);
+    out[2] = ImMin((int)((pcmd->ClipRect.z - display_pos.x) * fb_scale.x), fb_width);
+    out[3] = ImMin((int)((pcmd->ClipRect.w - display_pos.y) * fb_scale.y), fb_height);
+}
+
+// Bounding box of a command's vertices in framebuffer pixels
+static ImVec4 ImDrawCmdBounds(const ImDrawList* cmd_list, const ImDrawCmd* pcmd, const ImVec2& display_pos, const ImVec2& fb_scale)
+{
+    ImVec4 bb(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    const ImDrawIdx* idx = cmd_list->IdxBuffer.Data + pcmd->IdxOffset;
+    const ImDrawVert* vtx = cmd_list->VtxBuffer.Data + pcmd->VtxOffset;
+    for (unsigned int n = 0; n < pcmd->ElemCount; n++)
+    {
+        const ImVec2 pos = vtx[idx[n]].pos;
+        bb.x = ImMin(bb.x, pos.x); bb.y = ImMin(bb.y, pos.y);
+        bb.z = ImMax(bb.z, pos.x); bb.w = ImMax(bb.w, pos.y);
+    }
+    return ImVec4((bb.x - display_pos.x) * fb_scale.x, (bb.y - display_pos.y) * fb_scale.y, (bb.z - display_pos.x) * fb_scale.x, (bb.w - display_pos.y) * fb_scale.y);
+}
+
+// Bounds of large commands aren't worth their cost (see IM_DRAW_SUBMIT_BOUNDS_MAX_ELEMS): they are taken as covering everything
+static const ImVec4& ImDrawCmdBoundsCached(ImVec4* cached, const ImDrawList* cmd_list, const ImDrawCmd* pcmd, const ImVec2& display_pos, const ImVec2& fb_scale)
+{
+    if (cached->x > cached->z)
+        *cached = (pcmd->ElemCount <= IM_DRAW_SUBMIT_BOUNDS_MAX_ELEMS) ? ImDrawCmdBounds(cmd_list, pcmd, display_pos, fb_scale) : ImVec4(-FLT_MAX, -FLT_MAX, FLT_MAX, FLT_MAX);
+    return *cached;
+}
+
+// Triangles are only rasterized where they cover pixel centers, so a box inside the rect isn't clipped by it
+static bool ImDrawBoundsInScissor(const ImVec4& bb, const int scissor[4])
+{
+    return bb.x >= (float)scissor[0] && bb.y >= (float)scissor[1] && bb.z <= (float)scissor[2] && bb.w <= (float)scissor[3];
+}
+
+void ImDrawSubmission::Build(const ImDrawData* draw_data, bool merge_cmds, bool merge_by_bounds)
+{
+    draw_data->PlanIndexUpload(&Packing, merge_cmds);
+    Cmds.resize(0);
+    Stats = ImDrawSubmissionStats();
+
+    const ImVec2 display_pos = draw_data->DisplayPos;
+    const ImVec2 fb_scale = draw_data->FramebufferScale;
+    const int fb_width = (int)ImCeil(draw_data->DisplaySize.x * fb_scale.x);
+    const int fb_height = (int)ImCeil(draw_data->DisplaySize.y * fb_scale.y);
+    merge_by_bounds &= merge_cmds;
+    if (merge_by_bounds)
+    {
+        int cmd_count = 0;
+        for (int n = 0; n < draw_data->CmdListsCount; n++)
+            cmd_count += draw_data->CmdLists[n]->CmdBuffer.Size;
+        _CmdBounds.resize(cmd_count);
+        for (int i = 0; i < cmd_count; i++)
+            _CmdBounds.Data[i] = ImVec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+    }
+
+    // The draw call that can still grow, where its commands start, and whether all of them lie inside their own scissor rect (-1: not known yet)
+    int run = -1, run_list_n = 0, run_cmd_i = 0, run_cmd_ordinal = 0, run_inside = -1;
+    bool run_across_lists = false;
+    ImVec4 run_bounds;
+    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    {
+        const ImDrawList* cmd_list = draw_data->CmdLists[n];
+        const bool idx32 = Packing.ListIdx32[n];
+        const int vtx_base = Packing.ListVtxBase[n];
+        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        {
+            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer.Data[cmd_i];
+            const int cmd_ordinal = Stats.Cmds++;
+            if (pcmd->UserCallback != NULL)
+            {
+                Cmds.push_back(ImDrawSubmitCmd());
+                ImDrawSubmitCmd& draw = Cmds.back();
+                memset(&draw, 0, sizeof(draw));
+                draw.CmdCount = 1;
+                draw.CmdList = cmd_list;
+                draw.Cmd = pcmd;
+                Stats.Callbacks++;
+                run = -1;
+                continue;
+            }
+
+            int scissor[4];
+            ImDrawCmdScissor(pcmd, display_pos, fb_scale, fb_width, fb_height, scissor);
+            if (pcmd->ElemCount == 0 || scissor[2] <= scissor[0] || scissor[3] <= scissor[1])
+            {
+                Stats.Culled++;
+                continue;
+            }
+
+            const unsigned int idx_offset = (unsigned int)Packing.ListIdxOffset[n] + pcmd->IdxOffset;
+            if (merge_cmds && run != -1)
+            {
+                ImDrawSubmitCmd& draw = Cmds.Data[run];
+                bool merge = false;
+                if (draw.Idx32 == idx32 && draw.VtxOffset == vtx_base && draw.TextureId == pcmd->TextureId && draw.IdxOffset + draw.ElemCount == idx_offset)
+                {
+                    if (memcmp(draw.ClipRect, scissor, sizeof(scissor)) == 0)
+                    {
+                        merge = true;
+                        if (run_inside != -1)
+                        {
+                            // Keep the call's bounds up to date once they are known
+                            const ImVec4& bb = ImDrawCmdBoundsCached(&_CmdBounds.Data[cmd_ordinal], cmd_list, pcmd, display_pos, fb_scale);
+                            run_bounds = ImVec4(ImMin(run_bounds.x, bb.x), ImMin(run_bounds.y, bb.y), ImMax(run_bounds.z, bb.z), ImMax(run_bounds.w, bb.w));
+                            run_inside = run_inside && ImDrawBoundsInScissor(bb, scissor);
+                        }
+                    }
+                    else if (merge_by_bounds)
+                    {
+                        if (run_inside == -1)
+                        {
+                            // Bounds of the commands merged so far, walked again only when a scissor rect differs
+                            run_bounds = ImVec4(FLT_MAX, FLT_MAX, -FLT_MAX, -FLT_MAX);
+                            run_inside = 1;
+                            int list_n = run_list_n, i = run_cmd_i, ordinal = run_cmd_ordinal;
+                            for (int merged = 0; merged < draw.CmdCount; i++, ordinal++)
+                            {
+                                const ImDrawList* list = draw_data->CmdLists[list_n];
+                                if (i == list->CmdBuffer.Size)
+                                {
+                                    list_n++;
+                                    i = -1;
+                                    ordinal--;
+                                    continue;
+                                }
+                                const ImDrawCmd* member = &list->CmdBuffer.Data[i];
+                                int member_scissor[4];
+                                ImDrawCmdScissor(member, display_pos, fb_scale, fb_width, fb_height, member_scissor);
+                                if (member->ElemCount == 0 || member_scissor[2] <= member_scissor[0] || member_scissor[3] <= member_scissor[1])
+                                    continue;
+                                const ImVec4& bb = ImDrawCmdBoundsCached(&_CmdBounds.Data[ordinal], list, member, display_pos, fb_scale);
+                                run_bounds = ImVec4(ImMin(run_bounds.x, bb.x), ImMin(run_bounds.y, bb.y), ImMax(run_bounds.z, bb.z), ImMax(run_bounds.w, bb.w));
+                                run_inside = run_inside && ImDrawBoundsInScissor(bb, member_scissor);
+                                merged++;
+                            }
+                        }
+
+                        const ImVec4& bb = ImDrawCmdBoundsCached(&_CmdBounds.Data[cmd_ordinal], cmd_list, pcmd, display_pos, fb_scale);
+                        const bool inside = ImDrawBoundsInScissor(bb, scissor);
+                        if (inside && ImDrawBoundsInScissor(bb, draw.ClipRect))
+                        {
+                            // Not clipped by its own rect nor the call's: keep the call's
+                            merge = true;
+                        }
+                        else if (run_inside && ImDrawBoundsInScissor(run_bounds, scissor))
+                        {
+                            // Nothing merged so far is clipped by its own rect nor this one: switch the call to this one
+                            merge = true;
+                            memcpy(draw.ClipRect, scissor, sizeof(scissor));
+                        }
+                        if (merge)
+                        {
+                            run_bounds = ImVec4(ImMin(run_bounds.x, bb.x), ImMin(run_bounds.y, bb.y), ImMax(run_bounds.z, bb.z), ImMax(run_bounds.w, bb.w));
+                            run_inside = run_inside && inside;
+                        }
+                    }
+                }
+                if (merge)
+                {
+                    if (n != run_list_n && !run_across_lists)
+                        Stats.MergedAcrossLists++;
+                    run_across_lists |= n != run_list_n;
+                    draw.ElemCount += pcmd->ElemCount;
+                    draw.CmdCount++;
+                    continue;
+                }
+            }
+
+            Cmds.push_back(ImDrawSubmitCmd());
+            ImDrawSubmitCmd& draw = Cmds.back();
+            memcpy(draw.ClipRect, scissor, sizeof(scissor));
+            draw.TextureId = pcmd->TextureId;
+            draw.IdxOffset = idx_offset;
+            draw.ElemCount = pcmd->ElemCount;
+            draw.VtxOffset = vtx_base;
+            draw.Idx32 = idx32;
+            draw.CmdCount = 1;
+            draw.CmdList = cmd_list;
+            draw.Cmd = pcmd;
+            run = Cmds.Size - 1;
+            run_list_n = n;
+            run_cmd_i = cmd_i;
+            run_cmd_ordinal = cmd_ordinal;
+            run_inside = -1;
+            run_across_lists = false;
+        }
+    }
+
+    // State changes of a backend walking Cmds in order, with the 16-bit index buffer bound at the start and after callbacks
+    const ImDrawSubmitCmd* last = NULL;
+    bool idx32_bound = false;
+    for (int draw_i = 0; draw_i < Cmds.Size; draw_i++)
+    {
+        const ImDrawSubmitCmd& draw = Cmds.Data[draw_i];
+        if (draw.Cmd->UserCallback != NULL)
+        {
+            last = NULL;
+            idx32_bound = false;
+            continue;
+        }
+        Stats.Draws++;
+        Stats.ScissorChanges += (last == NULL || memcmp(last->ClipRect, draw.ClipRect, sizeof(draw.ClipRect)) != 0) ? 1 : 0;
+        Stats.TextureChanges += (last == NULL || last->TextureId != draw.TextureId) ? 1 : 0;
+        Stats.IndexFormatChanges += (draw.Idx32 != idx32_bound) ? 1 : 0;
+        idx32_bound = draw.Idx32;
+        last = &draw;
+    }
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] Helpers ShadeVertsXXX functions
 //-----------------------------------------------------------------------------
@@ -1968,6 +2583,7 @@ ImFontAtlas::ImFontAtlas()
 {
     memset(this, 0, sizeof(*this));
     TexGlyphPadding = 1;
+    TexDistanceFieldSpread = 4;
     PackIdMouseCursors = PackIdLines = -1;
 }
 
@@ -2334,9 +2950,142 @@ static void UnpackBitVectorToFlatIndexList(const ImBitVector* in, ImVector<int>*
                     out->push_back((int)(((it - it_begin) << 5) + bit_n));
 }
 
+// Glyphs of one source font measured or rasterized by one call of the parallel-for. Jobs write disjoint rects, so they can run concurrently.
+#define IM_FONTATLAS_BUILD_JOB_GLYPHS   64
+struct ImFontBuildJob
+{
+    int                 SrcIndex;
+    int                 GlyphBegin;
+    int                 GlyphEnd;
+};
+
+struct ImFontBuildJobContext
+{
+    ImFontAtlas*            Atlas;
+    ImFontBuildSrcData*     SrcTmp;
+    ImFontBuildJob*         Jobs;
+    const stbtt_pack_context* Spc;
+};
+
+static void ImFontAtlasBuildParallelForSerial(int count, void (*func)(void* user_data, int index), void* user_data, void*)
+{
+    for (int i = 0; i < count; i++)
+        func(user_data, i);
+}
+
+// Packed rect size of a glyph, TexGlyphPadding included
+static void ImFontAtlasBuildGlyphRectSize(const ImFontAtlas* atlas, const ImFontConfig& cfg, const stbtt_fontinfo* font_info, int glyph_index_in_font, float scale, int* out_w, int* out_h)
+{
+    int x0, y0, x1, y1;
+    if (atlas->Flags & ImFontAtlasFlags_DistanceField)
+    {
+        // Same box as stbtt_GetGlyphSDF(), which renders nothing for empty glyphs
+        stbtt_GetGlyphBitmapBoxSubpixel(font_info, glyph_index_in_font, scale, scale, 0, 0, &x0, &y0, &x1, &y1);
+        const int spread = (x0 != x1 && y0 != y1) ? atlas->TexDistanceFieldSpread : 0;
+        *out_w = x1 - x0 + spread * 2 + atlas->TexGlyphPadding;
+        *out_h = y1 - y0 + spread * 2 + atlas->TexGlyphPadding;
+        return;
+    }
+    stbtt_GetGlyphBitmapBoxSubpixel(font_info, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
+    *out_w = x1 - x0 + atlas->TexGlyphPadding + cfg.OversampleH - 1;
+    *out_h = y1 - y0 + atlas->TexGlyphPadding + cfg.OversampleV - 1;
+}
+
+// Distance field version of stbtt_PackFontRangesRenderIntoRects() for one glyph: padding goes on the left and top, and 'out_pc' is filled so stbtt_GetPackedQuad() works on it
+static void ImFontAtlasBuildRenderGlyphDistanceField(ImFontAtlas* atlas, const stbtt_fontinfo* font_info, int glyph_index_in_font, float scale, int x, int y, stbtt_packedchar* out_pc)
+{
+    const int pad = atlas->TexGlyphPadding;
+    const int spread = atlas->TexDistanceFieldSpread;
+    int w = 0, h = 0, xoff = 0, yoff = 0;
+    unsigned char* field = stbtt_GetGlyphSDF(font_info, scale, glyph_index_in_font, spread, IM_FONT_DISTANCE_FIELD_ON_EDGE, (float)IM_FONT_DISTANCE_FIELD_ON_EDGE / spread, &w, &h, &xoff, &yoff);
+    if (field != NULL)
+    {
+        for (int row = 0; row < h; row++)
+            memcpy(atlas->TexPixelsAlpha8 + (y + pad + row) * atlas->TexWidth + x + pad, field + row * w, (size_t)w);
+        stbtt_FreeSDF(field, font_info->userdata);
+    }
+    int advance, lsb;
+    stbtt_GetGlyphHMetrics(font_info, glyph_index_in_font, &advance, &lsb);
+    out_pc->x0 = (unsigned short)(x + pad);
+    out_pc->y0 = (unsigned short)(y + pad);
+    out_pc->x1 = (unsigned short)(x + pad + w);
+    out_pc->y1 = (unsigned short)(y + pad + h);
+    out_pc->xoff = (float)xoff;
+    out_pc->yoff = (float)yoff;
+    out_pc->xoff2 = (float)(xoff + w);
+    out_pc->yoff2 = (float)(yoff + h);
+    out_pc->xadvance = scale * advance;
+}
+
+// Gather the sizes of the rectangles we will need to pack (this is based on stbtt_PackFontRangesGatherRects)
+static void ImFontAtlasBuildGatherJob(void* user_data, int job_i)
+{
+    ImFontBuildJobContext* ctx = (ImFontBuildJobContext*)user_data;
+    const ImFontBuildJob& job = ctx->Jobs[job_i];
+    ImFontBuildSrcData& src_tmp = ctx->SrcTmp[job.SrcIndex];
+    const ImFontConfig& cfg = ctx->Atlas->ConfigData[job.SrcIndex];
+    const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src_tmp.FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src_tmp.FontInfo, -cfg.SizePixels);
+    for (int glyph_i = job.GlyphBegin; glyph_i < job.GlyphEnd; glyph_i++)
+    {
+        int w, h;
+        const int glyph_index_in_font = stbtt_FindGlyphIndex(&src_tmp.FontInfo, src_tmp.GlyphsList[glyph_i]);
+        IM_ASSERT(glyph_index_in_font != 0);
+        ImFontAtlasBuildGlyphRectSize(ctx->Atlas, cfg, &src_tmp.FontInfo, glyph_index_in_font, scale, &w, &h);
+        src_tmp.Rects[glyph_i].w = (stbrp_coord)w;
+        src_tmp.Rects[glyph_i].h = (stbrp_coord)h;
+    }
+}
+
+// Render/rasterize glyphs into their packed rects, each job through its own copy of the pack context (stb_truetype changes its oversampling fields while rendering)
+static void ImFontAtlasBuildRenderJob(void* user_data, int job_i)
+{
+    ImFontBuildJobContext* ctx = (ImFontBuildJobContext*)user_data;
+    const ImFontBuildJob& job = ctx->Jobs[job_i];
+    ImFontBuildSrcData& src_tmp = ctx->SrcTmp[job.SrcIndex];
+    const ImFontConfig& cfg = ctx->Atlas->ConfigData[job.SrcIndex];
+
+    // Distance fields are the slow part of building such an atlas, which is why they are generated here as well
+    if (ctx->Atlas->Flags & ImFontAtlasFlags_DistanceField)
+    {
+        const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src_tmp.FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src_tmp.FontInfo, -cfg.SizePixels);
+        for (int glyph_i = job.GlyphBegin; glyph_i < job.GlyphEnd; glyph_i++)
+        {
+            const stbrp_rect& r = src_tmp.Rects[glyph_i];
+            if (r.was_packed)
+                ImFontAtlasBuildRenderGlyphDistanceField(ctx->Atlas, &src_tmp.FontInfo, stbtt_FindGlyphIndex(&src_tmp.FontInfo, src_tmp.GlyphsList[glyph_i]), scale, r.x, r.y, &src_tmp.PackedChars[glyph_i]);
+        }
+        return;
+    }
+
+    stbtt_pack_context spc = *ctx->Spc;
+    stbtt_pack_range range = src_tmp.PackRange;
+    range.array_of_unicode_codepoints = src_tmp.GlyphsList.Data + job.GlyphBegin;
+    range.num_chars = job.GlyphEnd - job.GlyphBegin;
+    range.chardata_for_range = src_tmp.PackedChars + job.GlyphBegin;
+    stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &range, 1, src_tmp.Rects + job.GlyphBegin);
+
+    // Apply multiply operator
+    if (cfg.RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
+        stbrp_rect* r = &src_tmp.Rects[job.GlyphBegin];
+        for (int glyph_i = job.GlyphBegin; glyph_i < job.GlyphEnd; glyph_i++, r++)
+            if (r->was_packed)
+                ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, ctx->Atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, ctx->Atlas->TexWidth * 1);
+    }
+}
+
 static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
+{
+    return ImFontAtlasBuildWithStbTruetypeEx(atlas, NULL, NULL);
+}
+
+bool ImFontAtlasBuildWithStbTruetypeEx(ImFontAtlas* atlas, ImFontAtlasParallelForFunc parallel_for, void* parallel_for_user_data)
 {
     IM_ASSERT(atlas->ConfigData.Size > 0);
+    if (parallel_for == NULL)
+        parallel_for = ImFontAtlasBuildParallelForSerial;
 
     ImFontAtlasBuildInit(atlas);
 
@@ -2437,7 +3186,7 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     memset(buf_packedchars.Data, 0, (size_t)buf_packedchars.size_in_bytes());
 
     // 4. Gather glyphs sizes so we can pack them in our virtual canvas.
-    int total_surface = 0;
+    ImVector<ImFontBuildJob> jobs;
     int buf_rects_out_n = 0;
     int buf_packedchars_out_n = 0;
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
@@ -2461,20 +3210,17 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
         src_tmp.PackRange.h_oversample = (unsigned char)cfg.OversampleH;
         src_tmp.PackRange.v_oversample = (unsigned char)cfg.OversampleV;
 
-        // Gather the sizes of all rectangles we will need to pack (this loop is based on stbtt_PackFontRangesGatherRects)
-        const float scale = (cfg.SizePixels > 0) ? stbtt_ScaleForPixelHeight(&src_tmp.FontInfo, cfg.SizePixels) : stbtt_ScaleForMappingEmToPixels(&src_tmp.FontInfo, -cfg.SizePixels);
-        const int padding = atlas->TexGlyphPadding;
-        for (int glyph_i = 0; glyph_i < src_tmp.GlyphsList.Size; glyph_i++)
+        for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i += IM_FONTATLAS_BUILD_JOB_GLYPHS)
         {
-            int x0, y0, x1, y1;
-            const int glyph_index_in_font = stbtt_FindGlyphIndex(&src_tmp.FontInfo, src_tmp.GlyphsList[glyph_i]);
-            IM_ASSERT(glyph_index_in_font != 0);
-            stbtt_GetGlyphBitmapBoxSubpixel(&src_tmp.FontInfo, glyph_index_in_font, scale * cfg.OversampleH, scale * cfg.OversampleV, 0, 0, &x0, &y0, &x1, &y1);
-            src_tmp.Rects[glyph_i].w = (stbrp_coord)(x1 - x0 + padding + cfg.OversampleH - 1);
-            src_tmp.Rects[glyph_i].h = (stbrp_coord)(y1 - y0 + padding + cfg.OversampleV - 1);
-            total_surface += src_tmp.Rects[glyph_i].w * src_tmp.Rects[glyph_i].h;
+            ImFontBuildJob job = { src_i, glyph_i, ImMin(glyph_i + IM_FONTATLAS_BUILD_JOB_GLYPHS, src_tmp.GlyphsCount) };
+            jobs.push_back(job);
         }
     }
+    ImFontBuildJobContext job_ctx = { atlas, src_tmp_array.Data, jobs.Data, NULL };
+    parallel_for(jobs.Size, ImFontAtlasBuildGatherJob, &job_ctx, parallel_for_user_data);
+    int total_surface = 0;
+    for (int rect_i = 0; rect_i < buf_rects_out_n; rect_i++)
+        total_surface += buf_rects[rect_i].w * buf_rects[rect_i].h;
 
     // We need a width for the skyline algorithm, any width!
     // The exact width doesn't really matter much, but some API/GPU have texture size limitations and increasing width can decrease height.
@@ -2518,27 +3264,10 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     spc.height = atlas->TexHeight;
 
     // 8. Render/rasterize font characters into the texture
+    job_ctx.Spc = &spc;
+    parallel_for(jobs.Size, ImFontAtlasBuildRenderJob, &job_ctx, parallel_for_user_data);
     for (int src_i = 0; src_i < src_tmp_array.Size; src_i++)
-    {
-        ImFontConfig& cfg = atlas->ConfigData[src_i];
-        ImFontBuildSrcData& src_tmp = src_tmp_array[src_i];
-        if (src_tmp.GlyphsCount == 0)
-            continue;
-
-        stbtt_PackFontRangesRenderIntoRects(&spc, &src_tmp.FontInfo, &src_tmp.PackRange, 1, src_tmp.Rects);
-
-        // Apply multiply operator
-        if (cfg.RasterizerMultiply != 1.0f)
-        {
-            unsigned char multiply_table[256];
-            ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg.RasterizerMultiply);
-            stbrp_rect* r = &src_tmp.Rects[0];
-            for (int glyph_i = 0; glyph_i < src_tmp.GlyphsCount; glyph_i++, r++)
-                if (r->was_packed)
-                    ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, r->x, r->y, r->w, r->h, atlas->TexWidth * 1);
-        }
-        src_tmp.Rects = NULL;
-    }
+        src_tmp_array[src_i].Rects = NULL;
 
     // End packing
     stbtt_PackEnd(&spc);
@@ -2586,6 +3315,92 @@ static bool ImFontAtlasBuildWithStbTruetype(ImFontAtlas* atlas)
     return true;
 }
 
+static void ImFontGlyphSetup(ImFontGlyph& glyph, const ImFontConfig* cfg, ImWchar codepoint, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, float advance_x);
+
+static bool ImFontAtlasBuildInitGlyphStbTruetype(const ImFontConfig* cfg, ImWchar codepoint, stbtt_fontinfo* out_info, int* out_glyph_index)
+{
+    const int font_offset = stbtt_GetFontOffsetForIndex((unsigned char*)cfg->FontData, cfg->FontNo);
+    if (font_offset < 0 || !stbtt_InitFont(out_info, (unsigned char*)cfg->FontData, font_offset))
+        return false;
+    *out_glyph_index = stbtt_FindGlyphIndex(out_info, codepoint);
+    return *out_glyph_index != 0;
+}
+
+// Single glyph versions of the gather and render steps above, for glyph caches that rasterize into reserved atlas space on demand.
+// The rect includes TexGlyphPadding, pixels and metrics come out exactly as ImFontAtlasBuildWithStbTruetype() would make them.
+bool ImFontAtlasBuildMeasureGlyphStbTruetype(ImFontAtlas* atlas, const ImFontConfig* cfg, ImWchar codepoint, int* out_w, int* out_h)
+{
+    stbtt_fontinfo font_info;
+    int glyph_index_in_font;
+    if (!ImFontAtlasBuildInitGlyphStbTruetype(cfg, codepoint, &font_info, &glyph_index_in_font))
+        return false;
+    const float scale = (cfg->SizePixels > 0) ? stbtt_ScaleForPixelHeight(&font_info, cfg->SizePixels) : stbtt_ScaleForMappingEmToPixels(&font_info, -cfg->SizePixels);
+    ImFontAtlasBuildGlyphRectSize(atlas, *cfg, &font_info, glyph_index_in_font, scale, out_w, out_h);
+    return true;
+}
+
+void ImFontAtlasBuildRenderGlyphStbTruetype(ImFontAtlas* atlas, const ImFont* font, const ImFontConfig* cfg, ImWchar codepoint, int x, int y, ImFontGlyph* out_glyph)
+{
+    stbtt_fontinfo font_info;
+    int glyph_index_in_font;
+    int w, h;
+    if (!ImFontAtlasBuildInitGlyphStbTruetype(cfg, codepoint, &font_info, &glyph_index_in_font) || !ImFontAtlasBuildMeasureGlyphStbTruetype(atlas, cfg, codepoint, &w, &h))
+    {
+        IM_ASSERT(0 && "Measure the glyph first!");
+        return;
+    }
+    IM_ASSERT(x >= 0 && y >= 0 && x + w <= atlas->TexWidth && y + h <= atlas->TexHeight);
+
+    // The rect may hold an older glyph, padding included
+    const int stride = atlas->TexWidth;
+    for (int row = 0; row < h; row++)
+        memset(atlas->TexPixelsAlpha8 + (y + row) * stride + x, 0, w);
+
+    const float font_off_x = cfg->GlyphOffset.x;
+    const float font_off_y = cfg->GlyphOffset.y + IM_ROUND(font->Ascent);
+    if (atlas->Flags & ImFontAtlasFlags_DistanceField)
+    {
+        const float scale = (cfg->SizePixels > 0) ? stbtt_ScaleForPixelHeight(&font_info, cfg->SizePixels) : stbtt_ScaleForMappingEmToPixels(&font_info, -cfg->SizePixels);
+        stbtt_packedchar pc;
+        stbtt_aligned_quad q;
+        float unused_x = 0.0f, unused_y = 0.0f;
+        ImFontAtlasBuildRenderGlyphDistanceField(atlas, &font_info, glyph_index_in_font, scale, x, y, &pc);
+        stbtt_GetPackedQuad(&pc, atlas->TexWidth, atlas->TexHeight, 0, &unused_x, &unused_y, &q, 0);
+        ImFontGlyphSetup(*out_glyph, cfg, codepoint, q.x0 + font_off_x, q.y0 + font_off_y, q.x1 + font_off_x, q.y1 + font_off_y, q.s0, q.t0, q.s1, q.t1, pc.xadvance);
+        return;
+    }
+
+    // Same as stbtt_PackFontRangesRenderIntoRects(): padding goes on the left and top
+    const int pad = atlas->TexGlyphPadding;
+    const int oversample_h = cfg->OversampleH, oversample_v = cfg->OversampleV;
+    const float scale = (cfg->SizePixels > 0) ? stbtt_ScaleForPixelHeight(&font_info, cfg->SizePixels) : stbtt_ScaleForMappingEmToPixels(&font_info, -cfg->SizePixels);
+    const int rx = x + pad, ry = y + pad, rw = w - pad, rh = h - pad;
+    int advance, lsb, x0, y0, x1, y1;
+    stbtt_GetGlyphHMetrics(&font_info, glyph_index_in_font, &advance, &lsb);
+    stbtt_GetGlyphBitmapBox(&font_info, glyph_index_in_font, scale * oversample_h, scale * oversample_v, &x0, &y0, &x1, &y1);
+    unsigned char* pixels = atlas->TexPixelsAlpha8 + rx + ry * stride;
+    stbtt_MakeGlyphBitmapSubpixel(&font_info, pixels, rw - oversample_h + 1, rh - oversample_v + 1, stride, scale * oversample_h, scale * oversample_v, 0, 0, glyph_index_in_font);
+    if (oversample_h > 1)
+        stbtt__h_prefilter(pixels, rw, rh, stride, oversample_h);
+    if (oversample_v > 1)
+        stbtt__v_prefilter(pixels, rw, rh, stride, oversample_v);
+    if (cfg->RasterizerMultiply != 1.0f)
+    {
+        unsigned char multiply_table[256];
+        ImFontAtlasBuildMultiplyCalcLookupTable(multiply_table, cfg->RasterizerMultiply);
+        ImFontAtlasBuildMultiplyRectAlpha8(multiply_table, atlas->TexPixelsAlpha8, rx, ry, rw, rh, stride);
+    }
+
+    // Same as stbtt_GetPackedQuad() + the glyph registration at the end of ImFontAtlasBuildWithStbTruetype()
+    const float recip_h = 1.0f / oversample_h, recip_v = 1.0f / oversample_v;
+    const float sub_x = stbtt__oversample_shift(oversample_h), sub_y = stbtt__oversample_shift(oversample_v);
+    const float ipw = 1.0f / atlas->TexWidth, iph = 1.0f / atlas->TexHeight;
+    const float q_x0 = (float)x0 * recip_h + sub_x, q_y0 = (float)y0 * recip_v + sub_y;
+    const float q_x1 = (x0 + rw) * recip_h + sub_x, q_y1 = (y0 + rh) * recip_v + sub_y;
+    ImFontGlyphSetup(*out_glyph, cfg, codepoint, q_x0 + font_off_x, q_y0 + font_off_y, q_x1 + font_off_x, q_y1 + font_off_y,
+        rx * ipw, ry * iph, (rx + rw) * ipw, (ry + rh) * iph, scale * advance);
+}
+
 const ImFontBuilderIO* ImFontAtlasGetBuilderForStbTruetype()
 {
     static ImFontBuilderIO io;
@@ -2699,7 +3514,7 @@ static void ImFontAtlasBuildRenderDefaultTexData(ImFontAtlas* atlas)
 
 static void ImFontAtlasBuildRenderLinesTexData(ImFontAtlas* atlas)
 {
-    if (atlas->Flags & ImFontAtlasFlags_NoBakedLines)
+    if (atlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_DistanceField))
         return;
 
     // This generates a triangular shape in the texture, with the various line widths stacked on top of each other to allow interpolation between them
@@ -2764,7 +3579,7 @@ void ImFontAtlasBuildInit(ImFontAtlas* atlas)
     // The +2 here is to give space for the end caps, whilst height +1 is to accommodate the fact we have a zero-width row
     if (atlas->PackIdLines < 0)
     {
-        if (!(atlas->Flags & ImFontAtlasFlags_NoBakedLines))
+        if (!(atlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_DistanceField)))
             atlas->PackIdLines = atlas->AddCustomRectRegular(IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 2, IM_DRAWLIST_TEX_LINES_WIDTH_MAX + 1);
     }
 }
@@ -3122,6 +3937,8 @@ ImFont::ImFont()
     Ascent = Descent = 0.0f;
     MetricsTotalSurface = 0;
     memset(Used4kPagesMap, 0, sizeof(Used4kPagesMap));
+    GlyphLoadFunc = NULL;
+    GlyphLoadUserData = NULL;
 }
 
 ImFont::~ImFont()
@@ -3254,7 +4071,7 @@ void ImFont::GrowIndex(int new_size)
 // x0/y0/x1/y1 are offset from the character upper-left layout position, in pixels. Therefore x0/y0 are often fairly close to zero.
 // Not to be mistaken with texture coordinates, which are held by u0/v0/u1/v1 in normalized format (0.0..1.0 on each texture axis).
 // 'cfg' is not necessarily == 'this->ConfigData' because multiple source fonts+configs can be used to build one target font.
-void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, float advance_x)
+static void ImFontGlyphSetup(ImFontGlyph& glyph, const ImFontConfig* cfg, ImWchar codepoint, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, float advance_x)
 {
     if (cfg != NULL)
     {
@@ -3276,8 +4093,6 @@ void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, floa
         advance_x += cfg->GlyphExtraSpacing.x;
     }
 
-    Glyphs.resize(Glyphs.Size + 1);
-    ImFontGlyph& glyph = Glyphs.back();
     glyph.Codepoint = (unsigned int)codepoint;
     glyph.Visible = (x0 != x1) && (y0 != y1);
     glyph.Colored = false;
@@ -3290,6 +4105,13 @@ void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, floa
     glyph.U1 = u1;
     glyph.V1 = v1;
     glyph.AdvanceX = advance_x;
+}
+
+void ImFont::AddGlyph(const ImFontConfig* cfg, ImWchar codepoint, float x0, float y0, float x1, float y1, float u0, float v0, float u1, float v1, float advance_x)
+{
+    Glyphs.resize(Glyphs.Size + 1);
+    ImFontGlyph& glyph = Glyphs.back();
+    ImFontGlyphSetup(glyph, cfg, codepoint, x0, y0, x1, y1, u0, v0, u1, v1, advance_x);
 
     // Compute rough surface usage metrics (+1 to account for average padding, +0.99 to round)
     // We use (U1-U0)*TexWidth instead of X1-X0 to account for oversampling.
@@ -3313,24 +4135,33 @@ void ImFont::AddRemapChar(ImWchar dst, ImWchar src, bool overwrite_dst)
     IndexAdvanceX[dst] = (src < index_size) ? IndexAdvanceX.Data[src] : 1.0f;
 }
 
-const ImFontGlyph* ImFont::FindGlyph(ImWchar c) const
+// Codepoints beyond the index or without a glyph: loaded by GlyphLoadFunc, or the fallback glyph
+const ImFontGlyph* ImFont::FindGlyphSlow(ImWchar c) const
 {
-    if (c >= (size_t)IndexLookup.Size)
-        return FallbackGlyph;
-    const ImWchar i = IndexLookup.Data[c];
-    if (i == (ImWchar)-1)
-        return FallbackGlyph;
-    return &Glyphs.Data[i];
+    if (GlyphLoadFunc != NULL)
+        if (const ImFontGlyph* glyph = GlyphLoadFunc(const_cast<ImFont*>(this), c, GlyphLoadUserData))
+            return glyph;
+    return FallbackGlyph;
 }
 
 const ImFontGlyph* ImFont::FindGlyphNoFallback(ImWchar c) const
 {
-    if (c >= (size_t)IndexLookup.Size)
-        return NULL;
-    const ImWchar i = IndexLookup.Data[c];
-    if (i == (ImWchar)-1)
-        return NULL;
-    return &Glyphs.Data[i];
+    if (c < (size_t)IndexLookup.Size)
+    {
+        const ImWchar i = IndexLookup.Data[c];
+        if (i != (ImWchar)-1)
+            return &Glyphs.Data[i];
+    }
+    if (GlyphLoadFunc != NULL)
+        return GlyphLoadFunc(const_cast<ImFont*>(this), c, GlyphLoadUserData);
+    return NULL;
+}
+
+// Codepoints beyond the index, or not loaded yet by GlyphLoadFunc
+float ImFont::GetCharAdvanceSlow(ImWchar c) const
+{
+    const ImFontGlyph* glyph = (GlyphLoadFunc != NULL) ? FindGlyphNoFallback(c) : NULL;
+    return glyph ? glyph->AdvanceX : FallbackAdvanceX;
 }
 
 // Wrapping skips upcoming blanks
@@ -3376,7 +4207,7 @@ const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const c
         if (c < 0x80)
             next_s = s + 1;
         else
-            next_s = s + ImTextCharFromUtf8(&c, s, text_end);
+            next_s = s + ImTextCharFromUtf8Multibyte(&c, s, text_end);
         if (c == 0)
             break;
 
@@ -3396,7 +4227,7 @@ const char* ImFont::CalcWordWrapPositionA(float scale, const char* text, const c
             }
         }
 
-        const float char_width = ((int)c < IndexAdvanceX.Size ? IndexAdvanceX.Data[c] : FallbackAdvanceX);
+        const float char_width = GetCharAdvance((ImWchar)c);
         if (ImCharIsBlankW(c))
         {
             if (inside_word)
@@ -3480,6 +4311,26 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
             }
         }
 
+        // Printable ASCII up to the next control character, multi-byte sequence or wrap point: no decoding, and advances
+        // straight from the index (a negative one is a glyph GlyphLoadFunc hasn't loaded yet, see GetCharAdvance()).
+        // The sum stays serial so sizes are bit-identical, which bounds this loop by float add latency: cores that
+        // already hide the decoding behind that chain gain little from it.
+        if ((signed char)*s >= 32 && IndexAdvanceX.Size >= 0x80)
+        {
+            const char* run_end = word_wrap_enabled ? word_wrap_eol : text_end;
+            for (; s < run_end && (signed char)*s >= 32; s++)
+            {
+                const float advance_x = IndexAdvanceX.Data[(unsigned char)*s];
+                const float char_width = (advance_x >= 0.0f ? advance_x : GetCharAdvanceSlow((ImWchar)*s)) * scale;
+                if (line_width + char_width >= max_width)
+                    break;
+                line_width += char_width;
+            }
+            if (s < run_end && (signed char)*s >= 32) // Stopped by max_width
+                break;
+            continue;
+        }
+
         // Decode and advance source
         const char* prev_s = s;
         unsigned int c = (unsigned int)*s;
@@ -3489,7 +4340,7 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
         }
         else
         {
-            s += ImTextCharFromUtf8(&c, s, text_end);
+            s += ImTextCharFromUtf8Multibyte(&c, s, text_end);
             if (c == 0) // Malformed UTF-8?
                 break;
         }
@@ -3507,7 +4358,7 @@ ImVec2 ImFont::CalcTextSizeA(float size, float max_width, float wrap_width, cons
                 continue;
         }
 
-        const float char_width = ((int)c < IndexAdvanceX.Size ? IndexAdvanceX.Data[c] : FallbackAdvanceX) * scale;
+        const float char_width = GetCharAdvance((ImWchar)c) * scale;
         if (line_width + char_width >= max_width)
         {
             s = prev_s;
@@ -3550,6 +4401,12 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
     if (!text_end)
         text_end = text_begin + strlen(text_begin); // ImGui:: functions generally already provides a valid text_end, so this is merely to handle direct calls.
 
+    // Text drawn in earlier frames: draw its glyphs without decoding and looking them up again
+    if (ImTextLayoutCache* cache = draw_list->_Data->TextLayoutCache)
+        if (ImTextLayout* layout = cache->GetLayout(this, size, wrap_width, text_begin, text_end))
+            if (cache->RenderLayout(layout, draw_list, pos, col, clip_rect, text_begin, text_end, cpu_fine_clip))
+                return;
+
     // Align to be pixel perfect
     float x = IM_FLOOR(pos.x);
     float y = IM_FLOOR(pos.y);
@@ -3639,7 +4496,7 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
         }
         else
         {
-            s += ImTextCharFromUtf8(&c, s, text_end);
+            s += ImTextCharFromUtf8Multibyte(&c, s, text_end);
             if (c == 0) // Malformed UTF-8?
                 break;
         }
@@ -3737,6 +4594,349 @@ void ImFont::RenderText(ImDrawList* draw_list, float size, const ImVec2& pos, Im
     draw_list->_VtxCurrentIdx = vtx_current_idx;
 }
 
+//-----------------------------------------------------------------------------
+// [SECTION] ImTextLayoutCache
+//-----------------------------------------------------------------------------
+
+// 8 bytes at a time with a multiply, cheaper than the CRC32 of ImHashData() on the short text of a UI.
+// Only used for lookups where the text is compared as well.
+static ImGuiID ImTextLayoutHash(const char* text, size_t text_length, ImU64 seed)
+{
+    const ImU64 k = 0x9E3779B97F4A7C15ULL;
+    ImU64 h = (seed ^ text_length) * k;
+    ImU64 word;
+    for (; text_length >= 8; text += 8, text_length -= 8)
+    {
+        memcpy(&word, text, 8);
+        h = (h ^ word) * k;
+        h ^= h >> 32;
+    }
+    word = 0;
+    memcpy(&word, text, text_length);
+    h = (h ^ word) * k;
+    h ^= h >> 29;
+    return (ImGuiID)(h ^ (h >> 32));
+}
+
+void ImTextLayoutCache::Clear()
+{
+    Layouts.clear_destruct();
+    FreeLayouts.clear();
+    Buckets.clear();
+    AliveCount = MemoryBytes = 0;
+    LastLayoutIdx = -1;
+    Stats = StatsLastFrame = ImTextLayoutCacheStats();
+}
+
+void ImTextLayoutCache::Rehash(int bucket_count)
+{
+    Buckets.resize(bucket_count);
+    for (Bucket& bucket : Buckets)
+        bucket.Index = -1;
+    const int mask = bucket_count - 1;
+    for (int n = 0; n < Layouts.Size; n++)
+        if (Layouts.Data[n].Font != NULL)
+        {
+            int i = (int)(Layouts.Data[n].Key & mask);
+            while (Buckets.Data[i].Index != -1)
+                i = (i + 1) & mask;
+            Buckets.Data[i].Key = Layouts.Data[n].Key;
+            Buckets.Data[i].Index = n;
+        }
+}
+
+void ImTextLayoutCache::NewFrame(int frame_count)
+{
+    FrameCount = frame_count;
+    LastLayoutIdx = -1;
+    StatsLastFrame = Stats;
+    Stats = ImTextLayoutCacheStats();
+    if (frame_count % IM_TEXT_LAYOUT_CACHE_SWEEP_FRAMES == 0)
+    {
+        // Free the slots of layouts not used recently (keeping their buffers for the next ones), and rebuild the table without them
+        MemoryBytes = Layouts.Capacity * (int)sizeof(ImTextLayout) + FreeLayouts.Capacity * (int)sizeof(int) + Buckets.Capacity * (int)sizeof(Bucket);
+        for (int n = 0; n < Layouts.Size; n++)
+        {
+            ImTextLayout* layout = &Layouts.Data[n];
+            MemoryBytes += layout->Text.Capacity + layout->Glyphs.Capacity * (int)sizeof(ImTextLayoutGlyph);
+            if (layout->Font != NULL && layout->LastUsedFrame < frame_count - IM_TEXT_LAYOUT_CACHE_FRAMES)
+            {
+                layout->Font = NULL;
+                FreeLayouts.push_back(n);
+                AliveCount--;
+                Stats.Evicted++;
+            }
+        }
+        if (Stats.Evicted > 0)
+            Rehash(Buckets.Size);
+    }
+    Stats.Layouts = AliveCount;
+    Stats.MemoryBytes = MemoryBytes;
+}
+
+ImTextLayout* ImTextLayoutCache::GetLayout(const ImFont* font, float size, float wrap_width, const char* text_begin, const char* text_end)
+{
+    if (!text_end)
+        text_end = text_begin + strlen(text_begin);
+    const int text_length = (int)(text_end - text_begin);
+    if (text_length == 0 || text_length > IM_TEXT_LAYOUT_CACHE_MAX_LENGTH || font->GlyphLoadFunc != NULL)
+        return NULL;
+
+    // Same text as the last call (e.g. measured, now drawn)
+    if (LastLayoutIdx != -1 && LastText == text_begin)
+    {
+        ImTextLayout* layout = &Layouts.Data[LastLayoutIdx];
+        if (layout->Font == font && layout->Size == size && layout->WrapWidth == wrap_width && layout->Text.Size == text_length && memcmp(layout->Text.Data, text_begin, (size_t)text_length) == 0)
+            return layout;
+    }
+
+    ImU32 size_bits, wrap_width_bits;
+    memcpy(&size_bits, &size, sizeof(size_bits));
+    memcpy(&wrap_width_bits, &wrap_width, sizeof(wrap_width_bits));
+    const ImU64 seed = (ImU64)(size_t)font ^ ((ImU64)size_bits << 32 | wrap_width_bits);
+    const ImGuiID key = ImTextLayoutHash(text_begin, (size_t)text_length, seed);
+    if ((AliveCount + 1) * 2 > Buckets.Size)
+        Rehash(Buckets.Size > 0 ? Buckets.Size * 2 : 256);
+
+    const int mask = Buckets.Size - 1;
+    int i = (int)(key & mask);
+    while (Buckets.Data[i].Index != -1 && Buckets.Data[i].Key != key)
+        i = (i + 1) & mask;
+    ImTextLayout* layout;
+    if (Buckets.Data[i].Index != -1)
+    {
+        layout = &Layouts.Data[Buckets.Data[i].Index];
+    }
+    else
+    {
+        if (FreeLayouts.Size > 0)
+        {
+            Buckets.Data[i].Index = FreeLayouts.back();
+            FreeLayouts.pop_back();
+        }
+        else
+        {
+            Buckets.Data[i].Index = Layouts.Size;
+            Layouts.push_back(ImTextLayout());
+        }
+        Buckets.Data[i].Key = key;
+        layout = &Layouts.Data[Buckets.Data[i].Index];
+        layout->Key = key;
+        AliveCount++;
+    }
+
+    if (layout->Font != font || layout->Size != size || layout->WrapWidth != wrap_width || layout->Text.Size != text_length || memcmp(layout->Text.Data, text_begin, (size_t)text_length) != 0)
+    {
+        // New, or another text with the same hash which we replace
+        layout->Font = font;
+        layout->Size = size;
+        layout->WrapWidth = wrap_width;
+        layout->Text.resize(text_length);
+        memcpy(layout->Text.Data, text_begin, (size_t)text_length);
+        layout->FirstUsedFrame = FrameCount;
+        layout->HasTextSize = layout->HasGlyphs = false;
+        layout->Glyphs.resize(0);
+    }
+    layout->LastUsedFrame = FrameCount;
+    LastLayoutIdx = (int)(layout - Layouts.Data);
+    LastText = text_begin;
+    return layout;
+}
+
+// Everything ImFont::RenderText() does to the text before positioning glyphs
+static void ImTextLayoutBuildGlyphs(ImTextLayout* layout, const char* text_begin, const char* text_end)
+{
+    const ImFont* font = layout->Font;
+    const float scale = layout->Size / font->FontSize;
+    const float wrap_width = layout->WrapWidth;
+    const bool word_wrap_enabled = (wrap_width > 0.0f);
+    const char* word_wrap_eol = NULL;
+    float line_width = 0.0f;
+    layout->Glyphs.resize(0);
+    layout->Glyphs.reserve((int)(text_end - text_begin));
+
+    ImTextLayoutGlyph layout_glyph;
+    const char* s = text_begin;
+    while (s < text_end)
+    {
+        if (word_wrap_enabled)
+        {
+            if (!word_wrap_eol)
+                word_wrap_eol = font->CalcWordWrapPositionA(scale, s, text_end, wrap_width - line_width);
+
+            if (s >= word_wrap_eol)
+            {
+                layout_glyph.AdvanceX = 0.0f;
+                layout_glyph.Index = ImTextLayoutGlyphIndex_WrapLine;
+                layout->Glyphs.push_back(layout_glyph);
+                line_width = 0.0f;
+                word_wrap_eol = NULL;
+                s = CalcWordWrapNextLineStartA(s, text_end); // Wrapping skips upcoming blanks
+                continue;
+            }
+        }
+
+        unsigned int c = (unsigned int)*s;
+        if (c < 0x80)
+        {
+            s += 1;
+        }
+        else
+        {
+            s += ImTextCharFromUtf8Multibyte(&c, s, text_end);
+            if (c == 0) // Malformed UTF-8?
+                break;
+        }
+
+        if (c < 32)
+        {
+            if (c == '\n')
+            {
+                layout_glyph.AdvanceX = 0.0f;
+                layout_glyph.Index = ImTextLayoutGlyphIndex_NewLine;
+                layout->Glyphs.push_back(layout_glyph);
+                line_width = 0.0f;
+                continue;
+            }
+            if (c == '\r')
+                continue;
+        }
+
+        const ImFontGlyph* glyph = font->FindGlyph((ImWchar)c);
+        if (glyph == NULL)
+            continue;
+
+        layout_glyph.AdvanceX = glyph->AdvanceX * scale;
+        layout_glyph.Index = glyph->Visible ? (int)(glyph - font->Glyphs.Data) : ImTextLayoutGlyphIndex_Invisible;
+        layout->Glyphs.push_back(layout_glyph);
+        line_width += layout_glyph.AdvanceX;
+    }
+    layout->HasGlyphs = true;
+}
+
+// Same as the loop of ImFont::RenderText(), from the layout's glyphs
+bool ImTextLayoutCache::RenderLayout(ImTextLayout* layout, ImDrawList* draw_list, const ImVec2& pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, bool cpu_fine_clip)
+{
+    // Text seen for the first time this frame may well be different in the next one: don't spend more on it yet
+    if (!layout->HasGlyphs && layout->FirstUsedFrame == FrameCount)
+    {
+        Stats.RenderMisses++;
+        return false;
+    }
+
+    const ImFont* font = layout->Font;
+    float x = IM_FLOOR(pos.x);
+    float y = IM_FLOOR(pos.y);
+    if (y > clip_rect.w)
+    {
+        Stats.RenderHits++;
+        return true;
+    }
+    const float start_x = x;
+    const float scale = layout->Size / font->FontSize;
+    const float line_height = font->FontSize * scale;
+    if (y + line_height < clip_rect.y)
+    {
+        Stats.RenderClipped++;
+        return false;
+    }
+    if (!layout->HasGlyphs)
+        ImTextLayoutBuildGlyphs(layout, text_begin, text_end);
+    Stats.RenderHits++;
+
+    const int vtx_count_max = (int)(text_end - text_begin) * 4;
+    const int idx_count_max = (int)(text_end - text_begin) * 6;
+    const int idx_expected_size = draw_list->IdxBuffer.Size + idx_count_max;
+    draw_list->PrimReserve(idx_count_max, vtx_count_max);
+
+    ImDrawVert* vtx_write = draw_list->_VtxWritePtr;
+    ImDrawIdx* idx_write = draw_list->_IdxWritePtr;
+    unsigned int vtx_current_idx = draw_list->_VtxCurrentIdx;
+
+    const ImU32 col_untinted = col | ~IM_COL32_A_MASK;
+    const ImFontGlyph* glyphs = font->Glyphs.Data;
+    const ImTextLayoutGlyph* layout_glyph_end = layout->Glyphs.Data + layout->Glyphs.Size;
+    for (const ImTextLayoutGlyph* layout_glyph = layout->Glyphs.Data; layout_glyph < layout_glyph_end; layout_glyph++)
+    {
+        if (layout_glyph->Index < 0)
+        {
+            if (layout_glyph->Index == ImTextLayoutGlyphIndex_Invisible)
+            {
+                x += layout_glyph->AdvanceX;
+                continue;
+            }
+            x = start_x;
+            y += line_height;
+            if (layout_glyph->Index == ImTextLayoutGlyphIndex_NewLine && y > clip_rect.w)
+                break;
+            continue;
+        }
+
+        const ImFontGlyph* glyph = &glyphs[layout_glyph->Index];
+        const float char_width = layout_glyph->AdvanceX;
+        float x1 = x + glyph->X0 * scale;
+        float x2 = x + glyph->X1 * scale;
+        float y1 = y + glyph->Y0 * scale;
+        float y2 = y + glyph->Y1 * scale;
+        if (x1 <= clip_rect.z && x2 >= clip_rect.x)
+        {
+            float u1 = glyph->U0;
+            float v1 = glyph->V0;
+            float u2 = glyph->U1;
+            float v2 = glyph->V1;
+
+            if (cpu_fine_clip)
+            {
+                if (x1 < clip_rect.x)
+                {
+                    u1 = u1 + (1.0f - (x2 - clip_rect.x) / (x2 - x1)) * (u2 - u1);
+                    x1 = clip_rect.x;
+                }
+                if (y1 < clip_rect.y)
+                {
+                    v1 = v1 + (1.0f - (y2 - clip_rect.y) / (y2 - y1)) * (v2 - v1);
+                    y1 = clip_rect.y;
+                }
+                if (x2 > clip_rect.z)
+                {
+                    u2 = u1 + ((clip_rect.z - x1) / (x2 - x1)) * (u2 - u1);
+                    x2 = clip_rect.z;
+                }
+                if (y2 > clip_rect.w)
+                {
+                    v2 = v1 + ((clip_rect.w - y1) / (y2 - y1)) * (v2 - v1);
+                    y2 = clip_rect.w;
+                }
+                if (y1 >= y2)
+                {
+                    x += char_width;
+                    continue;
+                }
+            }
+
+            ImU32 glyph_col = glyph->Colored ? col_untinted : col;
+            idx_write[0] = (ImDrawIdx)(vtx_current_idx); idx_write[1] = (ImDrawIdx)(vtx_current_idx+1); idx_write[2] = (ImDrawIdx)(vtx_current_idx+2);
+            idx_write[3] = (ImDrawIdx)(vtx_current_idx); idx_write[4] = (ImDrawIdx)(vtx_current_idx+2); idx_write[5] = (ImDrawIdx)(vtx_current_idx+3);
+            vtx_write[0].pos.x = x1; vtx_write[0].pos.y = y1; vtx_write[0].col = glyph_col; vtx_write[0].uv.x = u1; vtx_write[0].uv.y = v1;
+            vtx_write[1].pos.x = x2; vtx_write[1].pos.y = y1; vtx_write[1].col = glyph_col; vtx_write[1].uv.x = u2; vtx_write[1].uv.y = v1;
+            vtx_write[2].pos.x = x2; vtx_write[2].pos.y = y2; vtx_write[2].col = glyph_col; vtx_write[2].uv.x = u2; vtx_write[2].uv.y = v2;
+            vtx_write[3].pos.x = x1; vtx_write[3].pos.y = y2; vtx_write[3].col = glyph_col; vtx_write[3].uv.x = u1; vtx_write[3].uv.y = v2;
+            vtx_write += 4;
+            vtx_current_idx += 4;
+            idx_write += 6;
+        }
+        x += char_width;
+    }
+
+    draw_list->VtxBuffer.Size = (int)(vtx_write - draw_list->VtxBuffer.Data);
+    draw_list->IdxBuffer.Size = (int)(idx_write - draw_list->IdxBuffer.Data);
+    draw_list->CmdBuffer[draw_list->CmdBuffer.Size - 1].ElemCount -= (idx_expected_size - draw_list->IdxBuffer.Size);
+    draw_list->_VtxWritePtr = vtx_write;
+    draw_list->_IdxWritePtr = idx_write;
+    draw_list->_VtxCurrentIdx = vtx_current_idx;
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 // [SECTION] ImGui Internal Render Helpers
 //-----------------------------------------------------------------------------
@@ -4,6 +4,9 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'D3D12_GPU_DESCRIPTOR_HANDLE' as ImTextureID. Read the FAQ about ImTextureID!
 //  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: 16-bit or 32-bit indices chosen per draw list, so lists over 64k vertices draw in one call (see ImDrawIdxPacking).
+//  [X] Renderer: Adjacent compatible draw commands merged, also across draw lists, and redundant state changes skipped (see ImDrawSubmission).
+//  [X] Renderer: Distance field fonts (io.Fonts->Flags |= ImFontAtlasFlags_DistanceField).
 
 // Important: to compile on 32-bit systems, this backend requires code to be compiled with '#define ImTextureID ImU64'.
 // This is because we need ImTextureID to carry a 64-bit value and by default ImTextureID is defined as void*.
@@ -20,6 +23,11 @@
 
 // CHANGELOG
 // (minor and older changes stripped away, please see git history for details)
+//  2026-10-17: DirectX12: Submit draws from an ImDrawSubmission: merge adjacent commands that draw the same, also across draw lists, and only set the scissor rect, texture, pipeline and index buffer when they change. Added ImGui_ImplDX12_GetSubmissionStats().
+//  2026-10-17: DirectX12: Upload each draw list's indices as 16-bit or 32-bit, whichever addresses all its vertices, and draw the commands of lists over 64k vertices without splitting them at VtxOffset changes.
+//  2026-10-17: DirectX12: Draw the font texture with a distance field pixel shader when the atlas is built with ImFontAtlasFlags_DistanceField.
+//  2026-10-17: DirectX12: Added ImGui_ImplDX12_UpdateFontsTexture() to copy changed rects of the font atlas (e.g. glyphs loaded on demand) into the font texture.
+//  2026-10-17: DirectX12: Added ImGui_ImplDX12_SetUploadAllocator() to suballocate vertex/index data from a persistently mapped upload buffer.
 //  2022-10-11: Using 'nullptr' instead of 'NULL' as per our switch to C++11.
 //  2021-06-29: Reorganized backend to pull data from a single structure to facilitate usage with multiple-contexts (all g_XXXX access changed to bd->XXXX).
 //  2021-05-19: DirectX12: Replaced direct access to ImDrawCmd::TextureId with a call to ImDrawCmd::GetTexID(). (will become a requirement)
@@ -54,7 +62,7 @@ struct ImGui_ImplDX12_RenderBuffers
 {
     ID3D12Resource*     IndexBuffer;
     ID3D12Resource*     VertexBuffer;
-    int                 IndexBufferSize;
+    int                 IndexBufferSize;        // In bytes, 16-bit and 32-bit indices share it (see ImDrawIdxPacking)
     int                 VertexBufferSize;
 };
 
@@ -63,6 +71,7 @@ struct ImGui_ImplDX12_Data
     ID3D12Device*                   pd3dDevice;
     ID3D12RootSignature*            pRootSignature;
     ID3D12PipelineState*            pPipelineState;
+    ID3D12PipelineState*            pDistanceFieldPipelineState;
     DXGI_FORMAT                     RTVFormat;
     ID3D12Resource*                 pFontTextureResource;
     D3D12_CPU_DESCRIPTOR_HANDLE     hFontSrvCpuDescHandle;
@@ -72,9 +81,23 @@ struct ImGui_ImplDX12_Data
     UINT                            numFramesInFlight;
     UINT                            frameIndex;
 
+    ImGui_ImplDX12_AllocUploadFunc  UploadAllocFunc;
+    void*                           UploadAllocUserData;
+    ImDrawSubmission                Submission;     // Of the frame being rendered, kept to reuse its buffers
+
     ImGui_ImplDX12_Data()           { memset((void*)this, 0, sizeof(*this)); frameIndex = UINT_MAX; }
 };
 
+// Where this frame's vertices/indices live on the GPU
+struct ImGui_ImplDX12_GeometryViews
+{
+    D3D12_GPU_VIRTUAL_ADDRESS   VertexBufferAddress;
+    UINT                        VertexBufferSize;
+    D3D12_GPU_VIRTUAL_ADDRESS   IndexBufferAddress;
+    UINT                        IndexBufferSize;
+    UINT                        Index32ByteOffset;  // Where the 32-bit indices start, the 16-bit ones are at 0
+};
+
 struct VERTEX_CONSTANT_BUFFER_DX12
 {
     float   mvp[4][4];
@@ -88,7 +111,18 @@ static ImGui_ImplDX12_Data* ImGui_ImplDX12_GetBackendData()
 }
 
 // Functions
-static void ImGui_ImplDX12_SetupRenderState(ImDrawData* draw_data, ID3D12GraphicsCommandList* ctx, ImGui_ImplDX12_RenderBuffers* fr)
+static void ImGui_ImplDX12_SetIndexBuffer(ID3D12GraphicsCommandList* ctx, const ImGui_ImplDX12_GeometryViews* views, bool idx32)
+{
+    const UINT offset = idx32 ? views->Index32ByteOffset : 0;
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    memset(&ibv, 0, sizeof(D3D12_INDEX_BUFFER_VIEW));
+    ibv.BufferLocation = views->IndexBufferAddress + offset;
+    ibv.SizeInBytes = views->IndexBufferSize - offset;
+    ibv.Format = idx32 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+    ctx->IASetIndexBuffer(&ibv);
+}
+
+static void ImGui_ImplDX12_SetupRenderState(ImDrawData* draw_data, ID3D12GraphicsCommandList* ctx, const ImGui_ImplDX12_GeometryViews* views)
 {
     ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
 
@@ -122,19 +156,13 @@ static void ImGui_ImplDX12_SetupRenderState(ImDrawData* draw_data, ID3D12Graphic
 
     // Bind shader and vertex buffers
     unsigned int stride = sizeof(ImDrawVert);
-    unsigned int offset = 0;
     D3D12_VERTEX_BUFFER_VIEW vbv;
     memset(&vbv, 0, sizeof(D3D12_VERTEX_BUFFER_VIEW));
-    vbv.BufferLocation = fr->VertexBuffer->GetGPUVirtualAddress() + offset;
-    vbv.SizeInBytes = fr->VertexBufferSize * stride;
+    vbv.BufferLocation = views->VertexBufferAddress;
+    vbv.SizeInBytes = views->VertexBufferSize;
     vbv.StrideInBytes = stride;
     ctx->IASetVertexBuffers(0, 1, &vbv);
-    D3D12_INDEX_BUFFER_VIEW ibv;
-    memset(&ibv, 0, sizeof(D3D12_INDEX_BUFFER_VIEW));
-    ibv.BufferLocation = fr->IndexBuffer->GetGPUVirtualAddress();
-    ibv.SizeInBytes = fr->IndexBufferSize * sizeof(ImDrawIdx);
-    ibv.Format = sizeof(ImDrawIdx) == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
-    ctx->IASetIndexBuffer(&ibv);
+    ImGui_ImplDX12_SetIndexBuffer(ctx, views, false);
     ctx->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     ctx->SetPipelineState(bd->pPipelineState);
     ctx->SetGraphicsRootSignature(bd->pRootSignature);
@@ -166,117 +194,174 @@ void ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandL
     bd->frameIndex = bd->frameIndex + 1;
     ImGui_ImplDX12_RenderBuffers* fr = &bd->pFrameResources[bd->frameIndex % bd->numFramesInFlight];
 
-    // Create and grow vertex/index buffers if needed
-    if (fr->VertexBuffer == nullptr || fr->VertexBufferSize < draw_data->TotalVtxCount)
+    // Draw calls with adjacent compatible commands merged, and their 16-bit or 32-bit indices
+    ImDrawSubmission& submission = bd->Submission;
+    submission.Build(draw_data);
+    const ImDrawIdxPacking& packing = submission.Packing;
+
+    // Try the user provided upload allocator first: no resource creation and no Map/Unmap in the common case
+    ImGui_ImplDX12_GeometryViews views;
+    ImDrawVert* vtx_dst = nullptr;
+    void* idx_dst = nullptr;
+    bool uploaded_to_allocator = false;
+    if (bd->UploadAllocFunc != nullptr)
     {
-        SafeRelease(fr->VertexBuffer);
-        fr->VertexBufferSize = draw_data->TotalVtxCount + 5000;
-        D3D12_HEAP_PROPERTIES props;
-        memset(&props, 0, sizeof(D3D12_HEAP_PROPERTIES));
-        props.Type = D3D12_HEAP_TYPE_UPLOAD;
-        props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        D3D12_RESOURCE_DESC desc;
-        memset(&desc, 0, sizeof(D3D12_RESOURCE_DESC));
-        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        desc.Width = fr->VertexBufferSize * sizeof(ImDrawVert);
-        desc.Height = 1;
-        desc.DepthOrArraySize = 1;
-        desc.MipLevels = 1;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.SampleDesc.Count = 1;
-        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-        if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->VertexBuffer)) < 0)
-            return;
+        void* vtx_resource, *idx_resource;
+        unsigned long long vtx_gpu_address, idx_gpu_address;
+        size_t vtx_size = (size_t)draw_data->TotalVtxCount * sizeof(ImDrawVert);
+        size_t idx_size = packing.TotalBytes;
+        // If only the vertex allocation succeeds it is simply wasted until the allocator recycles this frame
+        if (bd->UploadAllocFunc(bd->UploadAllocUserData, vtx_size, 16, &vtx_resource, &vtx_gpu_address) &&
+            bd->UploadAllocFunc(bd->UploadAllocUserData, idx_size, 16, &idx_resource, &idx_gpu_address))
+        {
+            vtx_dst = (ImDrawVert*)vtx_resource;
+            idx_dst = idx_resource;
+            views.VertexBufferAddress = vtx_gpu_address;
+            views.VertexBufferSize = (UINT)vtx_size;
+            views.IndexBufferAddress = idx_gpu_address;
+            views.IndexBufferSize = (UINT)idx_size;
+            uploaded_to_allocator = true;
+        }
     }
-    if (fr->IndexBuffer == nullptr || fr->IndexBufferSize < draw_data->TotalIdxCount)
+
+    D3D12_RANGE range;
+    memset(&range, 0, sizeof(D3D12_RANGE));
+    if (!uploaded_to_allocator)
     {
-        SafeRelease(fr->IndexBuffer);
-        fr->IndexBufferSize = draw_data->TotalIdxCount + 10000;
-        D3D12_HEAP_PROPERTIES props;
-        memset(&props, 0, sizeof(D3D12_HEAP_PROPERTIES));
-        props.Type = D3D12_HEAP_TYPE_UPLOAD;
-        props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
-        props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
-        D3D12_RESOURCE_DESC desc;
-        memset(&desc, 0, sizeof(D3D12_RESOURCE_DESC));
-        desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
-        desc.Width = fr->IndexBufferSize * sizeof(ImDrawIdx);
-        desc.Height = 1;
-        desc.DepthOrArraySize = 1;
-        desc.MipLevels = 1;
-        desc.Format = DXGI_FORMAT_UNKNOWN;
-        desc.SampleDesc.Count = 1;
-        desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
-        desc.Flags = D3D12_RESOURCE_FLAG_NONE;
-        if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->IndexBuffer)) < 0)
+        // Create and grow vertex/index buffers if needed
+        if (fr->VertexBuffer == nullptr || fr->VertexBufferSize < draw_data->TotalVtxCount)
+        {
+            SafeRelease(fr->VertexBuffer);
+            fr->VertexBufferSize = draw_data->TotalVtxCount + 5000;
+            D3D12_HEAP_PROPERTIES props;
+            memset(&props, 0, sizeof(D3D12_HEAP_PROPERTIES));
+            props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            D3D12_RESOURCE_DESC desc;
+            memset(&desc, 0, sizeof(D3D12_RESOURCE_DESC));
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Width = fr->VertexBufferSize * sizeof(ImDrawVert);
+            desc.Height = 1;
+            desc.DepthOrArraySize = 1;
+            desc.MipLevels = 1;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.SampleDesc.Count = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->VertexBuffer)) < 0)
+                return;
+        }
+        if (fr->IndexBuffer == nullptr || (size_t)fr->IndexBufferSize < packing.TotalBytes)
+        {
+            SafeRelease(fr->IndexBuffer);
+            fr->IndexBufferSize = (int)(packing.TotalBytes + 10000 * sizeof(ImDrawIdx));
+            D3D12_HEAP_PROPERTIES props;
+            memset(&props, 0, sizeof(D3D12_HEAP_PROPERTIES));
+            props.Type = D3D12_HEAP_TYPE_UPLOAD;
+            props.CPUPageProperty = D3D12_CPU_PAGE_PROPERTY_UNKNOWN;
+            props.MemoryPoolPreference = D3D12_MEMORY_POOL_UNKNOWN;
+            D3D12_RESOURCE_DESC desc;
+            memset(&desc, 0, sizeof(D3D12_RESOURCE_DESC));
+            desc.Dimension = D3D12_RESOURCE_DIMENSION_BUFFER;
+            desc.Width = fr->IndexBufferSize;
+            desc.Height = 1;
+            desc.DepthOrArraySize = 1;
+            desc.MipLevels = 1;
+            desc.Format = DXGI_FORMAT_UNKNOWN;
+            desc.SampleDesc.Count = 1;
+            desc.Layout = D3D12_TEXTURE_LAYOUT_ROW_MAJOR;
+            desc.Flags = D3D12_RESOURCE_FLAG_NONE;
+            if (bd->pd3dDevice->CreateCommittedResource(&props, D3D12_HEAP_FLAG_NONE, &desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&fr->IndexBuffer)) < 0)
+                return;
+        }
+
+        void* vtx_resource, *idx_resource;
+        if (fr->VertexBuffer->Map(0, &range, &vtx_resource) != S_OK)
             return;
+        if (fr->IndexBuffer->Map(0, &range, &idx_resource) != S_OK)
+            return;
+        vtx_dst = (ImDrawVert*)vtx_resource;
+        idx_dst = idx_resource;
+        views.VertexBufferAddress = fr->VertexBuffer->GetGPUVirtualAddress();
+        views.VertexBufferSize = fr->VertexBufferSize * sizeof(ImDrawVert);
+        views.IndexBufferAddress = fr->IndexBuffer->GetGPUVirtualAddress();
+        views.IndexBufferSize = fr->IndexBufferSize;
     }
+    views.Index32ByteOffset = (UINT)packing.Idx32ByteOffset;
 
     // Upload vertex/index data into a single contiguous GPU buffer
-    void* vtx_resource, *idx_resource;
-    D3D12_RANGE range;
-    memset(&range, 0, sizeof(D3D12_RANGE));
-    if (fr->VertexBuffer->Map(0, &range, &vtx_resource) != S_OK)
-        return;
-    if (fr->IndexBuffer->Map(0, &range, &idx_resource) != S_OK)
-        return;
-    ImDrawVert* vtx_dst = (ImDrawVert*)vtx_resource;
-    ImDrawIdx* idx_dst = (ImDrawIdx*)idx_resource;
     for (int n = 0; n < draw_data->CmdListsCount; n++)
     {
         const ImDrawList* cmd_list = draw_data->CmdLists[n];
         memcpy(vtx_dst, cmd_list->VtxBuffer.Data, cmd_list->VtxBuffer.Size * sizeof(ImDrawVert));
-        memcpy(idx_dst, cmd_list->IdxBuffer.Data, cmd_list->IdxBuffer.Size * sizeof(ImDrawIdx));
         vtx_dst += cmd_list->VtxBuffer.Size;
-        idx_dst += cmd_list->IdxBuffer.Size;
     }
-    fr->VertexBuffer->Unmap(0, &range);
-    fr->IndexBuffer->Unmap(0, &range);
+    draw_data->PackIndices(packing, idx_dst);
+    if (!uploaded_to_allocator)
+    {
+        fr->VertexBuffer->Unmap(0, &range);
+        fr->IndexBuffer->Unmap(0, &range);
+    }
 
     // Setup desired DX state
-    ImGui_ImplDX12_SetupRenderState(draw_data, ctx, fr);
+    ImGui_ImplDX12_SetupRenderState(draw_data, ctx, &views);
 
     // Render command lists
-    // (Because we merged all buffers into a single one, we maintain our own offset into them)
-    int global_vtx_offset = 0;
-    int global_idx_offset = 0;
-    ImVec2 clip_off = draw_data->DisplayPos;
-    for (int n = 0; n < draw_data->CmdListsCount; n++)
+    // (Because we merged all buffers into a single one, draws carry their base vertex in it. Only state that changes is set.)
+    const bool font_distance_field = (ImGui::GetIO().Fonts->Flags & ImFontAtlasFlags_DistanceField) != 0;
+    bool distance_field_bound = false;
+    bool idx32_bound = false;
+    bool state_bound = false;   // Texture and scissor rect below were set by us (callbacks may change them)
+    D3D12_GPU_DESCRIPTOR_HANDLE texture_bound = {};
+    D3D12_RECT scissor_bound = {};
+    for (int draw_i = 0; draw_i < submission.Cmds.Size; draw_i++)
     {
-        const ImDrawList* cmd_list = draw_data->CmdLists[n];
-        for (int cmd_i = 0; cmd_i < cmd_list->CmdBuffer.Size; cmd_i++)
+        const ImDrawSubmitCmd* draw = &submission.Cmds[draw_i];
+        if (draw->Cmd->UserCallback != nullptr)
         {
-            const ImDrawCmd* pcmd = &cmd_list->CmdBuffer[cmd_i];
-            if (pcmd->UserCallback != nullptr)
+            // User callback, registered via ImDrawList::AddCallback()
+            // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
+            if (draw->Cmd->UserCallback == ImDrawCallback_ResetRenderState)
             {
-                // User callback, registered via ImDrawList::AddCallback()
-                // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
-                if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
-                    ImGui_ImplDX12_SetupRenderState(draw_data, ctx, fr);
-                else
-                    pcmd->UserCallback(cmd_list, pcmd);
+                ImGui_ImplDX12_SetupRenderState(draw_data, ctx, &views);
+                distance_field_bound = false;
+                idx32_bound = false;
             }
             else
+                draw->Cmd->UserCallback(draw->CmdList, draw->Cmd);
+            state_bound = false;
+            continue;
+        }
+
+        if (draw->Idx32 != idx32_bound)
+        {
+            ImGui_ImplDX12_SetIndexBuffer(ctx, &views, draw->Idx32);
+            idx32_bound = draw->Idx32;
+        }
+
+        // Bind texture (and the pipeline that samples it), apply scissor/clipping rectangle, draw
+        D3D12_GPU_DESCRIPTOR_HANDLE texture_handle = {};
+        texture_handle.ptr = (UINT64)draw->TextureId;
+        if (!state_bound || texture_handle.ptr != texture_bound.ptr)
+        {
+            const bool distance_field = font_distance_field && texture_handle.ptr == bd->hFontSrvGpuDescHandle.ptr;
+            if (distance_field != distance_field_bound)
             {
-                // Project scissor/clipping rectangles into framebuffer space
-                ImVec2 clip_min(pcmd->ClipRect.x - clip_off.x, pcmd->ClipRect.y - clip_off.y);
-                ImVec2 clip_max(pcmd->ClipRect.z - clip_off.x, pcmd->ClipRect.w - clip_off.y);
-                if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
-                    continue;
-
-                // Apply Scissor/clipping rectangle, Bind texture, Draw
-                const D3D12_RECT r = { (LONG)clip_min.x, (LONG)clip_min.y, (LONG)clip_max.x, (LONG)clip_max.y };
-                D3D12_GPU_DESCRIPTOR_HANDLE texture_handle = {};
-                texture_handle.ptr = (UINT64)pcmd->GetTexID();
-                ctx->SetGraphicsRootDescriptorTable(1, texture_handle);
-                ctx->RSSetScissorRects(1, &r);
-                ctx->DrawIndexedInstanced(pcmd->ElemCount, 1, pcmd->IdxOffset + global_idx_offset, pcmd->VtxOffset + global_vtx_offset, 0);
+                ctx->SetPipelineState(distance_field ? bd->pDistanceFieldPipelineState : bd->pPipelineState);
+                distance_field_bound = distance_field;
             }
+            ctx->SetGraphicsRootDescriptorTable(1, texture_handle);
+            texture_bound = texture_handle;
+        }
+        const D3D12_RECT r = { (LONG)draw->ClipRect[0], (LONG)draw->ClipRect[1], (LONG)draw->ClipRect[2], (LONG)draw->ClipRect[3] };
+        if (!state_bound || memcmp(&r, &scissor_bound, sizeof(r)) != 0)
+        {
+            ctx->RSSetScissorRects(1, &r);
+            scissor_bound = r;
         }
-        global_idx_offset += cmd_list->IdxBuffer.Size;
-        global_vtx_offset += cmd_list->VtxBuffer.Size;
+        state_bound = true;
+        ctx->DrawIndexedInstanced(draw->ElemCount, 1, draw->IdxOffset, draw->VtxOffset, 0);
     }
 }
 
@@ -547,6 +632,7 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
 
     ID3DBlob* vertexShaderBlob;
     ID3DBlob* pixelShaderBlob;
+    ID3DBlob* distanceFieldPixelShaderBlob;
 
     // Create the vertex shader
     {
@@ -616,6 +702,32 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
             return false; // NB: Pass ID3DBlob* pErrorBlob to D3DCompile() to get error showing in (const char*)pErrorBlob->GetBufferPointer(). Make sure to Release() the blob!
         }
         psoDesc.PS = { pixelShaderBlob->GetBufferPointer(), pixelShaderBlob->GetBufferSize() };
+
+        // Fonts built with ImFontAtlasFlags_DistanceField: alpha is a distance to the glyph outline (0.5 = IM_FONT_DISTANCE_FIELD_ON_EDGE / 255 on it),
+        // turned into coverage over one pixel whatever the glyph is scaled to. The white pixel and other atlas data are 0 or 1 and stay that way.
+        static const char* distanceFieldPixelShader =
+            "struct PS_INPUT\
+            {\
+              float4 pos : SV_POSITION;\
+              float4 col : COLOR0;\
+              float2 uv  : TEXCOORD0;\
+            };\
+            SamplerState sampler0 : register(s0);\
+            Texture2D texture0 : register(t0);\
+            \
+            float4 main(PS_INPUT input) : SV_Target\
+            {\
+              float4 texel = texture0.Sample(sampler0, input.uv); \
+              texel.a = saturate((texel.a - 128.0 / 255.0) / max(fwidth(texel.a), 1e-5) + 0.5); \
+              return input.col * texel; \
+            }";
+
+        if (FAILED(D3DCompile(distanceFieldPixelShader, strlen(distanceFieldPixelShader), nullptr, nullptr, nullptr, "main", "ps_5_0", 0, 0, &distanceFieldPixelShaderBlob, nullptr)))
+        {
+            vertexShaderBlob->Release();
+            pixelShaderBlob->Release();
+            return false;
+        }
     }
 
     // Create the blending setup
@@ -661,8 +773,14 @@ bool    ImGui_ImplDX12_CreateDeviceObjects()
     }
 
     HRESULT result_pipeline_state = bd->pd3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&bd->pPipelineState));
+    if (result_pipeline_state == S_OK)
+    {
+        psoDesc.PS = { distanceFieldPixelShaderBlob->GetBufferPointer(), distanceFieldPixelShaderBlob->GetBufferSize() };
+        result_pipeline_state = bd->pd3dDevice->CreateGraphicsPipelineState(&psoDesc, IID_PPV_ARGS(&bd->pDistanceFieldPipelineState));
+    }
     vertexShaderBlob->Release();
     pixelShaderBlob->Release();
+    distanceFieldPixelShaderBlob->Release();
     if (result_pipeline_state != S_OK)
         return false;
 
@@ -680,6 +798,7 @@ void    ImGui_ImplDX12_InvalidateDeviceObjects()
 
     SafeRelease(bd->pRootSignature);
     SafeRelease(bd->pPipelineState);
+    SafeRelease(bd->pDistanceFieldPipelineState);
     SafeRelease(bd->pFontTextureResource);
     io.Fonts->SetTexID(0); // We copied bd->pFontTextureView to io.Fonts->TexID so let's clear that as well.
 
@@ -718,7 +837,7 @@ bool ImGui_ImplDX12_Init(ID3D12Device* device, int num_frames_in_flight, DXGI_FO
         ImGui_ImplDX12_RenderBuffers* fr = &bd->pFrameResources[i];
         fr->IndexBuffer = nullptr;
         fr->VertexBuffer = nullptr;
-        fr->IndexBufferSize = 10000;
+        fr->IndexBufferSize = (int)(10000 * sizeof(ImDrawIdx));
         fr->VertexBufferSize = 5000;
     }
 
@@ -738,6 +857,59 @@ void ImGui_ImplDX12_Shutdown()
     IM_DELETE(bd);
 }
 
+void ImGui_ImplDX12_SetUploadAllocator(ImGui_ImplDX12_AllocUploadFunc alloc_func, void* user_data)
+{
+    ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplDX12_Init()?");
+    bd->UploadAllocFunc = alloc_func;
+    bd->UploadAllocUserData = user_data;
+}
+
+const ImDrawSubmissionStats* ImGui_ImplDX12_GetSubmissionStats()
+{
+    ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplDX12_Init()?");
+    return &bd->Submission.Stats;
+}
+
+void ImGui_ImplDX12_UpdateFontsTexture(ID3D12GraphicsCommandList* ctx, ID3D12Resource* upload_buffer, unsigned long long upload_offset, unsigned int upload_row_pitch, int x, int y, int width, int height)
+{
+    ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Did you call ImGui_ImplDX12_Init()?");
+    IM_ASSERT((upload_offset % D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) == 0 && (upload_row_pitch % D3D12_TEXTURE_DATA_PITCH_ALIGNMENT) == 0);
+    if (bd->pFontTextureResource == nullptr || width <= 0 || height <= 0)
+        return;
+
+    D3D12_TEXTURE_COPY_LOCATION srcLocation = {};
+    srcLocation.pResource = upload_buffer;
+    srcLocation.Type = D3D12_TEXTURE_COPY_TYPE_PLACED_FOOTPRINT;
+    srcLocation.PlacedFootprint.Offset = upload_offset;
+    srcLocation.PlacedFootprint.Footprint.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    srcLocation.PlacedFootprint.Footprint.Width = width;
+    srcLocation.PlacedFootprint.Footprint.Height = height;
+    srcLocation.PlacedFootprint.Footprint.Depth = 1;
+    srcLocation.PlacedFootprint.Footprint.RowPitch = upload_row_pitch;
+
+    D3D12_TEXTURE_COPY_LOCATION dstLocation = {};
+    dstLocation.pResource = bd->pFontTextureResource;
+    dstLocation.Type = D3D12_TEXTURE_COPY_TYPE_SUBRESOURCE_INDEX;
+    dstLocation.SubresourceIndex = 0;
+
+    // The texture lives in the pixel shader resource state between frames
+    D3D12_RESOURCE_BARRIER barrier = {};
+    barrier.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    barrier.Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+    barrier.Transition.pResource   = bd->pFontTextureResource;
+    barrier.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    barrier.Transition.StateAfter  = D3D12_RESOURCE_STATE_COPY_DEST;
+    ctx->ResourceBarrier(1, &barrier);
+    ctx->CopyTextureRegion(&dstLocation, (UINT)x, (UINT)y, 0, &srcLocation, nullptr);
+    barrier.Transition.StateBefore = D3D12_RESOURCE_STATE_COPY_DEST;
+    barrier.Transition.StateAfter  = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE;
+    ctx->ResourceBarrier(1, &barrier);
+}
+
 void ImGui_ImplDX12_NewFrame()
 {
     ImGui_ImplDX12_Data* bd = ImGui_ImplDX12_GetBackendData();
@@ -4,6 +4,7 @@
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'D3D12_GPU_DESCRIPTOR_HANDLE' as ImTextureID. Read the FAQ about ImTextureID!
 //  [X] Renderer: Support for large meshes (64k+ vertices) with 16-bit indices.
+//  [X] Renderer: Distance field fonts (io.Fonts->Flags |= ImFontAtlasFlags_DistanceField).
 
 // Important: to compile on 32-bit systems, this backend requires code to be compiled with '#define ImTextureID ImU64'.
 // See imgui_impl_dx12.cpp file for details.
@@ -20,6 +21,7 @@
 struct ID3D12Device;
 struct ID3D12DescriptorHeap;
 struct ID3D12GraphicsCommandList;
+struct ID3D12Resource;
 struct D3D12_CPU_DESCRIPTOR_HANDLE;
 struct D3D12_GPU_DESCRIPTOR_HANDLE;
 
@@ -33,6 +35,23 @@ IMGUI_IMPL_API void     ImGui_ImplDX12_Shutdown();
 IMGUI_IMPL_API void     ImGui_ImplDX12_NewFrame();
 IMGUI_IMPL_API void     ImGui_ImplDX12_RenderDrawData(ImDrawData* draw_data, ID3D12GraphicsCommandList* graphics_command_list);
 
+// Optional: suballocate the per-frame vertex/index data from a caller owned, persistently mapped upload buffer
+// (e.g. a ring buffer shared by all frames in flight) instead of the backend's own per-frame buffers.
+// The allocator must keep the memory alive until the GPU has consumed the frame. Return false when out of space,
+// the backend then falls back to its own buffers for that frame. Pass nullptr to go back to the default behavior.
+typedef bool (*ImGui_ImplDX12_AllocUploadFunc)(void* user_data, size_t size, size_t alignment, void** out_cpu_address, unsigned long long* out_gpu_address);
+IMGUI_IMPL_API void     ImGui_ImplDX12_SetUploadAllocator(ImGui_ImplDX12_AllocUploadFunc alloc_func, void* user_data);
+
+// Optional: copy a changed rect of the font atlas (e.g. glyphs rasterized on demand) into the font texture. The caller writes
+// the RGBA32 rows to 'upload_buffer' at 'upload_offset' (D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT) with 'upload_row_pitch'
+// (D3D12_TEXTURE_DATA_PITCH_ALIGNMENT), and keeps the buffer alive until the GPU is done with cmd_list. Record it before
+// the draws that sample the new pixels.
+IMGUI_IMPL_API void     ImGui_ImplDX12_UpdateFontsTexture(ID3D12GraphicsCommandList* graphics_command_list, ID3D12Resource* upload_buffer, unsigned long long upload_offset,
+                                                          unsigned int upload_row_pitch, int x, int y, int width, int height);
+
+// Optional: draw calls and render state changes of the last ImGui_ImplDX12_RenderDrawData(), after merging adjacent compatible commands.
+IMGUI_IMPL_API const ImDrawSubmissionStats* ImGui_ImplDX12_GetSubmissionStats();
+
 // Use if you want to reset your rendering device without losing Dear ImGui state.
 IMGUI_IMPL_API void     ImGui_ImplDX12_InvalidateDeviceObjects();
 IMGUI_IMPL_API bool     ImGui_ImplDX12_CreateDeviceObjects();
@@ -114,6 +114,7 @@ Index of this file:
 struct ImBitVector;                 // Store 1-bit per value
 struct ImRect;                      // An axis-aligned rectangle (2 points)
 struct ImDrawDataBuilder;           // Helper to build a ImDrawData instance
+struct ImDrawListMemoryInfo;        // Buffer sizes, capacities and growths of one draw list, see GetDrawListMemoryStats()
 struct ImDrawListSharedData;        // Data shared between all ImDrawList instances
 struct ImGuiColorMod;               // Stacked color modifier, backup of modified data so we can restore it
 struct ImGuiContext;                // Main Dear ImGui context
@@ -145,6 +146,7 @@ struct ImGuiTableColumnsSettings;   // Storage for a column .ini settings
 struct ImGuiWindow;                 // Storage for one window
 struct ImGuiWindowTempData;         // Temporary storage for one window (that's the data which in theory we could ditch at the end of the frame, in practice we currently keep it for each window)
 struct ImGuiWindowSettings;         // Storage for a window .ini settings (we keep one of those even if the actual window wasn't instanced during this session)
+struct ImTextLayoutCache;           // Text measurements and glyphs kept between frames for CalcTextSize()/RenderText()
 
 // Enumerations
 // Use your programming IDE "Go to definition" facility on the names of the center columns to find the actual flags/enum lists.
@@ -368,8 +370,30 @@ IMGUI_API int           ImTextStrToUtf8(char* out_buf, int out_buf_size, const I
 IMGUI_API int           ImTextCharFromUtf8(unsigned int* out_char, const char* in_text, const char* in_text_end);               // read one character. return input UTF-8 bytes count
 IMGUI_API int           ImTextStrFromUtf8(ImWchar* out_buf, int out_buf_size, const char* in_text, const char* in_text_end, const char** in_remaining = NULL);   // return input UTF-8 bytes count
 IMGUI_API int           ImTextCountCharsFromUtf8(const char* in_text, const char* in_text_end);                                 // return number of UTF-8 code-points (NOT bytes count)
+IMGUI_API int           ImTextCountAsciiChars(const char* in_text, const char* in_text_end);                                    // return number of leading ASCII characters except 0 (which decode as themselves), 16 bytes at a time with SSE2/NEON
 IMGUI_API int           ImTextCountUtf8BytesFromChar(const char* in_text, const char* in_text_end);                             // return number of bytes to express one char in UTF-8
 IMGUI_API int           ImTextCountUtf8BytesFromStr(const ImWchar* in_text, const ImWchar* in_text_end);                        // return number of bytes to express string in UTF-8
+// Same result as ImTextCharFromUtf8() for a non-ASCII character (in_text_end can't be NULL), with the well-formed 2 and 3 byte sequences
+// (the rest of the Basic Multilingual Plane, e.g. CJK) decoded inline. Anything else, including every error case, goes to ImTextCharFromUtf8().
+static inline int       ImTextCharFromUtf8Multibyte(unsigned int* out_char, const char* in_text, const char* in_text_end)
+{
+    const unsigned char* s = (const unsigned char*)in_text;
+    if ((s[0] & 0xF0) == 0xE0 && in_text_end - in_text >= 3 && ((s[1] & 0xC0) | ((s[2] & 0xC0) >> 2)) == 0xA0)
+    {
+        const unsigned int c = ((s[0] & 0x0F) << 12) | ((s[1] & 0x3F) << 6) | (s[2] & 0x3F);
+        if (c >= 0x800 && (c & 0xF800) != 0xD800) // Not overlong, not a surrogate half
+        {
+            *out_char = c;
+            return 3;
+        }
+    }
+    else if (s[0] >= 0xC2 && s[0] < 0xE0 && in_text_end - in_text >= 2 && (s[1] & 0xC0) == 0x80) // 0xC0 and 0xC1 can only start overlong encodings
+    {
+        *out_char = ((s[0] & 0x1F) << 6) | (s[1] & 0x3F);
+        return 2;
+    }
+    return ImTextCharFromUtf8(out_char, in_text, in_text_end);
+}
 
 // Helpers: ImVec2/ImVec4 operators
 // We are keeping those disabled by default so they don't leak in user space, to allow user enabling implicit cast operators between ImVec2 and their own types (using IM_VEC2_CLASS_EXTRA etc.)
@@ -645,6 +669,44 @@ struct ImSpanAllocator
     inline void  GetSpan(int n, ImSpan<T>* span)    { span->set((T*)GetSpanPtrBegin(n), (T*)GetSpanPtrEnd(n)); }
 };
 
+// Helper: ImGuiHashStorage
+// Alternative backend to ImGuiStorage for large or insert-heavy key sets: open addressing over groups of 16 slots, with one control byte
+// per slot holding 7 bits of the key hash, so a whole group is probed with a single SSE2/NEON compare. New keys are O(1) amortized instead
+// of the O(N) shift of a sorted insertion. Same API and same pointer invalidation rules as ImGuiStorage, but slots are unordered:
+// use BuildSortedStorage() when ordered iteration is needed (e.g. to hand the pairs to code written against a sorted ImGuiStorage).
+#define IM_HASHSTORAGE_GROUP_SIZE       16
+#define IM_HASHSTORAGE_CTRL_EMPTY       0x80
+struct IMGUI_API ImGuiHashStorage
+{
+    ImVector<ImU8>                              Ctrl;       // One per slot: IM_HASHSTORAGE_CTRL_EMPTY, or the low 7 bits of the key hash
+    ImVector<ImGuiStorage::ImGuiStoragePair>    Slots;      // Size is a power of two, and a multiple of IM_HASHSTORAGE_GROUP_SIZE
+    int                                         Count;      // Number of used slots
+
+    ImGuiHashStorage()              { Count = 0; }
+    void            Clear()         { Ctrl.clear(); Slots.clear(); Count = 0; }
+    int             GetCount() const{ return Count; }
+    void            Reserve(int count);
+    int             GetInt(ImGuiID key, int default_val = 0) const;
+    void            SetInt(ImGuiID key, int val);
+    bool            GetBool(ImGuiID key, bool default_val = false) const;
+    void            SetBool(ImGuiID key, bool val);
+    float           GetFloat(ImGuiID key, float default_val = 0.0f) const;
+    void            SetFloat(ImGuiID key, float val);
+    void*           GetVoidPtr(ImGuiID key) const;
+    void            SetVoidPtr(ImGuiID key, void* val);
+    int*            GetIntRef(ImGuiID key, int default_val = 0);
+    bool*           GetBoolRef(ImGuiID key, bool default_val = false);
+    float*          GetFloatRef(ImGuiID key, float default_val = 0.0f);
+    void**          GetVoidPtrRef(ImGuiID key, void* default_val = NULL);
+    void            SetAllInt(int val);
+    void            BuildSortedStorage(ImGuiStorage* out) const;    // Copy all pairs into 'out', sorted by key
+
+    // [Internal]
+    ImGuiStorage::ImGuiStoragePair* FindPair(ImGuiID key) const;
+    ImGuiStorage::ImGuiStoragePair* GetOrAddPair(ImGuiID key, bool* p_added);
+    void            Rehash(int slot_count);
+};
+
 // Helper: ImPool<>
 // Basic keyed storage for contiguous instances, slow/amortized insertion, O(1) indexable, O(Log N) queries by ID over a dense/hot buffer,
 // Honor constructor/destructor. Add/remove invalidate all pointers. Indexes have the same lifetime as the associated object.
@@ -748,8 +810,14 @@ struct ImGuiTextIndex
 #endif
 #define IM_DRAWLIST_ARCFAST_SAMPLE_MAX                          IM_DRAWLIST_ARCFAST_TABLE_SIZE // Sample index _PathArcToFastEx() for 360 angle.
 
+// ImDrawSubmission: With merge_by_bounds, commands with more indices than this are merged only with commands of the same scissor rect, their bounds would cost more than a draw call.
+#ifndef IM_DRAW_SUBMIT_BOUNDS_MAX_ELEMS
+#define IM_DRAW_SUBMIT_BOUNDS_MAX_ELEMS                         4096
+#endif
+
 // Data shared between all ImDrawList instances
 // You may want to create your own instance of this if you want to use ImDrawList completely without ImGui. In that case, watch out for future changes to this structure.
+// Only read while draw lists are being filled (NewFrame() updates it), so lists sharing it can be filled on several threads at once.
 struct IMGUI_API ImDrawListSharedData
 {
     ImVec2          TexUvWhitePixel;            // UV of white pixel in the atlas
@@ -759,9 +827,8 @@ struct IMGUI_API ImDrawListSharedData
     float           CircleSegmentMaxError;      // Number of circle segments to use per pixel of radius for AddCircle() etc
     ImVec4          ClipRectFullscreen;         // Value for PushClipRectFullscreen()
     ImDrawListFlags InitialFlags;               // Initial flags at the beginning of the frame (it is possible to alter flags on a per-drawlist basis afterwards)
-
-    // [Internal] Temp write buffer
-    ImVector<ImVec2> TempBuffer;
+    bool            TessellationSimd;           // Use the SIMD version of the anti-aliased AddPolyline() path for long lines where available (default: true). The output is identical.
+    ImTextLayoutCache* TextLayoutCache;         // Used by ImFont::RenderText() and ImGui::CalcTextSize() when not NULL (see io.ConfigTextLayoutCache). Not thread-safe: must be NULL in data shared with lists filled on other threads.
 
     // [Internal] Lookup tables
     ImVec2          ArcFastVtx[IM_DRAWLIST_ARCFAST_TABLE_SIZE]; // Sample points on the quarter of the circle.
@@ -773,6 +840,92 @@ struct IMGUI_API ImDrawListSharedData
     void SetCircleTessellationMaxError(float max_error);
 };
 
+// ImTextLayoutCache: text measurements and glyphs kept from frame to frame
+#define IM_TEXT_LAYOUT_CACHE_FRAMES         30      // Layouts not used for this many frames are dropped...
+#define IM_TEXT_LAYOUT_CACHE_SWEEP_FRAMES   8       // ...by NewFrame() every this many frames
+#define IM_TEXT_LAYOUT_CACHE_MAX_LENGTH     1024    // Longer text (typically large buffers drawn with clipping) is never cached
+
+// A glyph of a text layout, in drawing order
+struct ImTextLayoutGlyph
+{
+    float               AdvanceX;           // Scaled
+    int                 Index;              // In ImFont::Glyphs, or one of ImTextLayoutGlyphIndex_
+};
+
+enum ImTextLayoutGlyphIndex_
+{
+    ImTextLayoutGlyphIndex_Invisible    = -1,   // Advances the pen only
+    ImTextLayoutGlyphIndex_NewLine      = -2,   // '\n'
+    ImTextLayoutGlyphIndex_WrapLine     = -3,   // Line break from word wrapping
+};
+
+// One text run for a given font, size and wrap width
+struct ImTextLayout
+{
+    const ImFont*       Font;               // NULL for free slots
+    float               Size;
+    float               WrapWidth;
+    ImGuiID             Key;
+    ImVector<char>      Text;               // Copy of the text, compared on lookup so hash collisions never draw the wrong text
+    int                 FirstUsedFrame;
+    int                 LastUsedFrame;
+    bool                HasTextSize;
+    bool                HasGlyphs;
+    ImVec2              TextSize;           // CalcTextSizeA(Size, FLT_MAX, WrapWidth) before rounding
+    ImVector<ImTextLayoutGlyph> Glyphs;     // What RenderText() would do for each character, once decoded, looked up and wrapped
+
+    ImTextLayout()      { Font = NULL; Size = WrapWidth = 0.0f; Key = 0; FirstUsedFrame = LastUsedFrame = -1; HasTextSize = HasGlyphs = false; }
+};
+
+struct ImTextLayoutCacheStats
+{
+    int                 Layouts;            // At the start of the frame
+    int                 MemoryBytes;        // Text, glyphs and tables, as of the last sweep
+    int                 MeasureHits;        // CalcTextSize() calls answered from the cache
+    int                 MeasureMisses;      // Text not measured before (text that can't be cached isn't counted, see ImTextLayoutCache)
+    int                 RenderHits;         // RenderText() calls drawing cached glyphs
+    int                 RenderMisses;       // RenderText() calls on text seen for the first time this frame
+    int                 RenderClipped;      // RenderText() calls on text starting above the clip rect, drawn the regular way
+    int                 Evicted;
+
+    ImTextLayoutCacheStats() { memset(this, 0, sizeof(*this)); }
+};
+
+// Keeps the measured size and the glyphs of text keyed by (font, size, wrap width, text), so text that is drawn again
+// in the next frames skips UTF-8 decoding, glyph lookups and word wrapping: CalcTextSize() returns the stored size and
+// RenderText() goes through the stored glyphs, positioning and clipping them as it would have.
+// - Glyphs are only laid out for text seen in an earlier frame, so text that changes every frame costs a hash and a lookup.
+// - The output is the same as without the cache. Word wrapping is decided once for all positions, so a word ending
+//   within float rounding of the wrap width could wrap differently than it would at a given position.
+// - Text starting above the clip rect is drawn the regular way, which skips the lines above it without laying them out.
+// - Fonts with a GlyphLoadFunc are not cached: glyphs loaded on demand can be evicted, and their loader needs to see the lookups.
+// - Call Clear() after rebuilding fonts.
+// Layouts are found through an open addressing table of their own: a lookup in a ImGuiStorage of this many entries
+// costs about as much as measuring a short text again.
+struct IMGUI_API ImTextLayoutCache
+{
+    struct Bucket { ImGuiID Key; int Index; };  // Index in Layouts, -1 if empty
+
+    ImVector<ImTextLayout>  Layouts;
+    ImVector<int>           FreeLayouts;
+    ImVector<Bucket>        Buckets;            // Power of two size, at most half full
+    int                     AliveCount;
+    int                     FrameCount;
+    int                     LastLayoutIdx;      // Last layout returned by GetLayout() and its text pointer: text measured then drawn costs a single lookup
+    const char*             LastText;
+    int                     MemoryBytes;
+    ImTextLayoutCacheStats  Stats;              // Counts for the current frame
+    ImTextLayoutCacheStats  StatsLastFrame;
+
+    ImTextLayoutCache()     { AliveCount = FrameCount = MemoryBytes = 0; LastLayoutIdx = -1; LastText = NULL; }
+    ~ImTextLayoutCache()    { Clear(); }
+    void                    Clear();
+    void                    NewFrame(int frame_count);
+    ImTextLayout*           GetLayout(const ImFont* font, float size, float wrap_width, const char* text_begin, const char* text_end); // NULL if the text can't be cached
+    bool                    RenderLayout(ImTextLayout* layout, ImDrawList* draw_list, const ImVec2& pos, ImU32 col, const ImVec4& clip_rect, const char* text_begin, const char* text_end, bool cpu_fine_clip); // False if the caller must render the text itself
+    void                    Rehash(int bucket_count);
+};
+
 struct ImDrawDataBuilder
 {
     ImVector<ImDrawList*>   Layers[2];           // Global layers for: regular, tooltip
@@ -783,6 +936,21 @@ struct ImDrawDataBuilder
     IMGUI_API void FlattenIntoSingleLayer();
 };
 
+// Memory of one draw list's buffers, see ImGui::GetDrawListMemoryStats(). High-water marks are the largest sizes a
+// frame ended with in the current retention period (io.ConfigDrawListShrinkDelay).
+struct ImDrawListMemoryInfo
+{
+    const char* Name;                   // Owner window name, or "##Background"/"##Foreground"
+    int         CmdSize, CmdCapacity, CmdHighWater;
+    int         IdxSize, IdxCapacity, IdxHighWater;
+    int         VtxSize, VtxCapacity, VtxHighWater;
+    size_t      CapacityBytes;          // Reserved by CmdBuffer, IdxBuffer and VtxBuffer
+    size_t      UsedBytes;
+    int         ReallocCount;           // Times the buffers had to grow since the list was created
+
+    ImDrawListMemoryInfo()  { memset(this, 0, sizeof(*this)); }
+};
+
 //-----------------------------------------------------------------------------
 // [SECTION] Widgets support: flags, enums, data structures
 //-----------------------------------------------------------------------------
@@ -1722,6 +1890,7 @@ struct ImGuiContext
     float                   FontSize;                           // (Shortcut) == FontBaseSize * g.CurrentWindow->FontWindowScale == window->FontSize(). Text height for current window.
     float                   FontBaseSize;                       // (Shortcut) == IO.FontGlobalScale * Font->Scale * Font->FontSize. Base text height.
     ImDrawListSharedData    DrawListSharedData;
+    ImTextLayoutCache       TextLayoutCache;                    // Used when io.ConfigTextLayoutCache is set, through DrawListSharedData.TextLayoutCache
     double                  Time;
     int                     FrameCount;
     int                     FrameCountEnded;
@@ -3113,6 +3282,8 @@ namespace ImGui
     IMGUI_API void          GcCompactTransientMiscBuffers();
     IMGUI_API void          GcCompactTransientWindowBuffers(ImGuiWindow* window);
     IMGUI_API void          GcAwakeTransientWindowBuffers(ImGuiWindow* window);
+    IMGUI_API void          GcRetainDrawListBuffers(ImDrawList* draw_list);     // Before a draw list is reset for a new frame: update its high-water marks and shrink it at the end of a period (io.ConfigDrawListRetainBuffers)
+    IMGUI_API void          GetDrawListMemoryStats(ImVector<ImDrawListMemoryInfo>* out_stats); // One entry per window and viewport draw list
 
     // Debug Log
     IMGUI_API void          DebugLog(const char* fmt, ...) IM_FMTARGS(1);
@@ -3177,9 +3348,15 @@ struct ImFontBuilderIO
     bool    (*FontBuilder_Build)(ImFontAtlas* atlas);
 };
 
+// Runs func(user_data, i) for every i in [0, count) and returns once all calls are done. The calls may run concurrently and in any order.
+typedef void (*ImFontAtlasParallelForFunc)(int count, void (*func)(void* user_data, int index), void* user_data, void* parallel_for_user_data);
+
 // Helper for font builder
 #ifdef IMGUI_ENABLE_STB_TRUETYPE
 IMGUI_API const ImFontBuilderIO* ImFontAtlasGetBuilderForStbTruetype();
+IMGUI_API bool      ImFontAtlasBuildWithStbTruetypeEx(ImFontAtlas* atlas, ImFontAtlasParallelForFunc parallel_for, void* parallel_for_user_data); // Measure and rasterize glyphs through 'parallel_for' (NULL = serial). Output is identical either way.
+IMGUI_API bool      ImFontAtlasBuildMeasureGlyphStbTruetype(ImFontAtlas* atlas, const ImFontConfig* cfg, ImWchar codepoint, int* out_w, int* out_h); // False if the source font has no such glyph. Size includes TexGlyphPadding.
+IMGUI_API void      ImFontAtlasBuildRenderGlyphStbTruetype(ImFontAtlas* atlas, const ImFont* font, const ImFontConfig* cfg, ImWchar codepoint, int x, int y, ImFontGlyph* out_glyph); // Rasterize into the measured rect of TexPixelsAlpha8 at x,y (for glyphs loaded on demand).
 #endif
 IMGUI_API void      ImFontAtlasBuildInit(ImFontAtlas* atlas);
 IMGUI_API void      ImFontAtlasBuildSetupFont(ImFontAtlas* atlas, ImFont* font, ImFontConfig* font_config, float ascent, float descent);
@@ -1,11 +1,378 @@
 #include <cstdint>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
 #include "App.h"
+#include "Benchmarks.h"
 
 int main(int argc, char* argv[])
 {
+    // Parse command line
+    // --headless [frames]: run the frame loop on the null graphics device and report CPU frame time
+    // --software: with --headless, draw frames using the software rasterizer
+    // --screenshot <file.tga>: with --software, save the last frame
+    // --trace <file.json>: save the profiler zones still in memory on exit as a Chrome trace
+    // --capture <file>: write every UI frame's draw data to a capture file
+    // --replay <file>: draw the frames of a capture instead of the UI, looping at the end
+    // --dashboard: open the dashboard window, whose plots are built on the job system
+    // --font <file.ttf>: UI font instead of imgui's default one, --font-size <px> (default: 16)
+    // --font-ranges <name>: glyphs to bake, e.g. japanese or chinese (default: default, see UIFontConfig)
+    // --font-cache <file> / --no-font-cache: where the font atlas is cached between runs (default: imgui_fonts.cache)
+    // --font-sdf: bake the UI font as a distance field once and scale it to --font-size (see UIFontConfig::distanceField)
+    // --glyph-cache-pages <n>: atlas pages for glyphs of --font outside its ranges, loaded when drawn (default: 16, 0 to disable)
+    // --text-cache: reuse the layouts of unchanged text instead of measuring and laying out all text every frame
+    // --threads <n>: job system threads, including the main thread (default: one per core)
+    // --record-threads <n>: max command lists recorded in parallel (default: one per job system thread)
+    // --no-pipeline: don't overlap building the next frame with submitting the current one
+    // --power-saving / --no-power-saving: skip identical frames and sleep while idle (default: on, off when headless)
+    // --idle-wake <ms>: longest sleep while idle (default: 250)
+    // --latency <1-3>: frames queued ahead of the display (default: 2)
+    // --no-vsync: present without waiting for vblank, --tearing to also allow tearing
+    // --jit / --no-jit: sample input just in time for the next refresh (default: on, off when headless or at --latency 1)
+    // --bench-jobs: run the job system microbenchmarks and exit
+    // --bench-descriptors: run the descriptor allocator benchmark and exit
+    // --bench-upload-ring: check upload ring allocations against frames the GPU hasn't retired yet and exit
+    // --bench-graph: run the render graph compiler benchmark and exit
+    // --bench-pacing: run the frame pacer against a simulated display and exit
+    // --bench-profiler: time profiler zones and check reading the rings while they are written, then exit
+    // --bench-gpu-timing: check GPU timestamp readback against the null device's synthetic clock and exit
+    // --bench-record: record scene items into command lists on one and on --record-threads threads, check their order and exit
+    // --bench-tessellation: compare scalar and SIMD polyline tessellation in imgui and exit
+    // --bench-font-atlas: time building the font atlas (of --font, if given) serially, in parallel and from the cache, then exit
+    // --bench-sdf-font: build a distance field atlas of --font serially and in parallel, check it against a plain one and exit
+    // --bench-glyph-cache: draw text over all glyphs of --font through the glyph cache, check them against a full atlas and exit
+    // --bench-text-cache: measure and draw a mostly unchanged log with and without imgui's text layout cache, compare and exit
+    // --bench-text-decode: decode, measure and draw ASCII and CJK logs with imgui's text functions, check them and exit
+    // --bench-hash: time imgui's ID hashing on a large UI's ID stack, check it against the original CRC32 and exit
+    // --bench-storage: insert and look up 10^3 to 10^6 IDs in imgui's sorted and hashed key->value storages, compare and exit
+    // --bench-ui-alloc: churn allocations through imgui with malloc() and with the UI allocator's pools and arena, check and exit
+    // --bench-draw-list-retention: run windows that come and go with imgui's draw list buffers compacted and retained, compare and exit
+    // --bench-large-mesh: upload a million vertex scatter plot's indices as is and packed 16/32-bit per draw list, check and exit
+    // --bench-draw-merge: merge adjacent draw commands of imgui windows (or of the --replay capture), check pixels and exit
+    AppConfig config;
+    bool benchJobs = false;
+    bool benchDescriptors = false;
+    bool benchUploadRing = false;
+    bool benchGraph = false;
+    bool benchPacing = false;
+    bool benchProfiler = false;
+    bool benchGpuTiming = false;
+    bool benchRecord = false;
+    bool benchTessellation = false;
+    bool benchFontAtlas = false;
+    bool benchGlyphCache = false;
+    bool benchSdfFont = false;
+    bool benchTextCache = false;
+    bool benchTextDecode = false;
+    bool benchHash = false;
+    bool benchStorage = false;
+    bool benchUIAlloc = false;
+    bool benchDrawListRetention = false;
+    bool benchLargeMesh = false;
+    bool benchDrawMerge = false;
+    int powerSaving = -1;
+    int justInTime = -1;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--headless") == 0)
+        {
+            config.headless = true;
+            if (i + 1 < argc && argv[i + 1][0] != '-')
+                config.headlessFrames = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--software") == 0)
+        {
+            config.softwareRasterizer = true;
+        }
+        else if (strcmp(argv[i], "--screenshot") == 0 && i + 1 < argc)
+        {
+            config.screenshotPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            config.tracePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--capture") == 0 && i + 1 < argc)
+        {
+            config.capturePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc)
+        {
+            config.replayPath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--dashboard") == 0)
+        {
+            config.showDashboard = true;
+        }
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc)
+        {
+            config.fonts.path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--font-size") == 0 && i + 1 < argc)
+        {
+            config.fonts.size = strtof(argv[++i], nullptr);
+        }
+        else if (strcmp(argv[i], "--font-ranges") == 0 && i + 1 < argc)
+        {
+            config.fonts.glyphRanges = argv[++i];
+        }
+        else if (strcmp(argv[i], "--font-cache") == 0 && i + 1 < argc)
+        {
+            config.fonts.cachePath = argv[++i];
+        }
+        else if (strcmp(argv[i], "--no-font-cache") == 0)
+        {
+            config.fonts.cachePath = nullptr;
+        }
+        else if (strcmp(argv[i], "--font-sdf") == 0)
+        {
+            config.fonts.distanceField = true;
+        }
+        else if (strcmp(argv[i], "--glyph-cache-pages") == 0 && i + 1 < argc)
+        {
+            config.fonts.glyphCachePages = (int)strtol(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--text-cache") == 0)
+        {
+            config.fonts.textLayoutCache = true;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+        {
+            config.threads = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--record-threads") == 0 && i + 1 < argc)
+        {
+            config.recordThreads = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--no-pipeline") == 0)
+        {
+            config.pipelined = false;
+        }
+        else if (strcmp(argv[i], "--power-saving") == 0)
+        {
+            powerSaving = 1;
+        }
+        else if (strcmp(argv[i], "--no-power-saving") == 0)
+        {
+            powerSaving = 0;
+        }
+        else if (strcmp(argv[i], "--idle-wake") == 0 && i + 1 < argc)
+        {
+            config.idleWakeSeconds = strtod(argv[++i], nullptr) / 1000.0;
+        }
+        else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc)
+        {
+            config.pacing.maxLatency = (uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (strcmp(argv[i], "--no-vsync") == 0)
+        {
+            config.pacing.vsync = false;
+        }
+        else if (strcmp(argv[i], "--tearing") == 0)
+        {
+            config.pacing.vsync = false;
+            config.pacing.tearing = true;
+        }
+        else if (strcmp(argv[i], "--jit") == 0)
+        {
+            justInTime = 1;
+        }
+        else if (strcmp(argv[i], "--no-jit") == 0)
+        {
+            justInTime = 0;
+        }
+        else if (strcmp(argv[i], "--bench-jobs") == 0)
+        {
+            benchJobs = true;
+        }
+        else if (strcmp(argv[i], "--bench-descriptors") == 0)
+        {
+            benchDescriptors = true;
+        }
+        else if (strcmp(argv[i], "--bench-upload-ring") == 0)
+        {
+            benchUploadRing = true;
+        }
+        else if (strcmp(argv[i], "--bench-graph") == 0)
+        {
+            benchGraph = true;
+        }
+        else if (strcmp(argv[i], "--bench-pacing") == 0)
+        {
+            benchPacing = true;
+        }
+        else if (strcmp(argv[i], "--bench-profiler") == 0)
+        {
+            benchProfiler = true;
+        }
+        else if (strcmp(argv[i], "--bench-gpu-timing") == 0)
+        {
+            benchGpuTiming = true;
+        }
+        else if (strcmp(argv[i], "--bench-record") == 0)
+        {
+            benchRecord = true;
+        }
+        else if (strcmp(argv[i], "--bench-tessellation") == 0)
+        {
+            benchTessellation = true;
+        }
+        else if (strcmp(argv[i], "--bench-font-atlas") == 0)
+        {
+            benchFontAtlas = true;
+        }
+        else if (strcmp(argv[i], "--bench-glyph-cache") == 0)
+        {
+            benchGlyphCache = true;
+        }
+        else if (strcmp(argv[i], "--bench-sdf-font") == 0)
+        {
+            benchSdfFont = true;
+        }
+        else if (strcmp(argv[i], "--bench-text-cache") == 0)
+        {
+            benchTextCache = true;
+        }
+        else if (strcmp(argv[i], "--bench-text-decode") == 0)
+        {
+            benchTextDecode = true;
+        }
+        else if (strcmp(argv[i], "--bench-hash") == 0)
+        {
+            benchHash = true;
+        }
+        else if (strcmp(argv[i], "--bench-storage") == 0)
+        {
+            benchStorage = true;
+        }
+        else if (strcmp(argv[i], "--bench-ui-alloc") == 0)
+        {
+            benchUIAlloc = true;
+        }
+        else if (strcmp(argv[i], "--bench-draw-list-retention") == 0)
+        {
+            benchDrawListRetention = true;
+        }
+        else if (strcmp(argv[i], "--bench-large-mesh") == 0)
+        {
+            benchLargeMesh = true;
+        }
+        else if (strcmp(argv[i], "--bench-draw-merge") == 0)
+        {
+            benchDrawMerge = true;
+        }
+    }
+
+    // Headless runs are benchmarks, they render every frame unless asked otherwise
+    config.powerSaving = powerSaving >= 0 ? powerSaving != 0 : !config.headless;
+    // At latency 1 nothing is queued to cover a frame that takes longer than predicted, so just in time sampling trades
+    // every hitch for a repeated refresh. It only pays off by default once a queued frame can absorb them.
+    config.pacing.justInTime = justInTime >= 0 ? justInTime != 0 : !config.headless && config.pacing.maxLatency > 1;
+
+    if (benchJobs)
+    {
+        RunJobSystemBenchmark(config.threads);
+        return 0;
+    }
+    if (benchDescriptors)
+    {
+        RunDescriptorAllocatorBenchmark();
+        return 0;
+    }
+    if (benchUploadRing)
+    {
+        RunUploadRingBenchmark();
+        return 0;
+    }
+    if (benchGraph)
+    {
+        RunRenderGraphBenchmark();
+        return 0;
+    }
+    if (benchPacing)
+    {
+        RunFramePacingBenchmark();
+        return 0;
+    }
+    if (benchProfiler)
+    {
+        RunProfilerBenchmark();
+        return 0;
+    }
+    if (benchGpuTiming)
+    {
+        RunGpuTimingBenchmark();
+        return 0;
+    }
+    if (benchRecord)
+    {
+        RunRecordBenchmark(config.threads, config.recordThreads);
+        return 0;
+    }
+    if (benchTessellation)
+    {
+        RunTessellationBenchmark();
+        return 0;
+    }
+    if (benchFontAtlas)
+    {
+        RunFontAtlasBenchmark(config.threads, config.fonts.path);
+        return 0;
+    }
+    if (benchGlyphCache)
+    {
+        RunGlyphCacheBenchmark(config.fonts.path, config.fonts.size);
+        return 0;
+    }
+    if (benchSdfFont)
+    {
+        RunDistanceFieldFontBenchmark(config.threads, config.fonts.path);
+        return 0;
+    }
+    if (benchTextCache)
+    {
+        RunTextLayoutCacheBenchmark(config.fonts.path, config.fonts.size);
+        return 0;
+    }
+    if (benchTextDecode)
+    {
+        RunTextDecodeBenchmark(config.fonts.path, config.fonts.size);
+        return 0;
+    }
+    if (benchHash)
+    {
+        RunHashBenchmark();
+        return 0;
+    }
+    if (benchStorage)
+    {
+        RunStorageBenchmark();
+        return 0;
+    }
+    if (benchUIAlloc)
+    {
+        RunUIAllocatorBenchmark(config.threads);
+        return 0;
+    }
+    if (benchDrawListRetention)
+    {
+        RunDrawListRetentionBenchmark();
+        return 0;
+    }
+    if (benchLargeMesh)
+    {
+        RunLargeMeshBenchmark();
+        return 0;
+    }
+
+    if (benchDrawMerge)
+    {
+        RunDrawMergeBenchmark(config.replayPath);
+        return 0;
+    }
+
     // Initialize our app
-    App* app = new App();
+    App* app = new App(config);
     // Run the entire app. This starts an infinite loop until we exit.
     app->Run();
     